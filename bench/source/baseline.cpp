@@ -0,0 +1,437 @@
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string_view>
+#include <utility>
+
+#include "baseline.hpp"
+
+#include <fmt/format.h>
+
+#include "logging_macros.h"
+
+namespace bench
+{
+namespace
+{
+// Scales a MAD to the standard deviation of normally distributed samples.
+constexpr double kMadToSigma = 1.4826;
+
+/// Just enough JSON for the files written by this tool.
+struct JsonValue
+{
+    enum class Kind
+    {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object,
+    };
+
+    Kind kind = Kind::Null;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue>> members;
+
+    [[nodiscard]] const JsonValue* Find(std::string_view key) const
+    {
+        for (const auto& [name, value] : members) {
+            if (name == key) {
+                return &value;
+            }
+        }
+        return nullptr;
+    }
+};
+
+class JsonParser
+{
+  public:
+    explicit JsonParser(std::string_view text)
+        : mText(text)
+    {
+    }
+
+    bool Parse(JsonValue& value)
+    {
+        if (!ParseValue(value)) {
+            return false;
+        }
+        SkipWhitespace();
+        return mPos == mText.size();
+    }
+
+    [[nodiscard]] size_t GetPosition() const { return mPos; }
+
+  private:
+    void SkipWhitespace()
+    {
+        while (mPos < mText.size()
+               && std::isspace(static_cast<unsigned char>(mText[mPos])))
+        {
+            ++mPos;
+        }
+    }
+
+    bool Consume(char c)
+    {
+        SkipWhitespace();
+        if (mPos < mText.size() && mText[mPos] == c) {
+            ++mPos;
+            return true;
+        }
+        return false;
+    }
+
+    bool ConsumeWord(std::string_view word)
+    {
+        if (mText.substr(mPos, word.size()) != word) {
+            return false;
+        }
+        mPos += word.size();
+        return true;
+    }
+
+    bool ParseValue(JsonValue& value)
+    {
+        SkipWhitespace();
+        if (mPos >= mText.size()) {
+            return false;
+        }
+        switch (mText[mPos]) {
+            case '{':
+                return ParseObject(value);
+            case '[':
+                return ParseArray(value);
+            case '"':
+                value.kind = JsonValue::Kind::String;
+                return ParseString(value.string);
+            case 't':
+                value.kind = JsonValue::Kind::Bool;
+                value.number = 1.0;
+                return ConsumeWord("true");
+            case 'f':
+                value.kind = JsonValue::Kind::Bool;
+                return ConsumeWord("false");
+            case 'n':
+                value.kind = JsonValue::Kind::Null;
+                return ConsumeWord("null");
+            default:
+                return ParseNumber(value);
+        }
+    }
+
+    bool ParseObject(JsonValue& value)
+    {
+        value.kind = JsonValue::Kind::Object;
+        ++mPos;
+        if (Consume('}')) {
+            return true;
+        }
+        do {
+            std::string key;
+            SkipWhitespace();
+            if (!ParseString(key) || !Consume(':')) {
+                return false;
+            }
+            JsonValue member;
+            if (!ParseValue(member)) {
+                return false;
+            }
+            value.members.emplace_back(std::move(key), std::move(member));
+        } while (Consume(','));
+        return Consume('}');
+    }
+
+    bool ParseArray(JsonValue& value)
+    {
+        value.kind = JsonValue::Kind::Array;
+        ++mPos;
+        if (Consume(']')) {
+            return true;
+        }
+        do {
+            JsonValue item;
+            if (!ParseValue(item)) {
+                return false;
+            }
+            value.items.push_back(std::move(item));
+        } while (Consume(','));
+        return Consume(']');
+    }
+
+    bool ParseString(std::string& out)
+    {
+        if (mPos >= mText.size() || mText[mPos] != '"') {
+            return false;
+        }
+        ++mPos;
+        while (mPos < mText.size()) {
+            char c = mText[mPos++];
+            if (c == '"') {
+                return true;
+            }
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (mPos >= mText.size()) {
+                return false;
+            }
+            char escaped = mText[mPos++];
+            switch (escaped) {
+                case 'n':
+                    out += '\n';
+                    break;
+                case 't':
+                    out += '\t';
+                    break;
+                case 'u':
+                    // Only written for control characters; keep a marker.
+                    mPos = std::min(mPos + 4, mText.size());
+                    out += '?';
+                    break;
+                default:
+                    out += escaped;
+                    break;
+            }
+        }
+        return false;
+    }
+
+    bool ParseNumber(JsonValue& value)
+    {
+        value.kind = JsonValue::Kind::Number;
+        const char* begin = mText.data() + mPos;
+        const char* end = mText.data() + mText.size();
+        auto [ptr, ec] = std::from_chars(begin, end, value.number);
+        if (ec != std::errc {}) {
+            return false;
+        }
+        mPos += static_cast<size_t>(ptr - begin);
+        return true;
+    }
+
+    std::string_view mText;
+    size_t mPos = 0;
+};
+
+std::string_view VerdictName(Verdict verdict)
+{
+    switch (verdict) {
+        case Verdict::Ok:
+            return "ok";
+        case Verdict::Improved:
+            return "improved";
+        case Verdict::Regressed:
+            return "REGRESSED";
+        case Verdict::New:
+            return "new";
+        case Verdict::Missing:
+            return "missing";
+    }
+    return "";
+}
+}    // namespace
+
+std::string BaselineKey(const std::string& adapter,
+                        const std::string& buildType)
+{
+    return adapter + "|" + buildType;
+}
+
+std::optional<Baseline> LoadBaseline(const std::string& path)
+{
+    Baseline baseline;
+    std::ifstream in(path);
+    if (!in) {
+        LOG_WARN("No baseline at {}, starting from an empty one", path);
+        return baseline;
+    }
+    std::stringstream contents;
+    contents << in.rdbuf();
+    const std::string text = contents.str();
+
+    JsonValue root;
+    JsonParser parser(text);
+    if (!parser.Parse(root) || root.kind != JsonValue::Kind::Object) {
+        LOG_ERROR("Malformed baseline {} near offset {}",
+                  path,
+                  parser.GetPosition());
+        return std::nullopt;
+    }
+    const JsonValue* runs = root.Find("runs");
+    if (runs == nullptr || runs->kind != JsonValue::Kind::Object) {
+        LOG_ERROR("Baseline {} has no \"runs\" object", path);
+        return std::nullopt;
+    }
+    for (const auto& [key, run] : runs->members) {
+        BaselineRun& entries = baseline.runs[key];
+        for (const auto& [name, entry] : run.members) {
+            const JsonValue* median = entry.Find("median_ms");
+            const JsonValue* mad = entry.Find("mad_ms");
+            if (median == nullptr || median->kind != JsonValue::Kind::Number)
+            {
+                LOG_ERROR("Baseline entry {} in {} has no median", name, key);
+                return std::nullopt;
+            }
+            entries[name] = {
+                .medianMs = median->number,
+                .madMs = mad != nullptr ? mad->number : 0.0,
+            };
+        }
+    }
+    return baseline;
+}
+
+std::string BaselineToJSON(const Baseline& baseline)
+{
+    std::string json = "{\n  \"version\": 1,\n  \"runs\": {";
+    bool firstRun = true;
+    for (const auto& [key, run] : baseline.runs) {
+        json += fmt::format(
+            "{}\n    \"{}\": {{", firstRun ? "" : ",", EscapeJSON(key));
+        bool firstEntry = true;
+        for (const auto& [name, entry] : run) {
+            json += fmt::format(
+                "{}\n      \"{}\": {{\"median_ms\": {:.6f}, "
+                "\"mad_ms\": {:.6f}}}",
+                firstEntry ? "" : ",",
+                EscapeJSON(name),
+                entry.medianMs,
+                entry.madMs);
+            firstEntry = false;
+        }
+        json += run.empty() ? "}" : "\n    }";
+        firstRun = false;
+    }
+    json += baseline.runs.empty() ? "}\n}\n" : "\n  }\n}\n";
+    return json;
+}
+
+bool SaveBaseline(const std::string& path, const Baseline& baseline)
+{
+    std::ofstream out(path);
+    if (!out) {
+        LOG_ERROR("Cannot write baseline {}", path);
+        return false;
+    }
+    out << BaselineToJSON(baseline);
+    return static_cast<bool>(out);
+}
+
+void UpdateBaseline(Baseline& baseline,
+                    const std::string& key,
+                    const std::vector<Result>& results)
+{
+    BaselineRun& run = baseline.runs[key];
+    run.clear();
+    for (const Result& result : results) {
+        run[result.name] = {.medianMs = result.medianMs,
+                            .madMs = result.madMs};
+    }
+}
+
+std::vector<Comparison> Compare(const BaselineRun& baseline,
+                                const std::vector<Result>& results,
+                                const Thresholds& thresholds)
+{
+    std::vector<Comparison> comparisons;
+    for (const Result& result : results) {
+        Comparison comparison {
+            .name = result.name,
+            .currentMs = result.medianMs,
+        };
+        auto it = baseline.find(result.name);
+        if (it == baseline.end()) {
+            comparison.verdict = Verdict::New;
+            comparisons.push_back(std::move(comparison));
+            continue;
+        }
+        const BaselineEntry& entry = it->second;
+        double mad = std::max(entry.madMs, result.madMs);
+        comparison.baselineMs = entry.medianMs;
+        comparison.allowedMs =
+            std::max({thresholds.madScale * kMadToSigma * mad,
+                      thresholds.relative * entry.medianMs,
+                      thresholds.absoluteMs});
+        double delta = result.medianMs - entry.medianMs;
+        if (delta > comparison.allowedMs) {
+            comparison.verdict = Verdict::Regressed;
+        } else if (-delta > comparison.allowedMs) {
+            comparison.verdict = Verdict::Improved;
+        }
+        comparisons.push_back(std::move(comparison));
+    }
+    for (const auto& [name, entry] : baseline) {
+        bool measured = std::any_of(results.begin(),
+                                    results.end(),
+                                    [&name](const Result& result)
+                                    { return result.name == name; });
+        if (!measured) {
+            comparisons.push_back({
+                .name = name,
+                .baselineMs = entry.medianMs,
+                .verdict = Verdict::Missing,
+            });
+        }
+    }
+    return comparisons;
+}
+
+bool HasRegression(const std::vector<Comparison>& comparisons)
+{
+    return std::any_of(comparisons.begin(),
+                       comparisons.end(),
+                       [](const Comparison& comparison)
+                       { return comparison.verdict == Verdict::Regressed; });
+}
+
+std::string FormatReport(const std::vector<Comparison>& comparisons)
+{
+    size_t width = 9;
+    for (const Comparison& comparison : comparisons) {
+        width = std::max(width, comparison.name.size());
+    }
+    constexpr std::string_view kRow =
+        "{:<{}}  {:>12}  {:>12}  {:>9}  {:>12}  {}\n";
+    constexpr std::string_view kNumericRow =
+        "{:<{}}  {:>12.4f}  {:>12.4f}  {:>9}  {:>12.4f}  {}\n";
+    std::string report = fmt::format(fmt::runtime(kRow),
+                                     "benchmark",
+                                     width,
+                                     "baseline ms",
+                                     "current ms",
+                                     "change",
+                                     "allowed ms",
+                                     "verdict");
+    for (const Comparison& comparison : comparisons) {
+        std::string change = "-";
+        if (comparison.baselineMs > 0.0 && comparison.verdict != Verdict::New
+            && comparison.verdict != Verdict::Missing)
+        {
+            change = fmt::format(
+                "{:+.1f}%",
+                100.0 * (comparison.currentMs - comparison.baselineMs)
+                    / comparison.baselineMs);
+        }
+        report += fmt::format(fmt::runtime(kNumericRow),
+                              comparison.name,
+                              width,
+                              comparison.baselineMs,
+                              comparison.currentMs,
+                              change,
+                              comparison.allowedMs,
+                              VerdictName(comparison.verdict));
+    }
+    return report;
+}
+
+}    // namespace bench
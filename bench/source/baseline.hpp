@@ -0,0 +1,101 @@
+#pragma once
+
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+namespace bench
+{
+/// Stored timing of one benchmark.
+struct BaselineEntry
+{
+    double medianMs = 0.0;
+    double madMs = 0.0;
+};
+
+/// Benchmark name -> timing, for one adapter and build type.
+using BaselineRun = std::map<std::string, BaselineEntry>;
+
+/**
+ * @brief Reference timings keyed by "<adapter>|<build type>".
+ *
+ * Stored as JSON:
+ * {"version": 1, "runs": {"<key>": {"<name>": {"median_ms": x,
+ * "mad_ms": y}, ...}, ...}}
+ */
+struct Baseline
+{
+    std::map<std::string, BaselineRun> runs;
+};
+
+/// How far a median may move before it counts as a regression.
+struct Thresholds
+{
+    double madScale = 4.0;    // allowed deviations, in scaled MAD units
+    double relative = 0.25;    // allowed fraction of the baseline median
+    double absoluteMs = 0.05;    // differences below this are always noise
+};
+
+enum class Verdict
+{
+    Ok,
+    Improved,
+    Regressed,
+    New,    // no baseline entry for this benchmark
+    Missing,    // in the baseline but not measured
+};
+
+struct Comparison
+{
+    std::string name;
+    double baselineMs = 0.0;
+    double currentMs = 0.0;
+    double allowedMs = 0.0;    // largest accepted increase
+    Verdict verdict = Verdict::Ok;
+};
+
+/// Key under which results from this adapter and build are stored.
+[[nodiscard]] std::string BaselineKey(const std::string& adapter,
+                                      const std::string& buildType);
+
+/**
+ * @brief Reads a baseline file.
+ * @return an empty baseline if the file does not exist, std::nullopt if it
+ * cannot be parsed
+ */
+[[nodiscard]] std::optional<Baseline> LoadBaseline(const std::string& path);
+
+[[nodiscard]] std::string BaselineToJSON(const Baseline& baseline);
+
+[[nodiscard]] bool SaveBaseline(const std::string& path,
+                                const Baseline& baseline);
+
+/// Replaces the stored run for `key` with the given results.
+void UpdateBaseline(Baseline& baseline,
+                    const std::string& key,
+                    const std::vector<Result>& results);
+
+/**
+ * @brief Compares measured medians against the baseline.
+ *
+ * A benchmark regresses when its median exceeds the baseline median by more
+ * than max(madScale * 1.4826 * MAD, relative * median, absoluteMs), where
+ * MAD is the larger of the stored and the measured one; 1.4826 scales the
+ * MAD to a standard deviation for normally distributed noise. The symmetric
+ * drop is reported as an improvement.
+ */
+[[nodiscard]] std::vector<Comparison> Compare(
+    const BaselineRun& baseline,
+    const std::vector<Result>& results,
+    const Thresholds& thresholds);
+
+[[nodiscard]] bool HasRegression(const std::vector<Comparison>& comparisons);
+
+/// Human-readable table of the comparisons.
+[[nodiscard]] std::string FormatReport(
+    const std::vector<Comparison>& comparisons);
+
+}    // namespace bench
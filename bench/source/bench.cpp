@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "bench.hpp"
+
+#include <fmt/format.h>
+
+#include "autotune.hpp"
+#include "compute_kernel.hpp"
+#include "logging_macros.h"
+
+#ifndef CONGPU_BUILD_TYPE
+#    define CONGPU_BUILD_TYPE "unknown"
+#endif
+
+namespace bench
+{
+double Median(std::vector<double> values)
+{
+    if (values.empty()) {
+        return 0.0;
+    }
+    auto mid = static_cast<std::ptrdiff_t>(values.size() / 2);
+    std::nth_element(values.begin(), values.begin() + mid, values.end());
+    double upper = values[static_cast<size_t>(mid)];
+    if (values.size() % 2 == 1) {
+        return upper;
+    }
+    double lower = *std::max_element(values.begin(), values.begin() + mid);
+    return (lower + upper) / 2.0;
+}
+
+double MedianAbsoluteDeviation(const std::vector<double>& values)
+{
+    double median = Median(values);
+    std::vector<double> deviations;
+    deviations.reserve(values.size());
+    for (double value : values) {
+        deviations.push_back(std::abs(value - median));
+    }
+    return Median(std::move(deviations));
+}
+
+Runner::Runner(Options options)
+    : mOptions(std::move(options))
+{
+}
+
+bool Runner::Enabled(const std::string& name) const
+{
+    return mOptions.filter.empty()
+        || name.find(mOptions.filter) != std::string::npos;
+}
+
+void Runner::Record(const std::string& name,
+                    std::vector<double> samples,
+                    double work,
+                    const std::string& unit)
+{
+    Result result {};
+    result.name = name;
+    result.medianMs = Median(samples);
+    result.madMs = MedianAbsoluteDeviation(samples);
+    result.minMs = samples.empty()
+        ? 0.0
+        : *std::min_element(samples.begin(), samples.end());
+    result.meanMs = samples.empty()
+        ? 0.0
+        : std::accumulate(samples.begin(), samples.end(), 0.0)
+            / static_cast<double>(samples.size());
+    if (work > 0.0 && result.medianMs > 0.0) {
+        result.throughput = work / (result.medianMs / 1000.0);
+        result.unit = unit;
+    }
+    result.samplesMs = std::move(samples);
+
+    LOG_INFO("{:<40} median {:10.4f} ms  mad {:8.4f} ms{}",
+             result.name,
+             result.medianMs,
+             result.madMs,
+             result.unit.empty()
+                 ? std::string {}
+                 : fmt::format("  {:.3f} {}", result.throughput, result.unit));
+    mResults.push_back(std::move(result));
+}
+
+const std::vector<Result>& Runner::GetResults() const
+{
+    return mResults;
+}
+
+std::string Runner::ToJSON(const Context& context) const
+{
+    std::string json = fmt::format(
+        "{{\n  \"adapter\": \"{}\",\n  \"build_type\": \"{}\",\n"
+        "  \"repetitions\": {},\n  \"benchmarks\": [",
+        EscapeJSON(autotune::AdapterKey(context.adapterInfo)),
+        EscapeJSON(BuildType()),
+        mOptions.repetitions);
+    bool first = true;
+    for (const Result& r : mResults) {
+        json += fmt::format(
+            "{}\n    {{\"name\": \"{}\", \"median_ms\": {:.6f}, "
+            "\"mad_ms\": {:.6f}, \"min_ms\": {:.6f}, \"mean_ms\": {:.6f}, "
+            "\"throughput\": {:.6f}, \"unit\": \"{}\"}}",
+            first ? "" : ",",
+            EscapeJSON(r.name),
+            r.medianMs,
+            r.madMs,
+            r.minMs,
+            r.meanMs,
+            r.throughput,
+            EscapeJSON(r.unit));
+        first = false;
+    }
+    json += "\n  ]\n}\n";
+    return json;
+}
+
+std::string EscapeJSON(std::string_view text)
+{
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+            case '"':
+                escaped += "\\\"";
+                break;
+            case '\\':
+                escaped += "\\\\";
+                break;
+            case '\n':
+                escaped += "\\n";
+                break;
+            case '\t':
+                escaped += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    escaped += fmt::format(
+                        "\\u{:04x}", static_cast<unsigned char>(c));
+                } else {
+                    escaped += c;
+                }
+        }
+    }
+    return escaped;
+}
+
+double SubmitAndTime(const Context& context, wgpu::CommandEncoder encoder)
+{
+    wgpu::CommandBuffer commandBuffer = encoder.Finish();
+    auto start = std::chrono::steady_clock::now();
+    context.queue.Submit(1, &commandBuffer);
+    compute_kernel::WaitForQueue(context.instance, context.device);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+std::string BuildType()
+{
+    return CONGPU_BUILD_TYPE;
+}
+
+}    // namespace bench
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <webgpu/webgpu_cpp.h>
+
+#include "slang_compiler.hpp"
+
+namespace bench
+{
+/// Device and compiler shared by all benchmark suites.
+struct Context
+{
+    wgpu::Instance instance {nullptr};
+    wgpu::Adapter adapter {nullptr};
+    wgpu::Device device {nullptr};
+    wgpu::Queue queue {nullptr};
+    wgpu::AdapterInfo adapterInfo {};
+    slang_compiler::Compiler* compiler = nullptr;
+};
+
+/// Timings of one benchmark, in milliseconds per iteration.
+struct Result
+{
+    std::string name;
+    std::vector<double> samplesMs;
+    double medianMs = 0.0;
+    double madMs = 0.0;    // median absolute deviation
+    double minMs = 0.0;
+    double meanMs = 0.0;
+    double throughput = 0.0;    // work per second at the median, if any
+    std::string unit;    // unit of throughput, e.g. "GB/s"
+};
+
+struct Options
+{
+    std::string filter;    // only run benchmarks whose name contains this
+    int repetitions = 10;
+    int warmup = 2;
+};
+
+[[nodiscard]] double Median(std::vector<double> values);
+[[nodiscard]] double MedianAbsoluteDeviation(const std::vector<double>& values);
+
+/**
+ * @brief Runs benchmarks and collects their statistics.
+ *
+ * Each benchmark runs `warmup` untimed iterations followed by `repetitions`
+ * timed ones. Throughput is reported as `work / median seconds`, so `work`
+ * should be given in the numerator of `unit` (bytes × 1e-9 for "GB/s", ...).
+ */
+class Runner
+{
+  public:
+    explicit Runner(Options options);
+
+    [[nodiscard]] bool Enabled(const std::string& name) const;
+
+    /// Times each call of `fn` with a steady clock.
+    template<typename F>
+    void Run(const std::string& name,
+             F&& fn,
+             double work = 0.0,
+             const std::string& unit = {})
+    {
+        RunManual(
+            name,
+            [&fn]()
+            {
+                auto start = std::chrono::steady_clock::now();
+                fn();
+                auto end = std::chrono::steady_clock::now();
+                return std::chrono::duration<double, std::milli>(end - start)
+                    .count();
+            },
+            work,
+            unit);
+    }
+
+    /// Like Run(), but `fn` returns the milliseconds to record so that it
+    /// can exclude its own setup from the measurement.
+    template<typename F>
+    void RunManual(const std::string& name,
+                   F&& fn,
+                   double work = 0.0,
+                   const std::string& unit = {})
+    {
+        if (!Enabled(name)) {
+            return;
+        }
+        for (int i = 0; i < mOptions.warmup; ++i) {
+            fn();
+        }
+        std::vector<double> samples;
+        samples.reserve(static_cast<size_t>(mOptions.repetitions));
+        for (int i = 0; i < mOptions.repetitions; ++i) {
+            samples.push_back(fn());
+        }
+        Record(name, std::move(samples), work, unit);
+    }
+
+    [[nodiscard]] const std::vector<Result>& GetResults() const;
+
+    /// All results and the adapter they were measured on, as JSON.
+    [[nodiscard]] std::string ToJSON(const Context& context) const;
+
+  private:
+    void Record(const std::string& name,
+                std::vector<double> samples,
+                double work,
+                const std::string& unit);
+
+    Options mOptions;
+    std::vector<Result> mResults;
+};
+
+/// Submits the encoder's commands and returns the milliseconds until the
+/// queue reports them done.
+[[nodiscard]] double SubmitAndTime(const Context& context,
+                                   wgpu::CommandEncoder encoder);
+
+/// Escapes `text` for use inside a JSON string literal.
+[[nodiscard]] std::string EscapeJSON(std::string_view text);
+
+/// CMake configuration the benchmarks were built with, e.g. "Release".
+[[nodiscard]] std::string BuildType();
+
+void RunCompileBenchmarks(Context& context, Runner& runner);
+void RunDispatchBenchmarks(Context& context, Runner& runner);
+void RunTransferBenchmarks(Context& context, Runner& runner);
+void RunMatmulBenchmarks(Context& context, Runner& runner);
+void RunNormalizationBenchmarks(Context& context, Runner& runner);
+void RunPermuteBenchmarks(Context& context, Runner& runner);
+void RunSubgroupBenchmarks(Context& context, Runner& runner);
+void RunSortBenchmarks(Context& context, Runner& runner);
+void RunPrintBenchmarks(Context& context, Runner& runner);
+
+}    // namespace bench
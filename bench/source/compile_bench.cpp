@@ -0,0 +1,83 @@
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "bench.hpp"
+#include "compute_kernel.hpp"
+#include "logging_macros.h"
+#include "tensor_buffer.hpp"
+#include "tensor_reflection.hpp"
+#include "uniform_buffer.hpp"
+
+namespace bench
+{
+void RunCompileBenchmarks(Context& context, Runner& runner)
+{
+    const slang_compiler::Compiler& compiler = *context.compiler;
+
+    runner.Run("slang/create_program/gemm",
+               [&compiler]()
+               {
+                   auto program = compiler.CreateProgram("matmul", "gemmNN");
+                   (void)program;
+               });
+
+    slang_compiler::SlangProgram program =
+        compiler.CreateProgram("matmul", "gemmNN");
+    runner.Run("slang/compile_to_wgsl/gemm",
+               [&program]()
+               {
+                   std::string wgsl = program.compileToWGSL();
+                   (void)wgsl;
+               });
+
+    if (!runner.Enabled("pipeline/create/gemm")) {
+        return;
+    }
+    auto* reflected = program.program.get();
+    auto uniformsInfo = uniform_buffer::ReflectUniformBuffer(reflected);
+    if (!uniformsInfo) {
+        LOG_ERROR("Failed to reflect matmul parameters");
+        return;
+    }
+    uniform_buffer::UniformBuffer uniforms(*uniformsInfo);
+    uniforms.Initialize(context.device);
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms);
+    std::vector<tensor_buffer::TensorBuffer> tensors;
+    tensors.reserve(3);
+    for (const char* name : {"a", "b", "c"}) {
+        auto info = tensor_reflection::ReflectTensorBuffer(reflected, name);
+        if (!info) {
+            LOG_ERROR("Failed to reflect matmul tensor {}", name);
+            return;
+        }
+        tensors.emplace_back(*info);
+        tensors.back().Initialize(context.device, sizeof(float), uniforms);
+        bindings.Add(tensors.back());
+    }
+    const std::string wgsl = program.compileToWGSL();
+
+    // Dawn deduplicates shader modules and pipelines with identical
+    // sources, so every iteration gets a unique comment appended.
+    int iteration = 0;
+    runner.RunManual(
+        "pipeline/create/gemm",
+        [&]()
+        {
+            std::string source =
+                fmt::format("{}\n// iteration {}\n", wgsl, iteration++);
+            compute_kernel::ComputeKernel kernel("bench_pipeline");
+            auto start = std::chrono::steady_clock::now();
+            kernel.Initialize(context.device,
+                              source,
+                              "gemmNN",
+                              bindings.GetLayoutEntries());
+            auto end = std::chrono::steady_clock::now();
+            return std::chrono::duration<double, std::milli>(end - start)
+                .count();
+        });
+}
+
+}    // namespace bench
@@ -0,0 +1,51 @@
+#include "bench.hpp"
+#include "compute_kernel.hpp"
+#include "logging_macros.h"
+
+namespace bench
+{
+namespace
+{
+const char* kEmptyKernel = R"(
+@compute @workgroup_size(1)
+fn computeMain() {}
+)";
+
+constexpr int kBatchedDispatches = 1000;
+}    // namespace
+
+void RunDispatchBenchmarks(Context& context, Runner& runner)
+{
+    compute_kernel::ComputeKernel kernel("bench_empty");
+    if (!kernel.Initialize(context.device, kEmptyKernel, "computeMain", {})) {
+        LOG_ERROR("Failed to create the empty kernel");
+        return;
+    }
+    wgpu::BindGroup bindGroup = kernel.CreateBindGroup({});
+
+    auto encode = [&](int dispatches)
+    {
+        wgpu::CommandEncoder encoder = context.device.CreateCommandEncoder();
+        wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+        pass.SetPipeline(kernel.GetPipeline());
+        pass.SetBindGroup(0, bindGroup);
+        for (int i = 0; i < dispatches; ++i) {
+            pass.DispatchWorkgroups(1, 1, 1);
+        }
+        pass.End();
+        return encoder;
+    };
+
+    // Round trip of a single empty dispatch: submit, execute, wait.
+    runner.RunManual("dispatch/empty/submit_wait",
+                     [&]() { return SubmitAndTime(context, encode(1)); });
+
+    // Per-dispatch cost once submission latency is amortized.
+    runner.RunManual(
+        "dispatch/empty/batched",
+        [&]() { return SubmitAndTime(context, encode(kBatchedDispatches)); },
+        kBatchedDispatches,
+        "dispatches/s");
+}
+
+}    // namespace bench
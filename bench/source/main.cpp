@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <webgpu/webgpu_cpp.h>
+
+#include "autotune.hpp"
+#include "baseline.hpp"
+#include "bench.hpp"
+#include "lib.hpp"
+#include "logging_macros.h"
+#include "slang_compiler.hpp"
+
+namespace
+{
+/// Exit code ctest treats as a skipped test (SKIP_RETURN_CODE).
+constexpr int kExitSkipped = 77;
+
+void PrintUsage()
+{
+    std::fputs(
+        "usage: congpu_bench [--out FILE] [--filter SUBSTRING]\n"
+        "                    [--repetitions N] [--hardware]\n"
+        "                    [--baseline FILE [--update-baseline]]\n"
+        "                    [--tolerance FRACTION]\n"
+        "Runs on Dawn's software adapter unless --hardware is given and\n"
+        "writes JSON results to FILE (default: congpu_bench.json).\n"
+        "With --baseline, compares the medians against the stored run for\n"
+        "this adapter and build type and fails on regressions;\n"
+        "--update-baseline stores the measured run instead.\n",
+        stderr);
+}
+
+/// Compares against, or updates, the baseline and returns the exit code.
+int CheckBaseline(const std::string& path,
+                  bench::Baseline& baseline,
+                  const std::string& key,
+                  bool update,
+                  const bench::Thresholds& thresholds,
+                  const bench::Runner& runner)
+{
+    if (update) {
+        bench::UpdateBaseline(baseline, key, runner.GetResults());
+        if (!bench::SaveBaseline(path, baseline)) {
+            return EXIT_FAILURE;
+        }
+        LOG_INFO("Stored baseline for {} in {}", key, path);
+        return EXIT_SUCCESS;
+    }
+
+    std::vector<bench::Comparison> comparisons =
+        bench::Compare(baseline.runs.at(key), runner.GetResults(), thresholds);
+    std::string report = bench::FormatReport(comparisons);
+    if (bench::HasRegression(comparisons)) {
+        LOG_ERROR("Performance regression against {}:\n{}", key, report);
+        return EXIT_FAILURE;
+    }
+    LOG_INFO("No regression against {}:\n{}", key, report);
+    return EXIT_SUCCESS;
+}
+}    // namespace
+
+int main(int argc, char** argv)
+{
+    std::string outPath = "congpu_bench.json";
+    bench::Options options;
+    bool hardware = false;
+    std::string baselinePath;
+    bool updateBaseline = false;
+    bench::Thresholds thresholds;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--out" && hasValue) {
+            outPath = argv[++i];
+        } else if (arg == "--filter" && hasValue) {
+            options.filter = argv[++i];
+        } else if (arg == "--repetitions" && hasValue) {
+            options.repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--hardware") {
+            hardware = true;
+        } else if (arg == "--baseline" && hasValue) {
+            baselinePath = argv[++i];
+        } else if (arg == "--update-baseline") {
+            updateBaseline = true;
+        } else if (arg == "--tolerance" && hasValue) {
+            thresholds.relative = std::atof(argv[++i]);
+        } else {
+            PrintUsage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    Library lib;
+    bench::Context context;
+    context.instance = lib.CreateInstance();
+    if (context.instance == nullptr) {
+        return EXIT_FAILURE;
+    }
+    context.adapter = lib.RequestAdapter(context.instance, !hardware);
+    if (context.adapter == nullptr) {
+        return EXIT_FAILURE;
+    }
+    context.adapterInfo = lib.GetAdapterInfo(context.adapter);
+
+    // Without a stored run there is nothing to compare against, so skip
+    // before spending the repetitions on benchmarks.
+    std::optional<bench::Baseline> baseline;
+    std::string baselineKey;
+    if (!baselinePath.empty()) {
+        baseline = bench::LoadBaseline(baselinePath);
+        if (!baseline) {
+            return EXIT_FAILURE;
+        }
+        baselineKey = bench::BaselineKey(
+            autotune::AdapterKey(context.adapterInfo), bench::BuildType());
+        if (!updateBaseline && !baseline->runs.contains(baselineKey)) {
+            LOG_WARN("No baseline for {} in {}; record one with "
+                     "--update-baseline",
+                     baselineKey,
+                     baselinePath);
+            return kExitSkipped;
+        }
+    }
+
+    context.device = lib.RequestDevice(context.adapter);
+    if (context.device == nullptr) {
+        return EXIT_FAILURE;
+    }
+    context.queue = context.device.GetQueue();
+
+    std::filesystem::path path(SHADERS_DIR);
+    slang_compiler::Compiler compiler({path.string()});
+    context.compiler = &compiler;
+
+    LOG_INFO("Benchmarking on {}", autotune::AdapterKey(context.adapterInfo));
+
+    bench::Runner runner(options);
+    bench::RunCompileBenchmarks(context, runner);
+    bench::RunDispatchBenchmarks(context, runner);
+    bench::RunTransferBenchmarks(context, runner);
+    bench::RunMatmulBenchmarks(context, runner);
+    bench::RunNormalizationBenchmarks(context, runner);
+    bench::RunPermuteBenchmarks(context, runner);
+    bench::RunSubgroupBenchmarks(context, runner);
+    bench::RunSortBenchmarks(context, runner);
+    bench::RunPrintBenchmarks(context, runner);
+
+    std::ofstream out(outPath);
+    if (!out) {
+        LOG_ERROR("Cannot write benchmark results to {}", outPath);
+        return EXIT_FAILURE;
+    }
+    out << runner.ToJSON(context);
+    LOG_INFO("Wrote {} results to {}", runner.GetResults().size(), outPath);
+
+    if (baseline) {
+        return CheckBaseline(baselinePath,
+                             *baseline,
+                             baselineKey,
+                             updateBaseline,
+                             thresholds,
+                             runner);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,353 @@
+#include <array>
+#include <cmath>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "bench.hpp"
+#include "autotune.hpp"
+#include "compute_kernel.hpp"
+#include "gemm.hpp"
+#include "gpu_memory.hpp"
+#include "logging_macros.h"
+#include "quantization.hpp"
+#include "tensor_buffer.hpp"
+#include "tensor_reflection.hpp"
+#include "uniform_buffer.hpp"
+
+namespace bench
+{
+namespace
+{
+/// One thread per output element; the baseline for the tiled GEMM.
+const char* kMatmulShader = R"(
+import tensor;
+RWTensorBuffer<float, int, int> a;
+RWTensorBuffer<float, int, int> b;
+RWTensorBuffer<float, int, int> c;
+uniform int M;
+uniform int N;
+uniform int K;
+[numthreads(8,8,1)]
+void computeMain(uint3 tid: SV_DispatchThreadID)
+{
+    int i = int(tid.x);
+    int j = int(tid.y);
+    if (i >= M || j >= N)
+        return;
+    float acc = 0.0f;
+    for (int k = 0; k < K; ++k)
+        acc += a[i, k] * b[k, j];
+    var out = c;
+    out[i, j] = acc;
+}
+)";
+
+constexpr uint32_t kTile = 8;
+constexpr std::array<int32_t, 3> kSizes = {64, 128, 256};
+
+struct GemmCase
+{
+    const char* name;
+    gemm::Variant variant;
+    gemm::Shape shape;
+};
+
+constexpr std::array<GemmCase, 9> kGemmCases = {{
+    {"square/64", gemm::Variant::NN, {.m = 64, .n = 64, .k = 64}},
+    {"square/128", gemm::Variant::NN, {.m = 128, .n = 128, .k = 128}},
+    {"square/256", gemm::Variant::NN, {.m = 256, .n = 256, .k = 256}},
+    {"square/512", gemm::Variant::NN, {.m = 512, .n = 512, .k = 512}},
+    {"square/256/NT", gemm::Variant::NT, {.m = 256, .n = 256, .k = 256}},
+    {"square/256/TN", gemm::Variant::TN, {.m = 256, .n = 256, .k = 256}},
+    {"skinny/16x1024x1024", gemm::Variant::NN, {.m = 16, .n = 1024, .k = 1024}},
+    {"skinny/1024x16x1024", gemm::Variant::NN, {.m = 1024, .n = 16, .k = 1024}},
+    {"skinny/1024x1024x16", gemm::Variant::NN, {.m = 1024, .n = 1024, .k = 16}},
+}};
+
+/// Checks the kernel against the CPU reference before it is timed.
+bool Validate(Context& context, gemm::Gemm& kernel)
+{
+    const gemm::Shape& shape = kernel.GetShape();
+    const auto m = static_cast<size_t>(shape.m);
+    const auto n = static_cast<size_t>(shape.n);
+    const auto k = static_cast<size_t>(shape.k);
+    std::vector<float> a(m * k);
+    std::vector<float> b(k * n);
+    for (size_t i = 0; i < a.size(); ++i) {
+        a[i] = static_cast<float>(i % 5) - 2.0f;
+    }
+    for (size_t i = 0; i < b.size(); ++i) {
+        b[i] = static_cast<float>(i % 3) - 1.0f;
+    }
+    kernel.WriteA(context.queue, a);
+    kernel.WriteB(context.queue, b);
+
+    wgpu::CommandEncoder encoder = context.device.CreateCommandEncoder();
+    wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+    kernel.Encode(pass);
+    pass.End();
+    (void)SubmitAndTime(context, encoder);
+
+    std::vector<float> expected(m * n);
+    gemm::ReferenceGemm(kernel.GetVariant(), shape, a, b, expected);
+    std::vector<float> result = kernel.ReadC(context.instance);
+    for (size_t i = 0; i < expected.size(); ++i) {
+        if (std::abs(result[i] - expected[i]) > 1e-3f) {
+            LOG_ERROR("GEMM mismatch at {}: {} != {}",
+                      i,
+                      result[i],
+                      expected[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+void TimeGemm(Context& context,
+              Runner& runner,
+              const std::string& name,
+              const gemm::Gemm& kernel)
+{
+    const gemm::Shape& shape = kernel.GetShape();
+    const double gflop = 2.0 * shape.m * shape.n * shape.k * 1e-9;
+    runner.RunManual(
+        name,
+        [&]()
+        {
+            wgpu::CommandEncoder encoder =
+                context.device.CreateCommandEncoder();
+            wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+            kernel.Encode(pass);
+            pass.End();
+            return SubmitAndTime(context, encoder);
+        },
+        gflop,
+        "GFLOP/s");
+}
+
+void RunTiledBenchmarks(Context& context, Runner& runner)
+{
+    for (const GemmCase& gemmCase : kGemmCases) {
+        const std::string name = fmt::format("gemm/tiled/{}", gemmCase.name);
+        if (!runner.Enabled(name)) {
+            continue;
+        }
+        gemm::Gemm kernel(gemmCase.variant);
+        if (!kernel.Initialize(context.device, *context.compiler)
+            || !kernel.Resize(context.queue, gemmCase.shape)
+            || !Validate(context, kernel))
+        {
+            LOG_ERROR("Skipping {}", name);
+            continue;
+        }
+
+        TimeGemm(context, runner, name, kernel);
+    }
+}
+
+/// Tunes the tile config for one shape, then times the winner.
+void RunTunedBenchmark(Context& context, Runner& runner)
+{
+    const std::string name = "gemm/tuned/square/256";
+    if (!runner.Enabled(name)) {
+        return;
+    }
+    const gemm::Shape shape = {.m = 256, .n = 256, .k = 256};
+    autotune::Autotuner tuner;
+    tuner.Initialize(context.instance, context.device);
+    autotune::TuningCache cache;
+    std::optional<gemm::TileConfig> best =
+        gemm::Autotune(tuner,
+                       cache,
+                       context.device,
+                       *context.compiler,
+                       gemm::Variant::NN,
+                       shape,
+                       autotune::AdapterKey(context.adapterInfo));
+    if (!best) {
+        return;
+    }
+    gemm::Gemm kernel(gemm::Variant::NN, *best);
+    if (!kernel.Initialize(context.device, *context.compiler)
+        || !kernel.Resize(context.queue, shape) || !Validate(context, kernel))
+    {
+        LOG_ERROR("Skipping {}", name);
+        return;
+    }
+    TimeGemm(context, runner, name, kernel);
+}
+
+/// Times quantized products of one [N, K] weight matrix, reporting the
+/// bandwidth of the packed weights that every product streams.
+void RunQuantizedBenchmarks(Context& context, Runner& runner)
+{
+    constexpr int32_t n = 2048;
+    constexpr int32_t k = 2048;
+    const std::vector<quantization::Format> formats = {
+        quantization::Format::Int8, quantization::Format::Int4};
+    const std::vector<int32_t> rows = {1, 64};
+
+    quantization::Matmul matmul;
+    std::vector<float> values;
+    for (quantization::Format format : formats) {
+        const int32_t bits = static_cast<int32_t>(quantization::BitsOf(format));
+        std::optional<quantization::DeviceWeights> weights;
+        for (int32_t m : rows) {
+            const auto strategy = m <= quantization::kGemvMaxRows
+                ? quantization::Strategy::Gemv
+                : quantization::Strategy::Gemm;
+            const std::string name =
+                fmt::format("gemm/int{}/{}x{}x{}", bits, m, n, k);
+            if (!runner.Enabled(name)) {
+                continue;
+            }
+            if (!matmul.Initialize(context.device, *context.compiler)) {
+                return;
+            }
+            if (!weights) {
+                if (values.empty()) {
+                    values.resize(static_cast<size_t>(n) * k);
+                    for (size_t i = 0; i < values.size(); ++i) {
+                        values[i] = static_cast<float>(i % 13) - 6.0f;
+                    }
+                }
+                // Groups of 128 along K, as is common for int4 weights.
+                weights = quantization::Load(
+                    context.device, values, n, k, format, 128);
+                if (!weights) {
+                    return;
+                }
+            }
+
+            const std::array<int32_t, 2> aDims = {m, k};
+            std::vector<float> activations(static_cast<size_t>(m) * k);
+            for (size_t i = 0; i < activations.size(); ++i) {
+                activations[i] = static_cast<float>(i % 7) * 0.25f - 0.75f;
+            }
+            wgpu::BufferDescriptor desc = {
+                .label = "bench_quantized",
+                .usage = wgpu::BufferUsage::Storage
+                    | wgpu::BufferUsage::CopyDst,
+                .size = activations.size() * sizeof(float),
+                .mappedAtCreation = false,
+            };
+            gpu_memory::TrackedBuffer a =
+                gpu_memory::CreateBuffer(context.device, desc);
+            desc.size = static_cast<uint64_t>(m) * n * sizeof(float);
+            gpu_memory::TrackedBuffer c =
+                gpu_memory::CreateBuffer(context.device, desc);
+            // Uploaded once: the timed products only read the activations.
+            context.queue.WriteBuffer(a.Get(),
+                                      0,
+                                      activations.data(),
+                                      activations.size() * sizeof(float));
+            const tensor_buffer::BufferView aView = {
+                a.Get(), tensor_buffer::TensorView::Contiguous(aDims)};
+
+            const double gigabytes =
+                static_cast<double>(weights->Bytes()) * 1e-9;
+            runner.RunManual(
+                name,
+                [&]()
+                {
+                    wgpu::CommandEncoder encoder =
+                        context.device.CreateCommandEncoder();
+                    wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+                    (void)matmul.Encode(
+                        pass, aView, *weights, c.Get(), strategy);
+                    pass.End();
+                    return SubmitAndTime(context, encoder);
+                },
+                gigabytes,
+                "GB/s");
+        }
+    }
+}
+}    // namespace
+
+void RunMatmulBenchmarks(Context& context, Runner& runner)
+{
+    RunTiledBenchmarks(context, runner);
+    RunTunedBenchmark(context, runner);
+    RunQuantizedBenchmarks(context, runner);
+
+    auto prog = context.compiler->CompileFromSource(
+        kMatmulShader, "bench_matmul", "computeMain");
+    auto* program = prog.program.get();
+    auto uniformsInfo = uniform_buffer::ReflectUniformBuffer(program);
+    auto aInfo = tensor_reflection::ReflectTensorBuffer(program, "a");
+    auto bInfo = tensor_reflection::ReflectTensorBuffer(program, "b");
+    auto cInfo = tensor_reflection::ReflectTensorBuffer(program, "c");
+    auto mOffset = uniform_buffer::ReflectUniformOffset(program, "M");
+    auto nOffset = uniform_buffer::ReflectUniformOffset(program, "N");
+    auto kOffset = uniform_buffer::ReflectUniformOffset(program, "K");
+    if (!uniformsInfo || !aInfo || !bInfo || !cInfo || !mOffset || !nOffset
+        || !kOffset)
+    {
+        LOG_ERROR("Failed to reflect the matmul benchmark kernel");
+        return;
+    }
+
+    for (int32_t n : kSizes) {
+        const std::string name = fmt::format("matmul/naive/{}", n);
+        if (!runner.Enabled(name)) {
+            continue;
+        }
+        const size_t elements = static_cast<size_t>(n) * static_cast<size_t>(n);
+        const std::array<int32_t, 2> dims = {n, n};
+
+        uniform_buffer::UniformBuffer uniforms(*uniformsInfo);
+        uniforms.Initialize(context.device);
+        tensor_buffer::TensorBuffer a(*aInfo);
+        tensor_buffer::TensorBuffer b(*bInfo);
+        tensor_buffer::TensorBuffer c(*cInfo);
+        std::vector<float> ones(elements, 1.0f);
+        for (tensor_buffer::TensorBuffer* t : {&a, &b, &c}) {
+            t->Initialize(context.device, elements * sizeof(float), uniforms);
+            t->WriteShape(context.queue, dims);
+            context.queue.WriteBuffer(t->GetDataBuffer(),
+                                      0,
+                                      ones.data(),
+                                      ones.size() * sizeof(float));
+        }
+        uniforms.Write(context.queue, *mOffset, n);
+        uniforms.Write(context.queue, *nOffset, n);
+        uniforms.Write(context.queue, *kOffset, n);
+
+        compute_kernel::Bindings bindings;
+        bindings.Add(uniforms).Add(a).Add(b).Add(c);
+        compute_kernel::ComputeKernel kernel("bench_matmul");
+        if (!kernel.Initialize(context.device,
+                               prog.compileToWGSL(),
+                               "computeMain",
+                               bindings.GetLayoutEntries()))
+        {
+            continue;
+        }
+        wgpu::BindGroup bindGroup =
+            kernel.CreateBindGroup(bindings.GetEntries());
+        const uint32_t groups = (static_cast<uint32_t>(n) + kTile - 1) / kTile;
+
+        const double gflop = 2.0 * n * n * n * 1e-9;
+        runner.RunManual(
+            name,
+            [&]()
+            {
+                wgpu::CommandEncoder encoder =
+                    context.device.CreateCommandEncoder();
+                wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+                pass.SetPipeline(kernel.GetPipeline());
+                pass.SetBindGroup(0, bindGroup);
+                pass.DispatchWorkgroups(groups, groups, 1);
+                pass.End();
+                return SubmitAndTime(context, encoder);
+            },
+            gflop,
+            "GFLOP/s");
+    }
+}
+
+}    // namespace bench
@@ -0,0 +1,377 @@
+#include <array>
+#include <cmath>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "bench.hpp"
+#include "compute_kernel.hpp"
+#include "dispatch.hpp"
+#include "gpu_memory.hpp"
+#include "logging_macros.h"
+#include "normalization.hpp"
+#include "reduction.hpp"
+#include "tensor_buffer.hpp"
+#include "tensor_reflection.hpp"
+#include "uniform_buffer.hpp"
+
+namespace bench
+{
+namespace
+{
+/// Elementwise half of the naive composition: combines each element with
+/// the statistic of its row, produced by a separate reduction dispatch.
+const char* kRowwiseShader = R"(
+import tensor;
+RWTensorBuffer<float, int, int> x;
+RWTensorBuffer<float, int, int> stat;
+RWTensorBuffer<float, int, int> y;
+uniform int cols;
+uniform int mode;
+[numthreads(256,1,1)]
+void rowwise(uint3 gid: SV_GroupID, uint3 ltid: SV_GroupThreadID)
+{
+    var out = y;
+    uint i = linearThreadIndex(gid, ltid, 256);
+    if (i >= uint(out.getCount()))
+        return;
+    int r = int(i) / cols;
+    int c = int(i) % cols;
+    float v = x[r, c];
+    float s = stat[r, 0];
+    float result;
+    switch (mode) {
+        case 0: result = exp(v - s); break;
+        case 1: result = v / s; break;
+        case 2: result = v - s; break;
+        case 3: result = (v - s) * (v - s); break;
+        default: result = v * rsqrt(s + 1e-5f); break;
+    }
+    out[r, c] = result;
+}
+)";
+
+enum class Rowwise : int32_t
+{
+    ExpShift,
+    Divide,
+    Subtract,
+    SquaredDeviation,
+    Scale,
+};
+
+struct Case
+{
+    int32_t rows;
+    int32_t cols;
+};
+
+constexpr std::array<Case, 3> kCases = {{
+    {.rows = 256, .cols = 1024},
+    {.rows = 1024, .cols = 1024},
+    {.rows = 64, .cols = 16384},
+}};
+
+/// Separate reduce and elementwise dispatches, the way softmax and layer
+/// norm are built without fused kernels.
+class NaiveComposition
+{
+  public:
+    bool Initialize(Context& context)
+    {
+        mContext = &context;
+        if (!mReducer.Initialize(context.device, *context.compiler)) {
+            return false;
+        }
+        mProgram = context.compiler->CompileFromSource(
+            kRowwiseShader, "bench_rowwise", "rowwise");
+        auto* program = mProgram.program.get();
+        auto uniforms = uniform_buffer::ReflectUniformBuffer(program);
+        auto x = tensor_reflection::ReflectTensorBuffer(program, "x");
+        auto stat = tensor_reflection::ReflectTensorBuffer(program, "stat");
+        auto y = tensor_reflection::ReflectTensorBuffer(program, "y");
+        auto cols = uniform_buffer::ReflectUniformOffset(program, "cols");
+        auto mode = uniform_buffer::ReflectUniformOffset(program, "mode");
+        if (!uniforms || !x || !stat || !y || !cols || !mode) {
+            LOG_ERROR("Failed to reflect the rowwise benchmark kernel");
+            return false;
+        }
+        mUniforms = *uniforms;
+        mX = *x;
+        mStat = *stat;
+        mY = *y;
+        mColsOffset = *cols;
+        mModeOffset = *mode;
+
+        uniform_buffer::UniformBuffer placeholder(mUniforms);
+        tensor_buffer::TensorBuffer tx(mX);
+        tensor_buffer::TensorBuffer ts(mStat);
+        tensor_buffer::TensorBuffer ty(mY);
+        compute_kernel::Bindings bindings;
+        bindings.Add(placeholder).Add(tx).Add(ts).Add(ty);
+        return mKernel.Initialize(context.device,
+                                  mProgram.compileToWGSL(),
+                                  "rowwise",
+                                  bindings.GetLayoutEntries());
+    }
+
+    /// max, exp(x - max), sum, divide.
+    bool EncodeSoftmax(wgpu::ComputePassEncoder pass,
+                       wgpu::Buffer input,
+                       wgpu::Buffer scratch,
+                       wgpu::Buffer output,
+                       const Case& shape) const
+    {
+        const std::array<int32_t, 2> dims = {shape.rows, shape.cols};
+        const std::array<size_t, 1> axes = {1};
+        auto max =
+            mReducer.Reduce(pass, input, dims, axes, reduction::Op::Max);
+        if (!max) {
+            return false;
+        }
+        EncodeRowwise(
+            pass, Rowwise::ExpShift, input, max->values.Get(), scratch, shape);
+        auto sum =
+            mReducer.Reduce(pass, scratch, dims, axes, reduction::Op::Sum);
+        if (!sum) {
+            return false;
+        }
+        EncodeRowwise(
+            pass, Rowwise::Divide, scratch, sum->values.Get(), output, shape);
+        return true;
+    }
+
+    /// mean, x - mean, (x - mean)^2, mean, scale.
+    bool EncodeLayerNorm(wgpu::ComputePassEncoder pass,
+                         wgpu::Buffer input,
+                         wgpu::Buffer scratch,
+                         wgpu::Buffer squares,
+                         wgpu::Buffer output,
+                         const Case& shape) const
+    {
+        const std::array<int32_t, 2> dims = {shape.rows, shape.cols};
+        const std::array<size_t, 1> axes = {1};
+        auto mean =
+            mReducer.Reduce(pass, input, dims, axes, reduction::Op::Mean);
+        if (!mean) {
+            return false;
+        }
+        EncodeRowwise(
+            pass, Rowwise::Subtract, input, mean->values.Get(), scratch, shape);
+        EncodeRowwise(pass,
+                      Rowwise::SquaredDeviation,
+                      input,
+                      mean->values.Get(),
+                      squares,
+                      shape);
+        auto variance =
+            mReducer.Reduce(pass, squares, dims, axes, reduction::Op::Mean);
+        if (!variance) {
+            return false;
+        }
+        EncodeRowwise(pass,
+                      Rowwise::Scale,
+                      scratch,
+                      variance->values.Get(),
+                      output,
+                      shape);
+        return true;
+    }
+
+  private:
+    void EncodeRowwise(wgpu::ComputePassEncoder pass,
+                       Rowwise mode,
+                       wgpu::Buffer x,
+                       wgpu::Buffer stat,
+                       wgpu::Buffer y,
+                       const Case& shape) const
+    {
+        const size_t elements = static_cast<size_t>(shape.rows)
+            * static_cast<size_t>(shape.cols);
+        const std::array<int32_t, 2> dims = {shape.rows, shape.cols};
+        const std::array<int32_t, 2> statDims = {shape.rows, 1};
+
+        uniform_buffer::UniformBuffer uniforms(mUniforms);
+        uniforms.Initialize(mContext->device);
+        tensor_buffer::TensorBuffer tx(mX);
+        tensor_buffer::TensorBuffer ts(mStat);
+        tensor_buffer::TensorBuffer ty(mY);
+        tx.Initialize(uniforms, x, elements * sizeof(float));
+        ts.Initialize(uniforms,
+                      stat,
+                      static_cast<size_t>(shape.rows) * sizeof(float));
+        ty.Initialize(uniforms, y, elements * sizeof(float));
+        tx.WriteShape(mContext->queue, dims);
+        ts.WriteShape(mContext->queue, statDims);
+        ty.WriteShape(mContext->queue, dims);
+        uniforms.Write(mContext->queue, mColsOffset, shape.cols);
+        uniforms.Write(
+            mContext->queue, mModeOffset, static_cast<int32_t>(mode));
+
+        compute_kernel::Bindings bindings;
+        bindings.Add(uniforms).Add(tx).Add(ts).Add(ty);
+        pass.SetPipeline(mKernel.GetPipeline());
+        pass.SetBindGroup(0, mKernel.CreateBindGroup(bindings.GetEntries()));
+        dispatch::DispatchLinear(pass, dispatch::WorkgroupsFor(elements, 256));
+    }
+
+    Context* mContext = nullptr;
+    reduction::Reducer mReducer;
+    slang_compiler::SlangProgram mProgram;
+    compute_kernel::ComputeKernel mKernel {"bench_rowwise"};
+    uniform_buffer::UniformBufferReflection mUniforms;
+    tensor_reflection::TensorBufferReflection mX;
+    tensor_reflection::TensorBufferReflection mStat;
+    tensor_reflection::TensorBufferReflection mY;
+    size_t mColsOffset = 0;
+    size_t mModeOffset = 0;
+};
+
+std::vector<float> Input(const Case& shape)
+{
+    std::vector<float> values(static_cast<size_t>(shape.rows)
+                              * static_cast<size_t>(shape.cols));
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = std::sin(static_cast<float>(i) * 0.01f) * 8.0f;
+    }
+    return values;
+}
+
+gpu_memory::TrackedBuffer CreateScratch(Context& context, size_t elements)
+{
+    wgpu::BufferDescriptor desc = {
+        .label = "bench_normalization",
+        .usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst
+            | wgpu::BufferUsage::CopySrc,
+        .size = elements * sizeof(float),
+        .mappedAtCreation = false,
+    };
+    return gpu_memory::CreateBuffer(context.device, desc);
+}
+
+/// Checks a result against the CPU reference before it is timed.
+bool Validate(const std::vector<float>& result,
+              const std::vector<float>& expected,
+              const std::string& name)
+{
+    if (result.size() != expected.size()) {
+        LOG_ERROR("{}: read back {} of {} values",
+                  name,
+                  result.size(),
+                  expected.size());
+        return false;
+    }
+    for (size_t i = 0; i < expected.size(); ++i) {
+        if (std::abs(result[i] - expected[i]) > 1e-3f) {
+            LOG_ERROR("{}: mismatch at {}: {} != {}",
+                      name,
+                      i,
+                      result[i],
+                      expected[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+void RunCase(Context& context,
+             Runner& runner,
+             const NaiveComposition& naive,
+             normalization::RowNormalization& fused,
+             const Case& shape)
+{
+    const bool softmax = fused.GetKind() == normalization::Kind::Softmax;
+    const std::string kind = softmax ? "softmax" : "layernorm";
+    const std::string size = fmt::format("{}x{}", shape.rows, shape.cols);
+    const std::string fusedName = fmt::format("{}/fused/{}", kind, size);
+    const std::string naiveName = fmt::format("{}/naive/{}", kind, size);
+    if (!runner.Enabled(fusedName) && !runner.Enabled(naiveName)) {
+        return;
+    }
+
+    const std::vector<float> input = Input(shape);
+    const size_t elements = input.size();
+    std::vector<float> expected(elements);
+    if (softmax) {
+        normalization::ReferenceSoftmax(
+            input, expected, shape.rows, shape.cols);
+    } else {
+        const std::vector<float> gamma(static_cast<size_t>(shape.cols), 1.0f);
+        const std::vector<float> beta(static_cast<size_t>(shape.cols), 0.0f);
+        normalization::ReferenceLayerNorm(
+            input, gamma, beta, expected, shape.rows, shape.cols, 1e-5f);
+    }
+    // Both variants read the input once and write the output once at best.
+    const double gigabytes =
+        2.0 * static_cast<double>(elements * sizeof(float)) * 1e-9;
+
+    if (!fused.Resize(context.queue, shape.rows, shape.cols)) {
+        return;
+    }
+    fused.WriteInput(context.queue, input);
+    auto encodeFused = [&]()
+    {
+        wgpu::CommandEncoder encoder = context.device.CreateCommandEncoder();
+        wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+        fused.Encode(pass);
+        pass.End();
+        return SubmitAndTime(context, encoder);
+    };
+    (void)encodeFused();
+    if (Validate(fused.ReadOutput(context.instance), expected, fusedName)) {
+        runner.RunManual(fusedName, encodeFused, gigabytes, "GB/s");
+    }
+
+    gpu_memory::TrackedBuffer scratch = CreateScratch(context, elements);
+    gpu_memory::TrackedBuffer squares = CreateScratch(context, elements);
+    gpu_memory::TrackedBuffer output = CreateScratch(context, elements);
+    auto encodeNaive = [&]()
+    {
+        wgpu::CommandEncoder encoder = context.device.CreateCommandEncoder();
+        wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+        const bool encoded = softmax
+            ? naive.EncodeSoftmax(
+                  pass, fused.GetInput(), scratch.Get(), output.Get(), shape)
+            : naive.EncodeLayerNorm(pass,
+                                    fused.GetInput(),
+                                    scratch.Get(),
+                                    squares.Get(),
+                                    output.Get(),
+                                    shape);
+        pass.End();
+        if (!encoded) {
+            LOG_ERROR("{}: failed to encode", naiveName);
+        }
+        return SubmitAndTime(context, encoder);
+    };
+    (void)encodeNaive();
+    std::vector<float> naiveResult = compute_kernel::ReadBuffer<float>(
+        context.instance, context.device, output.Get(), elements);
+    if (Validate(naiveResult, expected, naiveName)) {
+        runner.RunManual(naiveName, encodeNaive, gigabytes, "GB/s");
+    }
+}
+}    // namespace
+
+void RunNormalizationBenchmarks(Context& context, Runner& runner)
+{
+    NaiveComposition naive;
+    if (!naive.Initialize(context)) {
+        return;
+    }
+    for (normalization::Kind kind :
+         {normalization::Kind::Softmax, normalization::Kind::LayerNorm})
+    {
+        normalization::RowNormalization fused(kind);
+        if (!fused.Initialize(context.device, *context.compiler)) {
+            continue;
+        }
+        for (const Case& shape : kCases) {
+            RunCase(context, runner, naive, fused, shape);
+        }
+    }
+}
+
+}    // namespace bench
@@ -0,0 +1,144 @@
+#include <array>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "bench.hpp"
+#include "compute_kernel.hpp"
+#include "gpu_memory.hpp"
+#include "logging_macros.h"
+#include "permute.hpp"
+
+namespace bench
+{
+namespace
+{
+struct Case
+{
+    const char* name;
+    std::vector<int32_t> dims;
+    std::vector<size_t> order;
+};
+
+/// Permutations that move the innermost axis, where the naive gather is
+/// uncoalesced on one side, and one that keeps it, which the vector kernel
+/// moves in 128-bit runs.
+const std::array<Case, 4> kCases = {{
+    {.name = "transpose/2048x2048", .dims = {2048, 2048}, .order = {1, 0}},
+    {.name = "nchw_to_nhwc/8x64x56x56",
+     .dims = {8, 64, 56, 56},
+     .order = {0, 2, 3, 1}},
+    {.name = "heads_transposed/8x16x256x64",
+     .dims = {8, 16, 256, 64},
+     .order = {0, 1, 3, 2}},
+    {.name = "split_heads/8x256x16x64",
+     .dims = {8, 256, 16, 64},
+     .order = {0, 2, 1, 3}},
+}};
+
+const char* StrategyName(permute::Strategy strategy)
+{
+    switch (strategy) {
+        case permute::Strategy::Tiled:
+            return "tiled";
+        case permute::Strategy::Vector:
+            return "vec4";
+        default:
+            return "naive";
+    }
+}
+
+gpu_memory::TrackedBuffer CreateScratch(Context& context, size_t elements)
+{
+    wgpu::BufferDescriptor desc = {
+        .label = "bench_permute",
+        .usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst
+            | wgpu::BufferUsage::CopySrc,
+        .size = elements * sizeof(float),
+        .mappedAtCreation = false,
+    };
+    return gpu_memory::CreateBuffer(context.device, desc);
+}
+
+void RunCase(Context& context,
+             Runner& runner,
+             const permute::Permuter& permuter,
+             const Case& shape)
+{
+    // The naive gather against whichever specialized kernel accepts the
+    // permutation; the kept innermost axes of kCases are multiples of four.
+    const bool kept = shape.order.back() == shape.order.size() - 1;
+    const std::array<permute::Strategy, 2> strategies = {
+        kept ? permute::Strategy::Vector : permute::Strategy::Tiled,
+        permute::Strategy::Naive,
+    };
+    std::array<std::string, 2> names;
+    for (size_t i = 0; i < strategies.size(); ++i) {
+        names[i] = fmt::format(
+            "permute/{}/{}", StrategyName(strategies[i]), shape.name);
+    }
+    if (!runner.Enabled(names[0]) && !runner.Enabled(names[1])) {
+        return;
+    }
+
+    size_t elements = 1;
+    for (int32_t dim : shape.dims) {
+        elements *= static_cast<size_t>(dim);
+    }
+    std::vector<float> input(elements);
+    for (size_t i = 0; i < elements; ++i) {
+        input[i] = static_cast<float>(i % 4093);
+    }
+    const std::vector<float> expected =
+        permute::ReferencePermute(shape.dims, input, shape.order);
+    gpu_memory::TrackedBuffer src = CreateScratch(context, elements);
+    gpu_memory::TrackedBuffer dst = CreateScratch(context, elements);
+    context.queue.WriteBuffer(
+        src.Get(), 0, input.data(), elements * sizeof(float));
+    // Every element is read once and written once.
+    const double gigabytes =
+        2.0 * static_cast<double>(elements * sizeof(float)) * 1e-9;
+
+    for (size_t i = 0; i < strategies.size(); ++i) {
+        const permute::Strategy strategy = strategies[i];
+        const std::string& name = names[i];
+        if (!runner.Enabled(name)) {
+            continue;
+        }
+        bool encoded = true;
+        auto encode = [&]()
+        {
+            wgpu::CommandEncoder encoder =
+                context.device.CreateCommandEncoder();
+            wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+            encoded = permuter.Encode(
+                pass, src.Get(), dst.Get(), shape.dims, shape.order, strategy);
+            pass.End();
+            return SubmitAndTime(context, encoder);
+        };
+        (void)encode();
+        const std::vector<float> result = compute_kernel::ReadBuffer<float>(
+            context.instance, context.device, dst.Get(), elements);
+        if (!encoded || result != expected) {
+            LOG_ERROR("{}: result does not match the reference", name);
+            continue;
+        }
+        runner.RunManual(name, encode, gigabytes, "GB/s");
+    }
+}
+}    // namespace
+
+void RunPermuteBenchmarks(Context& context, Runner& runner)
+{
+    permute::Permuter permuter;
+    if (!permuter.Initialize(context.device, *context.compiler)) {
+        return;
+    }
+    for (const Case& shape : kCases) {
+        RunCase(context, runner, permuter, shape);
+    }
+}
+
+}    // namespace bench
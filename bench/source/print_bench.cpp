@@ -0,0 +1,89 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "bench.hpp"
+#include "compute_kernel.hpp"
+#include "logging_macros.h"
+#include "print_buffer.hpp"
+#include "print_reflection.hpp"
+#include "shaders/tools/gpu-printing.h"
+
+namespace bench
+{
+namespace
+{
+const char* kPrintShader = R"(
+import tools.printing;
+[numthreads(64,1,1)]
+void computeMain(uint3 tid: SV_DispatchThreadID)
+{
+    printf_("thread %d value %f\n", tid.x, float(tid.x) * 0.5f);
+}
+)";
+
+constexpr uint32_t kPrintGroups = 4;
+constexpr size_t kPrintBufferSize = 64 * 1024;
+}    // namespace
+
+void RunPrintBenchmarks(Context& context, Runner& runner)
+{
+    if (!runner.Enabled("print/decode")) {
+        return;
+    }
+    auto prog = context.compiler->CompileFromSource(
+        kPrintShader, "bench_print", "computeMain");
+    auto printInfo = print_reflection::ReflectPrintBuffer(prog.program.get());
+    if (!printInfo) {
+        LOG_ERROR("Failed to reflect the print benchmark kernel");
+        return;
+    }
+    print_buffer::PrintBuffer printBuf(*printInfo);
+    printBuf.Initialize(context.device, kPrintBufferSize);
+    uint32_t zero = 0;
+    context.queue.WriteBuffer(printBuf.GetBuffer(), 0, &zero, sizeof(zero));
+
+    compute_kernel::Bindings bindings;
+    bindings.Add(printBuf);
+    compute_kernel::ComputeKernel kernel("bench_print");
+    if (!kernel.Initialize(context.device,
+                           prog.compileToWGSL(),
+                           "computeMain",
+                           bindings.GetLayoutEntries()))
+    {
+        return;
+    }
+    wgpu::BindGroup bindGroup = kernel.CreateBindGroup(bindings.GetEntries());
+    wgpu::CommandEncoder encoder = context.device.CreateCommandEncoder();
+    wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+    pass.SetPipeline(kernel.GetPipeline());
+    pass.SetBindGroup(0, bindGroup);
+    pass.DispatchWorkgroups(kPrintGroups, 1, 1);
+    pass.End();
+    (void)SubmitAndTime(context, encoder);
+
+    // Decode the same buffer repeatedly; only the host side is measured.
+    std::vector<std::byte> data =
+        compute_kernel::ReadBuffer(context.instance,
+                                   context.device,
+                                   printBuf.GetBuffer(),
+                                   kPrintBufferSize);
+    uint32_t usedWords = 0;
+    std::memcpy(&usedWords, data.data(), sizeof(usedWords));
+    const double megabytes = (usedWords + 1.0) * sizeof(uint32_t) * 1e-6;
+
+    GPUPrinting gpuPrinting;
+    gpuPrinting.loadStrings(prog.program->getLayout());
+    runner.Run(
+        "print/decode",
+        [&]()
+        {
+            gpuPrinting.processGPUPrintCommands(data.data(), data.size());
+            std::fflush(stdout);
+        },
+        megabytes,
+        "MB/s");
+}
+
+}    // namespace bench
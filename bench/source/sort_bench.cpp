@@ -0,0 +1,120 @@
+#include <array>
+#include <string>
+
+#include <fmt/format.h>
+
+#include "bench.hpp"
+#include "gpu_memory.hpp"
+#include "logging_macros.h"
+#include "radix_sort.hpp"
+#include "top_k.hpp"
+
+namespace bench
+{
+namespace
+{
+constexpr uint32_t kSortCount = 1 << 22;
+constexpr int32_t kTopKRows = 8;
+constexpr int32_t kTopKLength = 32000;
+constexpr int32_t kTopK = 50;
+
+gpu_memory::TrackedBuffer CreateScratch(Context& context, size_t elements)
+{
+    wgpu::BufferDescriptor desc = {
+        .label = "bench_sort",
+        .usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst,
+        .size = elements * sizeof(uint32_t),
+        .mappedAtCreation = false,
+    };
+    return gpu_memory::CreateBuffer(context.device, desc);
+}
+
+void RunRadixSort(Context& context, Runner& runner)
+{
+    const std::string name = fmt::format("sort/radix/{}", kSortCount);
+    if (!runner.Enabled(name)) {
+        return;
+    }
+    radix_sort::Sorter sorter;
+    if (!sorter.Initialize(context.device, *context.compiler)) {
+        LOG_ERROR("Skipping {}", name);
+        return;
+    }
+    gpu_memory::TrackedBuffer keys = CreateScratch(context, kSortCount);
+    gpu_memory::TrackedBuffer values = CreateScratch(context, kSortCount);
+
+    // Keys and values read and written once per pass.
+    const double passes = 32.0 / radix_sort::kDigitBits;
+    const double gigabytes =
+        passes * 4.0 * kSortCount * sizeof(uint32_t) * 1e-9;
+    runner.RunManual(
+        name,
+        [&]()
+        {
+            wgpu::CommandEncoder encoder =
+                context.device.CreateCommandEncoder();
+            wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+            (void)sorter.Encode(pass,
+                                keys.Get(),
+                                values.Get(),
+                                keys.Get(),
+                                values.Get(),
+                                kSortCount,
+                                radix_sort::KeyType::Uint,
+                                radix_sort::Order::Ascending);
+            pass.End();
+            return SubmitAndTime(context, encoder);
+        },
+        gigabytes,
+        "GB/s");
+}
+
+void RunTopK(Context& context, Runner& runner)
+{
+    const std::string name =
+        fmt::format("sort/top_k/{}x{}/{}", kTopKRows, kTopKLength, kTopK);
+    if (!runner.Enabled(name)) {
+        return;
+    }
+    top_k::TopK topK;
+    if (!topK.Initialize(context.device, *context.compiler)) {
+        LOG_ERROR("Skipping {}", name);
+        return;
+    }
+    const size_t count = static_cast<size_t>(kTopKRows) * kTopKLength;
+    const size_t selected = static_cast<size_t>(kTopKRows) * kTopK;
+    gpu_memory::TrackedBuffer logits = CreateScratch(context, count);
+    gpu_memory::TrackedBuffer values = CreateScratch(context, selected);
+    gpu_memory::TrackedBuffer indices = CreateScratch(context, selected);
+
+    // Logits read once.
+    const double gigabytes = count * sizeof(float) * 1e-9;
+    runner.RunManual(
+        name,
+        [&]()
+        {
+            wgpu::CommandEncoder encoder =
+                context.device.CreateCommandEncoder();
+            wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+            (void)topK.Encode(pass,
+                              logits.Get(),
+                              values.Get(),
+                              indices.Get(),
+                              kTopKRows,
+                              kTopKLength,
+                              kTopK);
+            pass.End();
+            return SubmitAndTime(context, encoder);
+        },
+        gigabytes,
+        "GB/s");
+}
+}    // namespace
+
+void RunSortBenchmarks(Context& context, Runner& runner)
+{
+    RunRadixSort(context, runner);
+    RunTopK(context, runner);
+}
+
+}    // namespace bench
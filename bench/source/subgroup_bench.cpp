@@ -0,0 +1,156 @@
+#include <array>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "bench.hpp"
+#include "gemm.hpp"
+#include "gpu_memory.hpp"
+#include "logging_macros.h"
+#include "reduction.hpp"
+#include "scan.hpp"
+#include "subgroups.hpp"
+
+namespace bench
+{
+namespace
+{
+constexpr std::array<subgroups::Path, 2> kPaths = {
+    subgroups::Path::Subgroups,
+    subgroups::Path::Shared,
+};
+
+constexpr int32_t kReduceLength = 1 << 24;
+constexpr int32_t kScanRows = 256;
+constexpr int32_t kScanLength = 16384;
+constexpr gemm::Shape kGemmShape = {.m = 512, .n = 512, .k = 512};
+
+gpu_memory::TrackedBuffer CreateScratch(Context& context, size_t elements)
+{
+    wgpu::BufferDescriptor desc = {
+        .label = "bench_subgroups",
+        .usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst,
+        .size = elements * sizeof(float),
+        .mappedAtCreation = false,
+    };
+    return gpu_memory::CreateBuffer(context.device, desc);
+}
+
+void RunReduce(Context& context, Runner& runner, subgroups::Path path)
+{
+    const std::string name = fmt::format(
+        "subgroups/{}/reduce_sum/{}", subgroups::PathName(path), kReduceLength);
+    if (!runner.Enabled(name)) {
+        return;
+    }
+    reduction::Reducer reducer(path);
+    if (!reducer.Initialize(context.device, *context.compiler)) {
+        LOG_ERROR("Skipping {}", name);
+        return;
+    }
+    gpu_memory::TrackedBuffer input = CreateScratch(context, kReduceLength);
+    const std::array<int32_t, 1> dims = {kReduceLength};
+    const std::array<size_t, 1> axes = {0};
+
+    const double gigabytes = kReduceLength * sizeof(float) * 1e-9;
+    runner.RunManual(
+        name,
+        [&]()
+        {
+            wgpu::CommandEncoder encoder =
+                context.device.CreateCommandEncoder();
+            wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+            (void)reducer.Reduce(
+                pass, input.Get(), dims, axes, reduction::Op::Sum);
+            pass.End();
+            return SubmitAndTime(context, encoder);
+        },
+        gigabytes,
+        "GB/s");
+}
+
+void RunScan(Context& context, Runner& runner, subgroups::Path path)
+{
+    const std::string name = fmt::format("subgroups/{}/scan_rows/{}x{}",
+                                         subgroups::PathName(path),
+                                         kScanRows,
+                                         kScanLength);
+    if (!runner.Enabled(name)) {
+        return;
+    }
+    scan::Scanner scanner(scan::Element::Float, path);
+    if (!scanner.Initialize(context.device, *context.compiler)) {
+        LOG_ERROR("Skipping {}", name);
+        return;
+    }
+    const size_t count = static_cast<size_t>(kScanRows) * kScanLength;
+    gpu_memory::TrackedBuffer input = CreateScratch(context, count);
+    gpu_memory::TrackedBuffer output = CreateScratch(context, count);
+
+    // Read once and written once.
+    const double gigabytes = 2.0 * count * sizeof(float) * 1e-9;
+    runner.RunManual(
+        name,
+        [&]()
+        {
+            wgpu::CommandEncoder encoder =
+                context.device.CreateCommandEncoder();
+            wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+            (void)scanner.Encode(
+                pass, input.Get(), output.Get(), kScanRows, kScanLength);
+            pass.End();
+            return SubmitAndTime(context, encoder);
+        },
+        gigabytes,
+        "GB/s");
+}
+
+void RunGemm(Context& context, Runner& runner, subgroups::Path path)
+{
+    const std::string name =
+        fmt::format("subgroups/{}/gemm/{}x{}x{}",
+                    subgroups::PathName(path),
+                    kGemmShape.m,
+                    kGemmShape.n,
+                    kGemmShape.k);
+    if (!runner.Enabled(name)) {
+        return;
+    }
+    gemm::Gemm kernel(gemm::Variant::NN, {}, path);
+    if (!kernel.Initialize(context.device, *context.compiler)
+        || !kernel.Resize(context.queue, kGemmShape))
+    {
+        LOG_ERROR("Skipping {}", name);
+        return;
+    }
+
+    const double gflop =
+        2.0 * kGemmShape.m * kGemmShape.n * kGemmShape.k * 1e-9;
+    runner.RunManual(
+        name,
+        [&]()
+        {
+            wgpu::CommandEncoder encoder =
+                context.device.CreateCommandEncoder();
+            wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+            kernel.Encode(pass);
+            pass.End();
+            return SubmitAndTime(context, encoder);
+        },
+        gflop,
+        "GFLOP/s");
+}
+}    // namespace
+
+void RunSubgroupBenchmarks(Context& context, Runner& runner)
+{
+    // The subgroup path is skipped where subgroups::Select() rejects it.
+    for (subgroups::Path path : kPaths) {
+        RunReduce(context, runner, path);
+        RunScan(context, runner, path);
+        RunGemm(context, runner, path);
+    }
+}
+
+}    // namespace bench
@@ -0,0 +1,70 @@
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "bench.hpp"
+#include "compute_kernel.hpp"
+#include "gpu_memory.hpp"
+
+namespace bench
+{
+namespace
+{
+constexpr std::array<size_t, 3> kTransferSizes = {
+    64 * 1024,
+    1024 * 1024,
+    16 * 1024 * 1024,
+};
+
+std::string SizeName(size_t bytes)
+{
+    if (bytes >= 1024 * 1024) {
+        return fmt::format("{}MiB", bytes / (1024 * 1024));
+    }
+    return fmt::format("{}KiB", bytes / 1024);
+}
+}    // namespace
+
+void RunTransferBenchmarks(Context& context, Runner& runner)
+{
+    for (size_t bytes : kTransferSizes) {
+        const std::string size = SizeName(bytes);
+        const double gigabytes = static_cast<double>(bytes) * 1e-9;
+
+        wgpu::BufferDescriptor desc = {
+            .label = "bench_transfer",
+            .usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst
+                | wgpu::BufferUsage::CopySrc,
+            .size = bytes,
+        };
+        gpu_memory::TrackedBuffer buffer =
+            gpu_memory::CreateBuffer(context.device, desc);
+        std::vector<std::byte> host(bytes, std::byte {0x5a});
+
+        runner.Run(
+            "transfer/write/" + size,
+            [&]()
+            {
+                context.queue.WriteBuffer(
+                    buffer.Get(), 0, host.data(), host.size());
+                compute_kernel::WaitForQueue(context.instance, context.device);
+            },
+            gigabytes,
+            "GB/s");
+
+        runner.Run(
+            "transfer/readback/" + size,
+            [&]()
+            {
+                std::vector<std::byte> result = compute_kernel::ReadBuffer(
+                    context.instance, context.device, buffer.Get(), bytes);
+                (void)result;
+            },
+            gigabytes,
+            "GB/s");
+    }
+}
+
+}    // namespace bench
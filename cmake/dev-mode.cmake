@@ -1,5 +1,28 @@
 include(cmake/folders.cmake)
 
+option(congpu_BUILD_BENCHMARKS "Build the congpu_bench benchmark target" ON)
+if(congpu_BUILD_BENCHMARKS)
+  add_subdirectory(bench)
+
+  add_custom_target(
+      run-bench
+      COMMAND congpu_bench --out "${PROJECT_BINARY_DIR}/congpu_bench.json"
+      VERBATIM
+  )
+  add_dependencies(run-bench congpu_bench)
+
+  # Records this machine's timings as the perf regression baseline
+  add_custom_target(
+      update-perf-baseline
+      COMMAND congpu_bench --repetitions 15
+              --out "${PROJECT_BINARY_DIR}/congpu_bench.json"
+              --baseline "${PROJECT_SOURCE_DIR}/test/perf/baseline.json"
+              --update-baseline
+      VERBATIM
+  )
+  add_dependencies(update-perf-baseline congpu_bench)
+endif()
+
 include(CTest)
 if(BUILD_TESTING)
   add_subdirectory(test)
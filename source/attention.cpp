@@ -0,0 +1,264 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "attention.hpp"
+
+#include <fmt/format.h>
+#include <tracy/Tracy.hpp>
+
+#include "logging_macros.h"
+
+namespace attention
+{
+namespace
+{
+/// Host mirror of AttentionParams in attention.slang.
+struct Params
+{
+    int32_t queryLen;
+    int32_t keyLen;
+    float scale;
+    int32_t causal;
+};
+}    // namespace
+
+std::optional<Shape> InferShape(const tensor_buffer::TensorView& q,
+                                const tensor_buffer::TensorView& k,
+                                const tensor_buffer::TensorView& v)
+{
+    if (q.dims.size() != 4 || k.dims.size() != 4 || k.dims != v.dims) {
+        LOG_ERROR("Attention needs 4-D Q, K and V with matching K and V");
+        return std::nullopt;
+    }
+    const Shape shape {
+        .batch = q.dims[0],
+        .heads = q.dims[1],
+        .queryLen = q.dims[2],
+        .keyLen = k.dims[2],
+        .headDim = q.dims[3],
+    };
+    if (k.dims[0] != shape.batch || k.dims[1] != shape.heads
+        || k.dims[3] != shape.headDim)
+    {
+        LOG_ERROR("K of [{}, {}, {}, {}] does not match Q of [{}, {}, {}, {}]",
+                  k.dims[0],
+                  k.dims[1],
+                  k.dims[2],
+                  k.dims[3],
+                  q.dims[0],
+                  q.dims[1],
+                  q.dims[2],
+                  q.dims[3]);
+        return std::nullopt;
+    }
+    return shape;
+}
+
+float DefaultScale(int32_t headDim)
+{
+    return 1.0f / std::sqrt(static_cast<float>(headDim));
+}
+
+uint32_t SharedBytes(int32_t headDim)
+{
+    return 2 * kBlockK * static_cast<uint32_t>(headDim) * sizeof(float);
+}
+
+dispatch::Grid Workgroups(const Shape& shape)
+{
+    return {
+        .x = static_cast<uint32_t>(
+            dispatch::WorkgroupsFor(static_cast<uint64_t>(shape.queryLen),
+                                    kBlockQ)),
+        .y = static_cast<uint32_t>(shape.heads),
+        .z = static_cast<uint32_t>(shape.batch),
+    };
+}
+
+void ReferenceAttention(const Shape& shape,
+                        std::span<const float> q,
+                        std::span<const float> k,
+                        std::span<const float> v,
+                        std::span<float> out,
+                        float scale,
+                        bool causal)
+{
+    const auto queryLen = static_cast<size_t>(shape.queryLen);
+    const auto keyLen = static_cast<size_t>(shape.keyLen);
+    const auto dim = static_cast<size_t>(shape.headDim);
+    const auto heads =
+        static_cast<size_t>(shape.batch) * static_cast<size_t>(shape.heads);
+    const int64_t shift = static_cast<int64_t>(shape.keyLen) - shape.queryLen;
+    std::vector<float> scores(keyLen);
+    for (size_t head = 0; head < heads; ++head) {
+        const size_t qBase = head * queryLen * dim;
+        const size_t kBase = head * keyLen * dim;
+        for (size_t i = 0; i < queryLen; ++i) {
+            // Keys j <= i + keyLen - queryLen are visible.
+            const int64_t last = static_cast<int64_t>(i) + shift;
+            const size_t visible = causal
+                ? static_cast<size_t>(std::clamp<int64_t>(
+                      last + 1, 0, static_cast<int64_t>(keyLen)))
+                : keyLen;
+            float maximum = -std::numeric_limits<float>::max();
+            for (size_t j = 0; j < visible; ++j) {
+                float s = 0.0f;
+                for (size_t d = 0; d < dim; ++d) {
+                    s += q[qBase + i * dim + d] * k[kBase + j * dim + d];
+                }
+                scores[j] = s * scale;
+                maximum = std::max(maximum, scores[j]);
+            }
+            float sum = 0.0f;
+            for (size_t j = 0; j < visible; ++j) {
+                scores[j] = std::exp(scores[j] - maximum);
+                sum += scores[j];
+            }
+            for (size_t d = 0; d < dim; ++d) {
+                float acc = 0.0f;
+                for (size_t j = 0; j < visible; ++j) {
+                    acc += scores[j] * v[kBase + j * dim + d];
+                }
+                out[qBase + i * dim + d] = visible > 0 ? acc / sum : 0.0f;
+            }
+        }
+    }
+}
+
+Attention::Attention(int32_t headDim)
+    : mHeadDim(headDim)
+{
+}
+
+bool Attention::Initialize(wgpu::Device device,
+                           const slang_compiler::Compiler& compiler)
+{
+    ZoneScoped;
+    if (mInitialized) {
+        return true;
+    }
+    wgpu::Limits limits {};
+    device.GetLimits(&limits);
+    if (mHeadDim <= 0
+        || SharedBytes(mHeadDim) > limits.maxComputeWorkgroupStorageSize)
+    {
+        LOG_ERROR("Attention head dimension {} does not fit in {} bytes of "
+                  "workgroup storage",
+                  mHeadDim,
+                  limits.maxComputeWorkgroupStorageSize);
+        return false;
+    }
+    mDevice = device;
+    const std::string source = fmt::format(
+        "#define ATTENTION_HEAD_DIM {}\n"
+        "#include \"attention.slang\"\n",
+        mHeadDim);
+    mProgram = compiler.CompileFromSource(
+        source, fmt::format("attention_d{}", mHeadDim), "attention");
+    if (!mProgram.program) {
+        return false;
+    }
+
+    auto* program = mProgram.program.get();
+    auto uniformsInfo = uniform_buffer::ReflectUniformBuffer(program);
+    auto paramsOffset = uniform_buffer::ReflectUniformOffset(program, "params");
+    auto q = tensor_reflection::ReflectTensorBuffer(program, "q");
+    auto k = tensor_reflection::ReflectTensorBuffer(program, "k");
+    auto v = tensor_reflection::ReflectTensorBuffer(program, "v");
+    auto output = tensor_reflection::ReflectTensorBuffer(program, "output");
+    if (!uniformsInfo || !paramsOffset || !q || !k || !v || !output) {
+        LOG_ERROR("attention.slang is missing parameters");
+        return false;
+    }
+    mUniforms = *uniformsInfo;
+    mParamsOffset = *paramsOffset;
+    mQ = *q;
+    mK = *k;
+    mV = *v;
+    mOutput = *output;
+
+    uniform_buffer::UniformBuffer uniforms(mUniforms);
+    tensor_buffer::TensorBuffer qBuffer(mQ);
+    tensor_buffer::TensorBuffer kBuffer(mK);
+    tensor_buffer::TensorBuffer vBuffer(mV);
+    tensor_buffer::TensorBuffer outBuffer(mOutput);
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms).Add(qBuffer).Add(kBuffer).Add(vBuffer).Add(
+        outBuffer);
+    mInitialized = mKernel.Initialize(mDevice,
+                                      mProgram.compileToWGSL(),
+                                      "attention",
+                                      bindings.GetLayoutEntries());
+    return mInitialized;
+}
+
+bool Attention::Encode(wgpu::ComputePassEncoder pass,
+                       const tensor_buffer::BufferView& q,
+                       const tensor_buffer::BufferView& k,
+                       const tensor_buffer::BufferView& v,
+                       wgpu::Buffer output,
+                       float scale,
+                       bool causal) const
+{
+    ZoneScoped;
+    if (!mInitialized) {
+        LOG_ERROR("Attention::Encode called before Initialize");
+        return false;
+    }
+    const std::optional<Shape> shape = InferShape(q.view, k.view, v.view);
+    if (!shape) {
+        return false;
+    }
+    if (shape->headDim != mHeadDim) {
+        LOG_ERROR("Attention kernel for head dimension {} got {}",
+                  mHeadDim,
+                  shape->headDim);
+        return false;
+    }
+    const std::vector<int32_t> outDims = {
+        shape->batch, shape->heads, shape->queryLen, shape->headDim};
+
+    wgpu::Queue queue = mDevice.GetQueue();
+    uniform_buffer::UniformBuffer uniforms(mUniforms);
+    uniforms.Initialize(mDevice);
+    tensor_buffer::TensorBuffer qBuffer(mQ);
+    tensor_buffer::TensorBuffer kBuffer(mK);
+    tensor_buffer::TensorBuffer vBuffer(mV);
+    tensor_buffer::TensorBuffer outBuffer(mOutput);
+    qBuffer.Initialize(uniforms, q.buffer, q.buffer.GetSize());
+    kBuffer.Initialize(uniforms, k.buffer, k.buffer.GetSize());
+    vBuffer.Initialize(uniforms, v.buffer, v.buffer.GetSize());
+    outBuffer.Initialize(uniforms, output, output.GetSize());
+    qBuffer.WriteShape(queue, q.view);
+    kBuffer.WriteShape(queue, k.view);
+    vBuffer.WriteShape(queue, v.view);
+    outBuffer.WriteShape(queue, outDims);
+
+    const Params params {
+        .queryLen = shape->queryLen,
+        .keyLen = shape->keyLen,
+        .scale = scale,
+        .causal = causal ? 1 : 0,
+    };
+    uniforms.Write(queue, mParamsOffset, params);
+
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms).Add(qBuffer).Add(kBuffer).Add(vBuffer).Add(
+        outBuffer);
+    pass.SetPipeline(mKernel.GetPipeline());
+    pass.SetBindGroup(0, mKernel.CreateBindGroup(bindings.GetEntries()));
+
+    wgpu::Limits limits {};
+    mDevice.GetLimits(&limits);
+    return dispatch::Dispatch(pass, Workgroups(*shape), limits);
+}
+
+int32_t Attention::GetHeadDim() const
+{
+    return mHeadDim;
+}
+
+}    // namespace attention
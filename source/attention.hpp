@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+
+#include <webgpu/webgpu_cpp.h>
+
+#include "compute_kernel.hpp"
+#include "dispatch.hpp"
+#include "slang_compiler.hpp"
+#include "tensor_buffer.hpp"
+#include "tensor_reflection.hpp"
+#include "uniform_buffer.hpp"
+
+namespace attention
+{
+/// Queries per workgroup and keys per groupshared tile; mirror
+/// attention.slang.
+inline constexpr uint32_t kBlockQ = 64;
+inline constexpr uint32_t kBlockK = 16;
+
+struct Shape
+{
+    int32_t batch = 1;
+    int32_t heads = 1;
+    int32_t queryLen = 0;
+    int32_t keyLen = 0;
+    int32_t headDim = 0;
+};
+
+/**
+ * @brief Problem size of views of Q: [batch, heads, queryLen, headDim] and
+ * K, V: [batch, heads, keyLen, headDim].
+ * @return nullopt if the views do not fit together
+ */
+[[nodiscard]] std::optional<Shape> InferShape(
+    const tensor_buffer::TensorView& q,
+    const tensor_buffer::TensorView& k,
+    const tensor_buffer::TensorView& v);
+
+/// The usual 1 / sqrt(headDim) score scale.
+[[nodiscard]] float DefaultScale(int32_t headDim);
+
+/// Bytes of groupshared memory used by the K and V tiles.
+[[nodiscard]] uint32_t SharedBytes(int32_t headDim);
+
+/// Workgroups: query blocks x heads x batch.
+[[nodiscard]] dispatch::Grid Workgroups(const Shape& shape);
+
+/**
+ * @brief CPU reference of softmax(scale * Q * K^T + mask) * V on
+ * contiguous tensors. The causal mask lets query i see keys
+ * j <= i + keyLen - queryLen.
+ */
+void ReferenceAttention(const Shape& shape,
+                        std::span<const float> q,
+                        std::span<const float> k,
+                        std::span<const float> v,
+                        std::span<float> out,
+                        float scale,
+                        bool causal);
+
+/**
+ * @brief Fused attention for one head dimension, streaming K and V tiles
+ * through groupshared memory with an online softmax.
+ *
+ * Operands are caller-owned views, so a [batch, seq, heads, headDim]
+ * projection can be read in place through a permuted view.
+ */
+class Attention
+{
+  public:
+    explicit Attention(int32_t headDim);
+
+    /// Compiles the kernel; fails if the tiles exceed the device's
+    /// workgroup storage.
+    bool Initialize(wgpu::Device device,
+                    const slang_compiler::Compiler& compiler);
+
+    /**
+     * @brief Records attention of `q` over `k` and `v` into `pass`.
+     * @param output Buffer receiving the contiguous
+     * [batch, heads, queryLen, headDim] result; it must not alias the
+     * inputs.
+     * @return false if the views do not match the head dimension or
+     * nothing was dispatched
+     */
+    [[nodiscard]] bool Encode(wgpu::ComputePassEncoder pass,
+                              const tensor_buffer::BufferView& q,
+                              const tensor_buffer::BufferView& k,
+                              const tensor_buffer::BufferView& v,
+                              wgpu::Buffer output,
+                              float scale,
+                              bool causal) const;
+
+    [[nodiscard]] int32_t GetHeadDim() const;
+
+  private:
+    int32_t mHeadDim;
+    wgpu::Device mDevice {nullptr};
+    slang_compiler::SlangProgram mProgram;
+    compute_kernel::ComputeKernel mKernel {"attention"};
+    uniform_buffer::UniformBufferReflection mUniforms;
+    size_t mParamsOffset = 0;
+    tensor_reflection::TensorBufferReflection mQ;
+    tensor_reflection::TensorBufferReflection mK;
+    tensor_reflection::TensorBufferReflection mV;
+    tensor_reflection::TensorBufferReflection mOutput;
+    bool mInitialized = false;
+};
+
+}    // namespace attention
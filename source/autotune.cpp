@@ -0,0 +1,299 @@
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+#include "autotune.hpp"
+
+#include <fmt/format.h>
+#include <tracy/Tracy.hpp>
+
+#include "compute_kernel.hpp"
+#include "logging_macros.h"
+
+namespace autotune
+{
+namespace
+{
+constexpr std::string_view kCacheHeader = "# congpu autotune cache v1";
+
+/// Keeps cache fields free of the tab and newline separators.
+std::string Sanitize(std::string_view text)
+{
+    std::string clean(text);
+    std::replace_if(
+        clean.begin(),
+        clean.end(),
+        [](char c) { return c == '\t' || c == '\n' || c == '\r'; },
+        ' ');
+    return clean;
+}
+
+std::vector<std::string_view> Split(std::string_view text, char separator)
+{
+    std::vector<std::string_view> fields;
+    size_t start = 0;
+    while (true) {
+        size_t end = text.find(separator, start);
+        fields.push_back(text.substr(start, end - start));
+        if (end == std::string_view::npos) {
+            return fields;
+        }
+        start = end + 1;
+    }
+}
+}    // namespace
+
+std::string FormatConfig(const Config& config)
+{
+    std::string text;
+    for (const auto& [name, value] : config) {
+        text += fmt::format("{}{}={}", text.empty() ? "" : " ", name, value);
+    }
+    return text;
+}
+
+std::optional<Config> ParseConfig(std::string_view text)
+{
+    Config config;
+    for (std::string_view pair : Split(text, ' ')) {
+        if (pair.empty()) {
+            continue;
+        }
+        size_t eq = pair.find('=');
+        if (eq == std::string_view::npos || eq == 0) {
+            return std::nullopt;
+        }
+        int32_t value = 0;
+        std::string_view digits = pair.substr(eq + 1);
+        const char* end = digits.data() + digits.size();
+        auto [ptr, ec] = std::from_chars(digits.data(), end, value);
+        if (ec != std::errc {} || ptr != end) {
+            return std::nullopt;
+        }
+        config[std::string(pair.substr(0, eq))] = value;
+    }
+    return config;
+}
+
+std::string ShapeBucket(std::span<const int64_t> dims)
+{
+    std::string bucket;
+    for (int64_t dim : dims) {
+        uint64_t rounded =
+            std::bit_ceil(static_cast<uint64_t>(std::max<int64_t>(dim, 1)));
+        bucket += fmt::format("{}{}", bucket.empty() ? "" : "x", rounded);
+    }
+    return bucket;
+}
+
+std::string AdapterKey(const wgpu::AdapterInfo& info)
+{
+    return Sanitize(fmt::format("{}/{}/{}/{}/backend{}/{:04x}:{:04x}",
+                                std::string_view(info.vendor),
+                                std::string_view(info.architecture),
+                                std::string_view(info.device),
+                                std::string_view(info.description),
+                                static_cast<uint32_t>(info.backendType),
+                                info.vendorID,
+                                info.deviceID));
+}
+
+bool TuningCache::Load(const std::string& path)
+{
+    std::ifstream in(path);
+    if (!in) {
+        return true;
+    }
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::vector<std::string_view> fields = Split(line, '\t');
+        double meanUs = 0.0;
+        std::optional<Config> config;
+        if (fields.size() == 5) {
+            std::string_view time = fields[3];
+            auto [ptr, ec] =
+                std::from_chars(time.data(), time.data() + time.size(), meanUs);
+            if (ec == std::errc {}) {
+                config = ParseConfig(fields[4]);
+            }
+        }
+        if (!config) {
+            LOG_ERROR(
+                "Malformed autotune cache entry at {}:{}", path, lineNumber);
+            return false;
+        }
+        Key key {
+            .kernel = std::string(fields[0]),
+            .bucket = std::string(fields[1]),
+            .adapter = std::string(fields[2]),
+        };
+        mEntries[key] = {.config = std::move(*config), .meanUs = meanUs};
+    }
+    return true;
+}
+
+bool TuningCache::Save(const std::string& path) const
+{
+    std::ofstream out(path);
+    if (!out) {
+        LOG_ERROR("Cannot write autotune cache {}", path);
+        return false;
+    }
+    out << kCacheHeader << '\n';
+    for (const auto& [key, entry] : mEntries) {
+        out << fmt::format("{}\t{}\t{}\t{:.3f}\t{}\n",
+                           Sanitize(key.kernel),
+                           Sanitize(key.bucket),
+                           Sanitize(key.adapter),
+                           entry.meanUs,
+                           FormatConfig(entry.config));
+    }
+    return static_cast<bool>(out);
+}
+
+std::optional<Config> TuningCache::Find(const Key& key) const
+{
+    auto it = mEntries.find(key);
+    if (it == mEntries.end()) {
+        return std::nullopt;
+    }
+    return it->second.config;
+}
+
+void TuningCache::Store(const Key& key, const Config& config, double meanUs)
+{
+    mEntries[key] = {.config = config, .meanUs = meanUs};
+}
+
+size_t TuningCache::GetSize() const
+{
+    return mEntries.size();
+}
+
+Autotuner::Autotuner(int warmup, int repetitions)
+    : mWarmup(warmup)
+    , mRepetitions(std::max(1, repetitions))
+    , mProfiler(1, 1)
+{
+}
+
+void Autotuner::Initialize(wgpu::Instance instance, wgpu::Device device)
+{
+    mInstance = instance;
+    mDevice = device;
+    if (!mProfiler.Initialize(device)) {
+        LOG_WARN("No TimestampQuery; autotuning with host timings");
+    }
+}
+
+bool Autotuner::UsesGpuTimestamps() const
+{
+    return mProfiler.IsEnabled();
+}
+
+void Autotuner::RunOnce(const std::string& label, const EncodeFn& encode)
+{
+    wgpu::CommandEncoder encoder = mDevice.CreateCommandEncoder();
+    wgpu::ComputePassDescriptor passDesc = {
+        .label = label.c_str(),
+        .timestampWrites = mProfiler.BeginPass(label),
+    };
+    wgpu::ComputePassEncoder pass = encoder.BeginComputePass(&passDesc);
+    encode(pass);
+    pass.End();
+    mProfiler.Resolve(encoder);
+    wgpu::CommandBuffer commandBuffer = encoder.Finish();
+
+    auto start = std::chrono::steady_clock::now();
+    mDevice.GetQueue().Submit(1, &commandBuffer);
+    if (mProfiler.IsEnabled()) {
+        mProfiler.Flush(mInstance);
+        return;
+    }
+    compute_kernel::WaitForQueue(mInstance, mDevice);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    mProfiler.RecordSample(
+        label,
+        static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                .count()));
+}
+
+std::optional<Timing> Autotuner::Measure(const Config& config,
+                                         const EncodeFn& encode)
+{
+    ZoneScoped;
+    if (!encode) {
+        return std::nullopt;
+    }
+    // Labels are unique so that repeated measurements do not mix.
+    const std::string label =
+        fmt::format("autotune#{} {}", mMeasurements++, FormatConfig(config));
+
+    for (int i = 0; i < mWarmup; ++i) {
+        RunOnce(label + " warmup", encode);
+    }
+    for (int i = 0; i < mRepetitions; ++i) {
+        RunOnce(label, encode);
+    }
+
+    for (const gpu_profiler::KernelStats& stats : mProfiler.GetStats()) {
+        if (stats.name == label) {
+            return Timing {
+                .config = config,
+                .meanUs = stats.meanUs,
+                .minUs = stats.minUs,
+            };
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<Config> Autotuner::Tune(const Key& key,
+                                      std::span<const Config> candidates,
+                                      const PrepareFn& prepare,
+                                      TuningCache& cache)
+{
+    ZoneScoped;
+    mTimings.clear();
+    for (const Config& config : candidates) {
+        // The candidate's resources are released before the next one.
+        std::optional<Timing> timing = Measure(config, prepare(config));
+        if (timing) {
+            mTimings.push_back(std::move(*timing));
+        }
+    }
+    if (mTimings.empty()) {
+        LOG_ERROR("No runnable candidate for {} {}", key.kernel, key.bucket);
+        return std::nullopt;
+    }
+    std::sort(mTimings.begin(),
+              mTimings.end(),
+              [](const Timing& lhs, const Timing& rhs)
+              { return lhs.meanUs < rhs.meanUs; });
+
+    const Timing& best = mTimings.front();
+    LOG_INFO("Tuned {} {}: {} ({:.1f} us, {} candidates)",
+             key.kernel,
+             key.bucket,
+             FormatConfig(best.config),
+             best.meanUs,
+             mTimings.size());
+    cache.Store(key, best.config, best.meanUs);
+    return best.config;
+}
+
+const std::vector<Timing>& Autotuner::GetTimings() const
+{
+    return mTimings;
+}
+
+}    // namespace autotune
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <compare>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <webgpu/webgpu_cpp.h>
+
+#include "gpu_profiler.hpp"
+
+namespace autotune
+{
+/// Tunable parameters of one kernel configuration, e.g. {"tile_k", 16}.
+using Config = std::map<std::string, int32_t>;
+
+/// Formats a config as space-separated "name=value" pairs.
+[[nodiscard]] std::string FormatConfig(const Config& config);
+
+/// Parses the output of FormatConfig().
+[[nodiscard]] std::optional<Config> ParseConfig(std::string_view text);
+
+/**
+ * Buckets a problem shape by rounding every dimension up to a power of two,
+ * so that similar shapes share a tuning result.
+ * @return e.g. "128x64x64" for {67, 33, 45}
+ */
+[[nodiscard]] std::string ShapeBucket(std::span<const int64_t> dims);
+
+/// Identifies an adapter and driver, from Library::GetAdapterInfo().
+[[nodiscard]] std::string AdapterKey(const wgpu::AdapterInfo& info);
+
+struct Key
+{
+    std::string kernel;
+    std::string bucket;
+    std::string adapter;
+
+    auto operator<=>(const Key&) const = default;
+};
+
+/**
+ * @brief Best known configuration per (kernel, shape bucket, adapter).
+ *
+ * Persisted as a tab-separated text file with one entry per line:
+ * kernel, bucket, adapter, mean time in microseconds and the config.
+ */
+class TuningCache
+{
+  public:
+    /// Merges the entries of a cache file; a missing file is not an error.
+    bool Load(const std::string& path);
+    bool Save(const std::string& path) const;
+
+    [[nodiscard]] std::optional<Config> Find(const Key& key) const;
+    void Store(const Key& key, const Config& config, double meanUs);
+
+    [[nodiscard]] size_t GetSize() const;
+
+  private:
+    struct Entry
+    {
+        Config config;
+        double meanUs = 0.0;
+    };
+
+    std::map<Key, Entry> mEntries;
+};
+
+/// Records one run of a candidate into an open compute pass.
+using EncodeFn = std::function<void(wgpu::ComputePassEncoder)>;
+
+/// Builds a candidate's pipeline and resources; returns an empty function
+/// if the candidate cannot run on this device.
+using PrepareFn = std::function<EncodeFn(const Config&)>;
+
+struct Timing
+{
+    Config config;
+    double meanUs = 0.0;
+    double minUs = 0.0;
+};
+
+/**
+ * @brief Times kernel candidates and keeps the fastest.
+ *
+ * Candidates are measured one at a time, so only one candidate's resources
+ * are alive at once. Each candidate runs in its own compute pass and
+ * submission, timed with pass timestamps when the device supports
+ * TimestampQuery and with the host clock around the queue otherwise.
+ */
+class Autotuner
+{
+  public:
+    explicit Autotuner(int warmup = 2, int repetitions = 10);
+
+    void Initialize(wgpu::Instance instance, wgpu::Device device);
+
+    [[nodiscard]] bool UsesGpuTimestamps() const;
+
+    /// Times one candidate; nullopt if `encode` is empty.
+    std::optional<Timing> Measure(const Config& config,
+                                  const EncodeFn& encode);
+
+    /**
+     * @brief Measures every candidate and stores the fastest under `key`.
+     * @return the fastest config, or nullopt if no candidate could run
+     */
+    std::optional<Config> Tune(const Key& key,
+                               std::span<const Config> candidates,
+                               const PrepareFn& prepare,
+                               TuningCache& cache);
+
+    /// Timings of the last Tune(), fastest first.
+    [[nodiscard]] const std::vector<Timing>& GetTimings() const;
+
+  private:
+    void RunOnce(const std::string& label, const EncodeFn& encode);
+
+    int mWarmup;
+    int mRepetitions;
+    wgpu::Instance mInstance {nullptr};
+    wgpu::Device mDevice {nullptr};
+    gpu_profiler::GpuProfiler mProfiler;
+    std::vector<Timing> mTimings;
+    uint64_t mMeasurements = 0;
+};
+
+}    // namespace autotune
@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "batched_gemm.hpp"
+
+#include <fmt/format.h>
+#include <tracy/Tracy.hpp>
+
+#include "logging_macros.h"
+
+namespace batched_gemm
+{
+namespace
+{
+/// Host mirror of GemmParams in gemm.slang.
+struct Params
+{
+    int32_t m;
+    int32_t n;
+    int32_t k;
+    float alpha;
+    float beta;
+};
+
+/// Batch count of a 2-D or 3-D view, or 0 for other ranks.
+int32_t BatchOf(const tensor_buffer::TensorView& view)
+{
+    if (view.dims.size() == 2) {
+        return 1;
+    }
+    return view.dims.size() == 3 ? view.dims[0] : 0;
+}
+}    // namespace
+
+std::optional<Shape> InferShape(const tensor_buffer::TensorView& a,
+                                const tensor_buffer::TensorView& b)
+{
+    const int32_t aBatch = BatchOf(a);
+    const int32_t bBatch = BatchOf(b);
+    if (aBatch == 0 || bBatch == 0) {
+        LOG_ERROR("Batched GEMM operands must have 2 or 3 dimensions, got {} "
+                  "and {}",
+                  a.dims.size(),
+                  b.dims.size());
+        return std::nullopt;
+    }
+    Shape shape {
+        .batch = std::max(aBatch, bBatch),
+        .m = a.dims[a.dims.size() - 2],
+        .n = b.dims.back(),
+        .k = a.dims.back(),
+    };
+    const int32_t bk = b.dims[b.dims.size() - 2];
+    if ((aBatch != bBatch && aBatch != 1 && bBatch != 1) || bk != shape.k) {
+        LOG_ERROR("Cannot multiply [{}, {}, {}] by [{}, {}, {}]",
+                  aBatch,
+                  shape.m,
+                  shape.k,
+                  bBatch,
+                  bk,
+                  shape.n);
+        return std::nullopt;
+    }
+    return shape;
+}
+
+dispatch::Grid Workgroups(const Shape& shape,
+                          const gemm::TileConfig& config,
+                          const wgpu::Limits& limits)
+{
+    dispatch::Grid grid =
+        gemm::Workgroups({.m = shape.m, .n = shape.n, .k = shape.k}, config);
+    grid.z = std::min(static_cast<uint32_t>(shape.batch),
+                      limits.maxComputeWorkgroupsPerDimension);
+    return grid;
+}
+
+void ReferenceBatchedGemm(const Shape& shape,
+                          std::span<const float> a,
+                          int32_t aBatches,
+                          std::span<const float> b,
+                          int32_t bBatches,
+                          std::span<float> c)
+{
+    const auto m = static_cast<size_t>(shape.m);
+    const auto n = static_cast<size_t>(shape.n);
+    const auto k = static_cast<size_t>(shape.k);
+    const size_t aSize = m * k;
+    const size_t bSize = k * n;
+    const size_t cSize = m * n;
+    for (int32_t batch = 0; batch < shape.batch; ++batch) {
+        const auto index = static_cast<size_t>(batch);
+        gemm::ReferenceGemm(gemm::Variant::NN,
+                            {.m = shape.m, .n = shape.n, .k = shape.k},
+                            a.subspan(aBatches == 1 ? 0 : index * aSize, aSize),
+                            b.subspan(bBatches == 1 ? 0 : index * bSize, bSize),
+                            c.subspan(index * cSize, cSize));
+    }
+}
+
+BatchedGemm::BatchedGemm(gemm::TileConfig config)
+    : mConfig(config)
+{
+}
+
+bool BatchedGemm::Initialize(wgpu::Device device,
+                             const slang_compiler::Compiler& compiler)
+{
+    ZoneScoped;
+    if (mInitialized) {
+        return true;
+    }
+    mDevice = device;
+    const std::string moduleName = fmt::format("batched_matmul_{}x{}x{}",
+                                               mConfig.threadsX,
+                                               mConfig.threadsY,
+                                               mConfig.tileK);
+    mProgram = compiler.CompileFromSource(
+        gemm::ProgramSource(mConfig, "batched_matmul.slang"),
+        moduleName,
+        "batchedGemm");
+    if (!mProgram.program) {
+        return false;
+    }
+
+    auto* program = mProgram.program.get();
+    auto uniformsInfo = uniform_buffer::ReflectUniformBuffer(program);
+    auto paramsOffset = uniform_buffer::ReflectUniformOffset(program, "params");
+    auto batchCountOffset =
+        uniform_buffer::ReflectUniformOffset(program, "batchCount");
+    auto batchStepOffset =
+        uniform_buffer::ReflectUniformOffset(program, "batchStep");
+    auto a = tensor_reflection::ReflectTensorBuffer(program, "a");
+    auto b = tensor_reflection::ReflectTensorBuffer(program, "b");
+    auto c = tensor_reflection::ReflectTensorBuffer(program, "c");
+    if (!uniformsInfo || !paramsOffset || !batchCountOffset
+        || !batchStepOffset || !a || !b || !c)
+    {
+        LOG_ERROR("batched_matmul.slang is missing parameters");
+        return false;
+    }
+    mUniforms = *uniformsInfo;
+    mParamsOffset = *paramsOffset;
+    mBatchCountOffset = *batchCountOffset;
+    mBatchStepOffset = *batchStepOffset;
+    mA = *a;
+    mB = *b;
+    mC = *c;
+
+    uniform_buffer::UniformBuffer uniforms(mUniforms);
+    tensor_buffer::TensorBuffer aBuffer(mA);
+    tensor_buffer::TensorBuffer bBuffer(mB);
+    tensor_buffer::TensorBuffer cBuffer(mC);
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms).Add(aBuffer).Add(bBuffer).Add(cBuffer);
+    mInitialized = mKernel.Initialize(mDevice,
+                                      mProgram.compileToWGSL(),
+                                      "batchedGemm",
+                                      bindings.GetLayoutEntries());
+    return mInitialized;
+}
+
+bool BatchedGemm::Encode(wgpu::ComputePassEncoder pass,
+                         const tensor_buffer::BufferView& a,
+                         const tensor_buffer::BufferView& b,
+                         wgpu::Buffer c,
+                         float alpha,
+                         float beta) const
+{
+    ZoneScoped;
+    if (!mInitialized) {
+        LOG_ERROR("BatchedGemm::Encode called before Initialize");
+        return false;
+    }
+    const std::optional<Shape> shape = InferShape(a.view, b.view);
+    if (!shape) {
+        return false;
+    }
+    // Broadcast operands get batch stride 0 instead of a copy.
+    const std::vector<int32_t> aDims = {shape->batch, shape->m, shape->k};
+    const std::vector<int32_t> bDims = {shape->batch, shape->k, shape->n};
+    const std::vector<int32_t> cDims = {shape->batch, shape->m, shape->n};
+    const auto aView = a.view.Expand(aDims);
+    const auto bView = b.view.Expand(bDims);
+    if (!aView || !bView) {
+        return false;
+    }
+
+    wgpu::Limits limits {};
+    mDevice.GetLimits(&limits);
+    const dispatch::Grid grid = Workgroups(*shape, mConfig, limits);
+
+    wgpu::Queue queue = mDevice.GetQueue();
+    uniform_buffer::UniformBuffer uniforms(mUniforms);
+    uniforms.Initialize(mDevice);
+    tensor_buffer::TensorBuffer aBuffer(mA);
+    tensor_buffer::TensorBuffer bBuffer(mB);
+    tensor_buffer::TensorBuffer cBuffer(mC);
+    aBuffer.Initialize(uniforms, a.buffer, a.buffer.GetSize());
+    bBuffer.Initialize(uniforms, b.buffer, b.buffer.GetSize());
+    cBuffer.Initialize(uniforms, c, c.GetSize());
+    aBuffer.WriteShape(queue, *aView);
+    bBuffer.WriteShape(queue, *bView);
+    cBuffer.WriteShape(queue, cDims);
+
+    const Params params {
+        .m = shape->m,
+        .n = shape->n,
+        .k = shape->k,
+        .alpha = alpha,
+        .beta = beta,
+    };
+    uniforms.Write(queue, mParamsOffset, params);
+    uniforms.Write(queue, mBatchCountOffset, shape->batch);
+    uniforms.Write(queue, mBatchStepOffset, static_cast<int32_t>(grid.z));
+
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms).Add(aBuffer).Add(bBuffer).Add(cBuffer);
+    pass.SetPipeline(mKernel.GetPipeline());
+    pass.SetBindGroup(0, mKernel.CreateBindGroup(bindings.GetEntries()));
+    return dispatch::Dispatch(pass, grid, limits);
+}
+
+const gemm::TileConfig& BatchedGemm::GetTileConfig() const
+{
+    return mConfig;
+}
+
+}    // namespace batched_gemm
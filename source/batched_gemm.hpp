@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+
+#include <webgpu/webgpu_cpp.h>
+
+#include "compute_kernel.hpp"
+#include "dispatch.hpp"
+#include "gemm.hpp"
+#include "slang_compiler.hpp"
+#include "tensor_buffer.hpp"
+#include "tensor_reflection.hpp"
+#include "uniform_buffer.hpp"
+
+namespace batched_gemm
+{
+struct Shape
+{
+    int32_t batch = 1;
+    int32_t m = 0;
+    int32_t n = 0;
+    int32_t k = 0;
+};
+
+/**
+ * @brief Problem size of A x B for views of A: [batch, M, K] and
+ * B: [batch, K, N]. Either batch may be 1 or missing, in which case that
+ * operand is broadcast across the other's batch.
+ * @return nullopt if the views do not multiply
+ */
+[[nodiscard]] std::optional<Shape> InferShape(
+    const tensor_buffer::TensorView& a, const tensor_buffer::TensorView& b);
+
+/**
+ * @brief Workgroups covering the [batch, M, N] output. Batches beyond the
+ * device's z limit are walked by the workgroups in z.
+ */
+[[nodiscard]] dispatch::Grid Workgroups(const Shape& shape,
+                                        const gemm::TileConfig& config,
+                                        const wgpu::Limits& limits);
+
+/**
+ * @brief CPU reference of C[b] = A[b] x B[b] on contiguous operands, where
+ * A holds `aBatches` and B `bBatches` matrices, each 1 or shape.batch.
+ */
+void ReferenceBatchedGemm(const Shape& shape,
+                          std::span<const float> a,
+                          int32_t aBatches,
+                          std::span<const float> b,
+                          int32_t bBatches,
+                          std::span<float> c);
+
+/**
+ * @brief Batched GEMM over RWTensorBuffer<float, int, int, int> operands,
+ * built on the tiled core of gemm.slang.
+ *
+ * Operands are caller-owned views, so broadcast batches (stride 0) and
+ * transposed matrices need no copies.
+ */
+class BatchedGemm
+{
+  public:
+    explicit BatchedGemm(gemm::TileConfig config = {});
+
+    bool Initialize(wgpu::Device device,
+                    const slang_compiler::Compiler& compiler);
+
+    /**
+     * @brief Records C = alpha * A x B + beta * C into `pass`.
+     * @param c Buffer holding the contiguous [batch, M, N] output; it must
+     * not alias `a` or `b`.
+     * @return false if the operands do not multiply or nothing was
+     * dispatched
+     */
+    [[nodiscard]] bool Encode(wgpu::ComputePassEncoder pass,
+                              const tensor_buffer::BufferView& a,
+                              const tensor_buffer::BufferView& b,
+                              wgpu::Buffer c,
+                              float alpha = 1.0f,
+                              float beta = 0.0f) const;
+
+    [[nodiscard]] const gemm::TileConfig& GetTileConfig() const;
+
+  private:
+    gemm::TileConfig mConfig;
+    wgpu::Device mDevice {nullptr};
+    slang_compiler::SlangProgram mProgram;
+    compute_kernel::ComputeKernel mKernel {"batchedGemm"};
+    uniform_buffer::UniformBufferReflection mUniforms;
+    size_t mParamsOffset = 0;
+    size_t mBatchCountOffset = 0;
+    size_t mBatchStepOffset = 0;
+    tensor_reflection::TensorBufferReflection mA;
+    tensor_reflection::TensorBufferReflection mB;
+    tensor_reflection::TensorBufferReflection mC;
+    bool mInitialized = false;
+};
+
+}    // namespace batched_gemm
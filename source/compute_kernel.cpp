@@ -0,0 +1,180 @@
+#include <algorithm>
+
+#include "compute_kernel.hpp"
+
+#include <tracy/Tracy.hpp>
+
+#include "gpu_memory.hpp"
+#include "logging_macros.h"
+
+namespace compute_kernel
+{
+Bindings& Bindings::Add(const wgpu::BindGroupLayoutEntry& layoutEntry,
+                        const wgpu::BindGroupEntry& entry)
+{
+    uint32_t binding = layoutEntry.binding;
+    bool present = std::any_of(mLayoutEntries.begin(),
+                               mLayoutEntries.end(),
+                               [binding](const auto& existing)
+                               { return existing.binding == binding; });
+    if (!present) {
+        mLayoutEntries.push_back(layoutEntry);
+        mEntries.push_back(entry);
+    }
+    return *this;
+}
+
+std::span<const wgpu::BindGroupLayoutEntry> Bindings::GetLayoutEntries() const
+{
+    return mLayoutEntries;
+}
+
+std::span<const wgpu::BindGroupEntry> Bindings::GetEntries() const
+{
+    return mEntries;
+}
+
+ComputeKernel::ComputeKernel(std::string label)
+    : mLabel(std::move(label))
+{
+}
+
+bool ComputeKernel::Initialize(
+    wgpu::Device device,
+    const std::string& wgslSource,
+    const std::string& entryPoint,
+    std::span<const wgpu::BindGroupLayoutEntry> layoutEntries,
+    std::span<const wgpu::ConstantEntry> constants)
+{
+    ZoneScoped;
+    if (wgslSource.empty()) {
+        LOG_ERROR("No WGSL source for kernel {}", mLabel);
+        return false;
+    }
+    mDevice = device;
+
+    wgpu::BindGroupLayoutDescriptor bindGroupLayoutDesc = {
+        .label = mLabel.c_str(),
+        .entryCount = layoutEntries.size(),
+        .entries = layoutEntries.data(),
+    };
+    mBindGroupLayout = device.CreateBindGroupLayout(&bindGroupLayoutDesc);
+
+    wgpu::PipelineLayoutDescriptor pipelineLayoutDesc = {
+        .label = mLabel.c_str(),
+        .bindGroupLayoutCount = 1,
+        .bindGroupLayouts = &mBindGroupLayout,
+    };
+    wgpu::PipelineLayout pipelineLayout =
+        device.CreatePipelineLayout(&pipelineLayoutDesc);
+
+    wgpu::ShaderSourceWGSL shader = {};
+    shader.code = wgslSource.c_str();
+    wgpu::ShaderModuleDescriptor shaderModuleDesc = {
+        .nextInChain = reinterpret_cast<wgpu::ChainedStruct*>(&shader),
+        .label = mLabel.c_str(),
+    };
+    wgpu::ShaderModule shaderModule =
+        device.CreateShaderModule(&shaderModuleDesc);
+
+    wgpu::ComputePipelineDescriptor computePipelineDesc = {
+        .label = mLabel.c_str(),
+        .layout = pipelineLayout,
+        .compute =
+            {
+                .module = shaderModule,
+                .entryPoint = entryPoint.c_str(),
+                .constantCount = constants.size(),
+                .constants = constants.data(),
+            },
+    };
+    mPipeline = device.CreateComputePipeline(&computePipelineDesc);
+    if (mPipeline == nullptr) {
+        LOG_ERROR("Failed to create pipeline for kernel {}", mLabel);
+        return false;
+    }
+    return true;
+}
+
+wgpu::BindGroup ComputeKernel::CreateBindGroup(
+    std::span<const wgpu::BindGroupEntry> entries) const
+{
+    wgpu::BindGroupDescriptor bindGroupDesc = {
+        .label = mLabel.c_str(),
+        .layout = mBindGroupLayout,
+        .entryCount = entries.size(),
+        .entries = entries.data(),
+    };
+    return mDevice.CreateBindGroup(&bindGroupDesc);
+}
+
+wgpu::ComputePipeline ComputeKernel::GetPipeline() const
+{
+    return mPipeline;
+}
+
+wgpu::BindGroupLayout ComputeKernel::GetBindGroupLayout() const
+{
+    return mBindGroupLayout;
+}
+
+const std::string& ComputeKernel::GetLabel() const
+{
+    return mLabel;
+}
+
+std::vector<std::byte> ReadBuffer(wgpu::Instance instance,
+                                  wgpu::Device device,
+                                  wgpu::Buffer buffer,
+                                  size_t byteSize)
+{
+    ZoneScoped;
+    wgpu::BufferDescriptor mapBufferDesc = {
+        .label = "readback",
+        .usage = wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::MapRead,
+        .size = byteSize,
+        .mappedAtCreation = false,
+    };
+    gpu_memory::TrackedBuffer mapBuffer =
+        gpu_memory::CreateBuffer(device, mapBufferDesc);
+    if (mapBuffer.Get() == nullptr) {
+        return {};
+    }
+
+    wgpu::CommandEncoder commandEncoder = device.CreateCommandEncoder();
+    commandEncoder.CopyBufferToBuffer(buffer, 0, mapBuffer.Get(), 0, byteSize);
+    wgpu::CommandBuffer commandBuffer = commandEncoder.Finish();
+    device.GetQueue().Submit(1, &commandBuffer);
+
+    std::vector<std::byte> result;
+    wgpu::Buffer mapped = mapBuffer.Get();
+    auto mapCallback = [&mapped, &result, byteSize](wgpu::MapAsyncStatus status,
+                                                    wgpu::StringView message)
+    {
+        if (status != wgpu::MapAsyncStatus::Success) {
+            LOG_ERROR("Failed to map readback buffer: {}", message);
+            return;
+        }
+        const auto* data = static_cast<const std::byte*>(
+            mapped.GetConstMappedRange(0, byteSize));
+        result.assign(data, data + byteSize);
+        mapped.Unmap();
+    };
+    instance.WaitAny(mapped.MapAsync(wgpu::MapMode::Read,
+                                     0,
+                                     byteSize,
+                                     wgpu::CallbackMode::WaitAnyOnly,
+                                     mapCallback),
+                     UINT64_MAX);
+    return result;
+}
+
+void WaitForQueue(wgpu::Instance instance, wgpu::Device device)
+{
+    instance.WaitAny(device.GetQueue().OnSubmittedWorkDone(
+                         wgpu::CallbackMode::WaitAnyOnly,
+                         [](wgpu::QueueWorkDoneStatus, wgpu::StringView) {}),
+                     UINT64_MAX);
+}
+
+}    // namespace compute_kernel
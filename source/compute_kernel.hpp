@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <webgpu/webgpu_cpp.h>
+
+namespace compute_kernel
+{
+/**
+ * @brief Collects the bind group entries of a kernel's resources.
+ *
+ * Accepts any resource wrapper exposing GetBindGroupLayoutEntries(),
+ * GetBindGroupEntries() and GetEntryCount() (TensorBuffer, PrintBuffer,
+ * UniformBuffer, ...). Entries sharing a binding, such as the global uniform
+ * buffer every tensor reports, are only added once.
+ */
+class Bindings
+{
+  public:
+    template<typename Resource>
+    Bindings& Add(const Resource& resource)
+    {
+        const wgpu::BindGroupLayoutEntry* layoutEntries =
+            resource.GetBindGroupLayoutEntries();
+        const wgpu::BindGroupEntry* entries = resource.GetBindGroupEntries();
+        for (size_t i = 0; i < resource.GetEntryCount(); ++i) {
+            Add(layoutEntries[i], entries[i]);
+        }
+        return *this;
+    }
+
+    Bindings& Add(const wgpu::BindGroupLayoutEntry& layoutEntry,
+                  const wgpu::BindGroupEntry& entry);
+
+    [[nodiscard]] std::span<const wgpu::BindGroupLayoutEntry> GetLayoutEntries()
+        const;
+    [[nodiscard]] std::span<const wgpu::BindGroupEntry> GetEntries() const;
+
+  private:
+    std::vector<wgpu::BindGroupLayoutEntry> mLayoutEntries;
+    std::vector<wgpu::BindGroupEntry> mEntries;
+};
+
+/**
+ * @brief A compute pipeline with a single explicit bind group layout.
+ */
+class ComputeKernel
+{
+  public:
+    explicit ComputeKernel(std::string label = "compute_kernel");
+
+    /**
+     * @brief Creates the shader module, bind group layout and pipeline.
+     * @param device Device to create the pipeline on.
+     * @param wgslSource WGSL code, usually SlangProgram::compileToWGSL().
+     * @param entryPoint Name of the compute entry point.
+     * @param layoutEntries Layout of every resource of bind group 0.
+     * @param constants Values for WGSL override constants.
+     * @return false if any of the objects could not be created.
+     */
+    bool Initialize(wgpu::Device device,
+                    const std::string& wgslSource,
+                    const std::string& entryPoint,
+                    std::span<const wgpu::BindGroupLayoutEntry> layoutEntries,
+                    std::span<const wgpu::ConstantEntry> constants = {});
+
+    [[nodiscard]] wgpu::BindGroup CreateBindGroup(
+        std::span<const wgpu::BindGroupEntry> entries) const;
+
+    [[nodiscard]] wgpu::ComputePipeline GetPipeline() const;
+    [[nodiscard]] wgpu::BindGroupLayout GetBindGroupLayout() const;
+    [[nodiscard]] const std::string& GetLabel() const;
+
+  private:
+    std::string mLabel;
+    wgpu::Device mDevice {nullptr};
+    wgpu::BindGroupLayout mBindGroupLayout {nullptr};
+    wgpu::ComputePipeline mPipeline {nullptr};
+};
+
+/**
+ * Copies a buffer back to the host and waits for the copy to complete.
+ * @param instance Instance used to wait on the mapping.
+ * @param device Device owning the buffer, which must have CopySrc usage.
+ * @param buffer Buffer to read.
+ * @param byteSize Number of bytes to read from offset 0 (a multiple of four).
+ * @return the buffer contents, or an empty vector if mapping failed
+ */
+[[nodiscard]] std::vector<std::byte> ReadBuffer(wgpu::Instance instance,
+                                                wgpu::Device device,
+                                                wgpu::Buffer buffer,
+                                                size_t byteSize);
+
+/// Typed variant of ReadBuffer() for trivially copyable element types.
+template<typename T>
+[[nodiscard]] std::vector<T> ReadBuffer(wgpu::Instance instance,
+                                        wgpu::Device device,
+                                        wgpu::Buffer buffer,
+                                        size_t count)
+{
+    std::vector<std::byte> bytes =
+        ReadBuffer(instance, device, buffer, count * sizeof(T));
+    std::vector<T> values(bytes.size() / sizeof(T));
+    std::memcpy(values.data(), bytes.data(), values.size() * sizeof(T));
+    return values;
+}
+
+/// Blocks until all work submitted to the device's queue has completed.
+void WaitForQueue(wgpu::Instance instance, wgpu::Device device);
+
+}    // namespace compute_kernel
@@ -0,0 +1,433 @@
+#include <string>
+
+#include "conv2d.hpp"
+
+#include <fmt/format.h>
+#include <tracy/Tracy.hpp>
+
+#include "logging_macros.h"
+
+namespace conv2d
+{
+namespace
+{
+/// Host mirror of ConvParams in conv2d.slang.
+struct Params
+{
+    int32_t batch;
+    int32_t inChannels;
+    int32_t height;
+    int32_t width;
+    int32_t outChannels;
+    int32_t kernelH;
+    int32_t kernelW;
+    int32_t groups;
+    int32_t outHeight;
+    int32_t outWidth;
+    int32_t strideH;
+    int32_t strideW;
+    int32_t padH;
+    int32_t padW;
+    int32_t dilationH;
+    int32_t dilationW;
+};
+
+size_t ElementCount(const std::array<int32_t, 4>& dims)
+{
+    size_t count = 1;
+    for (int32_t dim : dims) {
+        count *= static_cast<size_t>(dim);
+    }
+    return count;
+}
+
+/// Row-major offset of element (n, c, h, w) of a tensor with `channels`
+/// channels of height x width pixels.
+size_t Offset(Layout layout,
+              int32_t channels,
+              int32_t height,
+              int32_t width,
+              int32_t n,
+              int32_t c,
+              int32_t h,
+              int32_t w)
+{
+    const int64_t offset = layout == Layout::NHWC
+        ? ((int64_t {n} * height + h) * width + w) * channels + c
+        : ((int64_t {n} * channels + c) * height + h) * width + w;
+    return static_cast<size_t>(offset);
+}
+}    // namespace
+
+int32_t Shape::OutHeight() const
+{
+    return (height + 2 * padH - dilationH * (kernelH - 1) - 1) / strideH + 1;
+}
+
+int32_t Shape::OutWidth() const
+{
+    return (width + 2 * padW - dilationW * (kernelW - 1) - 1) / strideW + 1;
+}
+
+bool Shape::IsValid() const
+{
+    const bool positive = batch > 0 && inChannels > 0 && height > 0
+        && width > 0 && outChannels > 0 && kernelH > 0 && kernelW > 0
+        && strideH > 0 && strideW > 0 && dilationH > 0 && dilationW > 0
+        && groups > 0 && padH >= 0 && padW >= 0;
+    return positive && inChannels % groups == 0 && outChannels % groups == 0
+        && height + 2 * padH >= dilationH * (kernelH - 1) + 1
+        && width + 2 * padW >= dilationW * (kernelW - 1) + 1;
+}
+
+std::array<int32_t, 4> InputDims(const Shape& shape, Layout layout)
+{
+    if (layout == Layout::NHWC) {
+        return {shape.batch, shape.height, shape.width, shape.inChannels};
+    }
+    return {shape.batch, shape.inChannels, shape.height, shape.width};
+}
+
+std::array<int32_t, 4> OutputDims(const Shape& shape, Layout layout)
+{
+    if (layout == Layout::NHWC) {
+        return {shape.batch,
+                shape.OutHeight(),
+                shape.OutWidth(),
+                shape.outChannels};
+    }
+    return {
+        shape.batch, shape.outChannels, shape.OutHeight(), shape.OutWidth()};
+}
+
+std::array<int32_t, 4> WeightDims(const Shape& shape)
+{
+    return {shape.outChannels,
+            shape.inChannels / shape.groups,
+            shape.kernelH,
+            shape.kernelW};
+}
+
+const char* EntryPoint(Layout layout)
+{
+    return layout == Layout::NCHW ? "conv2dNCHW" : "conv2dNHWC";
+}
+
+dispatch::Grid Workgroups(const Shape& shape, const gemm::TileConfig& config)
+{
+    const gemm::Shape gemmShape = {
+        .m = shape.batch * shape.OutHeight() * shape.OutWidth(),
+        .n = shape.outChannels / shape.groups,
+        .k = 1,
+    };
+    dispatch::Grid grid = gemm::Workgroups(gemmShape, config);
+    grid.z = static_cast<uint32_t>(shape.groups);
+    return grid;
+}
+
+Layout PreferredLayout(const Shape& shape)
+{
+    const int32_t channelRun = shape.inChannels / shape.groups;
+    const int32_t columnRun = shape.dilationW == 1 ? shape.kernelW : 1;
+    return channelRun >= columnRun ? Layout::NHWC : Layout::NCHW;
+}
+
+void ReferenceConv2d(const Shape& shape,
+                     Layout layout,
+                     std::span<const float> input,
+                     std::span<const float> weight,
+                     std::span<const float> bias,
+                     std::span<float> output)
+{
+    const int32_t outHeight = shape.OutHeight();
+    const int32_t outWidth = shape.OutWidth();
+    const int32_t groupIn = shape.inChannels / shape.groups;
+    const int32_t groupOut = shape.outChannels / shape.groups;
+    for (int32_t n = 0; n < shape.batch; ++n) {
+        for (int32_t co = 0; co < shape.outChannels; ++co) {
+            const int32_t group = co / groupOut;
+            for (int32_t oh = 0; oh < outHeight; ++oh) {
+                for (int32_t ow = 0; ow < outWidth; ++ow) {
+                    float acc = bias[static_cast<size_t>(co)];
+                    for (int32_t ci = 0; ci < groupIn; ++ci) {
+                        for (int32_t kh = 0; kh < shape.kernelH; ++kh) {
+                            const int32_t h = oh * shape.strideH - shape.padH
+                                + kh * shape.dilationH;
+                            for (int32_t kw = 0; kw < shape.kernelW; ++kw) {
+                                const int32_t w = ow * shape.strideW
+                                    - shape.padW + kw * shape.dilationW;
+                                if (h < 0 || h >= shape.height || w < 0
+                                    || w >= shape.width)
+                                {
+                                    continue;
+                                }
+                                const size_t in = Offset(layout,
+                                                         shape.inChannels,
+                                                         shape.height,
+                                                         shape.width,
+                                                         n,
+                                                         group * groupIn + ci,
+                                                         h,
+                                                         w);
+                                const size_t k = static_cast<size_t>(
+                                    ((co * groupIn + ci) * shape.kernelH + kh)
+                                        * shape.kernelW
+                                    + kw);
+                                acc += input[in] * weight[k];
+                            }
+                        }
+                    }
+                    output[Offset(layout,
+                                  shape.outChannels,
+                                  outHeight,
+                                  outWidth,
+                                  n,
+                                  co,
+                                  oh,
+                                  ow)] = acc;
+                }
+            }
+        }
+    }
+}
+
+Conv2d::Conv2d(Layout layout, gemm::TileConfig config)
+    : mLayout(layout)
+    , mConfig(config)
+    , mKernel(EntryPoint(layout))
+{
+}
+
+bool Conv2d::Initialize(wgpu::Device device,
+                        const slang_compiler::Compiler& compiler)
+{
+    ZoneScoped;
+    if (mInitialized) {
+        return true;
+    }
+    mDevice = device;
+    const std::string moduleName = fmt::format("conv2d_{}x{}x{}",
+                                               mConfig.threadsX,
+                                               mConfig.threadsY,
+                                               mConfig.tileK);
+    mProgram =
+        compiler.CompileFromSource(gemm::ProgramSource(mConfig, "conv2d.slang"),
+                                   moduleName,
+                                   EntryPoint(mLayout));
+    if (!mProgram.program) {
+        return false;
+    }
+
+    auto* program = mProgram.program.get();
+    auto uniformsInfo = uniform_buffer::ReflectUniformBuffer(program);
+    auto paramsOffset = uniform_buffer::ReflectUniformOffset(program, "params");
+    if (!uniformsInfo || !paramsOffset) {
+        LOG_ERROR("conv2d.slang has no ConvParams uniform");
+        return false;
+    }
+    mParamsOffset = *paramsOffset;
+    mUniforms.emplace(*uniformsInfo);
+    mUniforms->Initialize(device);
+
+    // The bind group layout only depends on the reflection, so the kernel is
+    // created once with placeholder tensors.
+    if (!Resize(device.GetQueue(), {})) {
+        return false;
+    }
+    compute_kernel::Bindings bindings;
+    bindings.Add(*mUniforms).Add(*mInput).Add(*mWeight).Add(*mBias).Add(
+        *mOutput);
+    if (!mKernel.Initialize(device,
+                            mProgram.compileToWGSL(),
+                            EntryPoint(mLayout),
+                            bindings.GetLayoutEntries()))
+    {
+        return false;
+    }
+    mBindGroup = mKernel.CreateBindGroup(bindings.GetEntries());
+    mInitialized = true;
+    return true;
+}
+
+bool Conv2d::Resize(wgpu::Queue queue, const Shape& shape)
+{
+    ZoneScoped;
+    if (!mUniforms) {
+        LOG_ERROR("Conv2d::Resize called before Initialize");
+        return false;
+    }
+    if (!shape.IsValid()) {
+        LOG_ERROR("Invalid Conv2D of {}x{}x{}x{} with a {}x{} kernel and {} "
+                  "groups",
+                  shape.batch,
+                  shape.inChannels,
+                  shape.height,
+                  shape.width,
+                  shape.kernelH,
+                  shape.kernelW,
+                  shape.groups);
+        return false;
+    }
+    wgpu::Limits limits {};
+    mDevice.GetLimits(&limits);
+    if (!dispatch::FitsLimits(Workgroups(shape, mConfig), limits)) {
+        LOG_ERROR("Conv2D output of {}x{}x{} pixels exceeds the workgroup "
+                  "limits",
+                  shape.batch,
+                  shape.OutHeight(),
+                  shape.OutWidth());
+        return false;
+    }
+
+    auto* program = mProgram.program.get();
+    auto inputInfo = tensor_reflection::ReflectTensorBuffer(program, "input");
+    auto weightInfo = tensor_reflection::ReflectTensorBuffer(program, "weight");
+    auto biasInfo = tensor_reflection::ReflectTensorBuffer(program, "bias");
+    auto outputInfo = tensor_reflection::ReflectTensorBuffer(program, "output");
+    if (!inputInfo || !weightInfo || !biasInfo || !outputInfo) {
+        return false;
+    }
+
+    const std::array<int32_t, 4> inputDims = InputDims(shape, mLayout);
+    const std::array<int32_t, 4> weightDims = WeightDims(shape);
+    const std::array<int32_t, 1> biasDims = {shape.outChannels};
+    const std::array<int32_t, 4> outputDims = OutputDims(shape, mLayout);
+
+    mInput.emplace(*inputInfo);
+    mWeight.emplace(*weightInfo);
+    mBias.emplace(*biasInfo);
+    mOutput.emplace(*outputInfo);
+    mInput->Initialize(
+        mDevice, ElementCount(inputDims) * sizeof(float), *mUniforms);
+    mWeight->Initialize(
+        mDevice, ElementCount(weightDims) * sizeof(float), *mUniforms);
+    mBias->Initialize(mDevice,
+                      static_cast<size_t>(shape.outChannels) * sizeof(float),
+                      *mUniforms);
+    mOutput->Initialize(
+        mDevice, ElementCount(outputDims) * sizeof(float), *mUniforms);
+    mInput->WriteShape(queue, inputDims);
+    mWeight->WriteShape(queue, weightDims);
+    mBias->WriteShape(queue, biasDims);
+    mOutput->WriteShape(queue, outputDims);
+
+    const Params params {
+        .batch = shape.batch,
+        .inChannels = shape.inChannels,
+        .height = shape.height,
+        .width = shape.width,
+        .outChannels = shape.outChannels,
+        .kernelH = shape.kernelH,
+        .kernelW = shape.kernelW,
+        .groups = shape.groups,
+        .outHeight = shape.OutHeight(),
+        .outWidth = shape.OutWidth(),
+        .strideH = shape.strideH,
+        .strideW = shape.strideW,
+        .padH = shape.padH,
+        .padW = shape.padW,
+        .dilationH = shape.dilationH,
+        .dilationW = shape.dilationW,
+    };
+    mUniforms->Write(queue, mParamsOffset, params);
+    const std::vector<float> zeros(static_cast<size_t>(shape.outChannels));
+    WriteBias(queue, zeros);
+    mShape = shape;
+
+    if (mInitialized) {
+        compute_kernel::Bindings bindings;
+        bindings.Add(*mUniforms).Add(*mInput).Add(*mWeight).Add(*mBias).Add(
+            *mOutput);
+        mBindGroup = mKernel.CreateBindGroup(bindings.GetEntries());
+    }
+    return true;
+}
+
+void Conv2d::WriteInput(wgpu::Queue queue, std::span<const float> values) const
+{
+    queue.WriteBuffer(
+        mInput->GetDataBuffer(), 0, values.data(), values.size_bytes());
+}
+
+void Conv2d::WriteWeight(wgpu::Queue queue,
+                         std::span<const float> values) const
+{
+    queue.WriteBuffer(
+        mWeight->GetDataBuffer(), 0, values.data(), values.size_bytes());
+}
+
+void Conv2d::WriteBias(wgpu::Queue queue, std::span<const float> values) const
+{
+    queue.WriteBuffer(
+        mBias->GetDataBuffer(), 0, values.data(), values.size_bytes());
+}
+
+void Conv2d::Encode(wgpu::ComputePassEncoder pass) const
+{
+    dispatch::Grid grid = Workgroups(mShape, mConfig);
+    pass.SetPipeline(mKernel.GetPipeline());
+    pass.SetBindGroup(0, mBindGroup);
+    pass.DispatchWorkgroups(grid.x, grid.y, grid.z);
+}
+
+std::vector<float> Conv2d::ReadOutput(wgpu::Instance instance) const
+{
+    return compute_kernel::ReadBuffer<float>(
+        instance,
+        mDevice,
+        mOutput->GetDataBuffer(),
+        ElementCount(OutputDims(mShape, mLayout)));
+}
+
+Layout Conv2d::GetLayout() const
+{
+    return mLayout;
+}
+
+const Shape& Conv2d::GetShape() const
+{
+    return mShape;
+}
+
+wgpu::Buffer Conv2d::GetInput() const
+{
+    return mInput->GetDataBuffer();
+}
+
+wgpu::Buffer Conv2d::GetOutput() const
+{
+    return mOutput->GetDataBuffer();
+}
+
+bool LayoutTransform::Initialize(wgpu::Device device,
+                                 const slang_compiler::Compiler& compiler)
+{
+    ZoneScoped;
+    if (mInitialized) {
+        return true;
+    }
+    mInitialized = mPermuter.Initialize(device, compiler);
+    return mInitialized;
+}
+
+bool LayoutTransform::Encode(wgpu::ComputePassEncoder pass,
+                             Layout from,
+                             wgpu::Buffer src,
+                             wgpu::Buffer dst,
+                             const std::array<int32_t, 4>& nchw) const
+{
+    if (!mInitialized) {
+        LOG_ERROR("LayoutTransform::Encode called before Initialize");
+        return false;
+    }
+    if (from == Layout::NHWC) {
+        const std::array<int32_t, 4> nhwc = {
+            nchw[0], nchw[2], nchw[3], nchw[1]};
+        constexpr std::array<size_t, 4> kToNchw = {0, 3, 1, 2};
+        return mPermuter.Encode(pass, src, dst, nhwc, kToNchw);
+    }
+    constexpr std::array<size_t, 4> kToNhwc = {0, 2, 3, 1};
+    return mPermuter.Encode(pass, src, dst, nchw, kToNhwc);
+}
+
+}    // namespace conv2d
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <webgpu/webgpu_cpp.h>
+
+#include "compute_kernel.hpp"
+#include "dispatch.hpp"
+#include "gemm.hpp"
+#include "permute.hpp"
+#include "slang_compiler.hpp"
+#include "tensor_buffer.hpp"
+#include "tensor_reflection.hpp"
+#include "uniform_buffer.hpp"
+
+namespace conv2d
+{
+/// Memory order of 4-D activations.
+enum class Layout
+{
+    NHWC,
+    NCHW,
+};
+
+/// Problem description; the input has `inChannels` channels of
+/// height x width pixels per batch item.
+struct Shape
+{
+    int32_t batch = 1;
+    int32_t inChannels = 1;
+    int32_t height = 1;
+    int32_t width = 1;
+    int32_t outChannels = 1;
+    int32_t kernelH = 1;
+    int32_t kernelW = 1;
+    int32_t strideH = 1;
+    int32_t strideW = 1;
+    int32_t padH = 0;
+    int32_t padW = 0;
+    int32_t dilationH = 1;
+    int32_t dilationW = 1;
+    int32_t groups = 1;
+
+    [[nodiscard]] int32_t OutHeight() const;
+    [[nodiscard]] int32_t OutWidth() const;
+
+    /// Positive sizes, channels divisible by groups and a non-empty output.
+    [[nodiscard]] bool IsValid() const;
+};
+
+/// Dimensions of the input in the given layout, outermost first.
+[[nodiscard]] std::array<int32_t, 4> InputDims(const Shape& shape,
+                                               Layout layout);
+/// Dimensions of the output in the given layout, outermost first.
+[[nodiscard]] std::array<int32_t, 4> OutputDims(const Shape& shape,
+                                                Layout layout);
+/// Weights are [outChannels, inChannels / groups, kernelH, kernelW] in
+/// either layout.
+[[nodiscard]] std::array<int32_t, 4> WeightDims(const Shape& shape);
+
+/// Name of the conv2d.slang entry point for the layout.
+[[nodiscard]] const char* EntryPoint(Layout layout);
+
+/// Workgroups of the implicit GEMM, with one z slice per group.
+[[nodiscard]] dispatch::Grid Workgroups(const Shape& shape,
+                                        const gemm::TileConfig& config = {});
+
+/**
+ * @brief Layout expected to run faster for a shape.
+ *
+ * The implicit GEMM reads its reduction dimension in consecutive runs: input
+ * channels in NHWC, kernel columns in NCHW (contiguous only without
+ * horizontal dilation). The layout with the longer contiguous run wins, so
+ * NHWC for most layers and NCHW for depthwise or few-channel convolutions
+ * with wide kernels.
+ */
+[[nodiscard]] Layout PreferredLayout(const Shape& shape);
+
+/// CPU reference of the convolution, with data in the given layout.
+void ReferenceConv2d(const Shape& shape,
+                     Layout layout,
+                     std::span<const float> input,
+                     std::span<const float> weight,
+                     std::span<const float> bias,
+                     std::span<float> output);
+
+/**
+ * @brief Conv2D forward pass as an implicit GEMM on the tiled GEMM core.
+ *
+ * Owns the input, weight, bias and output tensors of the current shape.
+ * Typical use: Initialize(), Resize(), write the operands, Encode() into a
+ * compute pass and read the output back.
+ */
+class Conv2d
+{
+  public:
+    explicit Conv2d(Layout layout = Layout::NHWC,
+                    gemm::TileConfig config = {});
+
+    bool Initialize(wgpu::Device device,
+                    const slang_compiler::Compiler& compiler);
+
+    /**
+     * @brief Allocates the tensors for `shape` and uploads their shapes.
+     * The bias is reset to zero.
+     * @return false if the shape is invalid or exceeds the workgroup limits
+     */
+    bool Resize(wgpu::Queue queue, const Shape& shape);
+
+    void WriteInput(wgpu::Queue queue, std::span<const float> values) const;
+    void WriteWeight(wgpu::Queue queue, std::span<const float> values) const;
+    void WriteBias(wgpu::Queue queue, std::span<const float> values) const;
+
+    /// Records the dispatch into an open compute pass.
+    void Encode(wgpu::ComputePassEncoder pass) const;
+
+    [[nodiscard]] std::vector<float> ReadOutput(wgpu::Instance instance) const;
+
+    [[nodiscard]] Layout GetLayout() const;
+    [[nodiscard]] const Shape& GetShape() const;
+    [[nodiscard]] wgpu::Buffer GetInput() const;
+    [[nodiscard]] wgpu::Buffer GetOutput() const;
+
+  private:
+    Layout mLayout;
+    gemm::TileConfig mConfig;
+    wgpu::Device mDevice {nullptr};
+    slang_compiler::SlangProgram mProgram;
+    compute_kernel::ComputeKernel mKernel;
+
+    std::optional<uniform_buffer::UniformBuffer> mUniforms;
+    std::optional<tensor_buffer::TensorBuffer> mInput;
+    std::optional<tensor_buffer::TensorBuffer> mWeight;
+    std::optional<tensor_buffer::TensorBuffer> mBias;
+    std::optional<tensor_buffer::TensorBuffer> mOutput;
+    size_t mParamsOffset = 0;
+    wgpu::BindGroup mBindGroup {nullptr};
+
+    Shape mShape {};
+    bool mInitialized = false;
+};
+
+/**
+ * @brief Converts activations between NHWC and NCHW with the tiled
+ * permutation kernel.
+ */
+class LayoutTransform
+{
+  public:
+    bool Initialize(wgpu::Device device,
+                    const slang_compiler::Compiler& compiler);
+
+    /**
+     * @brief Records the conversion of `src`, stored in layout `from`, into
+     * `dst` in the other layout.
+     * @param nchw Logical [N, C, H, W] size of the tensor.
+     * @return false if nothing was dispatched
+     */
+    bool Encode(wgpu::ComputePassEncoder pass,
+                Layout from,
+                wgpu::Buffer src,
+                wgpu::Buffer dst,
+                const std::array<int32_t, 4>& nchw) const;
+
+  private:
+    permute::Permuter mPermuter;
+    bool mInitialized = false;
+};
+
+}    // namespace conv2d
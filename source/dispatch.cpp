@@ -0,0 +1,115 @@
+#include <algorithm>
+
+#include "dispatch.hpp"
+
+#include "logging_macros.h"
+
+namespace dispatch
+{
+uint64_t WorkgroupsFor(uint64_t elementCount, uint32_t workgroupSize)
+{
+    if (workgroupSize == 0) {
+        return 0;
+    }
+    return (elementCount + workgroupSize - 1) / workgroupSize;
+}
+
+std::optional<Grid> FoldWorkgroups(uint64_t workgroupCount)
+{
+    constexpr uint64_t kWidth = kFoldWidth;
+    if (workgroupCount > kMaxLinearThreads) {
+        return std::nullopt;
+    }
+
+    Grid grid {};
+    if (workgroupCount <= kWidth) {
+        grid.x = static_cast<uint32_t>(std::max<uint64_t>(workgroupCount, 1));
+        return grid;
+    }
+
+    // Row-major folding: x is full, y covers the remaining rows and z is only
+    // used once y itself would overflow.
+    uint64_t rows = (workgroupCount + kWidth - 1) / kWidth;
+    grid.x = kFoldWidth;
+    if (rows <= kWidth) {
+        grid.y = static_cast<uint32_t>(rows);
+        return grid;
+    }
+    grid.y = kFoldWidth;
+    grid.z = static_cast<uint32_t>((rows + kWidth - 1) / kWidth);
+    return grid;
+}
+
+bool FitsLimits(const Grid& grid, const wgpu::Limits& limits)
+{
+    uint32_t maxDim = limits.maxComputeWorkgroupsPerDimension;
+    return grid.x <= maxDim && grid.y <= maxDim && grid.z <= maxDim;
+}
+
+bool DispatchLinear(wgpu::ComputePassEncoder pass,
+                    uint64_t workgroupCount,
+                    uint32_t workgroupSize)
+{
+    if (workgroupCount == 0 || workgroupSize == 0) {
+        return false;
+    }
+    if (workgroupCount > kMaxLinearThreads / workgroupSize) {
+        LOG_ERROR("{} workgroups of {} threads exceed the {} threads a "
+                  "linear launch can address",
+                  workgroupCount,
+                  workgroupSize,
+                  kMaxLinearThreads);
+        return false;
+    }
+    std::optional<Grid> grid = FoldWorkgroups(workgroupCount);
+    if (!grid) {
+        LOG_ERROR("Cannot fold {} workgroups into a single dispatch",
+                  workgroupCount);
+        return false;
+    }
+    pass.DispatchWorkgroups(grid->x, grid->y, grid->z);
+    return true;
+}
+
+bool Dispatch(wgpu::ComputePassEncoder pass,
+              const Grid& grid,
+              const wgpu::Limits& limits)
+{
+    if (!FitsLimits(grid, limits)) {
+        LOG_ERROR("Dispatch ({}, {}, {}) exceeds {} workgroups per dimension",
+                  grid.x,
+                  grid.y,
+                  grid.z,
+                  limits.maxComputeWorkgroupsPerDimension);
+        return false;
+    }
+    pass.DispatchWorkgroups(grid.x, grid.y, grid.z);
+    return true;
+}
+
+bool DispatchIndirect(wgpu::ComputePassEncoder pass,
+                      wgpu::Buffer args,
+                      uint64_t offset)
+{
+    if (!args
+        || (args.GetUsage() & wgpu::BufferUsage::Indirect)
+            == wgpu::BufferUsage::None)
+    {
+        LOG_ERROR("Indirect dispatch arguments need a buffer with Indirect "
+                  "usage");
+        return false;
+    }
+    if (offset % sizeof(uint32_t) != 0
+        || offset + kIndirectArgsSize > args.GetSize())
+    {
+        LOG_ERROR("Indirect dispatch record at {} does not fit a {}-byte "
+                  "buffer",
+                  offset,
+                  args.GetSize());
+        return false;
+    }
+    pass.DispatchWorkgroupsIndirect(args, offset);
+    return true;
+}
+
+}    // namespace dispatch
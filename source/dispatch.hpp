@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+#include <webgpu/webgpu_cpp.h>
+
+namespace dispatch
+{
+/// Width at which oversized 1-D launches are folded into the y and z
+/// dimensions. 65535 is the guaranteed minimum of
+/// maxComputeWorkgroupsPerDimension; mirrored by kDispatchFoldWidth in
+/// tensor.slang.
+inline constexpr uint32_t kFoldWidth = 65535;
+
+/// Largest number of threads a linear launch may address. Kernels index
+/// folded launches with 32-bit linearThreadIndex(), which saturates at this
+/// value so that the workgroups a fold adds past the end fail every bounds
+/// check instead of wrapping onto valid indices.
+inline constexpr uint64_t kMaxLinearThreads = UINT32_MAX;
+
+/// Bytes of one indirect dispatch record: the uint32 workgroup counts x, y
+/// and z, as read by DispatchWorkgroupsIndirect.
+inline constexpr uint64_t kIndirectArgsSize = 3 * sizeof(uint32_t);
+
+struct Grid
+{
+    uint32_t x = 1;
+    uint32_t y = 1;
+    uint32_t z = 1;
+};
+
+/**
+ * Number of workgroups needed to cover a number of elements.
+ * @param elementCount number of elements (threads) to launch
+ * @param workgroupSize number of threads per workgroup
+ */
+[[nodiscard]] uint64_t WorkgroupsFor(uint64_t elementCount,
+                                     uint32_t workgroupSize);
+
+/**
+ * Folds a linear workgroup count into a grid that respects kFoldWidth in every
+ * dimension. Kernels recover the linear index with linearGroupIndex().
+ * @param workgroupCount number of workgroups to launch
+ * @return the folded grid, or nullopt if the count exceeds
+ * kMaxLinearThreads, beyond which linearGroupIndex() cannot address it
+ */
+[[nodiscard]] std::optional<Grid> FoldWorkgroups(uint64_t workgroupCount);
+
+/**
+ * Checks a grid against the device's maxComputeWorkgroupsPerDimension.
+ */
+[[nodiscard]] bool FitsLimits(const Grid& grid, const wgpu::Limits& limits);
+
+/**
+ * Records a 1-D launch of `workgroupCount` workgroups, folded into a single
+ * 2-D/3-D dispatch when it exceeds kFoldWidth.
+ * @param workgroupSize threads per workgroup that the kernel indexes with
+ * linearThreadIndex(); 1 for kernels that only use linearGroupIndex()
+ * @return false if nothing was dispatched, e.g. because the launch has more
+ * than kMaxLinearThreads threads
+ */
+bool DispatchLinear(wgpu::ComputePassEncoder pass,
+                    uint64_t workgroupCount,
+                    uint32_t workgroupSize = 1);
+
+/**
+ * Records a dispatch of an explicit grid after validating it against the
+ * device limits.
+ * @return false if nothing was dispatched
+ */
+bool Dispatch(wgpu::ComputePassEncoder pass,
+              const Grid& grid,
+              const wgpu::Limits& limits);
+
+/**
+ * Records a dispatch whose grid a preceding kernel of the same command
+ * buffer wrote to `args` at `offset`, so that a data-dependent launch needs
+ * no readback. The grid is only known on the device: a zero count
+ * dispatches nothing, and so does one beyond the device limits.
+ * @return false if nothing was recorded: `args` lacks Indirect usage, or
+ * the record is misaligned or out of bounds
+ */
+bool DispatchIndirect(wgpu::ComputePassEncoder pass,
+                      wgpu::Buffer args,
+                      uint64_t offset = 0);
+
+}    // namespace dispatch
@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include "elementwise.hpp"
+
+#include <fmt/format.h>
+#include <tracy/Tracy.hpp>
+
+#include "dispatch.hpp"
+#include "logging_macros.h"
+
+namespace elementwise
+{
+namespace
+{
+/// Host mirror of ElementwiseParams in elementwise.slang.
+struct Params
+{
+    int32_t dims[kMaxRank];
+    int32_t op;
+    int32_t rows;
+    int32_t runsPerRow;
+};
+}    // namespace
+
+std::optional<std::vector<int32_t>> BroadcastShape(std::span<const int32_t> a,
+                                                   std::span<const int32_t> b)
+{
+    const size_t rank = std::max(a.size(), b.size());
+    std::vector<int32_t> dims(rank, 1);
+    for (size_t d = 0; d < rank; ++d) {
+        // Aligned on the innermost axis; missing leading axes act as 1.
+        const int32_t x = d < rank - a.size() ? 1 : a[d - (rank - a.size())];
+        const int32_t y = d < rank - b.size() ? 1 : b[d - (rank - b.size())];
+        if (x != y && x != 1 && y != 1) {
+            LOG_ERROR("Cannot broadcast axis {} of sizes {} and {}", d, x, y);
+            return std::nullopt;
+        }
+        dims[d] = x == 1 ? y : x;
+    }
+    return dims;
+}
+
+float Apply(BinaryOp op, float a, float b)
+{
+    switch (op) {
+        case BinaryOp::Subtract:
+            return a - b;
+        case BinaryOp::Multiply:
+            return a * b;
+        case BinaryOp::Divide:
+            return a / b;
+        case BinaryOp::Maximum:
+            return std::max(a, b);
+        case BinaryOp::Minimum:
+            return std::min(a, b);
+        case BinaryOp::Power:
+            return std::pow(a, b);
+        default:
+            return a + b;
+    }
+}
+
+std::vector<float> ReferenceBinary(BinaryOp op,
+                                   std::span<const int32_t> aDims,
+                                   std::span<const float> a,
+                                   std::span<const int32_t> bDims,
+                                   std::span<const float> b)
+{
+    auto dims = BroadcastShape(aDims, bDims);
+    if (!dims) {
+        return {};
+    }
+    using tensor_buffer::TensorView;
+    const auto aView = TensorView::Contiguous(aDims).Expand(*dims);
+    const auto bView = TensorView::Contiguous(bDims).Expand(*dims);
+    const auto outView = TensorView::Contiguous(*dims);
+
+    std::vector<float> out(static_cast<size_t>(outView.Count()));
+    for (size_t i = 0; i < out.size(); ++i) {
+        int32_t rest = static_cast<int32_t>(i);
+        int32_t aIndex = aView->offset;
+        int32_t bIndex = bView->offset;
+        for (size_t d = dims->size(); d-- > 0;) {
+            const int32_t index = rest % (*dims)[d];
+            rest /= (*dims)[d];
+            aIndex += index * aView->strides[d];
+            bIndex += index * bView->strides[d];
+        }
+        out[i] = Apply(op,
+                       a[static_cast<size_t>(aIndex)],
+                       b[static_cast<size_t>(bIndex)]);
+    }
+    return out;
+}
+
+bool Engine::Initialize(wgpu::Device device,
+                        const slang_compiler::Compiler& compiler)
+{
+    ZoneScoped;
+    if (mInitialized) {
+        return true;
+    }
+    mDevice = device;
+    for (size_t rank = 1; rank <= kMaxRank; ++rank) {
+        if (!InitializeKernel(compiler, rank, false, mKernels[rank - 1])
+            || !InitializeKernel(
+                compiler, rank, true, mVectorKernels[rank - 1]))
+        {
+            return false;
+        }
+    }
+    mInitialized = true;
+    return true;
+}
+
+bool Engine::InitializeKernel(const slang_compiler::Compiler& compiler,
+                              size_t rank,
+                              bool vec4,
+                              Kernel& kernel) const
+{
+    const std::string source = fmt::format(
+        "#define ELEMENTWISE_RANK {}\n"
+        "#define ELEMENTWISE_VEC4 {}\n"
+        "#include \"elementwise.slang\"\n",
+        rank,
+        vec4 ? 1 : 0);
+    kernel.program = compiler.CompileFromSource(
+        source,
+        fmt::format("elementwise_{}rank{}", vec4 ? "vec4_" : "", rank),
+        "binary");
+    if (!kernel.program.program) {
+        return false;
+    }
+
+    auto* program = kernel.program.program.get();
+    auto uniformsInfo = uniform_buffer::ReflectUniformBuffer(program);
+    auto paramsOffset = uniform_buffer::ReflectUniformOffset(program, "params");
+    auto a = tensor_reflection::ReflectTensorBuffer(program, "a");
+    auto b = tensor_reflection::ReflectTensorBuffer(program, "b");
+    auto output = tensor_reflection::ReflectTensorBuffer(program, "output");
+    if (!uniformsInfo || !paramsOffset || !a || !b || !output) {
+        LOG_ERROR("elementwise.slang is missing parameters for rank {}",
+                  rank);
+        return false;
+    }
+    kernel.uniforms = *uniformsInfo;
+    kernel.paramsOffset = *paramsOffset;
+    kernel.a = *a;
+    kernel.b = *b;
+    kernel.output = *output;
+
+    // The layout only depends on the reflection.
+    uniform_buffer::UniformBuffer uniforms(kernel.uniforms);
+    tensor_buffer::TensorBuffer aBuffer(kernel.a);
+    tensor_buffer::TensorBuffer bBuffer(kernel.b);
+    tensor_buffer::TensorBuffer outBuffer(kernel.output);
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms).Add(aBuffer).Add(bBuffer).Add(outBuffer);
+    return kernel.kernel.Initialize(mDevice,
+                                    kernel.program.compileToWGSL(),
+                                    "binary",
+                                    bindings.GetLayoutEntries());
+}
+
+bool Engine::Encode(wgpu::ComputePassEncoder pass,
+                    BinaryOp op,
+                    const tensor_buffer::BufferView& a,
+                    const tensor_buffer::BufferView& b,
+                    wgpu::Buffer output) const
+{
+    ZoneScoped;
+    if (!mInitialized) {
+        LOG_ERROR("Engine::Encode called before Initialize");
+        return false;
+    }
+    auto dims = BroadcastShape(a.view.dims, b.view.dims);
+    if (!dims) {
+        return false;
+    }
+    // Scalars are evaluated as one-element vectors.
+    if (dims->empty()) {
+        dims->push_back(1);
+    }
+    if (dims->size() > kMaxRank) {
+        LOG_ERROR("Elementwise operations support up to {} dimensions, got {}",
+                  kMaxRank,
+                  dims->size());
+        return false;
+    }
+    auto aView = a.view.Expand(*dims);
+    auto bView = b.view.Expand(*dims);
+    if (!aView || !bView) {
+        return false;
+    }
+    const auto outView = tensor_buffer::TensorView::Contiguous(*dims);
+    const int32_t count = outView.Count();
+    if (count == 0) {
+        return true;
+    }
+
+    // Vector bindings cover whole 16-byte words. Every thread must also own
+    // whole output words: writing a component of a vec4 word may rewrite the
+    // others, so runs of two rows must not share one.
+    const int32_t inner = dims->back();
+    const bool vec4 = inner % kVectorWidth == 0
+        && a.buffer.GetSize() % tensor_buffer::kStorageAlignment == 0
+        && b.buffer.GetSize() % tensor_buffer::kStorageAlignment == 0
+        && output.GetSize() % tensor_buffer::kStorageAlignment == 0;
+    const Kernel& kernel =
+        (vec4 ? mVectorKernels : mKernels)[dims->size() - 1];
+    wgpu::Queue queue = mDevice.GetQueue();
+    uniform_buffer::UniformBuffer uniforms(kernel.uniforms);
+    uniforms.Initialize(mDevice);
+    tensor_buffer::TensorBuffer aBuffer(kernel.a);
+    tensor_buffer::TensorBuffer bBuffer(kernel.b);
+    tensor_buffer::TensorBuffer outBuffer(kernel.output);
+    aBuffer.Initialize(uniforms, a.buffer, a.buffer.GetSize());
+    bBuffer.Initialize(uniforms, b.buffer, b.buffer.GetSize());
+    outBuffer.Initialize(uniforms, output, output.GetSize());
+    aBuffer.WriteShape(queue, *aView);
+    bBuffer.WriteShape(queue, *bView);
+    outBuffer.WriteShape(queue, outView);
+
+    Params params {
+        .dims = {1, 1, 1, 1},
+        .op = static_cast<int32_t>(op),
+        .rows = count / inner,
+        .runsPerRow = (inner + kVectorWidth - 1) / kVectorWidth,
+    };
+    std::copy(dims->begin(), dims->end(), params.dims);
+    uniforms.Write(queue, kernel.paramsOffset, params);
+
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms).Add(aBuffer).Add(bBuffer).Add(outBuffer);
+    pass.SetPipeline(kernel.kernel.GetPipeline());
+    pass.SetBindGroup(0, kernel.kernel.CreateBindGroup(bindings.GetEntries()));
+
+    const uint64_t threads = static_cast<uint64_t>(params.rows)
+        * static_cast<uint64_t>(params.runsPerRow);
+    return dispatch::DispatchLinear(
+        pass, dispatch::WorkgroupsFor(threads, kGroupSize), kGroupSize);
+}
+
+}    // namespace elementwise
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <webgpu/webgpu_cpp.h>
+
+#include "compute_kernel.hpp"
+#include "slang_compiler.hpp"
+#include "tensor_buffer.hpp"
+#include "tensor_reflection.hpp"
+#include "uniform_buffer.hpp"
+
+namespace elementwise
+{
+/// Workgroup size, innermost elements per thread and highest specialized
+/// rank; mirror elementwise.slang.
+inline constexpr uint32_t kGroupSize = 256;
+inline constexpr int32_t kVectorWidth = 4;
+inline constexpr size_t kMaxRank = 4;
+
+enum class BinaryOp
+{
+    Add,
+    Subtract,
+    Multiply,
+    Divide,
+    Maximum,
+    Minimum,
+    Power,
+};
+
+/**
+ * @brief Broadcast output shape of two operands, following NumPy: shapes
+ * are aligned on their innermost axis and each pair of sizes must match or
+ * contain a 1.
+ * @return the output dimensions, or nullopt if the shapes are incompatible
+ */
+[[nodiscard]] std::optional<std::vector<int32_t>> BroadcastShape(
+    std::span<const int32_t> a, std::span<const int32_t> b);
+
+/// CPU evaluation of one operator.
+[[nodiscard]] float Apply(BinaryOp op, float a, float b);
+
+/// CPU reference of a broadcast binary operation on row-major operands.
+[[nodiscard]] std::vector<float> ReferenceBinary(BinaryOp op,
+                                                 std::span<const int32_t> aDims,
+                                                 std::span<const float> a,
+                                                 std::span<const int32_t> bDims,
+                                                 std::span<const float> b);
+
+/**
+ * @brief Broadcasting binary elementwise operations.
+ *
+ * Operands are bound with views expanded to the output shape, so broadcast
+ * axes are read with stride 0 and never materialized. One kernel is
+ * compiled per rank from 1 to kMaxRank; each thread evaluates a run of
+ * kVectorWidth consecutive innermost elements after unravelling the output
+ * index once. When the innermost output dimension is a multiple of
+ * kVectorWidth and every bound buffer is a multiple of
+ * tensor_buffer::kStorageAlignment bytes, as library allocations are, a
+ * second set of kernels moves full runs as 128-bit vectors.
+ */
+class Engine
+{
+  public:
+    /// Compiles the per-rank specializations.
+    bool Initialize(wgpu::Device device,
+                    const slang_compiler::Compiler& compiler);
+
+    /**
+     * @brief Records `output = op(a, b)` into `pass`.
+     * @param output Storage buffer receiving the contiguous result, of at
+     * least Count(BroadcastShape(a, b)) floats. It must not alias `a` or
+     * `b`, since writable bindings of a dispatch may not overlap.
+     * @return false if the shapes do not broadcast or the rank exceeds
+     * kMaxRank
+     */
+    [[nodiscard]] bool Encode(wgpu::ComputePassEncoder pass,
+                              BinaryOp op,
+                              const tensor_buffer::BufferView& a,
+                              const tensor_buffer::BufferView& b,
+                              wgpu::Buffer output) const;
+
+  private:
+    struct Kernel
+    {
+        slang_compiler::SlangProgram program;
+        compute_kernel::ComputeKernel kernel;
+        uniform_buffer::UniformBufferReflection uniforms;
+        size_t paramsOffset = 0;
+        tensor_reflection::TensorBufferReflection a;
+        tensor_reflection::TensorBufferReflection b;
+        tensor_reflection::TensorBufferReflection output;
+    };
+
+    bool InitializeKernel(const slang_compiler::Compiler& compiler,
+                          size_t rank,
+                          bool vec4,
+                          Kernel& kernel) const;
+
+    wgpu::Device mDevice {nullptr};
+    std::array<Kernel, kMaxRank> mKernels;
+    std::array<Kernel, kMaxRank> mVectorKernels;
+    bool mInitialized = false;
+};
+
+}    // namespace elementwise
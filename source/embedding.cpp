@@ -0,0 +1,408 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+
+#include "embedding.hpp"
+
+#include <tracy/Tracy.hpp>
+
+#include "dispatch.hpp"
+#include "logging_macros.h"
+#include "tensor_buffer.hpp"
+
+namespace embedding
+{
+namespace
+{
+/// Host mirror of EmbeddingParams in embedding.slang.
+struct Params
+{
+    int32_t count;
+    int32_t rows;
+    int32_t dim;
+};
+
+size_t ChunkLength(const Table& table, size_t chunk)
+{
+    const size_t elements =
+        static_cast<size_t>(table.rows) * static_cast<size_t>(table.dim);
+    const size_t first = chunk * table.chunkElements;
+    return chunk < table.chunkCount
+        ? std::min<size_t>(table.chunkElements, elements - first)
+        : 0;
+}
+}    // namespace
+
+std::array<wgpu::Buffer, tensor_reflection::kMaxTensorChunks> Table::Buffers()
+    const
+{
+    std::array<wgpu::Buffer, tensor_reflection::kMaxTensorChunks> buffers;
+    for (size_t c = 0; c < buffers.size(); ++c) {
+        buffers[c] = chunks[c].Get();
+    }
+    return buffers;
+}
+
+std::optional<Table> CreateTable(wgpu::Device device,
+                                 int32_t rows,
+                                 int32_t dim,
+                                 size_t maxChunkBytes)
+{
+    ZoneScoped;
+    if (rows <= 0 || dim <= 0) {
+        LOG_ERROR("Invalid embedding table of [{}, {}]", rows, dim);
+        return std::nullopt;
+    }
+    wgpu::Limits limits {};
+    device.GetLimits(&limits);
+    const auto deviceMax = static_cast<size_t>(
+        std::min(limits.maxStorageBufferBindingSize, limits.maxBufferSize));
+    const size_t chunkBytes =
+        maxChunkBytes == 0 ? deviceMax : std::min(maxChunkBytes, deviceMax);
+    const size_t chunkElements =
+        std::min<size_t>(chunkBytes / sizeof(float), UINT32_MAX);
+    const size_t elements =
+        static_cast<size_t>(rows) * static_cast<size_t>(dim);
+    if (elements > tensor_reflection::kMaxChunkedElements) {
+        LOG_ERROR("Embedding table of [{}, {}] exceeds the 32-bit index "
+                  "limit of {} elements",
+                  rows,
+                  dim,
+                  tensor_reflection::kMaxChunkedElements);
+        return std::nullopt;
+    }
+    if (chunkElements == 0
+        || elements > chunkElements * tensor_reflection::kMaxTensorChunks)
+    {
+        LOG_ERROR("Embedding table of [{}, {}] does not fit in {} chunks of "
+                  "{} bytes",
+                  rows,
+                  dim,
+                  tensor_reflection::kMaxTensorChunks,
+                  chunkBytes);
+        return std::nullopt;
+    }
+
+    Table table;
+    table.rows = rows;
+    table.dim = dim;
+    table.chunkElements = static_cast<uint32_t>(chunkElements);
+    table.chunkCount = (elements + chunkElements - 1) / chunkElements;
+    for (size_t c = 0; c < table.chunks.size(); ++c) {
+        // Unused chunks get their own small buffer, so that no two
+        // writable bindings alias.
+        wgpu::BufferDescriptor desc = {
+            .label = c < table.chunkCount ? "embedding_chunk"
+                                          : "embedding_chunk_unused",
+            .usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst
+                | wgpu::BufferUsage::CopySrc,
+            .size = std::max<size_t>(1, ChunkLength(table, c)) * sizeof(float),
+            .mappedAtCreation = false,
+        };
+        table.chunks[c] = gpu_memory::CreateBuffer(device, desc);
+    }
+    return table;
+}
+
+void WriteTable(wgpu::Queue queue,
+                const Table& table,
+                std::span<const float> values)
+{
+    for (size_t c = 0; c < table.chunkCount; ++c) {
+        const size_t first = c * table.chunkElements;
+        if (first >= values.size()) {
+            break;
+        }
+        const size_t length =
+            std::min(ChunkLength(table, c), values.size() - first);
+        queue.WriteBuffer(table.chunks[c].Get(),
+                          0,
+                          values.data() + first,
+                          length * sizeof(float));
+    }
+}
+
+std::vector<float> ReadTable(wgpu::Instance instance,
+                             wgpu::Device device,
+                             const Table& table)
+{
+    std::vector<float> values;
+    values.reserve(static_cast<size_t>(table.rows)
+                   * static_cast<size_t>(table.dim));
+    for (size_t c = 0; c < table.chunkCount; ++c) {
+        const std::vector<float> chunk = compute_kernel::ReadBuffer<float>(
+            instance, device, table.chunks[c].Get(), ChunkLength(table, c));
+        values.insert(values.end(), chunk.begin(), chunk.end());
+    }
+    return values;
+}
+
+void ReferenceGather(std::span<const float> table,
+                     int32_t rows,
+                     int32_t dim,
+                     std::span<const int32_t> indices,
+                     std::span<float> values)
+{
+    const auto width = static_cast<size_t>(dim);
+    for (size_t i = 0; i < indices.size(); ++i) {
+        const int32_t row = indices[i];
+        for (size_t d = 0; d < width; ++d) {
+            values[i * width + d] = row >= 0 && row < rows
+                ? table[static_cast<size_t>(row) * width + d]
+                : 0.0f;
+        }
+    }
+}
+
+void ReferenceScatterAdd(std::span<float> table,
+                         int32_t rows,
+                         int32_t dim,
+                         std::span<const int32_t> indices,
+                         std::span<const float> values)
+{
+    const auto width = static_cast<size_t>(dim);
+    for (size_t i = 0; i < indices.size(); ++i) {
+        const int32_t row = indices[i];
+        if (row < 0 || row >= rows) {
+            continue;
+        }
+        for (size_t d = 0; d < width; ++d) {
+            table[static_cast<size_t>(row) * width + d] +=
+                values[i * width + d];
+        }
+    }
+}
+
+Embedding::Embedding(std::optional<subgroups::Path> path)
+    : mSorter(path)
+{
+}
+
+bool Embedding::Initialize(wgpu::Device device,
+                           const slang_compiler::Compiler& compiler)
+{
+    ZoneScoped;
+    if (mInitialized) {
+        return true;
+    }
+    mDevice = device;
+    // Separate buffers, so that no two writable bindings alias.
+    wgpu::BufferDescriptor desc = {
+        .label = "embedding_unused",
+        .usage = wgpu::BufferUsage::Storage,
+        .size = sizeof(uint32_t),
+        .mappedAtCreation = false,
+    };
+    mUnusedKeys = gpu_memory::CreateBuffer(device, desc);
+    mUnusedOrder = gpu_memory::CreateBuffer(device, desc);
+
+    if (!mSorter.Initialize(device, compiler)
+        || !InitializeKernel(compiler, "embeddingGather", mGather)
+        || !InitializeKernel(
+            compiler, "embeddingScatterAtomic", mScatterAtomic)
+        || !InitializeKernel(compiler, "embeddingKeys", mKeys)
+        || !InitializeKernel(
+            compiler, "embeddingScatterSegments", mScatterSegments))
+    {
+        return false;
+    }
+    mInitialized = true;
+    return true;
+}
+
+bool Embedding::InitializeKernel(const slang_compiler::Compiler& compiler,
+                                 const char* entryPoint,
+                                 Kernel& kernel) const
+{
+    kernel.program = compiler.CreateProgram("embedding", entryPoint);
+    if (!kernel.program.program) {
+        return false;
+    }
+
+    auto* program = kernel.program.program.get();
+    auto uniformsInfo = uniform_buffer::ReflectUniformBuffer(program);
+    auto paramsOffset = uniform_buffer::ReflectUniformOffset(program, "params");
+    auto table =
+        tensor_reflection::ReflectChunkedTensorBuffer(program, "table");
+    auto indices = tensor_reflection::ReflectTensorBuffer(program, "indices");
+    auto values = tensor_reflection::ReflectTensorBuffer(program, "values");
+    auto keys = tensor_reflection::ReflectTensorBuffer(program, "keys");
+    auto order = tensor_reflection::ReflectTensorBuffer(program, "order");
+    if (!uniformsInfo || !paramsOffset || !table || !indices || !values
+        || !keys || !order)
+    {
+        LOG_ERROR("embedding.slang is missing parameters of {}", entryPoint);
+        return false;
+    }
+    kernel.uniforms = *uniformsInfo;
+    kernel.paramsOffset = *paramsOffset;
+    kernel.table = *table;
+    kernel.indices = *indices;
+    kernel.values = *values;
+    kernel.keys = *keys;
+    kernel.order = *order;
+
+    uniform_buffer::UniformBuffer uniforms(kernel.uniforms);
+    tensor_buffer::ChunkedTensorBuffer tableBuffer(kernel.table);
+    tensor_buffer::TensorBuffer indicesBuffer(kernel.indices);
+    tensor_buffer::TensorBuffer valuesBuffer(kernel.values);
+    tensor_buffer::TensorBuffer keysBuffer(kernel.keys);
+    tensor_buffer::TensorBuffer orderBuffer(kernel.order);
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms)
+        .Add(tableBuffer)
+        .Add(indicesBuffer)
+        .Add(valuesBuffer)
+        .Add(keysBuffer)
+        .Add(orderBuffer);
+    kernel.kernel = compute_kernel::ComputeKernel(entryPoint);
+    return kernel.kernel.Initialize(mDevice,
+                                    kernel.program.compileToWGSL(),
+                                    entryPoint,
+                                    bindings.GetLayoutEntries());
+}
+
+bool Embedding::Validate(const Table& table, int32_t count) const
+{
+    if (!mInitialized) {
+        LOG_ERROR("Embedding used before Initialize");
+        return false;
+    }
+    if (count <= 0 || table.rows <= 0 || table.dim <= 0) {
+        LOG_ERROR("Invalid lookup of {} rows from a [{}, {}] table",
+                  count,
+                  table.rows,
+                  table.dim);
+        return false;
+    }
+    return true;
+}
+
+bool Embedding::EncodeGather(wgpu::ComputePassEncoder pass,
+                             const Table& table,
+                             wgpu::Buffer indices,
+                             int32_t count,
+                             wgpu::Buffer values) const
+{
+    ZoneScoped;
+    if (!Validate(table, count)) {
+        return false;
+    }
+    Step step;
+    step.table = &table;
+    step.indices = indices;
+    step.values = values;
+    step.keys = mUnusedKeys.Get();
+    step.order = mUnusedOrder.Get();
+    step.count = count;
+    return EncodeKernel(pass,
+                        mGather,
+                        step,
+                        static_cast<uint64_t>(count)
+                            * static_cast<uint64_t>(table.dim));
+}
+
+bool Embedding::EncodeScatterAdd(wgpu::ComputePassEncoder pass,
+                                 const Table& table,
+                                 wgpu::Buffer indices,
+                                 int32_t count,
+                                 wgpu::Buffer values,
+                                 Scatter scatter) const
+{
+    ZoneScoped;
+    if (!Validate(table, count)) {
+        return false;
+    }
+    const uint64_t elements =
+        static_cast<uint64_t>(count) * static_cast<uint64_t>(table.dim);
+    Step step;
+    step.table = &table;
+    step.indices = indices;
+    step.values = values;
+    step.keys = mUnusedKeys.Get();
+    step.order = mUnusedOrder.Get();
+    step.count = count;
+    if (scatter == Scatter::Atomic) {
+        return EncodeKernel(pass, mScatterAtomic, step, elements);
+    }
+
+    // The recorded bind groups keep the keys and order alive until the
+    // pass has executed.
+    wgpu::BufferDescriptor desc = {
+        .label = "embedding_segments",
+        .usage = wgpu::BufferUsage::Storage,
+        .size = tensor_buffer::PaddedBytes(static_cast<size_t>(count)
+                                           * sizeof(uint32_t)),
+        .mappedAtCreation = false,
+    };
+    gpu_memory::TrackedBuffer keys = gpu_memory::CreateBuffer(mDevice, desc);
+    gpu_memory::TrackedBuffer order = gpu_memory::CreateBuffer(mDevice, desc);
+    step.keys = keys.Get();
+    step.order = order.Get();
+    // Keys are at most `rows`, which marks the skipped indices.
+    const auto keyBits = static_cast<uint32_t>(
+        std::bit_width(static_cast<uint32_t>(table.rows)));
+    return EncodeKernel(pass, mKeys, step, static_cast<uint64_t>(count))
+        && mSorter.Encode(pass,
+                          keys.Get(),
+                          order.Get(),
+                          keys.Get(),
+                          order.Get(),
+                          static_cast<uint32_t>(count),
+                          radix_sort::KeyType::Uint,
+                          radix_sort::Order::Ascending,
+                          keyBits)
+        && EncodeKernel(pass, mScatterSegments, step, elements);
+}
+
+bool Embedding::EncodeKernel(wgpu::ComputePassEncoder pass,
+                             const Kernel& kernel,
+                             const Step& step,
+                             uint64_t threads) const
+{
+    const Table& table = *step.table;
+    const std::array<int32_t, 2> tableDims = {table.rows, table.dim};
+    const std::array<int32_t, 1> flat = {step.count};
+    const std::array<int32_t, 2> valuesDims = {step.count, table.dim};
+
+    wgpu::Queue queue = mDevice.GetQueue();
+    uniform_buffer::UniformBuffer uniforms(kernel.uniforms);
+    uniforms.Initialize(mDevice);
+    tensor_buffer::ChunkedTensorBuffer tableBuffer(kernel.table);
+    tensor_buffer::TensorBuffer indices(kernel.indices);
+    tensor_buffer::TensorBuffer values(kernel.values);
+    tensor_buffer::TensorBuffer keys(kernel.keys);
+    tensor_buffer::TensorBuffer order(kernel.order);
+    const auto chunks = table.Buffers();
+    if (!tableBuffer.Initialize(
+            uniforms, chunks, table.chunkElements, sizeof(float)))
+    {
+        return false;
+    }
+    indices.Initialize(uniforms, step.indices, step.indices.GetSize());
+    values.Initialize(uniforms, step.values, step.values.GetSize());
+    keys.Initialize(uniforms, step.keys, step.keys.GetSize());
+    order.Initialize(uniforms, step.order, step.order.GetSize());
+    tableBuffer.WriteShape(queue, tableDims);
+    indices.WriteShape(queue, flat);
+    values.WriteShape(queue, valuesDims);
+    keys.WriteShape(queue, flat);
+    order.WriteShape(queue, flat);
+    const Params params {
+        .count = step.count, .rows = table.rows, .dim = table.dim};
+    uniforms.Write(queue, kernel.paramsOffset, params);
+
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms)
+        .Add(tableBuffer)
+        .Add(indices)
+        .Add(values)
+        .Add(keys)
+        .Add(order);
+    pass.SetPipeline(kernel.kernel.GetPipeline());
+    pass.SetBindGroup(0, kernel.kernel.CreateBindGroup(bindings.GetEntries()));
+    return dispatch::DispatchLinear(
+        pass, dispatch::WorkgroupsFor(threads, kGroupSize), kGroupSize);
+}
+
+}    // namespace embedding
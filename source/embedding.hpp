@@ -0,0 +1,187 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <webgpu/webgpu_cpp.h>
+
+#include "compute_kernel.hpp"
+#include "gpu_memory.hpp"
+#include "radix_sort.hpp"
+#include "slang_compiler.hpp"
+#include "subgroups.hpp"
+#include "tensor_reflection.hpp"
+#include "uniform_buffer.hpp"
+
+namespace embedding
+{
+/// Workgroup size of the embedding.slang kernels.
+inline constexpr uint32_t kGroupSize = 256;
+
+/**
+ * @brief A [rows, dim] f32 embedding table resident on a device.
+ *
+ * The table is spread over up to tensor_reflection::kMaxTensorChunks
+ * storage buffers, so that it may exceed maxStorageBufferBindingSize, and
+ * holds at most tensor_reflection::kMaxChunkedElements elements.
+ * Chunk c holds the row-major elements [c * chunkElements, (c + 1) *
+ * chunkElements); the chunks past chunkCount are small placeholders.
+ */
+struct Table
+{
+    int32_t rows = 0;
+    int32_t dim = 0;
+    uint32_t chunkElements = 0;
+    size_t chunkCount = 0;
+    std::array<gpu_memory::TrackedBuffer, tensor_reflection::kMaxTensorChunks>
+        chunks {};
+
+    /// The chunk buffers, placeholders included, for binding.
+    [[nodiscard]] std::array<wgpu::Buffer, tensor_reflection::kMaxTensorChunks>
+    Buffers() const;
+};
+
+/**
+ * @brief Allocates a zeroed table.
+ * @param maxChunkBytes Upper bound on the size of a chunk, 0 to use the
+ * device's maxStorageBufferBindingSize and maxBufferSize.
+ * @return nullopt if the shape is empty or the table needs more than
+ * kMaxTensorChunks chunks
+ */
+[[nodiscard]] std::optional<Table> CreateTable(wgpu::Device device,
+                                               int32_t rows,
+                                               int32_t dim,
+                                               size_t maxChunkBytes = 0);
+
+/// Uploads row-major [rows, dim] values.
+void WriteTable(wgpu::Queue queue,
+                const Table& table,
+                std::span<const float> values);
+
+/// Reads the whole table back in row-major order.
+[[nodiscard]] std::vector<float> ReadTable(wgpu::Instance instance,
+                                           wgpu::Device device,
+                                           const Table& table);
+
+/// CPU reference of Embedding::EncodeGather.
+void ReferenceGather(std::span<const float> table,
+                     int32_t rows,
+                     int32_t dim,
+                     std::span<const int32_t> indices,
+                     std::span<float> values);
+
+/// CPU reference of Embedding::EncodeScatterAdd.
+void ReferenceScatterAdd(std::span<float> table,
+                         int32_t rows,
+                         int32_t dim,
+                         std::span<const int32_t> indices,
+                         std::span<const float> values);
+
+/// How EncodeScatterAdd resolves repeated indices.
+enum class Scatter
+{
+    /// Sorts the indices and adds every segment of repeats with one thread
+    /// per column. Deterministic, and frequent indices cost no contention.
+    SortedSegments,
+    /// One compare-and-swap loop per element and no sort; the cheaper
+    /// choice when few indices repeat. The order of the additions, and so
+    /// the rounding, varies between runs.
+    Atomic,
+};
+
+/**
+ * @brief Token embedding lookups and their gradient scatter, without host
+ * round trips.
+ *
+ * Indices are int32 rows of the table; indices outside [0, rows) gather
+ * zeros and are skipped by the scatter-add.
+ */
+class Embedding
+{
+  public:
+    /// `path` overrides subgroups::Select() for the sort of the
+    /// sorted-segment scatter.
+    explicit Embedding(std::optional<subgroups::Path> path = std::nullopt);
+
+    bool Initialize(wgpu::Device device,
+                    const slang_compiler::Compiler& compiler);
+
+    /**
+     * @brief Records values[i, :] = table[indices[i], :] for i < count
+     * into `pass`.
+     * @param values Buffer holding the contiguous f32 [count, dim] output.
+     * @return false if `count` is not positive or the table is empty
+     */
+    [[nodiscard]] bool EncodeGather(wgpu::ComputePassEncoder pass,
+                                    const Table& table,
+                                    wgpu::Buffer indices,
+                                    int32_t count,
+                                    wgpu::Buffer values) const;
+
+    /**
+     * @brief Records table[indices[i], :] += values[i, :] for i < count
+     * into `pass`, e.g. to accumulate the gradient of a lookup.
+     * @param values Buffer holding the contiguous f32 [count, dim] input.
+     * @return false if `count` is not positive or the table is empty
+     */
+    [[nodiscard]] bool EncodeScatterAdd(
+        wgpu::ComputePassEncoder pass,
+        const Table& table,
+        wgpu::Buffer indices,
+        int32_t count,
+        wgpu::Buffer values,
+        Scatter scatter = Scatter::SortedSegments) const;
+
+  private:
+    struct Kernel
+    {
+        slang_compiler::SlangProgram program;
+        compute_kernel::ComputeKernel kernel;
+        uniform_buffer::UniformBufferReflection uniforms;
+        size_t paramsOffset = 0;
+        tensor_reflection::ChunkedTensorBufferReflection table;
+        tensor_reflection::TensorBufferReflection indices;
+        tensor_reflection::TensorBufferReflection values;
+        tensor_reflection::TensorBufferReflection keys;
+        tensor_reflection::TensorBufferReflection order;
+    };
+
+    /// Buffers and shape of one dispatch.
+    struct Step
+    {
+        const Table* table = nullptr;
+        wgpu::Buffer indices;
+        wgpu::Buffer values;
+        wgpu::Buffer keys;
+        wgpu::Buffer order;
+        int32_t count = 0;
+    };
+
+    bool InitializeKernel(const slang_compiler::Compiler& compiler,
+                          const char* entryPoint,
+                          Kernel& kernel) const;
+
+    [[nodiscard]] bool Validate(const Table& table, int32_t count) const;
+
+    [[nodiscard]] bool EncodeKernel(wgpu::ComputePassEncoder pass,
+                                    const Kernel& kernel,
+                                    const Step& step,
+                                    uint64_t threads) const;
+
+    wgpu::Device mDevice {nullptr};
+    radix_sort::Sorter mSorter;
+    Kernel mGather;
+    Kernel mScatterAtomic;
+    Kernel mKeys;
+    Kernel mScatterSegments;
+    // Bound as the keys and order of the kernels that do not use them.
+    gpu_memory::TrackedBuffer mUnusedKeys;
+    gpu_memory::TrackedBuffer mUnusedOrder;
+    bool mInitialized = false;
+};
+
+}    // namespace embedding
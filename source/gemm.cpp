@@ -0,0 +1,458 @@
+#include <array>
+#include <cmath>
+#include <memory>
+
+#include "gemm.hpp"
+
+#include <fmt/format.h>
+#include <tracy/Tracy.hpp>
+
+#include "logging_macros.h"
+#include "tensor_reflection.hpp"
+
+namespace gemm
+{
+namespace
+{
+/// Host mirror of GemmParams in gemm.slang; scalars pack tightly in std140.
+struct Params
+{
+    int32_t m;
+    int32_t n;
+    int32_t k;
+    float alpha;
+    float beta;
+};
+
+size_t ByteSize(int32_t rows, int32_t cols)
+{
+    return static_cast<size_t>(rows) * static_cast<size_t>(cols)
+        * sizeof(float);
+}
+}    // namespace
+
+bool TransposesA(Variant variant)
+{
+    return variant == Variant::TN || variant == Variant::TT;
+}
+
+bool TransposesB(Variant variant)
+{
+    return variant == Variant::NT || variant == Variant::TT;
+}
+
+const char* EntryPoint(Variant variant)
+{
+    switch (variant) {
+        case Variant::NT:
+            return "gemmNT";
+        case Variant::TN:
+            return "gemmTN";
+        case Variant::TT:
+            return "gemmTT";
+        default:
+            return "gemmNN";
+    }
+}
+
+dispatch::Grid Workgroups(const Shape& shape, const TileConfig& config)
+{
+    const uint32_t tileM = config.TileM();
+    const uint32_t tileN = config.TileN();
+    return {
+        .x = (static_cast<uint32_t>(shape.n) + tileN - 1) / tileN,
+        .y = (static_cast<uint32_t>(shape.m) + tileM - 1) / tileM,
+    };
+}
+
+std::string ProgramSource(const TileConfig& config,
+                          std::string_view entryFile,
+                          subgroups::Path path)
+{
+    return fmt::format(
+        "#define GEMM_THREADS_X {}\n"
+        "#define GEMM_THREADS_Y {}\n"
+        "#define GEMM_TILE_K {}\n"
+        "#define GEMM_SUBGROUPS {}\n"
+        "#include \"{}\"\n",
+        config.threadsX,
+        config.threadsY,
+        config.tileK,
+        path == subgroups::Path::Subgroups ? 1 : 0,
+        entryFile);
+}
+
+std::optional<subgroups::Path> SelectPath(
+    wgpu::Device device,
+    const TileConfig& config,
+    std::optional<subgroups::Path> requested)
+{
+    // A thread row shares its A values within one subgroup.
+    return subgroups::Select(subgroups::Query(device),
+                             requested,
+                             config.threadsX * config.threadsY,
+                             config.threadsX);
+}
+
+std::vector<TileConfig> Candidates(const wgpu::Limits& limits)
+{
+    std::vector<TileConfig> candidates;
+    for (uint32_t threadsX : {8u, 16u, 32u}) {
+        for (uint32_t threadsY : {4u, 8u, 16u, 32u}) {
+            for (uint32_t tileK : {8u, 16u, 32u}) {
+                TileConfig config {
+                    .threadsX = threadsX,
+                    .threadsY = threadsY,
+                    .tileK = tileK,
+                };
+                if (threadsX * threadsY
+                        <= limits.maxComputeInvocationsPerWorkgroup
+                    && threadsX <= limits.maxComputeWorkgroupSizeX
+                    && threadsY <= limits.maxComputeWorkgroupSizeY
+                    && config.SharedBytes()
+                        <= limits.maxComputeWorkgroupStorageSize)
+                {
+                    candidates.push_back(config);
+                }
+            }
+        }
+    }
+    return candidates;
+}
+
+autotune::Config ToConfig(const TileConfig& config)
+{
+    return {
+        {"threads_x", static_cast<int32_t>(config.threadsX)},
+        {"threads_y", static_cast<int32_t>(config.threadsY)},
+        {"tile_k", static_cast<int32_t>(config.tileK)},
+    };
+}
+
+std::optional<TileConfig> FromConfig(const autotune::Config& config)
+{
+    auto get = [&config](const char* name) -> uint32_t
+    {
+        auto it = config.find(name);
+        return it == config.end() || it->second <= 0
+            ? 0
+            : static_cast<uint32_t>(it->second);
+    };
+    TileConfig tile {
+        .threadsX = get("threads_x"),
+        .threadsY = get("threads_y"),
+        .tileK = get("tile_k"),
+    };
+    if (tile.threadsX == 0 || tile.threadsY == 0 || tile.tileK == 0) {
+        return std::nullopt;
+    }
+    return tile;
+}
+
+autotune::Key TuningKey(Variant variant,
+                        const Shape& shape,
+                        const std::string& adapterKey)
+{
+    const std::array<int64_t, 3> dims = {shape.m, shape.n, shape.k};
+    return {
+        .kernel = EntryPoint(variant),
+        .bucket = autotune::ShapeBucket(dims),
+        .adapter = adapterKey,
+    };
+}
+
+void ReferenceGemm(Variant variant,
+                   const Shape& shape,
+                   std::span<const float> a,
+                   std::span<const float> b,
+                   std::span<float> c,
+                   float alpha,
+                   float beta)
+{
+    const auto m = static_cast<size_t>(shape.m);
+    const auto n = static_cast<size_t>(shape.n);
+    const auto k = static_cast<size_t>(shape.k);
+    const bool ta = TransposesA(variant);
+    const bool tb = TransposesB(variant);
+    for (size_t i = 0; i < m; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            float acc = 0.0f;
+            for (size_t l = 0; l < k; ++l) {
+                float av = ta ? a[l * m + i] : a[i * k + l];
+                float bv = tb ? b[j * k + l] : b[l * n + j];
+                acc += av * bv;
+            }
+            float value = alpha * acc;
+            if (std::abs(beta) > 0.0f) {
+                value += beta * c[i * n + j];
+            }
+            c[i * n + j] = value;
+        }
+    }
+}
+
+Gemm::Gemm(Variant variant,
+           TileConfig config,
+           std::optional<subgroups::Path> path)
+    : mVariant(variant)
+    , mConfig(config)
+    , mRequestedPath(path)
+    , mKernel(EntryPoint(variant))
+{
+}
+
+bool Gemm::Initialize(wgpu::Device device,
+                      const slang_compiler::Compiler& compiler)
+{
+    ZoneScoped;
+    if (mInitialized) {
+        return true;
+    }
+    mDevice = device;
+    const std::optional<subgroups::Path> path =
+        SelectPath(device, mConfig, mRequestedPath);
+    if (!path) {
+        return false;
+    }
+    mPath = *path;
+    const std::string moduleName = fmt::format("matmul_{}_{}x{}x{}",
+                                               subgroups::PathName(mPath),
+                                               mConfig.threadsX,
+                                               mConfig.threadsY,
+                                               mConfig.tileK);
+    mProgram = compiler.CompileFromSource(
+        ProgramSource(mConfig, "matmul.slang", mPath),
+        moduleName,
+        EntryPoint(mVariant));
+    if (!mProgram.program) {
+        return false;
+    }
+
+    auto* program = mProgram.program.get();
+    auto uniformsInfo = uniform_buffer::ReflectUniformBuffer(program);
+    auto paramsOffset = uniform_buffer::ReflectUniformOffset(program, "params");
+    if (!uniformsInfo || !paramsOffset) {
+        LOG_ERROR("matmul.slang has no GemmParams uniform");
+        return false;
+    }
+    mParamsOffset = *paramsOffset;
+    mUniforms.emplace(*uniformsInfo);
+    mUniforms->Initialize(device);
+
+    // The bind group layout only depends on the reflection, so the kernel is
+    // created once with placeholder tensors.
+    if (!Resize(device.GetQueue(), {.m = 1, .n = 1, .k = 1})) {
+        return false;
+    }
+    compute_kernel::Bindings bindings;
+    bindings.Add(*mUniforms).Add(*mA).Add(*mB).Add(*mC);
+    if (!mKernel.Initialize(device,
+                            mProgram.compileToWGSL(),
+                            EntryPoint(mVariant),
+                            bindings.GetLayoutEntries()))
+    {
+        return false;
+    }
+    mBindGroup = mKernel.CreateBindGroup(bindings.GetEntries());
+    mInitialized = true;
+    return true;
+}
+
+bool Gemm::Resize(wgpu::Queue queue, const Shape& shape)
+{
+    ZoneScoped;
+    if (!mUniforms) {
+        LOG_ERROR("Gemm::Resize called before Initialize");
+        return false;
+    }
+    if (shape.m <= 0 || shape.n <= 0 || shape.k <= 0) {
+        LOG_ERROR("Invalid GEMM shape {}x{}x{}", shape.m, shape.n, shape.k);
+        return false;
+    }
+    wgpu::Limits limits {};
+    mDevice.GetLimits(&limits);
+    if (!dispatch::FitsLimits(Workgroups(shape, mConfig), limits)) {
+        LOG_ERROR("GEMM {}x{}x{} exceeds the workgroup limits",
+                  shape.m,
+                  shape.n,
+                  shape.k);
+        return false;
+    }
+
+    auto* program = mProgram.program.get();
+    auto aInfo = tensor_reflection::ReflectTensorBuffer(program, "a");
+    auto bInfo = tensor_reflection::ReflectTensorBuffer(program, "b");
+    auto cInfo = tensor_reflection::ReflectTensorBuffer(program, "c");
+    if (!aInfo || !bInfo || !cInfo) {
+        return false;
+    }
+
+    const bool ta = TransposesA(mVariant);
+    const bool tb = TransposesB(mVariant);
+    const std::array<int32_t, 2> aDims = {ta ? shape.k : shape.m,
+                                          ta ? shape.m : shape.k};
+    const std::array<int32_t, 2> bDims = {tb ? shape.n : shape.k,
+                                          tb ? shape.k : shape.n};
+    const std::array<int32_t, 2> cDims = {shape.m, shape.n};
+
+    mA.emplace(*aInfo);
+    mB.emplace(*bInfo);
+    mC.emplace(*cInfo);
+    mA->Initialize(mDevice, ByteSize(shape.m, shape.k), *mUniforms);
+    mB->Initialize(mDevice, ByteSize(shape.k, shape.n), *mUniforms);
+    mC->Initialize(mDevice, ByteSize(shape.m, shape.n), *mUniforms);
+    mA->WriteShape(queue, aDims);
+    mB->WriteShape(queue, bDims);
+    mC->WriteShape(queue, cDims);
+
+    mShape = shape;
+    WriteParams(queue);
+
+    if (mInitialized) {
+        compute_kernel::Bindings bindings;
+        bindings.Add(*mUniforms).Add(*mA).Add(*mB).Add(*mC);
+        mBindGroup = mKernel.CreateBindGroup(bindings.GetEntries());
+    }
+    return true;
+}
+
+void Gemm::SetScalars(wgpu::Queue queue, float alpha, float beta)
+{
+    mAlpha = alpha;
+    mBeta = beta;
+    WriteParams(queue);
+}
+
+void Gemm::WriteParams(wgpu::Queue queue) const
+{
+    Params params {
+        .m = mShape.m,
+        .n = mShape.n,
+        .k = mShape.k,
+        .alpha = mAlpha,
+        .beta = mBeta,
+    };
+    mUniforms->Write(queue, mParamsOffset, params);
+}
+
+void Gemm::WriteA(wgpu::Queue queue, std::span<const float> values) const
+{
+    queue.WriteBuffer(
+        mA->GetDataBuffer(), 0, values.data(), values.size_bytes());
+}
+
+void Gemm::WriteB(wgpu::Queue queue, std::span<const float> values) const
+{
+    queue.WriteBuffer(
+        mB->GetDataBuffer(), 0, values.data(), values.size_bytes());
+}
+
+void Gemm::WriteC(wgpu::Queue queue, std::span<const float> values) const
+{
+    queue.WriteBuffer(
+        mC->GetDataBuffer(), 0, values.data(), values.size_bytes());
+}
+
+void Gemm::Encode(wgpu::ComputePassEncoder pass) const
+{
+    dispatch::Grid grid = Workgroups(mShape, mConfig);
+    pass.SetPipeline(mKernel.GetPipeline());
+    pass.SetBindGroup(0, mBindGroup);
+    pass.DispatchWorkgroups(grid.x, grid.y, grid.z);
+}
+
+std::vector<float> Gemm::ReadC(wgpu::Instance instance) const
+{
+    return compute_kernel::ReadBuffer<float>(
+        instance,
+        mDevice,
+        mC->GetDataBuffer(),
+        static_cast<size_t>(mShape.m) * static_cast<size_t>(mShape.n));
+}
+
+Variant Gemm::GetVariant() const
+{
+    return mVariant;
+}
+
+const TileConfig& Gemm::GetTileConfig() const
+{
+    return mConfig;
+}
+
+subgroups::Path Gemm::GetPath() const
+{
+    return mPath;
+}
+
+const Shape& Gemm::GetShape() const
+{
+    return mShape;
+}
+
+wgpu::Buffer Gemm::GetA() const
+{
+    return mA->GetDataBuffer();
+}
+
+wgpu::Buffer Gemm::GetB() const
+{
+    return mB->GetDataBuffer();
+}
+
+wgpu::Buffer Gemm::GetC() const
+{
+    return mC->GetDataBuffer();
+}
+
+std::optional<TileConfig> Autotune(autotune::Autotuner& tuner,
+                                   autotune::TuningCache& cache,
+                                   wgpu::Device device,
+                                   const slang_compiler::Compiler& compiler,
+                                   Variant variant,
+                                   const Shape& shape,
+                                   const std::string& adapterKey)
+{
+    ZoneScoped;
+    wgpu::Limits limits {};
+    device.GetLimits(&limits);
+    std::vector<autotune::Config> candidates;
+    for (const TileConfig& config : Candidates(limits)) {
+        candidates.push_back(ToConfig(config));
+    }
+
+    auto prepare = [&](const autotune::Config& config) -> autotune::EncodeFn
+    {
+        std::optional<TileConfig> tile = FromConfig(config);
+        if (!tile) {
+            return {};
+        }
+        auto kernel = std::make_shared<Gemm>(variant, *tile);
+        if (!kernel->Initialize(device, compiler)
+            || !kernel->Resize(device.GetQueue(), shape))
+        {
+            return {};
+        }
+        return [kernel](wgpu::ComputePassEncoder pass)
+        { kernel->Encode(pass); };
+    };
+
+    std::optional<autotune::Config> best = tuner.Tune(
+        TuningKey(variant, shape, adapterKey), candidates, prepare, cache);
+    return best ? FromConfig(*best) : std::nullopt;
+}
+
+TileConfig LookupTileConfig(const autotune::TuningCache& cache,
+                            Variant variant,
+                            const Shape& shape,
+                            const std::string& adapterKey)
+{
+    std::optional<autotune::Config> config =
+        cache.Find(TuningKey(variant, shape, adapterKey));
+    if (!config) {
+        return {};
+    }
+    return FromConfig(*config).value_or(TileConfig {});
+}
+
+}    // namespace gemm
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <compare>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <webgpu/webgpu_cpp.h>
+
+#include "autotune.hpp"
+#include "compute_kernel.hpp"
+#include "dispatch.hpp"
+#include "slang_compiler.hpp"
+#include "subgroups.hpp"
+#include "tensor_buffer.hpp"
+#include "uniform_buffer.hpp"
+
+namespace gemm
+{
+/// Per-thread register block; mirrors kGemmThreadM/kGemmThreadN in
+/// gemm.slang.
+inline constexpr uint32_t kThreadM = 4;
+inline constexpr uint32_t kThreadN = 4;
+
+/**
+ * @brief Workgroup shape and K slice of the tiled kernel.
+ *
+ * Each workgroup of threadsX x threadsY threads computes a
+ * (threadsY * kThreadM) x (threadsX * kThreadN) tile of C.
+ */
+struct TileConfig
+{
+    uint32_t threadsX = 16;
+    uint32_t threadsY = 16;
+    uint32_t tileK = 16;
+
+    [[nodiscard]] uint32_t TileM() const { return threadsY * kThreadM; }
+    [[nodiscard]] uint32_t TileN() const { return threadsX * kThreadN; }
+
+    /// Bytes of groupshared memory used by the A and B tiles.
+    [[nodiscard]] uint32_t SharedBytes() const
+    {
+        return tileK * (TileM() + TileN()) * sizeof(float);
+    }
+
+    auto operator<=>(const TileConfig&) const = default;
+};
+
+/// Which operands are stored transposed: A as [K, M], B as [N, K].
+enum class Variant
+{
+    NN,
+    NT,
+    TN,
+    TT,
+};
+
+struct Shape
+{
+    int32_t m = 0;
+    int32_t n = 0;
+    int32_t k = 0;
+};
+
+[[nodiscard]] bool TransposesA(Variant variant);
+[[nodiscard]] bool TransposesB(Variant variant);
+
+/// Name of the matmul.slang entry point implementing the variant.
+[[nodiscard]] const char* EntryPoint(Variant variant);
+
+/// Workgroups covering the [M, N] output with the config's tiles.
+[[nodiscard]] dispatch::Grid Workgroups(const Shape& shape,
+                                        const TileConfig& config = {});
+
+/// Slang source of an entry file built on gemm.slang, by default
+/// matmul.slang, specialized for a tile config and inner-product path.
+[[nodiscard]] std::string ProgramSource(
+    const TileConfig& config,
+    std::string_view entryFile = "matmul.slang",
+    subgroups::Path path = subgroups::Path::Shared);
+
+/**
+ * @brief The inner-product path for a config: subgroup shuffles when every
+ * subgroup holds whole thread rows, groupshared reads otherwise.
+ * @return nullopt if `requested` is the subgroup path and it does not fit
+ */
+[[nodiscard]] std::optional<subgroups::Path> SelectPath(
+    wgpu::Device device,
+    const TileConfig& config,
+    std::optional<subgroups::Path> requested = std::nullopt);
+
+/// Tile configs that fit the device's workgroup size and storage limits.
+[[nodiscard]] std::vector<TileConfig> Candidates(const wgpu::Limits& limits);
+
+[[nodiscard]] autotune::Config ToConfig(const TileConfig& config);
+[[nodiscard]] std::optional<TileConfig> FromConfig(
+    const autotune::Config& config);
+
+/// Autotuning key of a GEMM problem on an adapter.
+[[nodiscard]] autotune::Key TuningKey(Variant variant,
+                                      const Shape& shape,
+                                      const std::string& adapterKey);
+
+/**
+ * @brief CPU reference of C = alpha * op(A) * op(B) + beta * C, with the
+ * operands in the layouts the kernel expects.
+ */
+void ReferenceGemm(Variant variant,
+                   const Shape& shape,
+                   std::span<const float> a,
+                   std::span<const float> b,
+                   std::span<float> c,
+                   float alpha = 1.0f,
+                   float beta = 0.0f);
+
+/**
+ * @brief Tiled GEMM over RWTensorBuffer<float, int, int> operands.
+ *
+ * Owns the A, B and C tensors of the current shape. Typical use:
+ * Initialize(), Resize(), write the operands, then Encode() into a compute
+ * pass and read C back.
+ */
+class Gemm
+{
+  public:
+    /// `path` overrides SelectPath(), e.g. to benchmark the fallback.
+    explicit Gemm(Variant variant = Variant::NN,
+                  TileConfig config = {},
+                  std::optional<subgroups::Path> path = std::nullopt);
+
+    /// Compiles the variant's entry point and creates its pipeline.
+    bool Initialize(wgpu::Device device,
+                    const slang_compiler::Compiler& compiler);
+
+    /**
+     * @brief Allocates the operands for `shape` and uploads their shapes.
+     * @return false if the shape is empty or needs more workgroups than the
+     * device allows
+     */
+    bool Resize(wgpu::Queue queue, const Shape& shape);
+
+    /// Sets the epilogue scalars; the default is alpha = 1, beta = 0.
+    void SetScalars(wgpu::Queue queue, float alpha, float beta);
+
+    void WriteA(wgpu::Queue queue, std::span<const float> values) const;
+    void WriteB(wgpu::Queue queue, std::span<const float> values) const;
+    void WriteC(wgpu::Queue queue, std::span<const float> values) const;
+
+    /// Records the dispatch into an open compute pass.
+    void Encode(wgpu::ComputePassEncoder pass) const;
+
+    [[nodiscard]] std::vector<float> ReadC(wgpu::Instance instance) const;
+
+    [[nodiscard]] Variant GetVariant() const;
+    [[nodiscard]] const TileConfig& GetTileConfig() const;
+    [[nodiscard]] subgroups::Path GetPath() const;
+    [[nodiscard]] const Shape& GetShape() const;
+    [[nodiscard]] wgpu::Buffer GetA() const;
+    [[nodiscard]] wgpu::Buffer GetB() const;
+    [[nodiscard]] wgpu::Buffer GetC() const;
+
+  private:
+    void WriteParams(wgpu::Queue queue) const;
+
+    Variant mVariant;
+    TileConfig mConfig;
+    std::optional<subgroups::Path> mRequestedPath;
+    subgroups::Path mPath = subgroups::Path::Shared;
+    wgpu::Device mDevice {nullptr};
+    slang_compiler::SlangProgram mProgram;
+    compute_kernel::ComputeKernel mKernel;
+
+    std::optional<uniform_buffer::UniformBuffer> mUniforms;
+    std::optional<tensor_buffer::TensorBuffer> mA;
+    std::optional<tensor_buffer::TensorBuffer> mB;
+    std::optional<tensor_buffer::TensorBuffer> mC;
+    size_t mParamsOffset = 0;
+    wgpu::BindGroup mBindGroup {nullptr};
+
+    Shape mShape {};
+    float mAlpha = 1.0f;
+    float mBeta = 0.0f;
+    bool mInitialized = false;
+};
+
+/**
+ * @brief Times every candidate tile config on `shape` and stores the fastest
+ * in `cache`.
+ * @return the fastest config, or nullopt if none could run
+ */
+std::optional<TileConfig> Autotune(autotune::Autotuner& tuner,
+                                   autotune::TuningCache& cache,
+                                   wgpu::Device device,
+                                   const slang_compiler::Compiler& compiler,
+                                   Variant variant,
+                                   const Shape& shape,
+                                   const std::string& adapterKey);
+
+/// The tuned config for the shape's bucket, or the default one.
+[[nodiscard]] TileConfig LookupTileConfig(const autotune::TuningCache& cache,
+                                          Variant variant,
+                                          const Shape& shape,
+                                          const std::string& adapterKey);
+
+}    // namespace gemm
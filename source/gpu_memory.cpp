@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+#include "gpu_memory.hpp"
+
+#include <tracy/Tracy.hpp>
+
+#include "logging_macros.h"
+
+namespace gpu_memory
+{
+namespace
+{
+struct Allocation
+{
+    std::string label;
+    uint64_t size = 0;
+    WGPUDevice device = nullptr;
+};
+
+struct LabelCounters
+{
+    uint64_t liveBytes = 0;
+    uint64_t highWaterBytes = 0;
+    uint64_t liveBuffers = 0;
+    uint64_t totalAllocations = 0;
+};
+
+/// Process-wide accounting of every buffer created through CreateBuffer().
+struct Tracker
+{
+    std::mutex mutex;
+    std::unordered_map<WGPUBuffer, Allocation> allocations;
+    std::map<std::string, LabelCounters, std::less<>> labels;
+    uint64_t liveBytes = 0;
+    uint64_t highWaterBytes = 0;
+
+    void Add(WGPUBuffer handle, Allocation allocation)
+    {
+        std::scoped_lock lock(mutex);
+        LabelCounters& counters = labels[allocation.label];
+        counters.liveBytes += allocation.size;
+        counters.highWaterBytes =
+            std::max(counters.highWaterBytes, counters.liveBytes);
+        counters.liveBuffers += 1;
+        counters.totalAllocations += 1;
+        liveBytes += allocation.size;
+        highWaterBytes = std::max(highWaterBytes, liveBytes);
+        allocations.emplace(handle, std::move(allocation));
+    }
+
+    void Remove(WGPUBuffer handle)
+    {
+        std::scoped_lock lock(mutex);
+        auto it = allocations.find(handle);
+        if (it == allocations.end()) {
+            return;
+        }
+        LabelCounters& counters = labels[it->second.label];
+        counters.liveBytes -= it->second.size;
+        counters.liveBuffers -= 1;
+        liveBytes -= it->second.size;
+        allocations.erase(it);
+    }
+};
+
+Tracker& GetTracker()
+{
+    static Tracker tracker;
+    return tracker;
+}
+
+}    // namespace
+
+TrackedBuffer::TrackedBuffer(wgpu::Buffer buffer, uint64_t size)
+    : mBuffer(std::move(buffer))
+    , mSize(size)
+{
+}
+
+TrackedBuffer::~TrackedBuffer()
+{
+    Reset();
+}
+
+TrackedBuffer::TrackedBuffer(TrackedBuffer&& other) noexcept
+    : mBuffer(std::move(other.mBuffer))
+    , mSize(other.mSize)
+{
+    other.mBuffer = nullptr;
+    other.mSize = 0;
+}
+
+TrackedBuffer& TrackedBuffer::operator=(TrackedBuffer&& other) noexcept
+{
+    if (this != &other) {
+        Reset();
+        mBuffer = std::move(other.mBuffer);
+        mSize = other.mSize;
+        other.mBuffer = nullptr;
+        other.mSize = 0;
+    }
+    return *this;
+}
+
+wgpu::Buffer TrackedBuffer::Get() const
+{
+    return mBuffer;
+}
+
+uint64_t TrackedBuffer::GetSize() const
+{
+    return mSize;
+}
+
+void TrackedBuffer::Reset()
+{
+    if (mBuffer == nullptr) {
+        return;
+    }
+    WGPUBuffer handle = mBuffer.Get();
+    TracyFreeN(handle, "gpu");
+    GetTracker().Remove(handle);
+    mBuffer = nullptr;
+    mSize = 0;
+}
+
+TrackedBuffer CreateBuffer(wgpu::Device device,
+                           const wgpu::BufferDescriptor& desc)
+{
+    wgpu::Buffer buffer = device.CreateBuffer(&desc);
+    if (buffer == nullptr) {
+        LOG_ERROR("Failed to create buffer {} of {} bytes",
+                  desc.label,
+                  desc.size);
+        return {};
+    }
+
+    WGPUBuffer handle = buffer.Get();
+    TracyAllocN(handle, desc.size, "gpu");
+    GetTracker().Add(handle,
+                     {.label = std::string(std::string_view(desc.label)),
+                      .size = desc.size,
+                      .device = device.Get()});
+    return TrackedBuffer(std::move(buffer), desc.size);
+}
+
+MemoryReport GetReport()
+{
+    Tracker& tracker = GetTracker();
+    std::scoped_lock lock(tracker.mutex);
+
+    MemoryReport report {};
+    report.liveBytes = tracker.liveBytes;
+    report.highWaterBytes = tracker.highWaterBytes;
+    report.liveBuffers = tracker.allocations.size();
+    for (const auto& [label, counters] : tracker.labels) {
+        report.labels.push_back({
+            .label = label,
+            .liveBytes = counters.liveBytes,
+            .highWaterBytes = counters.highWaterBytes,
+            .liveBuffers = counters.liveBuffers,
+            .totalAllocations = counters.totalAllocations,
+        });
+    }
+    std::sort(report.labels.begin(),
+              report.labels.end(),
+              [](const LabelUsage& a, const LabelUsage& b)
+              { return a.highWaterBytes > b.highWaterBytes; });
+    return report;
+}
+
+size_t ReportLeaks(const wgpu::Device& device)
+{
+    Tracker& tracker = GetTracker();
+    std::scoped_lock lock(tracker.mutex);
+
+    size_t leaks = 0;
+    uint64_t leakedBytes = 0;
+    for (const auto& [handle, allocation] : tracker.allocations) {
+        if (allocation.device != device.Get()) {
+            continue;
+        }
+        LOG_WARN("Leaked GPU buffer \"{}\" of {} bytes",
+                 allocation.label,
+                 allocation.size);
+        leaks += 1;
+        leakedBytes += allocation.size;
+    }
+    if (leaks > 0) {
+        LOG_WARN("{} GPU buffers ({} bytes) alive at device teardown",
+                 leaks,
+                 leakedBytes);
+    }
+    return leaks;
+}
+
+}    // namespace gpu_memory
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <webgpu/webgpu_cpp.h>
+
+namespace gpu_memory
+{
+/// Device memory held by the buffers sharing one label.
+struct LabelUsage
+{
+    std::string label;
+    uint64_t liveBytes = 0;
+    uint64_t highWaterBytes = 0;
+    uint64_t liveBuffers = 0;
+    uint64_t totalAllocations = 0;
+};
+
+/// Snapshot of all tracked buffer memory, largest label first.
+struct MemoryReport
+{
+    uint64_t liveBytes = 0;
+    uint64_t highWaterBytes = 0;
+    uint64_t liveBuffers = 0;
+    std::vector<LabelUsage> labels;
+};
+
+/**
+ * @brief Move-only owner of a buffer created through CreateBuffer().
+ *
+ * The allocation is accounted for until the owner is destroyed or Reset(),
+ * even if copies of the underlying wgpu::Buffer are still bound elsewhere.
+ */
+class TrackedBuffer
+{
+  public:
+    TrackedBuffer() = default;
+    ~TrackedBuffer();
+
+    TrackedBuffer(const TrackedBuffer&) = delete;
+    TrackedBuffer& operator=(const TrackedBuffer&) = delete;
+    TrackedBuffer(TrackedBuffer&& other) noexcept;
+    TrackedBuffer& operator=(TrackedBuffer&& other) noexcept;
+
+    [[nodiscard]] wgpu::Buffer Get() const;
+    [[nodiscard]] uint64_t GetSize() const;
+
+    /// Stops tracking and drops this reference to the buffer.
+    void Reset();
+
+  private:
+    friend TrackedBuffer CreateBuffer(wgpu::Device device,
+                                      const wgpu::BufferDescriptor& desc);
+
+    explicit TrackedBuffer(wgpu::Buffer buffer, uint64_t size);
+
+    wgpu::Buffer mBuffer {nullptr};
+    uint64_t mSize = 0;
+};
+
+/**
+ * Creates a buffer and records its size under the descriptor's label. Every
+ * buffer allocation of the library goes through here; with TRACY_ENABLE the
+ * allocation is also reported to the "gpu" memory pool.
+ * @return an empty TrackedBuffer if creation failed
+ */
+[[nodiscard]] TrackedBuffer CreateBuffer(wgpu::Device device,
+                                         const wgpu::BufferDescriptor& desc);
+
+/// Current and peak tracked memory, per label and in total.
+[[nodiscard]] MemoryReport GetReport();
+
+/**
+ * Logs every tracked buffer of `device` that is still alive.
+ * @return number of leaked buffers
+ */
+size_t ReportLeaks(const wgpu::Device& device);
+
+}    // namespace gpu_memory
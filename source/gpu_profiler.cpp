@@ -0,0 +1,363 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "gpu_profiler.hpp"
+
+#include <fmt/format.h>
+#include <tracy/Tracy.hpp>
+
+#ifdef TRACY_ENABLE
+#    include <client/TracyProfiler.hpp>
+#endif
+
+#include "logging_macros.h"
+
+namespace gpu_profiler
+{
+namespace
+{
+/// Number of most recent samples per kernel used for percentiles.
+constexpr size_t kPercentileWindow = 1024;
+
+/// Size of one resolved timestamp.
+constexpr uint64_t kTimestampSize = sizeof(uint64_t);
+
+int64_t CpuNow()
+{
+#ifdef TRACY_ENABLE
+    return tracy::Profiler::GetTime();
+#else
+    return 0;
+#endif
+}
+
+std::string EscapeJSON(std::string_view text)
+{
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped.push_back('\\');
+        }
+        escaped.push_back(c);
+    }
+    return escaped;
+}
+
+}    // namespace
+
+GpuProfiler::GpuProfiler(uint32_t maxPassesPerFrame, uint32_t ringSize)
+    : mMaxPasses(std::max(1u, maxPassesPerFrame))
+    , mSlots(std::max(1u, ringSize))
+{
+    // BeginPass hands out pointers into mWrites, so it must never reallocate.
+    mWrites.reserve(mMaxPasses);
+}
+
+bool GpuProfiler::Initialize(wgpu::Device device)
+{
+    ZoneScoped;
+    if (mEnabled) {
+        return true;
+    }
+    if (!device.HasFeature(wgpu::FeatureName::TimestampQuery)) {
+        LOG_WARN("TimestampQuery is not supported, GPU profiling disabled");
+        return false;
+    }
+
+    wgpu::QuerySetDescriptor querySetDesc = {
+        .label = "profiler_queries",
+        .type = wgpu::QueryType::Timestamp,
+        .count = 2 * mMaxPasses,
+    };
+    mQuerySet = device.CreateQuerySet(&querySetDesc);
+
+    wgpu::BufferDescriptor resolveDesc = {
+        .label = "profiler_resolve",
+        .usage = wgpu::BufferUsage::QueryResolve | wgpu::BufferUsage::CopySrc,
+        .size = 2 * mMaxPasses * kTimestampSize,
+        .mappedAtCreation = false,
+    };
+    mResolveBuffer = gpu_memory::CreateBuffer(device, resolveDesc);
+
+    for (Slot& slot : mSlots) {
+        wgpu::BufferDescriptor readbackDesc = {
+            .label = "profiler_readback",
+            .usage = wgpu::BufferUsage::MapRead | wgpu::BufferUsage::CopyDst,
+            .size = resolveDesc.size,
+            .mappedAtCreation = false,
+        };
+        slot.readback = gpu_memory::CreateBuffer(device, readbackDesc);
+    }
+
+    mEnabled = true;
+    return true;
+}
+
+bool GpuProfiler::IsEnabled() const
+{
+    return mEnabled;
+}
+
+const wgpu::PassTimestampWrites* GpuProfiler::BeginPass(std::string_view name)
+{
+    if (!mEnabled || mFramePasses.size() >= mMaxPasses
+        || mSlots[mWriteSlot].state != SlotState::Free)
+    {
+        return nullptr;
+    }
+
+    auto index = static_cast<uint32_t>(mFramePasses.size());
+    mFramePasses.push_back({.name = std::string(name), .cpuBegin = CpuNow()});
+    mWrites.push_back({
+        .querySet = mQuerySet,
+        .beginningOfPassWriteIndex = 2 * index,
+        .endOfPassWriteIndex = 2 * index + 1,
+    });
+    return &mWrites.back();
+}
+
+void GpuProfiler::Resolve(wgpu::CommandEncoder encoder)
+{
+    if (!mEnabled || mFramePasses.empty()) {
+        return;
+    }
+
+    auto queryCount = static_cast<uint32_t>(2 * mFramePasses.size());
+    Slot& slot = mSlots[mWriteSlot];
+    encoder.ResolveQuerySet(
+        mQuerySet, 0, queryCount, mResolveBuffer.Get(), 0);
+    encoder.CopyBufferToBuffer(mResolveBuffer.Get(),
+                               0,
+                               slot.readback.Get(),
+                               0,
+                               queryCount * kTimestampSize);
+
+    slot.passes = std::move(mFramePasses);
+    slot.cpuEnd = CpuNow();
+    slot.state = SlotState::Resolved;
+    mWriteSlot = (mWriteSlot + 1) % mSlots.size();
+
+    mFramePasses.clear();
+    mWrites.clear();
+}
+
+void GpuProfiler::Collect(wgpu::Instance instance)
+{
+    Collect(instance, 0);
+}
+
+void GpuProfiler::Flush(wgpu::Instance instance)
+{
+    Collect(instance, UINT64_MAX);
+}
+
+void GpuProfiler::Collect(wgpu::Instance instance, uint64_t timeoutNs)
+{
+    ZoneScoped;
+    for (Slot& slot : mSlots) {
+        if (slot.state == SlotState::Resolved) {
+            slot.state = SlotState::Mapping;
+            slot.future = slot.readback.Get().MapAsync(
+                wgpu::MapMode::Read,
+                0,
+                2 * slot.passes.size() * kTimestampSize,
+                wgpu::CallbackMode::WaitAnyOnly,
+                [&slot](wgpu::MapAsyncStatus status, wgpu::StringView message)
+                {
+                    if (status == wgpu::MapAsyncStatus::Success) {
+                        slot.state = SlotState::Mapped;
+                        return;
+                    }
+                    LOG_WARN("Profiler readback failed: {}", message);
+                    slot.passes.clear();
+                    slot.state = SlotState::Free;
+                });
+        }
+        if (slot.state == SlotState::Mapping) {
+            instance.WaitAny(slot.future, timeoutNs);
+        }
+        if (slot.state == SlotState::Mapped) {
+            ReadSlot(slot);
+        }
+    }
+}
+
+void GpuProfiler::ReadSlot(Slot& slot)
+{
+    wgpu::Buffer readback = slot.readback.Get();
+    const auto* timestamps =
+        static_cast<const uint64_t*>(readback.GetConstMappedRange(
+            0, 2 * slot.passes.size() * kTimestampSize));
+    for (size_t i = 0; i < slot.passes.size(); ++i) {
+        uint64_t begin = timestamps[2 * i];
+        uint64_t end = timestamps[2 * i + 1];
+        // Timestamps may be quantized or reset; drop inverted pairs.
+        if (end >= begin) {
+            RecordSample(slot.passes[i].name, end - begin);
+        }
+    }
+    EmitTracyZones(slot, timestamps);
+
+    readback.Unmap();
+    slot.passes.clear();
+    slot.state = SlotState::Free;
+}
+
+void GpuProfiler::RecordSample(std::string_view name, uint64_t durationNs)
+{
+    auto it = mSamples.find(name);
+    if (it == mSamples.end()) {
+        it = mSamples.emplace(std::string(name), Samples {}).first;
+    }
+    Samples& samples = it->second;
+    samples.count += 1;
+    samples.totalNs += durationNs;
+    samples.minNs = std::min(samples.minNs, durationNs);
+    samples.maxNs = std::max(samples.maxNs, durationNs);
+    if (samples.recent.size() < kPercentileWindow) {
+        samples.recent.push_back(durationNs);
+    } else {
+        samples.recent[samples.next] = durationNs;
+        samples.next = (samples.next + 1) % kPercentileWindow;
+    }
+}
+
+std::vector<KernelStats> GpuProfiler::GetStats() const
+{
+    std::vector<KernelStats> stats;
+    stats.reserve(mSamples.size());
+    for (const auto& [name, samples] : mSamples) {
+        std::vector<uint64_t> sorted = samples.recent;
+        std::sort(sorted.begin(), sorted.end());
+        auto rank = static_cast<size_t>(
+            std::ceil(0.99 * static_cast<double>(sorted.size())));
+        uint64_t p99 = sorted[std::max<size_t>(rank, 1) - 1];
+
+        stats.push_back({
+            .name = name,
+            .count = samples.count,
+            .minUs = static_cast<double>(samples.minNs) / 1000.0,
+            .meanUs = static_cast<double>(samples.totalNs)
+                / static_cast<double>(samples.count) / 1000.0,
+            .p99Us = static_cast<double>(p99) / 1000.0,
+            .maxUs = static_cast<double>(samples.maxNs) / 1000.0,
+        });
+    }
+    std::sort(stats.begin(),
+              stats.end(),
+              [](const KernelStats& a, const KernelStats& b)
+              { return a.meanUs > b.meanUs; });
+    return stats;
+}
+
+std::string GpuProfiler::DumpJSON() const
+{
+    std::string json = "[";
+    bool first = true;
+    for (const KernelStats& s : GetStats()) {
+        json += fmt::format(
+            "{}\n  {{\"name\": \"{}\", \"count\": {}, \"min_us\": {:.3f}, "
+            "\"mean_us\": {:.3f}, \"p99_us\": {:.3f}, \"max_us\": {:.3f}}}",
+            first ? "" : ",",
+            EscapeJSON(s.name),
+            s.count,
+            s.minUs,
+            s.meanUs,
+            s.p99Us,
+            s.maxUs);
+        first = false;
+    }
+    json += "\n]\n";
+    return json;
+}
+
+#ifdef TRACY_ENABLE
+void GpuProfiler::EmitTracyZones(const Slot& slot, const uint64_t* timestamps)
+{
+    using namespace tracy;
+    if (slot.passes.empty()) {
+        return;
+    }
+
+    if (!mTracyContextCreated) {
+        // There is no synchronous GPU clock query in WebGPU, so calibrate on
+        // the first resolved timestamp against the CPU time it was resolved.
+        mTracyContext =
+            GetGpuCtxCounter().fetch_add(1, std::memory_order_relaxed);
+        auto* item = Profiler::QueueSerial();
+        MemWrite(&item->hdr.type, QueueType::GpuNewContext);
+        MemWrite(&item->gpuNewContext.cpuTime, slot.cpuEnd);
+        MemWrite(&item->gpuNewContext.gpuTime,
+                 static_cast<int64_t>(timestamps[0]));
+        std::memset(&item->gpuNewContext.thread,
+                    0,
+                    sizeof(item->gpuNewContext.thread));
+        MemWrite(&item->gpuNewContext.period, 1.0f);
+        MemWrite(&item->gpuNewContext.context, mTracyContext);
+        MemWrite(&item->gpuNewContext.flags, uint8_t {0});
+        MemWrite(&item->gpuNewContext.type, GpuContextType::Custom);
+        Profiler::QueueSerialFinish();
+
+        constexpr std::string_view kName = "WebGPU";
+        auto* ptr = static_cast<char*>(tracy_malloc(kName.size()));
+        std::memcpy(ptr, kName.data(), kName.size());
+        item = Profiler::QueueSerial();
+        MemWrite(&item->hdr.type, QueueType::GpuContextName);
+        MemWrite(&item->gpuContextNameFat.context, mTracyContext);
+        MemWrite(&item->gpuContextNameFat.ptr, reinterpret_cast<uint64_t>(ptr));
+        MemWrite(&item->gpuContextNameFat.size,
+                 static_cast<uint16_t>(kName.size()));
+        Profiler::QueueSerialFinish();
+
+        mTracyContextCreated = true;
+    }
+
+    for (size_t i = 0; i < slot.passes.size(); ++i) {
+        const PassRecord& pass = slot.passes[i];
+        uint16_t beginId = mTracyQueryId++;
+        uint16_t endId = mTracyQueryId++;
+
+        uint64_t srcloc = Profiler::AllocSourceLocation(__LINE__,
+                                                        __FILE__,
+                                                        std::strlen(__FILE__),
+                                                        __func__,
+                                                        std::strlen(__func__),
+                                                        pass.name.c_str(),
+                                                        pass.name.size());
+        auto* item = Profiler::QueueSerial();
+        MemWrite(&item->hdr.type, QueueType::GpuZoneBeginAllocSrcLocSerial);
+        MemWrite(&item->gpuZoneBegin.cpuTime, pass.cpuBegin);
+        MemWrite(&item->gpuZoneBegin.srcloc, srcloc);
+        MemWrite(&item->gpuZoneBegin.thread, GetThreadHandle());
+        MemWrite(&item->gpuZoneBegin.queryId, beginId);
+        MemWrite(&item->gpuZoneBegin.context, mTracyContext);
+        Profiler::QueueSerialFinish();
+
+        item = Profiler::QueueSerial();
+        MemWrite(&item->hdr.type, QueueType::GpuZoneEndSerial);
+        MemWrite(&item->gpuZoneEnd.cpuTime, slot.cpuEnd);
+        MemWrite(&item->gpuZoneEnd.thread, GetThreadHandle());
+        MemWrite(&item->gpuZoneEnd.queryId, endId);
+        MemWrite(&item->gpuZoneEnd.context, mTracyContext);
+        Profiler::QueueSerialFinish();
+
+        for (auto [queryId, time] :
+             {std::pair {beginId, timestamps[2 * i]},
+              std::pair {endId, timestamps[2 * i + 1]}})
+        {
+            item = Profiler::QueueSerial();
+            MemWrite(&item->hdr.type, QueueType::GpuTime);
+            MemWrite(&item->gpuTime.gpuTime, static_cast<int64_t>(time));
+            MemWrite(&item->gpuTime.queryId, queryId);
+            MemWrite(&item->gpuTime.context, mTracyContext);
+            Profiler::QueueSerialFinish();
+        }
+    }
+}
+#else
+void GpuProfiler::EmitTracyZones(const Slot&, const uint64_t*) {}
+#endif
+
+}    // namespace gpu_profiler
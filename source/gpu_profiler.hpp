@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <webgpu/webgpu_cpp.h>
+
+#include "gpu_memory.hpp"
+
+namespace gpu_profiler
+{
+/// Aggregated GPU execution time of one kernel, in microseconds.
+struct KernelStats
+{
+    std::string name;
+    uint64_t count = 0;
+    double minUs = 0.0;
+    double meanUs = 0.0;
+    double p99Us = 0.0;
+    double maxUs = 0.0;
+};
+
+/**
+ * @brief Measures per-kernel GPU time with pass timestamp writes.
+ *
+ * Each profiled compute pass gets a begin/end timestamp pair in a shared
+ * QuerySet. Resolve() copies a frame's timestamps into a slot of a readback
+ * ring, and Collect() harvests slots whose mapping has completed without
+ * blocking. Results feed per-kernel statistics and, when TRACY_ENABLE is
+ * defined, Tracy GPU zones.
+ */
+class GpuProfiler
+{
+  public:
+    /**
+     * @param maxPassesPerFrame number of passes that can be profiled between
+     * two calls to Resolve()
+     * @param ringSize number of frames that can be in flight
+     */
+    explicit GpuProfiler(uint32_t maxPassesPerFrame = 64,
+                         uint32_t ringSize = 3);
+
+    /**
+     * @brief Creates the query set and readback ring.
+     * @return false if the device lacks the TimestampQuery feature, in which
+     * case the profiler stays disabled and BeginPass() returns nullptr.
+     */
+    bool Initialize(wgpu::Device device);
+
+    [[nodiscard]] bool IsEnabled() const;
+
+    /**
+     * @brief Reserves timestamps for a compute pass.
+     * @param name kernel name the measurement is recorded under
+     * @return timestamp writes for wgpu::ComputePassDescriptor, or nullptr when
+     * disabled, when the frame is full or when every ring slot is in flight.
+     * The pointer stays valid until the next call to Resolve().
+     */
+    const wgpu::PassTimestampWrites* BeginPass(std::string_view name);
+
+    /// Resolves the frame's timestamps into the next ring slot. Call once per
+    /// command encoder, after the last profiled pass.
+    void Resolve(wgpu::CommandEncoder encoder);
+
+    /// Starts mapping resolved slots and records those that are ready. Call
+    /// after submitting the encoder passed to Resolve(); never blocks.
+    void Collect(wgpu::Instance instance);
+
+    /// Like Collect(), but waits for every in-flight slot.
+    void Flush(wgpu::Instance instance);
+
+    /// Adds one measurement of a kernel.
+    void RecordSample(std::string_view name, uint64_t durationNs);
+
+    /// Per-kernel statistics, slowest mean first.
+    [[nodiscard]] std::vector<KernelStats> GetStats() const;
+
+    /// Per-kernel statistics as a JSON array.
+    [[nodiscard]] std::string DumpJSON() const;
+
+  private:
+    struct PassRecord
+    {
+        std::string name;
+        int64_t cpuBegin = 0;
+    };
+
+    enum class SlotState
+    {
+        Free,
+        Resolved,
+        Mapping,
+        Mapped,
+    };
+
+    struct Slot
+    {
+        gpu_memory::TrackedBuffer readback;
+        std::vector<PassRecord> passes;
+        int64_t cpuEnd = 0;
+        SlotState state = SlotState::Free;
+        wgpu::Future future {};
+    };
+
+    struct Samples
+    {
+        uint64_t count = 0;
+        uint64_t totalNs = 0;
+        uint64_t minNs = UINT64_MAX;
+        uint64_t maxNs = 0;
+        std::vector<uint64_t> recent;    // ring used for percentiles
+        size_t next = 0;
+    };
+
+    void Collect(wgpu::Instance instance, uint64_t timeoutNs);
+    void ReadSlot(Slot& slot);
+    void EmitTracyZones(const Slot& slot, const uint64_t* timestamps);
+
+    uint32_t mMaxPasses;
+    std::vector<Slot> mSlots;
+    size_t mWriteSlot = 0;
+    std::vector<PassRecord> mFramePasses;
+    std::vector<wgpu::PassTimestampWrites> mWrites;
+
+    wgpu::QuerySet mQuerySet {nullptr};
+    gpu_memory::TrackedBuffer mResolveBuffer;
+    bool mEnabled = false;
+
+    std::map<std::string, Samples, std::less<>> mSamples;
+
+    uint8_t mTracyContext = 0;
+    bool mTracyContextCreated = false;
+    uint16_t mTracyQueryId = 0;
+};
+
+}    // namespace gpu_profiler
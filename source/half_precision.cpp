@@ -0,0 +1,407 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <string>
+
+#include "half_precision.hpp"
+
+#include <fmt/format.h>
+#include <tracy/Tracy.hpp>
+
+#include "dispatch.hpp"
+#include "logging_macros.h"
+
+namespace half_precision
+{
+namespace
+{
+/// Host mirror of GemmParams in gemm.slang.
+struct Params
+{
+    int32_t m;
+    int32_t n;
+    int32_t k;
+    float alpha;
+    float beta;
+};
+
+const char* StorageName(Storage storage)
+{
+    return storage == Storage::Native ? "native" : "packed";
+}
+
+/// Adds one to `half` when the dropped bits `rest` are above `halfway`, or
+/// equal to it with `half` odd.
+uint32_t RoundToEven(uint32_t half, uint32_t rest, uint32_t halfway)
+{
+    if (rest > halfway || (rest == halfway && (half & 1u) != 0)) {
+        return half + 1;
+    }
+    return half;
+}
+
+/// The requested storage, or the device's; nullopt if it cannot be used.
+std::optional<Storage> ResolveStorage(wgpu::Device device,
+                                      std::optional<Storage> requested)
+{
+    const Storage available = StorageFor(device);
+    if (requested == Storage::Native && available != Storage::Native) {
+        LOG_ERROR("Native f16 storage needs the ShaderF16 feature");
+        return std::nullopt;
+    }
+    return requested.value_or(available);
+}
+}    // namespace
+
+Storage StorageFor(wgpu::Device device)
+{
+    return device.HasFeature(wgpu::FeatureName::ShaderF16) ? Storage::Native
+                                                           : Storage::Packed;
+}
+
+uint16_t ToHalf(float value)
+{
+    const auto bits = std::bit_cast<uint32_t>(value);
+    const uint32_t sign = (bits >> 16) & 0x8000u;
+    const uint32_t exponent = (bits >> 23) & 0xffu;
+    uint32_t mantissa = bits & 0x7fffffu;
+    if (exponent == 0xffu) {
+        // Keeps NaNs quiet rather than turning them into infinities.
+        return static_cast<uint16_t>(sign | 0x7c00u
+                                     | (mantissa != 0 ? 0x200u : 0u));
+    }
+    const int32_t rebased = static_cast<int32_t>(exponent) - 127 + 15;
+    if (rebased >= 0x1f) {
+        return static_cast<uint16_t>(sign | 0x7c00u);
+    }
+    if (rebased <= 0) {
+        // Subnormal half: the implicit bit joins the shifted mantissa.
+        if (rebased < -10) {
+            return static_cast<uint16_t>(sign);
+        }
+        mantissa |= 0x800000u;
+        const auto shift = static_cast<uint32_t>(14 - rebased);
+        const uint32_t half = RoundToEven(mantissa >> shift,
+                                          mantissa & ((1u << shift) - 1),
+                                          1u << (shift - 1));
+        return static_cast<uint16_t>(sign | half);
+    }
+    // A carry out of the mantissa correctly bumps the exponent, up to
+    // infinity.
+    const uint32_t half =
+        RoundToEven((static_cast<uint32_t>(rebased) << 10) | (mantissa >> 13),
+                    mantissa & 0x1fffu,
+                    0x1000u);
+    return static_cast<uint16_t>(sign | half);
+}
+
+float ToFloat(uint16_t value)
+{
+    const uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+    const uint32_t exponent = (value >> 10) & 0x1fu;
+    const uint32_t mantissa = value & 0x3ffu;
+    if (exponent == 0x1fu) {
+        return std::bit_cast<float>(sign | 0x7f800000u | (mantissa << 13));
+    }
+    if (exponent == 0) {
+        const float magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+        return sign != 0 ? -magnitude : magnitude;
+    }
+    return std::bit_cast<float>(sign | ((exponent + 112) << 23)
+                                | (mantissa << 13));
+}
+
+std::vector<uint16_t> ToHalf(std::span<const float> values)
+{
+    std::vector<uint16_t> halves(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        halves[i] = ToHalf(values[i]);
+    }
+    return halves;
+}
+
+std::vector<float> ToFloat(std::span<const uint16_t> values)
+{
+    std::vector<float> floats(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        floats[i] = ToFloat(values[i]);
+    }
+    return floats;
+}
+
+size_t Bytes(size_t count)
+{
+    return tensor_buffer::PaddedBytes(count * sizeof(uint16_t));
+}
+
+gpu_memory::TrackedBuffer CreateBuffer(wgpu::Device device,
+                                       size_t count,
+                                       wgpu::BufferUsage extraUsage)
+{
+    wgpu::BufferDescriptor desc = {
+        .label = "half_tensor",
+        .usage = wgpu::BufferUsage::Storage | extraUsage,
+        .size = Bytes(count),
+        .mappedAtCreation = false,
+    };
+    return gpu_memory::CreateBuffer(device, desc);
+}
+
+void Upload(wgpu::Queue queue,
+            wgpu::Buffer buffer,
+            std::span<const float> values)
+{
+    std::vector<uint16_t> halves = ToHalf(values);
+    // Buffer writes are whole 32-bit words.
+    if (halves.size() % 2 != 0) {
+        halves.push_back(0);
+    }
+    queue.WriteBuffer(
+        buffer, 0, halves.data(), halves.size() * sizeof(uint16_t));
+}
+
+std::vector<float> Readback(wgpu::Instance instance,
+                            wgpu::Device device,
+                            wgpu::Buffer buffer,
+                            size_t count)
+{
+    std::vector<uint16_t> halves = compute_kernel::ReadBuffer<uint16_t>(
+        instance, device, buffer, count + count % 2);
+    halves.resize(std::min(halves.size(), count));
+    return ToFloat(halves);
+}
+
+Converter::Converter(std::optional<Storage> storage)
+    : mRequested(storage)
+{
+}
+
+bool Converter::Initialize(wgpu::Device device,
+                           const slang_compiler::Compiler& compiler)
+{
+    ZoneScoped;
+    if (mInitialized) {
+        return true;
+    }
+    mDevice = device;
+    const std::optional<Storage> storage = ResolveStorage(device, mRequested);
+    if (!storage) {
+        return false;
+    }
+    mStorage = *storage;
+    if (!InitializeKernel(compiler, "floatToHalf", mToHalf)
+        || !InitializeKernel(compiler, "halfToFloat", mToFloat))
+    {
+        return false;
+    }
+    mInitialized = true;
+    return true;
+}
+
+bool Converter::InitializeKernel(const slang_compiler::Compiler& compiler,
+                                 const char* entryPoint,
+                                 Kernel& kernel) const
+{
+    const std::string source = fmt::format(
+        "#define HALF_NATIVE {}\n"
+        "#include \"convert.slang\"\n",
+        mStorage == Storage::Native ? 1 : 0);
+    kernel.program = compiler.CompileFromSource(
+        source, fmt::format("convert_{}", StorageName(mStorage)), entryPoint);
+    if (!kernel.program.program) {
+        return false;
+    }
+
+    auto* program = kernel.program.program.get();
+    auto uniformsInfo = uniform_buffer::ReflectUniformBuffer(program);
+    auto floats = tensor_reflection::ReflectTensorBuffer(program, "floats");
+    auto halves = tensor_reflection::ReflectTensorBuffer(program, "halves");
+    if (!uniformsInfo || !floats || !halves) {
+        LOG_ERROR("convert.slang is missing parameters of {}", entryPoint);
+        return false;
+    }
+    kernel.uniforms = *uniformsInfo;
+    kernel.floats = *floats;
+    kernel.halves = *halves;
+
+    uniform_buffer::UniformBuffer uniforms(kernel.uniforms);
+    tensor_buffer::TensorBuffer floatBuffer(kernel.floats);
+    tensor_buffer::TensorBuffer halfBuffer(kernel.halves);
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms).Add(floatBuffer).Add(halfBuffer);
+    kernel.kernel = compute_kernel::ComputeKernel(entryPoint);
+    return kernel.kernel.Initialize(mDevice,
+                                    kernel.program.compileToWGSL(),
+                                    entryPoint,
+                                    bindings.GetLayoutEntries());
+}
+
+bool Converter::Encode(wgpu::ComputePassEncoder pass,
+                       wgpu::Buffer src,
+                       wgpu::Buffer dst,
+                       size_t count,
+                       Direction direction) const
+{
+    ZoneScoped;
+    if (!mInitialized) {
+        LOG_ERROR("Converter::Encode called before Initialize");
+        return false;
+    }
+    if (count == 0) {
+        return false;
+    }
+    const bool toHalf = direction == Direction::ToHalf;
+    const Kernel& kernel = toHalf ? mToHalf : mToFloat;
+    wgpu::Buffer floats = toHalf ? src : dst;
+    wgpu::Buffer halves = toHalf ? dst : src;
+
+    wgpu::Queue queue = mDevice.GetQueue();
+    uniform_buffer::UniformBuffer uniforms(kernel.uniforms);
+    uniforms.Initialize(mDevice);
+    tensor_buffer::TensorBuffer floatBuffer(kernel.floats);
+    tensor_buffer::TensorBuffer halfBuffer(kernel.halves);
+    floatBuffer.Initialize(uniforms, floats, floats.GetSize());
+    halfBuffer.Initialize(uniforms, halves, halves.GetSize());
+    const std::array<int32_t, 1> dims = {static_cast<int32_t>(count)};
+    floatBuffer.WriteShape(queue, dims);
+    halfBuffer.WriteShape(queue, dims);
+
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms).Add(floatBuffer).Add(halfBuffer);
+    pass.SetPipeline(kernel.kernel.GetPipeline());
+    pass.SetBindGroup(0, kernel.kernel.CreateBindGroup(bindings.GetEntries()));
+    // Two elements per thread.
+    return dispatch::DispatchLinear(
+        pass, dispatch::WorkgroupsFor((count + 1) / 2, kGroupSize), kGroupSize);
+}
+
+Storage Converter::GetStorage() const
+{
+    return mStorage;
+}
+
+Gemm::Gemm(gemm::TileConfig config, std::optional<Storage> storage)
+    : mConfig(config)
+    , mRequested(storage)
+{
+}
+
+bool Gemm::Initialize(wgpu::Device device,
+                      const slang_compiler::Compiler& compiler)
+{
+    ZoneScoped;
+    if (mInitialized) {
+        return true;
+    }
+    mDevice = device;
+    const std::optional<Storage> storage = ResolveStorage(device, mRequested);
+    if (!storage) {
+        return false;
+    }
+    mStorage = *storage;
+    const std::string source =
+        fmt::format("#define HALF_NATIVE {}\n",
+                    mStorage == Storage::Native ? 1 : 0)
+        + gemm::ProgramSource(mConfig, "matmul_f16.slang");
+    const std::string moduleName = fmt::format("matmul_f16_{}_{}x{}x{}",
+                                               StorageName(mStorage),
+                                               mConfig.threadsX,
+                                               mConfig.threadsY,
+                                               mConfig.tileK);
+    mProgram = compiler.CompileFromSource(source, moduleName, "gemmHalf");
+    if (!mProgram.program) {
+        return false;
+    }
+
+    auto* program = mProgram.program.get();
+    auto uniformsInfo = uniform_buffer::ReflectUniformBuffer(program);
+    auto paramsOffset = uniform_buffer::ReflectUniformOffset(program, "params");
+    auto a = tensor_reflection::ReflectTensorBuffer(program, "a");
+    auto b = tensor_reflection::ReflectTensorBuffer(program, "b");
+    auto c = tensor_reflection::ReflectTensorBuffer(program, "c");
+    if (!uniformsInfo || !paramsOffset || !a || !b || !c) {
+        LOG_ERROR("matmul_f16.slang is missing parameters");
+        return false;
+    }
+    mUniforms = *uniformsInfo;
+    mParamsOffset = *paramsOffset;
+    mA = *a;
+    mB = *b;
+    mC = *c;
+
+    uniform_buffer::UniformBuffer uniforms(mUniforms);
+    tensor_buffer::TensorBuffer aBuffer(mA);
+    tensor_buffer::TensorBuffer bBuffer(mB);
+    tensor_buffer::TensorBuffer cBuffer(mC);
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms).Add(aBuffer).Add(bBuffer).Add(cBuffer);
+    mInitialized = mKernel.Initialize(mDevice,
+                                      mProgram.compileToWGSL(),
+                                      "gemmHalf",
+                                      bindings.GetLayoutEntries());
+    return mInitialized;
+}
+
+bool Gemm::Encode(wgpu::ComputePassEncoder pass,
+                  const tensor_buffer::BufferView& a,
+                  const tensor_buffer::BufferView& b,
+                  wgpu::Buffer c,
+                  float alpha,
+                  float beta) const
+{
+    ZoneScoped;
+    if (!mInitialized) {
+        LOG_ERROR("half_precision::Gemm::Encode called before Initialize");
+        return false;
+    }
+    if (a.view.dims.size() != 2 || b.view.dims.size() != 2
+        || a.view.dims[1] != b.view.dims[0])
+    {
+        LOG_ERROR("Mixed-precision GEMM needs [M, K] and [K, N] operands");
+        return false;
+    }
+    const gemm::Shape shape {
+        .m = a.view.dims[0],
+        .n = b.view.dims[1],
+        .k = a.view.dims[1],
+    };
+    const std::array<int32_t, 2> cDims = {shape.m, shape.n};
+
+    wgpu::Limits limits {};
+    mDevice.GetLimits(&limits);
+    wgpu::Queue queue = mDevice.GetQueue();
+    uniform_buffer::UniformBuffer uniforms(mUniforms);
+    uniforms.Initialize(mDevice);
+    tensor_buffer::TensorBuffer aBuffer(mA);
+    tensor_buffer::TensorBuffer bBuffer(mB);
+    tensor_buffer::TensorBuffer cBuffer(mC);
+    aBuffer.Initialize(uniforms, a.buffer, a.buffer.GetSize());
+    bBuffer.Initialize(uniforms, b.buffer, b.buffer.GetSize());
+    cBuffer.Initialize(uniforms, c, c.GetSize());
+    aBuffer.WriteShape(queue, a.view);
+    bBuffer.WriteShape(queue, b.view);
+    cBuffer.WriteShape(queue, cDims);
+
+    const Params params {
+        .m = shape.m,
+        .n = shape.n,
+        .k = shape.k,
+        .alpha = alpha,
+        .beta = beta,
+    };
+    uniforms.Write(queue, mParamsOffset, params);
+
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms).Add(aBuffer).Add(bBuffer).Add(cBuffer);
+    pass.SetPipeline(mKernel.GetPipeline());
+    pass.SetBindGroup(0, mKernel.CreateBindGroup(bindings.GetEntries()));
+    return dispatch::Dispatch(pass, gemm::Workgroups(shape, mConfig), limits);
+}
+
+Storage Gemm::GetStorage() const
+{
+    return mStorage;
+}
+
+}    // namespace half_precision
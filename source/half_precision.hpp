@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <webgpu/webgpu_cpp.h>
+
+#include "compute_kernel.hpp"
+#include "gemm.hpp"
+#include "gpu_memory.hpp"
+#include "slang_compiler.hpp"
+#include "tensor_buffer.hpp"
+#include "tensor_reflection.hpp"
+#include "uniform_buffer.hpp"
+
+namespace half_precision
+{
+/// Workgroup size of the conversion kernels; mirrors convert.slang.
+inline constexpr uint32_t kGroupSize = 256;
+
+/**
+ * @brief How f16 tensors are bound. Both store IEEE binary16 values in the
+ * same little-endian byte layout, so buffers and host helpers are shared.
+ */
+enum class Storage
+{
+    /// RWTensorBuffer<half, ...>; needs the ShaderF16 feature.
+    Native,
+    /// Two halves per 32-bit word, converted in the shader.
+    Packed,
+};
+
+enum class Direction
+{
+    ToHalf,
+    ToFloat,
+};
+
+/// Native storage when the device has ShaderF16, packed otherwise.
+[[nodiscard]] Storage StorageFor(wgpu::Device device);
+
+/// Rounds to the nearest binary16 value, ties to even; out-of-range values
+/// become infinities and NaNs stay NaNs.
+[[nodiscard]] uint16_t ToHalf(float value);
+
+/// Exact widening of a binary16 value.
+[[nodiscard]] float ToFloat(uint16_t value);
+
+[[nodiscard]] std::vector<uint16_t> ToHalf(std::span<const float> values);
+[[nodiscard]] std::vector<float> ToFloat(std::span<const uint16_t> values);
+
+/// Storage bytes of `count` halves, padded like tensor_buffer::PaddedBytes.
+[[nodiscard]] size_t Bytes(size_t count);
+
+/// Creates a storage buffer for `count` halves.
+[[nodiscard]] gpu_memory::TrackedBuffer CreateBuffer(
+    wgpu::Device device,
+    size_t count,
+    wgpu::BufferUsage extraUsage = wgpu::BufferUsage::CopyDst
+        | wgpu::BufferUsage::CopySrc);
+
+/// Converts `values` to halves and writes them at the start of `buffer`.
+void Upload(wgpu::Queue queue,
+            wgpu::Buffer buffer,
+            std::span<const float> values);
+
+/// Reads `count` halves from the start of `buffer`, widened to float.
+[[nodiscard]] std::vector<float> Readback(wgpu::Instance instance,
+                                          wgpu::Device device,
+                                          wgpu::Buffer buffer,
+                                          size_t count);
+
+/**
+ * @brief Converts contiguous tensors between f32 and f16 storage on the
+ * device.
+ */
+class Converter
+{
+  public:
+    /// `storage` overrides StorageFor(), e.g. to test the packed path.
+    explicit Converter(std::optional<Storage> storage = std::nullopt);
+
+    /// Compiles both directions; fails if native storage is requested
+    /// without ShaderF16.
+    bool Initialize(wgpu::Device device,
+                    const slang_compiler::Compiler& compiler);
+
+    /**
+     * @brief Records the conversion of `count` elements from `src` to `dst`.
+     * @return false if nothing was dispatched
+     */
+    [[nodiscard]] bool Encode(wgpu::ComputePassEncoder pass,
+                              wgpu::Buffer src,
+                              wgpu::Buffer dst,
+                              size_t count,
+                              Direction direction) const;
+
+    [[nodiscard]] Storage GetStorage() const;
+
+  private:
+    struct Kernel
+    {
+        slang_compiler::SlangProgram program;
+        compute_kernel::ComputeKernel kernel;
+        uniform_buffer::UniformBufferReflection uniforms;
+        tensor_reflection::TensorBufferReflection floats;
+        tensor_reflection::TensorBufferReflection halves;
+    };
+
+    bool InitializeKernel(const slang_compiler::Compiler& compiler,
+                          const char* entryPoint,
+                          Kernel& kernel) const;
+
+    std::optional<Storage> mRequested;
+    wgpu::Device mDevice {nullptr};
+    Storage mStorage = Storage::Packed;
+    Kernel mToHalf;
+    Kernel mToFloat;
+    bool mInitialized = false;
+};
+
+/**
+ * @brief C = alpha * A x B + beta * C with f16 A and B and an f32 C.
+ *
+ * Operands are widened to f32 when they are staged into the tiles, so all
+ * products and sums are f32; only the A and B traffic is halved. A and B
+ * are 2-D views of f16 buffers, so transposed operands need no copies.
+ */
+class Gemm
+{
+  public:
+    /// `storage` overrides StorageFor(), as for Converter.
+    explicit Gemm(gemm::TileConfig config = {},
+                  std::optional<Storage> storage = std::nullopt);
+
+    bool Initialize(wgpu::Device device,
+                    const slang_compiler::Compiler& compiler);
+
+    /**
+     * @brief Records the product into `pass`.
+     * @param a [M, K] view of an f16 buffer.
+     * @param b [K, N] view of an f16 buffer.
+     * @param c Buffer holding the contiguous f32 [M, N] output.
+     * @return false if the operands do not multiply or nothing was
+     * dispatched
+     */
+    [[nodiscard]] bool Encode(wgpu::ComputePassEncoder pass,
+                              const tensor_buffer::BufferView& a,
+                              const tensor_buffer::BufferView& b,
+                              wgpu::Buffer c,
+                              float alpha = 1.0f,
+                              float beta = 0.0f) const;
+
+    [[nodiscard]] Storage GetStorage() const;
+
+  private:
+    gemm::TileConfig mConfig;
+    std::optional<Storage> mRequested;
+    wgpu::Device mDevice {nullptr};
+    Storage mStorage = Storage::Packed;
+    slang_compiler::SlangProgram mProgram;
+    compute_kernel::ComputeKernel mKernel {"gemmHalf"};
+    uniform_buffer::UniformBufferReflection mUniforms;
+    size_t mParamsOffset = 0;
+    tensor_reflection::TensorBufferReflection mA;
+    tensor_reflection::TensorBufferReflection mB;
+    tensor_reflection::TensorBufferReflection mC;
+    bool mInitialized = false;
+};
+
+}    // namespace half_precision
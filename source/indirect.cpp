@@ -0,0 +1,133 @@
+#include <array>
+
+#include "indirect.hpp"
+
+#include <tracy/Tracy.hpp>
+
+#include "dispatch.hpp"
+#include "logging_macros.h"
+#include "tensor_buffer.hpp"
+
+namespace indirect
+{
+namespace
+{
+/// Host mirror of IndirectParams in indirect.slang.
+struct Params
+{
+    int32_t records;
+    uint32_t groupSize;
+    uint32_t threadsPerElement;
+};
+
+constexpr const char* kEntryPoint = "indirectArgs";
+}    // namespace
+
+gpu_memory::TrackedBuffer CreateArgsBuffer(wgpu::Device device,
+                                           uint32_t records)
+{
+    wgpu::BufferDescriptor desc = {
+        .label = "indirect_args",
+        .usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::Indirect
+            | wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::CopySrc,
+        .size = tensor_buffer::PaddedBytes(records
+                                           * dispatch::kIndirectArgsSize),
+        .mappedAtCreation = false,
+    };
+    return gpu_memory::CreateBuffer(device, desc);
+}
+
+bool ArgsWriter::Initialize(wgpu::Device device,
+                            const slang_compiler::Compiler& compiler)
+{
+    ZoneScoped;
+    if (mInitialized) {
+        return true;
+    }
+    mDevice = device;
+    mProgram = compiler.CreateProgram("indirect", kEntryPoint);
+    if (!mProgram.program) {
+        return false;
+    }
+
+    auto* program = mProgram.program.get();
+    auto uniformsInfo = uniform_buffer::ReflectUniformBuffer(program);
+    auto paramsOffset = uniform_buffer::ReflectUniformOffset(program, "params");
+    auto counts = tensor_reflection::ReflectTensorBuffer(program, "counts");
+    auto args = tensor_reflection::ReflectTensorBuffer(program, "args");
+    if (!uniformsInfo || !paramsOffset || !counts || !args) {
+        LOG_ERROR("indirect.slang is missing parameters of {}", kEntryPoint);
+        return false;
+    }
+    mUniforms = *uniformsInfo;
+    mParamsOffset = *paramsOffset;
+    mCounts = *counts;
+    mArgs = *args;
+
+    uniform_buffer::UniformBuffer uniforms(mUniforms);
+    tensor_buffer::TensorBuffer countsBuffer(mCounts);
+    tensor_buffer::TensorBuffer argsBuffer(mArgs);
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms).Add(countsBuffer).Add(argsBuffer);
+    mKernel = compute_kernel::ComputeKernel(kEntryPoint);
+    if (!mKernel.Initialize(mDevice,
+                            mProgram.compileToWGSL(),
+                            kEntryPoint,
+                            bindings.GetLayoutEntries()))
+    {
+        return false;
+    }
+    mInitialized = true;
+    return true;
+}
+
+bool ArgsWriter::Encode(wgpu::ComputePassEncoder pass,
+                        wgpu::Buffer counts,
+                        wgpu::Buffer args,
+                        uint32_t records,
+                        uint32_t workgroupSize,
+                        uint32_t threadsPerElement) const
+{
+    ZoneScoped;
+    if (!mInitialized) {
+        LOG_ERROR("ArgsWriter::Encode called before Initialize");
+        return false;
+    }
+    if (records == 0 || workgroupSize == 0 || threadsPerElement == 0
+        || args.GetSize() < records * dispatch::kIndirectArgsSize
+        || counts.GetSize() < records * sizeof(uint32_t))
+    {
+        LOG_ERROR("Invalid {} indirect records of {}-thread workgroups",
+                  records,
+                  workgroupSize);
+        return false;
+    }
+
+    wgpu::Queue queue = mDevice.GetQueue();
+    uniform_buffer::UniformBuffer uniforms(mUniforms);
+    uniforms.Initialize(mDevice);
+    tensor_buffer::TensorBuffer countsBuffer(mCounts);
+    tensor_buffer::TensorBuffer argsBuffer(mArgs);
+    countsBuffer.Initialize(uniforms, counts, counts.GetSize());
+    argsBuffer.Initialize(uniforms, args, args.GetSize());
+    const auto length = static_cast<int32_t>(records);
+    const std::array<int32_t, 1> countsDims = {length};
+    const std::array<int32_t, 2> argsDims = {length, 3};
+    countsBuffer.WriteShape(queue, countsDims);
+    argsBuffer.WriteShape(queue, argsDims);
+    const Params params {
+        .records = length,
+        .groupSize = workgroupSize,
+        .threadsPerElement = threadsPerElement,
+    };
+    uniforms.Write(queue, mParamsOffset, params);
+
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms).Add(countsBuffer).Add(argsBuffer);
+    pass.SetPipeline(mKernel.GetPipeline());
+    pass.SetBindGroup(0, mKernel.CreateBindGroup(bindings.GetEntries()));
+    return dispatch::DispatchLinear(
+        pass, dispatch::WorkgroupsFor(records, kGroupSize), kGroupSize);
+}
+
+}    // namespace indirect
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+
+#include <webgpu/webgpu_cpp.h>
+
+#include "compute_kernel.hpp"
+#include "gpu_memory.hpp"
+#include "slang_compiler.hpp"
+#include "tensor_reflection.hpp"
+#include "uniform_buffer.hpp"
+
+namespace indirect
+{
+/// Workgroup size of the indirect.slang kernel.
+inline constexpr uint32_t kGroupSize = 64;
+
+/**
+ * @brief Allocates `records` dispatch::DispatchIndirect records of
+ * dispatch::kIndirectArgsSize bytes each, writable by kernels.
+ */
+[[nodiscard]] gpu_memory::TrackedBuffer CreateArgsBuffer(
+    wgpu::Device device, uint32_t records = 1);
+
+/**
+ * @brief Writes indirect dispatch arguments from element counts on the
+ * device.
+ *
+ * A kernel whose output size depends on the data, e.g. the number of
+ * active tokens or of non-zeros left by a filter, stores that count in a
+ * buffer. ArgsWriter turns it into a folded grid, and the next kernel is
+ * recorded with dispatch::DispatchIndirect into the same pass, so the
+ * whole chain runs without a GPU to CPU round trip. The launched kernel
+ * reads the count again to bounds-check its linearThreadIndex().
+ */
+class ArgsWriter
+{
+  public:
+    bool Initialize(wgpu::Device device,
+                    const slang_compiler::Compiler& compiler);
+
+    /**
+     * @brief Records the kernel that writes record r of `args` for
+     * counts[r] * threadsPerElement threads in workgroups of
+     * `workgroupSize`, for r < records. A record of more than
+     * dispatch::kMaxLinearThreads threads gets a zero grid.
+     * @param counts Buffer of at least `records` uint32 counts.
+     * @param args Buffer from CreateArgsBuffer() with at least `records`
+     * records.
+     * @return false if a size is zero or `args` is too small
+     */
+    [[nodiscard]] bool Encode(wgpu::ComputePassEncoder pass,
+                              wgpu::Buffer counts,
+                              wgpu::Buffer args,
+                              uint32_t records,
+                              uint32_t workgroupSize,
+                              uint32_t threadsPerElement = 1) const;
+
+  private:
+    wgpu::Device mDevice {nullptr};
+    slang_compiler::SlangProgram mProgram;
+    compute_kernel::ComputeKernel mKernel;
+    uniform_buffer::UniformBufferReflection mUniforms;
+    size_t mParamsOffset = 0;
+    tensor_reflection::TensorBufferReflection mCounts;
+    tensor_reflection::TensorBufferReflection mArgs;
+    bool mInitialized = false;
+};
+
+}    // namespace indirect
@@ -1,12 +1,26 @@
+#include <array>
 #include <cstdlib>
 #include <iostream>
+#include <vector>
 
 #include "lib.hpp"
 
+#include "gpu_memory.hpp"
+
 #include <tracy/Tracy.hpp>
 
 #include "logging_macros.h"
 
+namespace
+{
+/// Features requested from the adapter whenever it supports them.
+constexpr std::array kOptionalFeatures = {
+    wgpu::FeatureName::TimestampQuery,
+    wgpu::FeatureName::Subgroups,
+    wgpu::FeatureName::ShaderF16,
+};
+}    // namespace
+
 /// Constructs the Library and initializes the project name.
 Library::Library()
     : mName("congpu")
@@ -29,7 +43,8 @@ wgpu::Instance Library::CreateInstance()
     return instance;
 }
 
-wgpu::Adapter Library::RequestAdapter(wgpu::Instance instance)
+wgpu::Adapter Library::RequestAdapter(wgpu::Instance instance,
+                                      bool forceFallbackAdapter)
 {
     ZoneScoped;
 
@@ -50,6 +65,7 @@ wgpu::Adapter Library::RequestAdapter(wgpu::Instance instance)
 
     wgpu::Adapter adapter = nullptr;
     wgpu::RequestAdapterOptions adapterOptions = {};
+    adapterOptions.forceFallbackAdapter = forceFallbackAdapter;
 
     for (wgpu::FeatureLevel level : kLevels) {
         adapterOptions.featureLevel = level;
@@ -81,17 +97,34 @@ wgpu::Device Library::RequestDevice(wgpu::Adapter adapter)
 {
     ZoneScoped;
     wgpu::DeviceDescriptor deviceDescriptor {};
+
+    std::vector<wgpu::FeatureName> requiredFeatures;
+    for (wgpu::FeatureName feature : kOptionalFeatures) {
+        if (adapter.HasFeature(feature)) {
+            requiredFeatures.push_back(feature);
+        }
+    }
+    deviceDescriptor.requiredFeatureCount = requiredFeatures.size();
+    deviceDescriptor.requiredFeatures = requiredFeatures.data();
+
     auto errorCallback =
         [](wgpu::Device const&, wgpu::ErrorType type, wgpu::StringView message)
     { LOG_ERROR("{}, {}", type, message); };
     deviceDescriptor.SetUncapturedErrorCallback(errorCallback);
 
-    auto deviceLostCallback = [](wgpu::Device const&,
+    auto deviceLostCallback = [](wgpu::Device const& device,
                                  wgpu::DeviceLostReason reason,
                                  wgpu::StringView message)
-    { LOG_ERROR("{}, {}", reason, message); };
-    deviceDescriptor.SetDeviceLostCallback(wgpu::CallbackMode::WaitAnyOnly,
-                                           deviceLostCallback);
+    {
+        if (reason == wgpu::DeviceLostReason::Destroyed) {
+            gpu_memory::ReportLeaks(device);
+            return;
+        }
+        LOG_ERROR("{}, {}", reason, message);
+    };
+    // Spontaneous so that teardown is observed without anyone waiting on it.
+    deviceDescriptor.SetDeviceLostCallback(
+        wgpu::CallbackMode::AllowSpontaneous, deviceLostCallback);
     wgpu::Device device = nullptr;
 
     auto deviceCallback = [](wgpu::RequestDeviceStatus status,
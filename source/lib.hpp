@@ -33,12 +33,18 @@ struct Library
     /**
      * @brief Synchronously requests a WebGPU adapter.
      * @param instance The instance from which to request the adapter.
+     * @param forceFallbackAdapter Request Dawn's software adapter, so that
+     * results do not depend on the GPU of the machine.
      * @return A valid wgpu::Adapter, or nullptr if the request failed.
      */
-    wgpu::Adapter RequestAdapter(wgpu::Instance instance);
+    wgpu::Adapter RequestAdapter(wgpu::Instance instance,
+                                 bool forceFallbackAdapter = false);
 
     /**
      * @brief Synchronously requests a WebGPU device from an adapter.
+     *
+     * Optional features such as TimestampQuery are enabled when the adapter
+     * supports them; check wgpu::Device::HasFeature before relying on one.
      * @param adapter The adapter from which to request the device.
      * @return A valid wgpu::Device, or nullptr if the request failed.
      */
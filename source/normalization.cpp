@@ -0,0 +1,295 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <string>
+
+#include "normalization.hpp"
+
+#include <fmt/format.h>
+#include <tracy/Tracy.hpp>
+
+#include "dispatch.hpp"
+#include "logging_macros.h"
+#include "reduction.hpp"
+#include "subgroups.hpp"
+#include "tensor_reflection.hpp"
+
+namespace normalization
+{
+namespace
+{
+/// Host mirror of NormParams in normalization.slang.
+struct Params
+{
+    int32_t rows;
+    int32_t cols;
+    float epsilon;
+};
+
+size_t ByteSize(int32_t rows, int32_t cols)
+{
+    return static_cast<size_t>(rows) * static_cast<size_t>(cols)
+        * sizeof(float);
+}
+}    // namespace
+
+const char* EntryPoint(Kind kind)
+{
+    return kind == Kind::LayerNorm ? "layerNormRows" : "softmaxRows";
+}
+
+void ReferenceSoftmax(std::span<const float> input,
+                      std::span<float> output,
+                      int32_t rows,
+                      int32_t cols)
+{
+    const auto n = static_cast<size_t>(cols);
+    for (size_t r = 0; r < static_cast<size_t>(rows); ++r) {
+        std::span<const float> in = input.subspan(r * n, n);
+        std::span<float> out = output.subspan(r * n, n);
+        const float rowMax = *std::ranges::max_element(in);
+        double sum = 0.0;
+        for (size_t c = 0; c < n; ++c) {
+            out[c] = std::exp(in[c] - rowMax);
+            sum += static_cast<double>(out[c]);
+        }
+        for (size_t c = 0; c < n; ++c) {
+            out[c] = static_cast<float>(static_cast<double>(out[c]) / sum);
+        }
+    }
+}
+
+void ReferenceLayerNorm(std::span<const float> input,
+                        std::span<const float> gamma,
+                        std::span<const float> beta,
+                        std::span<float> output,
+                        int32_t rows,
+                        int32_t cols,
+                        float epsilon)
+{
+    const auto n = static_cast<size_t>(cols);
+    for (size_t r = 0; r < static_cast<size_t>(rows); ++r) {
+        std::span<const float> in = input.subspan(r * n, n);
+        double mean = 0.0;
+        for (float x : in) {
+            mean += static_cast<double>(x);
+        }
+        mean /= static_cast<double>(n);
+        double variance = 0.0;
+        for (float x : in) {
+            const double centered = static_cast<double>(x) - mean;
+            variance += centered * centered;
+        }
+        variance /= static_cast<double>(n);
+        const double invStd =
+            1.0 / std::sqrt(variance + static_cast<double>(epsilon));
+        for (size_t c = 0; c < n; ++c) {
+            output[r * n + c] = static_cast<float>(
+                (static_cast<double>(in[c]) - mean) * invStd
+                    * static_cast<double>(gamma[c])
+                + static_cast<double>(beta[c]));
+        }
+    }
+}
+
+RowNormalization::RowNormalization(Kind kind)
+    : mKind(kind)
+    , mKernel(EntryPoint(kind))
+{
+}
+
+bool RowNormalization::Initialize(wgpu::Device device,
+                                  const slang_compiler::Compiler& compiler)
+{
+    ZoneScoped;
+    if (mInitialized) {
+        return true;
+    }
+    mDevice = device;
+    mSubgroups = subgroups::Select(subgroups::Query(device),
+                                   std::nullopt,
+                                   reduction::kGroupSize)
+        == subgroups::Path::Subgroups;
+
+    const std::string source = fmt::format(
+        "#define REDUCE_GROUP_SIZE {}\n"
+        "#define REDUCE_SUBGROUPS {}\n"
+        "#include \"normalization.slang\"\n",
+        reduction::kGroupSize,
+        mSubgroups ? 1 : 0);
+    mProgram = compiler.CompileFromSource(
+        source,
+        mSubgroups ? "normalization_subgroups" : "normalization_shared",
+        EntryPoint(mKind));
+    if (!mProgram.program) {
+        return false;
+    }
+
+    auto* program = mProgram.program.get();
+    auto uniformsInfo = uniform_buffer::ReflectUniformBuffer(program);
+    auto paramsOffset = uniform_buffer::ReflectUniformOffset(program, "params");
+    if (!uniformsInfo || !paramsOffset) {
+        LOG_ERROR("normalization.slang has no NormParams uniform");
+        return false;
+    }
+    mParamsOffset = *paramsOffset;
+    mUniforms.emplace(*uniformsInfo);
+    mUniforms->Initialize(device);
+
+    // The bind group layout only depends on the reflection, so the kernel is
+    // created once with placeholder tensors.
+    if (!Resize(device.GetQueue(), 1, 1)) {
+        return false;
+    }
+    compute_kernel::Bindings bindings;
+    bindings.Add(*mUniforms).Add(*mInput).Add(*mOutput).Add(*mGamma).Add(
+        *mBeta);
+    if (!mKernel.Initialize(device,
+                            mProgram.compileToWGSL(),
+                            EntryPoint(mKind),
+                            bindings.GetLayoutEntries()))
+    {
+        return false;
+    }
+    mBindGroup = mKernel.CreateBindGroup(bindings.GetEntries());
+    mInitialized = true;
+    return true;
+}
+
+bool RowNormalization::Resize(wgpu::Queue queue, int32_t rows, int32_t cols)
+{
+    ZoneScoped;
+    if (!mUniforms) {
+        LOG_ERROR("RowNormalization::Resize called before Initialize");
+        return false;
+    }
+    if (rows <= 0 || cols <= 0) {
+        LOG_ERROR("Invalid normalization shape {}x{}", rows, cols);
+        return false;
+    }
+
+    auto* program = mProgram.program.get();
+    auto inputInfo = tensor_reflection::ReflectTensorBuffer(program, "input");
+    auto outputInfo = tensor_reflection::ReflectTensorBuffer(program, "output");
+    auto gammaInfo = tensor_reflection::ReflectTensorBuffer(program, "gamma");
+    auto betaInfo = tensor_reflection::ReflectTensorBuffer(program, "beta");
+    if (!inputInfo || !outputInfo || !gammaInfo || !betaInfo) {
+        return false;
+    }
+
+    const std::array<int32_t, 2> dims = {rows, cols};
+    const std::array<int32_t, 2> columnDims = {1, cols};
+    mInput.emplace(*inputInfo);
+    mOutput.emplace(*outputInfo);
+    mGamma.emplace(*gammaInfo);
+    mBeta.emplace(*betaInfo);
+    mInput->Initialize(mDevice, ByteSize(rows, cols), *mUniforms);
+    mOutput->Initialize(mDevice, ByteSize(rows, cols), *mUniforms);
+    mGamma->Initialize(mDevice, ByteSize(1, cols), *mUniforms);
+    mBeta->Initialize(mDevice, ByteSize(1, cols), *mUniforms);
+    mInput->WriteShape(queue, dims);
+    mOutput->WriteShape(queue, dims);
+    mGamma->WriteShape(queue, columnDims);
+    mBeta->WriteShape(queue, columnDims);
+
+    mRows = rows;
+    mCols = cols;
+    WriteParams(queue);
+    const std::vector<float> ones(static_cast<size_t>(cols), 1.0f);
+    const std::vector<float> zeros(static_cast<size_t>(cols), 0.0f);
+    WriteGamma(queue, ones);
+    WriteBeta(queue, zeros);
+
+    if (mInitialized) {
+        compute_kernel::Bindings bindings;
+        bindings.Add(*mUniforms).Add(*mInput).Add(*mOutput).Add(*mGamma).Add(
+            *mBeta);
+        mBindGroup = mKernel.CreateBindGroup(bindings.GetEntries());
+    }
+    return true;
+}
+
+void RowNormalization::SetEpsilon(wgpu::Queue queue, float epsilon)
+{
+    mEpsilon = epsilon;
+    WriteParams(queue);
+}
+
+void RowNormalization::WriteParams(wgpu::Queue queue) const
+{
+    Params params {
+        .rows = mRows,
+        .cols = mCols,
+        .epsilon = mEpsilon,
+    };
+    mUniforms->Write(queue, mParamsOffset, params);
+}
+
+void RowNormalization::WriteInput(wgpu::Queue queue,
+                                  std::span<const float> values) const
+{
+    queue.WriteBuffer(
+        mInput->GetDataBuffer(), 0, values.data(), values.size_bytes());
+}
+
+void RowNormalization::WriteGamma(wgpu::Queue queue,
+                                  std::span<const float> values) const
+{
+    queue.WriteBuffer(
+        mGamma->GetDataBuffer(), 0, values.data(), values.size_bytes());
+}
+
+void RowNormalization::WriteBeta(wgpu::Queue queue,
+                                 std::span<const float> values) const
+{
+    queue.WriteBuffer(
+        mBeta->GetDataBuffer(), 0, values.data(), values.size_bytes());
+}
+
+void RowNormalization::Encode(wgpu::ComputePassEncoder pass) const
+{
+    pass.SetPipeline(mKernel.GetPipeline());
+    pass.SetBindGroup(0, mBindGroup);
+    dispatch::DispatchLinear(pass, static_cast<uint64_t>(mRows));
+}
+
+std::vector<float> RowNormalization::ReadOutput(wgpu::Instance instance) const
+{
+    return compute_kernel::ReadBuffer<float>(
+        instance,
+        mDevice,
+        mOutput->GetDataBuffer(),
+        static_cast<size_t>(mRows) * static_cast<size_t>(mCols));
+}
+
+Kind RowNormalization::GetKind() const
+{
+    return mKind;
+}
+
+int32_t RowNormalization::GetRows() const
+{
+    return mRows;
+}
+
+int32_t RowNormalization::GetCols() const
+{
+    return mCols;
+}
+
+wgpu::Buffer RowNormalization::GetInput() const
+{
+    return mInput->GetDataBuffer();
+}
+
+wgpu::Buffer RowNormalization::GetOutput() const
+{
+    return mOutput->GetDataBuffer();
+}
+
+bool RowNormalization::UsesSubgroups() const
+{
+    return mSubgroups;
+}
+
+}    // namespace normalization
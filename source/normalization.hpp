@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <webgpu/webgpu_cpp.h>
+
+#include "compute_kernel.hpp"
+#include "slang_compiler.hpp"
+#include "tensor_buffer.hpp"
+#include "uniform_buffer.hpp"
+
+namespace normalization
+{
+enum class Kind
+{
+    Softmax,
+    LayerNorm,
+};
+
+/// Name of the normalization.slang entry point implementing the kind.
+[[nodiscard]] const char* EntryPoint(Kind kind);
+
+/// CPU reference of a row-wise softmax of a [rows, cols] matrix.
+void ReferenceSoftmax(std::span<const float> input,
+                      std::span<float> output,
+                      int32_t rows,
+                      int32_t cols);
+
+/// CPU reference of a row-wise layer norm with per-column gamma and beta.
+void ReferenceLayerNorm(std::span<const float> input,
+                        std::span<const float> gamma,
+                        std::span<const float> beta,
+                        std::span<float> output,
+                        int32_t rows,
+                        int32_t cols,
+                        float epsilon);
+
+/**
+ * @brief Fused row-wise softmax or layer norm over RWTensorBuffer<float, int,
+ * int> operands.
+ *
+ * One workgroup normalizes one row, reading it once for its statistics and
+ * once more to write the result. Owns the input and output tensors of the
+ * current shape, and for layer norm gamma and beta, which default to ones
+ * and zeros.
+ */
+class RowNormalization
+{
+  public:
+    explicit RowNormalization(Kind kind);
+
+    /// Compiles the kind's entry point and creates its pipeline.
+    bool Initialize(wgpu::Device device,
+                    const slang_compiler::Compiler& compiler);
+
+    /**
+     * @brief Allocates the tensors for a [rows, cols] input.
+     * @return false if the shape is empty
+     */
+    bool Resize(wgpu::Queue queue, int32_t rows, int32_t cols);
+
+    /// Sets the layer-norm variance epsilon; the default is 1e-5.
+    void SetEpsilon(wgpu::Queue queue, float epsilon);
+
+    void WriteInput(wgpu::Queue queue, std::span<const float> values) const;
+    void WriteGamma(wgpu::Queue queue, std::span<const float> values) const;
+    void WriteBeta(wgpu::Queue queue, std::span<const float> values) const;
+
+    /// Records the dispatch into an open compute pass.
+    void Encode(wgpu::ComputePassEncoder pass) const;
+
+    [[nodiscard]] std::vector<float> ReadOutput(wgpu::Instance instance) const;
+
+    [[nodiscard]] Kind GetKind() const;
+    [[nodiscard]] int32_t GetRows() const;
+    [[nodiscard]] int32_t GetCols() const;
+    [[nodiscard]] wgpu::Buffer GetInput() const;
+    [[nodiscard]] wgpu::Buffer GetOutput() const;
+    [[nodiscard]] bool UsesSubgroups() const;
+
+  private:
+    void WriteParams(wgpu::Queue queue) const;
+
+    Kind mKind;
+    wgpu::Device mDevice {nullptr};
+    slang_compiler::SlangProgram mProgram;
+    compute_kernel::ComputeKernel mKernel;
+
+    std::optional<uniform_buffer::UniformBuffer> mUniforms;
+    std::optional<tensor_buffer::TensorBuffer> mInput;
+    std::optional<tensor_buffer::TensorBuffer> mOutput;
+    std::optional<tensor_buffer::TensorBuffer> mGamma;
+    std::optional<tensor_buffer::TensorBuffer> mBeta;
+    size_t mParamsOffset = 0;
+    wgpu::BindGroup mBindGroup {nullptr};
+
+    int32_t mRows = 0;
+    int32_t mCols = 0;
+    float mEpsilon = 1e-5f;
+    bool mSubgroups = false;
+    bool mInitialized = false;
+};
+
+}    // namespace normalization
@@ -0,0 +1,266 @@
+#include <algorithm>
+#include <array>
+#include <string>
+
+#include "permute.hpp"
+
+#include <tracy/Tracy.hpp>
+
+#include "dispatch.hpp"
+#include "logging_macros.h"
+#include "tensor_buffer.hpp"
+
+namespace permute
+{
+namespace
+{
+/// Host mirror of PermuteParams in permute.slang.
+struct Params
+{
+    int32_t inDims[kMaxRank];
+    int32_t order[kMaxRank];
+    int32_t rowAxis;
+    int32_t batchAxis0;
+    int32_t batchAxis1;
+    int32_t tilesX;
+    int32_t tilesY;
+};
+
+bool IsPermutation(std::span<const size_t> order, size_t rank)
+{
+    if (order.size() != rank) {
+        return false;
+    }
+    std::vector<bool> seen(rank, false);
+    for (size_t axis : order) {
+        if (axis >= rank || seen[axis]) {
+            return false;
+        }
+        seen[axis] = true;
+    }
+    return true;
+}
+
+int32_t CeilDiv(int32_t value, int32_t divisor)
+{
+    return (value + divisor - 1) / divisor;
+}
+}    // namespace
+
+std::optional<std::vector<int32_t>> PermutedDims(
+    std::span<const int32_t> dims, std::span<const size_t> order)
+{
+    if (!IsPermutation(order, dims.size())) {
+        LOG_ERROR("Invalid permutation of {} axes", dims.size());
+        return std::nullopt;
+    }
+    std::vector<int32_t> permuted(dims.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        permuted[i] = dims[order[i]];
+    }
+    return permuted;
+}
+
+Strategy Select(std::span<const int32_t> dims, std::span<const size_t> order)
+{
+    if (dims.empty() || order.empty()) {
+        return Strategy::Naive;
+    }
+    // Only a moved innermost axis makes the naive gather uncoalesced, and a
+    // tile spanning an axis of size 1 would leave most threads idle. A kept
+    // innermost axis moves whole vectors when they stay aligned.
+    const size_t last = dims.size() - 1;
+    if (order.back() == last) {
+        return dims[last] % kVectorWidth == 0 ? Strategy::Vector
+                                              : Strategy::Naive;
+    }
+    return dims[last] > 1 && dims[order.back()] > 1 ? Strategy::Tiled
+                                                    : Strategy::Naive;
+}
+
+std::vector<float> ReferencePermute(std::span<const int32_t> dims,
+                                    std::span<const float> values,
+                                    std::span<const size_t> order)
+{
+    auto outDims = PermutedDims(dims, order);
+    if (!outDims) {
+        return {};
+    }
+    const auto view = tensor_buffer::TensorView::Contiguous(dims).Permute(
+        order);
+    std::vector<float> out(values.size());
+    for (size_t i = 0; i < out.size(); ++i) {
+        int32_t rest = static_cast<int32_t>(i);
+        int32_t offset = 0;
+        for (size_t d = outDims->size(); d-- > 0;) {
+            offset += rest % (*outDims)[d] * view->strides[d];
+            rest /= (*outDims)[d];
+        }
+        out[i] = values[static_cast<size_t>(offset)];
+    }
+    return out;
+}
+
+bool Permuter::Initialize(wgpu::Device device,
+                          const slang_compiler::Compiler& compiler)
+{
+    ZoneScoped;
+    if (mInitialized) {
+        return true;
+    }
+    mDevice = device;
+    if (!InitializeKernel(compiler, "permuteTiled", mTiled)
+        || !InitializeKernel(compiler, "permuteVec4", mVector)
+        || !InitializeKernel(compiler, "permuteNaive", mNaive))
+    {
+        return false;
+    }
+    mInitialized = true;
+    return true;
+}
+
+bool Permuter::InitializeKernel(const slang_compiler::Compiler& compiler,
+                                const char* entryPoint,
+                                Kernel& kernel) const
+{
+    // The vector entry point binds the tensors as 16-byte words.
+    const bool vec4 = std::string(entryPoint) == "permuteVec4";
+    kernel.program = vec4
+        ? compiler.CompileFromSource(
+              "#define PERMUTE_VEC4 1\n#include \"permute.slang\"\n",
+              "permute_vec4",
+              entryPoint)
+        : compiler.CreateProgram("permute", entryPoint);
+    if (!kernel.program.program) {
+        return false;
+    }
+    auto* program = kernel.program.program.get();
+    auto uniformsInfo = uniform_buffer::ReflectUniformBuffer(program);
+    auto paramsOffset = uniform_buffer::ReflectUniformOffset(program, "params");
+    auto src = tensor_reflection::ReflectTensorBuffer(program, "src");
+    auto dst = tensor_reflection::ReflectTensorBuffer(program, "dst");
+    if (!uniformsInfo || !paramsOffset || !src || !dst) {
+        LOG_ERROR("permute.slang is missing parameters of {}", entryPoint);
+        return false;
+    }
+    kernel.uniforms = *uniformsInfo;
+    kernel.paramsOffset = *paramsOffset;
+    kernel.src = *src;
+    kernel.dst = *dst;
+
+    uniform_buffer::UniformBuffer uniforms(kernel.uniforms);
+    tensor_buffer::TensorBuffer in(kernel.src);
+    tensor_buffer::TensorBuffer out(kernel.dst);
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms).Add(in).Add(out);
+    kernel.kernel = compute_kernel::ComputeKernel(entryPoint);
+    return kernel.kernel.Initialize(mDevice,
+                                    kernel.program.compileToWGSL(),
+                                    entryPoint,
+                                    bindings.GetLayoutEntries());
+}
+
+bool Permuter::Encode(wgpu::ComputePassEncoder pass,
+                      wgpu::Buffer src,
+                      wgpu::Buffer dst,
+                      std::span<const int32_t> dims,
+                      std::span<const size_t> order,
+                      Strategy strategy) const
+{
+    ZoneScoped;
+    if (!mInitialized) {
+        LOG_ERROR("Permuter::Encode called before Initialize");
+        return false;
+    }
+    if (dims.empty() || dims.size() > kMaxRank
+        || std::ranges::any_of(dims, [](int32_t d) { return d <= 0; }))
+    {
+        LOG_ERROR("Permutations support 1 to {} non-empty dimensions",
+                  kMaxRank);
+        return false;
+    }
+    auto outDims = PermutedDims(dims, order);
+    if (!outDims) {
+        return false;
+    }
+    if (strategy == Strategy::Auto) {
+        strategy = Select(dims, order);
+    }
+
+    // Pad to four dimensions with leading axes of size 1.
+    const size_t lead = kMaxRank - dims.size();
+    std::array<int32_t, kMaxRank> inDims = {1, 1, 1, 1};
+    std::array<int32_t, kMaxRank> paddedOut = {1, 1, 1, 1};
+    Params params {};
+    for (size_t k = 0; k < kMaxRank; ++k) {
+        params.order[k] = static_cast<int32_t>(k);
+    }
+    for (size_t d = 0; d < dims.size(); ++d) {
+        inDims[lead + d] = dims[d];
+        paddedOut[lead + d] = (*outDims)[d];
+        params.order[lead + d] = static_cast<int32_t>(order[d] + lead);
+    }
+    std::copy(inDims.begin(), inDims.end(), params.inDims);
+
+    const auto rowAxis = static_cast<size_t>(params.order[kMaxRank - 1]);
+    if (strategy == Strategy::Tiled && rowAxis == kMaxRank - 1) {
+        LOG_ERROR("Tiled permutations need the innermost axis to move");
+        return false;
+    }
+    if (strategy == Strategy::Vector
+        && (rowAxis != kMaxRank - 1 || dims.back() % kVectorWidth != 0))
+    {
+        LOG_ERROR("Vector permutations need a kept innermost axis that is a "
+                  "multiple of {}",
+                  kVectorWidth);
+        return false;
+    }
+    std::array<size_t, 2> batchAxes = {0, 0};
+    size_t batchCount = 0;
+    for (size_t axis = 0; axis + 1 < kMaxRank; ++axis) {
+        if (axis != rowAxis && batchCount < batchAxes.size()) {
+            batchAxes[batchCount++] = axis;
+        }
+    }
+    params.rowAxis = static_cast<int32_t>(rowAxis);
+    params.batchAxis0 = static_cast<int32_t>(batchAxes[0]);
+    params.batchAxis1 = static_cast<int32_t>(batchAxes[1]);
+    params.tilesX = CeilDiv(inDims[kMaxRank - 1], kTile);
+    params.tilesY = CeilDiv(inDims[rowAxis], kTile);
+
+    const bool tiled = strategy == Strategy::Tiled;
+    const bool vector = strategy == Strategy::Vector;
+    const Kernel& kernel = tiled ? mTiled : (vector ? mVector : mNaive);
+    size_t count = 1;
+    for (int32_t dim : dims) {
+        count *= static_cast<size_t>(dim);
+    }
+    const size_t bytes = count * sizeof(float);
+
+    wgpu::Queue queue = mDevice.GetQueue();
+    uniform_buffer::UniformBuffer uniforms(kernel.uniforms);
+    uniforms.Initialize(mDevice);
+    tensor_buffer::TensorBuffer in(kernel.src);
+    tensor_buffer::TensorBuffer out(kernel.dst);
+    in.Initialize(uniforms, src, bytes);
+    out.Initialize(uniforms, dst, bytes);
+    in.WriteShape(queue, inDims);
+    out.WriteShape(queue, paddedOut);
+    uniforms.Write(queue, kernel.paramsOffset, params);
+
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms).Add(in).Add(out);
+    pass.SetPipeline(kernel.kernel.GetPipeline());
+    pass.SetBindGroup(0, kernel.kernel.CreateBindGroup(bindings.GetEntries()));
+
+    const uint64_t workgroups = tiled
+        ? static_cast<uint64_t>(params.tilesX)
+            * static_cast<uint64_t>(params.tilesY)
+            * static_cast<uint64_t>(inDims[batchAxes[0]])
+            * static_cast<uint64_t>(inDims[batchAxes[1]])
+        : dispatch::WorkgroupsFor(
+              vector ? count / kVectorWidth : count, kGroupSize);
+    return dispatch::DispatchLinear(pass, workgroups, tiled ? 1 : kGroupSize);
+}
+
+}    // namespace permute
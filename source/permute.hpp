@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <webgpu/webgpu_cpp.h>
+
+#include "compute_kernel.hpp"
+#include "slang_compiler.hpp"
+#include "tensor_reflection.hpp"
+#include "uniform_buffer.hpp"
+
+namespace permute
+{
+/// Tile edge, rows per thread pass and workgroup size; mirror
+/// permute.slang.
+inline constexpr int32_t kTile = 32;
+inline constexpr int32_t kTileRows = 8;
+inline constexpr uint32_t kGroupSize = kTile * kTileRows;
+inline constexpr size_t kMaxRank = 4;
+/// Elements moved per thread by Strategy::Vector.
+inline constexpr int32_t kVectorWidth = 4;
+
+enum class Strategy
+{
+    /// Tiled when the innermost axis moves, vector when it stays and is a
+    /// multiple of kVectorWidth, naive otherwise.
+    Auto,
+    /// One thread per output element.
+    Naive,
+    /// Transpose through groupshared tiles; needs the innermost axis to
+    /// move.
+    Tiled,
+    /// 128-bit loads and stores of kVectorWidth consecutive elements; needs
+    /// the innermost axis to stay and be a multiple of kVectorWidth.
+    Vector,
+};
+
+/**
+ * @brief Dimensions of `dims` permuted by `order`, where axis i of the
+ * result is axis order[i] of the source.
+ * @return nullopt if `order` is not a permutation of the axes
+ */
+[[nodiscard]] std::optional<std::vector<int32_t>> PermutedDims(
+    std::span<const int32_t> dims, std::span<const size_t> order);
+
+/// Kernel that Strategy::Auto picks for a valid permutation.
+[[nodiscard]] Strategy Select(std::span<const int32_t> dims,
+                              std::span<const size_t> order);
+
+/// CPU reference of a permutation of a row-major tensor.
+[[nodiscard]] std::vector<float> ReferencePermute(
+    std::span<const int32_t> dims,
+    std::span<const float> values,
+    std::span<const size_t> order);
+
+/**
+ * @brief Materializes axis permutations of row-major float tensors of up
+ * to kMaxRank dimensions.
+ */
+class Permuter
+{
+  public:
+    /// Compiles the tiled, vector and naive kernels.
+    bool Initialize(wgpu::Device device,
+                    const slang_compiler::Compiler& compiler);
+
+    /**
+     * @brief Records the permutation of `src` into `dst`, which must not
+     * alias it.
+     * @param dims Dimensions of the source, outermost first.
+     * @param order Axis i of the output is axis order[i] of the source.
+     * @return false if the request is invalid or nothing was dispatched
+     */
+    [[nodiscard]] bool Encode(wgpu::ComputePassEncoder pass,
+                              wgpu::Buffer src,
+                              wgpu::Buffer dst,
+                              std::span<const int32_t> dims,
+                              std::span<const size_t> order,
+                              Strategy strategy = Strategy::Auto) const;
+
+  private:
+    struct Kernel
+    {
+        slang_compiler::SlangProgram program;
+        compute_kernel::ComputeKernel kernel;
+        uniform_buffer::UniformBufferReflection uniforms;
+        size_t paramsOffset = 0;
+        tensor_reflection::TensorBufferReflection src;
+        tensor_reflection::TensorBufferReflection dst;
+    };
+
+    bool InitializeKernel(const slang_compiler::Compiler& compiler,
+                          const char* entryPoint,
+                          Kernel& kernel) const;
+
+    wgpu::Device mDevice {nullptr};
+    Kernel mTiled;
+    Kernel mVector;
+    Kernel mNaive;
+    bool mInitialized = false;
+};
+
+}    // namespace permute
@@ -35,8 +35,8 @@ void PrintBuffer::Initialize(wgpu::Device device,
         .size = byteSize,
         .mappedAtCreation = false,
     };
-    mBuffer = device.CreateBuffer(&desc);
-    mEntry.buffer = mBuffer;
+    mBuffer = gpu_memory::CreateBuffer(device, desc);
+    mEntry.buffer = mBuffer.Get();
     mEntry.offset = 0;
     mEntry.size = byteSize;
 
@@ -60,7 +60,7 @@ size_t PrintBuffer::GetEntryCount() const
 
 wgpu::Buffer PrintBuffer::GetBuffer() const
 {
-    return mBuffer;
+    return mBuffer.Get();
 }
 
 }    // namespace print_buffer
@@ -2,6 +2,7 @@
 
 #include <webgpu/webgpu_cpp.h>
 
+#include "gpu_memory.hpp"
 #include "print_reflection.hpp"
 
 namespace print_buffer
@@ -29,7 +30,7 @@ class PrintBuffer
     print_reflection::PrintBufferReflection mReflection;
     wgpu::ShaderStage mVisibility;
 
-    wgpu::Buffer mBuffer {nullptr};
+    gpu_memory::TrackedBuffer mBuffer;
 
     wgpu::BindGroupLayoutEntry mLayoutEntry {};
     wgpu::BindGroupEntry mEntry {};
@@ -0,0 +1,420 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <string>
+
+#include "quantization.hpp"
+
+#include <fmt/format.h>
+#include <tracy/Tracy.hpp>
+
+#include "dispatch.hpp"
+#include "logging_macros.h"
+#include "subgroups.hpp"
+
+namespace quantization
+{
+namespace
+{
+/// Host mirror of GemmParams in gemm.slang.
+struct Params
+{
+    int32_t m;
+    int32_t n;
+    int32_t k;
+    float alpha;
+    float beta;
+};
+
+int32_t CeilDiv(int32_t value, int32_t divisor)
+{
+    return (value + divisor - 1) / divisor;
+}
+
+int32_t WordsPerRow(int32_t cols, Format format)
+{
+    return CeilDiv(cols, ValuesPerWord(format));
+}
+
+int32_t Groups(int32_t cols, int32_t groupSize)
+{
+    return CeilDiv(cols, groupSize);
+}
+
+size_t FormatIndex(Format format)
+{
+    return format == Format::Int8 ? 0 : 1;
+}
+
+gpu_memory::TrackedBuffer CreateStorage(wgpu::Device device,
+                                        const char* label,
+                                        const void* data,
+                                        size_t bytes)
+{
+    wgpu::BufferDescriptor desc = {
+        .label = label,
+        .usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst,
+        .size = tensor_buffer::PaddedBytes(bytes),
+        .mappedAtCreation = false,
+    };
+    gpu_memory::TrackedBuffer buffer = gpu_memory::CreateBuffer(device, desc);
+    device.GetQueue().WriteBuffer(buffer.Get(), 0, data, bytes);
+    return buffer;
+}
+}    // namespace
+
+uint32_t BitsOf(Format format)
+{
+    return format == Format::Int8 ? 8 : 4;
+}
+
+int32_t ValuesPerWord(Format format)
+{
+    return static_cast<int32_t>(32 / BitsOf(format));
+}
+
+int32_t QuantizedWeights::WordsPerRow() const
+{
+    return quantization::WordsPerRow(cols, format);
+}
+
+int32_t QuantizedWeights::Groups() const
+{
+    return quantization::Groups(cols, groupSize);
+}
+
+std::optional<QuantizedWeights> Quantize(std::span<const float> values,
+                                         int32_t rows,
+                                         int32_t cols,
+                                         Format format,
+                                         int32_t groupSize)
+{
+    ZoneScoped;
+    if (groupSize == 0) {
+        groupSize = cols;
+    }
+    if (rows <= 0 || cols <= 0 || groupSize <= 0
+        || values.size()
+            != static_cast<size_t>(rows) * static_cast<size_t>(cols))
+    {
+        LOG_ERROR("Cannot quantize {} values as [{}, {}] in groups of {}",
+                  values.size(),
+                  rows,
+                  cols,
+                  groupSize);
+        return std::nullopt;
+    }
+    // Whole words per group let the kernels unpack a word with one scale.
+    if (groupSize < cols && groupSize % ValuesPerWord(format) != 0) {
+        LOG_ERROR("Group size {} is not a multiple of {} values per word",
+                  groupSize,
+                  ValuesPerWord(format));
+        return std::nullopt;
+    }
+
+    QuantizedWeights result;
+    result.format = format;
+    result.rows = rows;
+    result.cols = cols;
+    result.groupSize = groupSize;
+    const auto wordsPerRow = static_cast<size_t>(result.WordsPerRow());
+    const auto groups = static_cast<size_t>(result.Groups());
+    const auto width = static_cast<size_t>(cols);
+    const auto group = static_cast<size_t>(groupSize);
+    const auto perWord = static_cast<size_t>(ValuesPerWord(format));
+    const uint32_t bits = BitsOf(format);
+    const auto levels = static_cast<float>((1u << bits) - 1);
+    result.words.assign(static_cast<size_t>(rows) * wordsPerRow, 0);
+    result.scales.resize(static_cast<size_t>(rows) * groups);
+    result.zeros.resize(static_cast<size_t>(rows) * groups);
+
+    for (size_t r = 0; r < static_cast<size_t>(rows); ++r) {
+        for (size_t g = 0; g < groups; ++g) {
+            const size_t begin = g * group;
+            const size_t end = std::min(begin + group, width);
+            const auto row = values.subspan(r * width + begin, end - begin);
+            // Keeping 0 in range makes it exactly representable.
+            const float lo = std::min(0.0f, std::ranges::min(row));
+            const float hi = std::max(0.0f, std::ranges::max(row));
+            float scale = (hi - lo) / levels;
+            if (!(scale > 0.0f)) {
+                scale = 1.0f;
+            }
+            const float zero =
+                std::clamp(std::round(-lo / scale), 0.0f, levels);
+            result.scales[r * groups + g] = scale;
+            result.zeros[r * groups + g] = zero;
+
+            for (size_t k = begin; k < end; ++k) {
+                const float q = std::clamp(
+                    std::round(values[r * width + k] / scale) + zero,
+                    0.0f,
+                    levels);
+                const auto shift =
+                    static_cast<uint32_t>(k % perWord) * bits;
+                result.words[r * wordsPerRow + k / perWord] |=
+                    static_cast<uint32_t>(q) << shift;
+            }
+        }
+    }
+    return result;
+}
+
+std::vector<float> Dequantize(const QuantizedWeights& weights)
+{
+    const auto rows = static_cast<size_t>(weights.rows);
+    const auto cols = static_cast<size_t>(weights.cols);
+    const auto wordsPerRow = static_cast<size_t>(weights.WordsPerRow());
+    const auto groups = static_cast<size_t>(weights.Groups());
+    const auto group = static_cast<size_t>(weights.groupSize);
+    const auto perWord = static_cast<size_t>(ValuesPerWord(weights.format));
+    const uint32_t bits = BitsOf(weights.format);
+    const uint32_t mask = (1u << bits) - 1;
+
+    std::vector<float> values(rows * cols);
+    for (size_t r = 0; r < rows; ++r) {
+        for (size_t k = 0; k < cols; ++k) {
+            const uint32_t word = weights.words[r * wordsPerRow + k / perWord];
+            const uint32_t shift = static_cast<uint32_t>(k % perWord) * bits;
+            const auto q = static_cast<float>((word >> shift) & mask);
+            const size_t g = r * groups + k / group;
+            values[r * cols + k] =
+                (q - weights.zeros[g]) * weights.scales[g];
+        }
+    }
+    return values;
+}
+
+uint64_t DeviceWeights::Bytes() const
+{
+    return words.GetSize() + scales.GetSize() + zeros.GetSize();
+}
+
+DeviceWeights Upload(wgpu::Device device, const QuantizedWeights& weights)
+{
+    DeviceWeights result;
+    result.format = weights.format;
+    result.rows = weights.rows;
+    result.cols = weights.cols;
+    result.groupSize = weights.groupSize;
+    result.words = CreateStorage(device,
+                                 "quantized_words",
+                                 weights.words.data(),
+                                 weights.words.size() * sizeof(uint32_t));
+    result.scales = CreateStorage(device,
+                                  "quantized_scales",
+                                  weights.scales.data(),
+                                  weights.scales.size() * sizeof(float));
+    result.zeros = CreateStorage(device,
+                                 "quantized_zeros",
+                                 weights.zeros.data(),
+                                 weights.zeros.size() * sizeof(float));
+    return result;
+}
+
+std::optional<DeviceWeights> Load(wgpu::Device device,
+                                  std::span<const float> values,
+                                  int32_t rows,
+                                  int32_t cols,
+                                  Format format,
+                                  int32_t groupSize)
+{
+    auto weights = Quantize(values, rows, cols, format, groupSize);
+    if (!weights) {
+        return std::nullopt;
+    }
+    return Upload(device, *weights);
+}
+
+Matmul::Matmul(gemm::TileConfig config)
+    : mConfig(config)
+{
+}
+
+bool Matmul::Initialize(wgpu::Device device,
+                        const slang_compiler::Compiler& compiler)
+{
+    ZoneScoped;
+    if (mInitialized) {
+        return true;
+    }
+    mDevice = device;
+    mSubgroups = subgroups::Select(
+                     subgroups::Query(device), std::nullopt, kGemvGroupSize)
+        == subgroups::Path::Subgroups;
+    for (Format format : {Format::Int8, Format::Int4}) {
+        const size_t index = FormatIndex(format);
+        if (!InitializeKernel(compiler, format, "gemmQuantized", mGemm[index])
+            || !InitializeKernel(
+                compiler, format, "gemvQuantized", mGemv[index]))
+        {
+            return false;
+        }
+    }
+    mInitialized = true;
+    return true;
+}
+
+bool Matmul::InitializeKernel(const slang_compiler::Compiler& compiler,
+                              Format format,
+                              const char* entryPoint,
+                              Kernel& kernel) const
+{
+    const std::string source = fmt::format(
+                                   "#define QUANT_BITS {}\n"
+                                   "#define REDUCE_GROUP_SIZE {}\n"
+                                   "#define REDUCE_SUBGROUPS {}\n",
+                                   BitsOf(format),
+                                   kGemvGroupSize,
+                                   mSubgroups ? 1 : 0)
+        + gemm::ProgramSource(mConfig, "matmul_quantized.slang");
+    const std::string moduleName = fmt::format("matmul_q{}_{}{}x{}x{}",
+                                               BitsOf(format),
+                                               mSubgroups ? "subgroups_" : "",
+                                               mConfig.threadsX,
+                                               mConfig.threadsY,
+                                               mConfig.tileK);
+    kernel.program =
+        compiler.CompileFromSource(source, moduleName, entryPoint);
+    if (!kernel.program.program) {
+        return false;
+    }
+
+    auto* program = kernel.program.program.get();
+    auto uniformsInfo = uniform_buffer::ReflectUniformBuffer(program);
+    auto paramsOffset = uniform_buffer::ReflectUniformOffset(program, "params");
+    auto groupSizeOffset =
+        uniform_buffer::ReflectUniformOffset(program, "groupSize");
+    auto a = tensor_reflection::ReflectTensorBuffer(program, "a");
+    auto weights = tensor_reflection::ReflectTensorBuffer(program, "weights");
+    auto scales = tensor_reflection::ReflectTensorBuffer(program, "scales");
+    auto zeros = tensor_reflection::ReflectTensorBuffer(program, "zeros");
+    auto c = tensor_reflection::ReflectTensorBuffer(program, "c");
+    if (!uniformsInfo || !paramsOffset || !groupSizeOffset || !a || !weights
+        || !scales || !zeros || !c)
+    {
+        LOG_ERROR("matmul_quantized.slang is missing parameters of {}",
+                  entryPoint);
+        return false;
+    }
+    kernel.uniforms = *uniformsInfo;
+    kernel.paramsOffset = *paramsOffset;
+    kernel.groupSizeOffset = *groupSizeOffset;
+    kernel.a = *a;
+    kernel.weights = *weights;
+    kernel.scales = *scales;
+    kernel.zeros = *zeros;
+    kernel.c = *c;
+
+    uniform_buffer::UniformBuffer uniforms(kernel.uniforms);
+    tensor_buffer::TensorBuffer aBuffer(kernel.a);
+    tensor_buffer::TensorBuffer wordsBuffer(kernel.weights);
+    tensor_buffer::TensorBuffer scalesBuffer(kernel.scales);
+    tensor_buffer::TensorBuffer zerosBuffer(kernel.zeros);
+    tensor_buffer::TensorBuffer cBuffer(kernel.c);
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms)
+        .Add(aBuffer)
+        .Add(wordsBuffer)
+        .Add(scalesBuffer)
+        .Add(zerosBuffer)
+        .Add(cBuffer);
+    kernel.kernel = compute_kernel::ComputeKernel(entryPoint);
+    return kernel.kernel.Initialize(mDevice,
+                                    kernel.program.compileToWGSL(),
+                                    entryPoint,
+                                    bindings.GetLayoutEntries());
+}
+
+bool Matmul::Encode(wgpu::ComputePassEncoder pass,
+                    const tensor_buffer::BufferView& a,
+                    const DeviceWeights& weights,
+                    wgpu::Buffer c,
+                    Strategy strategy,
+                    float alpha,
+                    float beta) const
+{
+    ZoneScoped;
+    if (!mInitialized) {
+        LOG_ERROR("quantization::Matmul::Encode called before Initialize");
+        return false;
+    }
+    if (a.view.dims.size() != 2 || a.view.dims[1] != weights.cols) {
+        LOG_ERROR("Quantized matmul needs an [M, {}] operand", weights.cols);
+        return false;
+    }
+    const gemm::Shape shape {
+        .m = a.view.dims[0],
+        .n = weights.rows,
+        .k = weights.cols,
+    };
+    if (strategy == Strategy::Auto) {
+        strategy = shape.m <= kGemvMaxRows ? Strategy::Gemv : Strategy::Gemm;
+    }
+    const bool gemv = strategy == Strategy::Gemv;
+    const size_t index = FormatIndex(weights.format);
+    const Kernel& kernel = gemv ? mGemv[index] : mGemm[index];
+
+    const std::array<int32_t, 2> wordDims = {
+        weights.rows, WordsPerRow(weights.cols, weights.format)};
+    const std::array<int32_t, 2> groupDims = {
+        weights.rows, Groups(weights.cols, weights.groupSize)};
+    const std::array<int32_t, 2> cDims = {shape.m, shape.n};
+
+    wgpu::Queue queue = mDevice.GetQueue();
+    uniform_buffer::UniformBuffer uniforms(kernel.uniforms);
+    uniforms.Initialize(mDevice);
+    tensor_buffer::TensorBuffer aBuffer(kernel.a);
+    tensor_buffer::TensorBuffer wordsBuffer(kernel.weights);
+    tensor_buffer::TensorBuffer scalesBuffer(kernel.scales);
+    tensor_buffer::TensorBuffer zerosBuffer(kernel.zeros);
+    tensor_buffer::TensorBuffer cBuffer(kernel.c);
+    aBuffer.Initialize(uniforms, a.buffer, a.buffer.GetSize());
+    wordsBuffer.Initialize(
+        uniforms, weights.words.Get(), weights.words.GetSize());
+    scalesBuffer.Initialize(
+        uniforms, weights.scales.Get(), weights.scales.GetSize());
+    zerosBuffer.Initialize(
+        uniforms, weights.zeros.Get(), weights.zeros.GetSize());
+    cBuffer.Initialize(uniforms, c, c.GetSize());
+    aBuffer.WriteShape(queue, a.view);
+    wordsBuffer.WriteShape(queue, wordDims);
+    scalesBuffer.WriteShape(queue, groupDims);
+    zerosBuffer.WriteShape(queue, groupDims);
+    cBuffer.WriteShape(queue, cDims);
+
+    const Params params {
+        .m = shape.m,
+        .n = shape.n,
+        .k = shape.k,
+        .alpha = alpha,
+        .beta = beta,
+    };
+    uniforms.Write(queue, kernel.paramsOffset, params);
+    uniforms.Write(queue, kernel.groupSizeOffset, weights.groupSize);
+
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms)
+        .Add(aBuffer)
+        .Add(wordsBuffer)
+        .Add(scalesBuffer)
+        .Add(zerosBuffer)
+        .Add(cBuffer);
+    pass.SetPipeline(kernel.kernel.GetPipeline());
+    pass.SetBindGroup(0, kernel.kernel.CreateBindGroup(bindings.GetEntries()));
+
+    if (gemv) {
+        return dispatch::DispatchLinear(
+            pass,
+            static_cast<uint64_t>(shape.m) * static_cast<uint64_t>(shape.n));
+    }
+    // The kernel computes the [N, M] transpose.
+    wgpu::Limits limits {};
+    mDevice.GetLimits(&limits);
+    return dispatch::Dispatch(
+        pass,
+        gemm::Workgroups({.m = shape.n, .n = shape.m, .k = shape.k}, mConfig),
+        limits);
+}
+
+}    // namespace quantization
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <webgpu/webgpu_cpp.h>
+
+#include "compute_kernel.hpp"
+#include "gemm.hpp"
+#include "gpu_memory.hpp"
+#include "slang_compiler.hpp"
+#include "tensor_buffer.hpp"
+#include "tensor_reflection.hpp"
+#include "uniform_buffer.hpp"
+
+namespace quantization
+{
+/// Workgroup size of the GEMV kernel; mirrors REDUCE_GROUP_SIZE in
+/// matmul_quantized.slang.
+inline constexpr uint32_t kGemvGroupSize = 128;
+/// Largest M that Strategy::Auto computes with the GEMV kernel.
+inline constexpr int32_t kGemvMaxRows = 4;
+
+/// Unsigned integer width of the quantized values.
+enum class Format
+{
+    Int8,
+    Int4,
+};
+
+enum class Strategy
+{
+    /// GEMV for at most kGemvMaxRows rows of A, GEMM otherwise.
+    Auto,
+    Gemm,
+    Gemv,
+};
+
+[[nodiscard]] uint32_t BitsOf(Format format);
+
+/// Quantized values per 32-bit word: 4 for Int8, 8 for Int4.
+[[nodiscard]] int32_t ValuesPerWord(Format format);
+
+/**
+ * @brief A [rows, cols] weight matrix quantized along its rows.
+ *
+ * Value w[r][k] is (q - zeros[r][g]) * scales[r][g] with g = k / groupSize
+ * and q the unsigned integer in slot k % ValuesPerWord() of word
+ * r * WordsPerRow() + k / ValuesPerWord(), counting slots from the least
+ * significant bits. Rows are padded with zero slots to whole words.
+ */
+struct QuantizedWeights
+{
+    Format format = Format::Int8;
+    int32_t rows = 0;
+    int32_t cols = 0;
+    int32_t groupSize = 0;
+    std::vector<uint32_t> words;
+    std::vector<float> scales;    // [rows, Groups()]
+    std::vector<float> zeros;    // [rows, Groups()]
+
+    [[nodiscard]] int32_t WordsPerRow() const;
+    [[nodiscard]] int32_t Groups() const;
+};
+
+/**
+ * @brief Asymmetric min/max quantization of row-major [rows, cols] weights.
+ * @param groupSize Values sharing a scale and zero point along each row;
+ * 0 quantizes per channel (one group per row). Must be a multiple of
+ * ValuesPerWord(format) unless it covers the row.
+ * @return nullopt if the sizes are invalid
+ */
+[[nodiscard]] std::optional<QuantizedWeights> Quantize(
+    std::span<const float> values,
+    int32_t rows,
+    int32_t cols,
+    Format format,
+    int32_t groupSize = 0);
+
+/// CPU expansion of the weights back to row-major floats.
+[[nodiscard]] std::vector<float> Dequantize(const QuantizedWeights& weights);
+
+/// Quantized weights resident on a device.
+struct DeviceWeights
+{
+    Format format = Format::Int8;
+    int32_t rows = 0;
+    int32_t cols = 0;
+    int32_t groupSize = 0;
+    gpu_memory::TrackedBuffer words;
+    gpu_memory::TrackedBuffer scales;
+    gpu_memory::TrackedBuffer zeros;
+
+    /// Bytes of the packed words, scales and zero points.
+    [[nodiscard]] uint64_t Bytes() const;
+};
+
+/// Uploads quantized weights.
+[[nodiscard]] DeviceWeights Upload(wgpu::Device device,
+                                   const QuantizedWeights& weights);
+
+/**
+ * @brief Quantize-on-load: quantizes float weights on the host and uploads
+ * only the packed form.
+ */
+[[nodiscard]] std::optional<DeviceWeights> Load(wgpu::Device device,
+                                                std::span<const float> values,
+                                                int32_t rows,
+                                                int32_t cols,
+                                                Format format,
+                                                int32_t groupSize = 0);
+
+/**
+ * @brief C = alpha * A x W^T + beta * C for f32 A: [M, K] and quantized
+ * weights W: [N, K], as in a linear layer.
+ *
+ * Weights are dequantized in registers, so they are read 4x (Int8) or 8x
+ * (Int4) narrower than f32. The GEMM stages W as the tiled core's A
+ * operand, which reads whole packed words; the GEMV gives each output a
+ * workgroup, for the few rows of token-by-token decoding.
+ */
+class Matmul
+{
+  public:
+    explicit Matmul(gemm::TileConfig config = {});
+
+    /// Compiles the GEMM and GEMV kernels for both formats.
+    bool Initialize(wgpu::Device device,
+                    const slang_compiler::Compiler& compiler);
+
+    /**
+     * @brief Records the product into `pass`.
+     * @param a [M, K] view of an f32 buffer.
+     * @param c Buffer holding the contiguous f32 [M, N] output.
+     * @return false if the operands do not multiply or nothing was
+     * dispatched
+     */
+    [[nodiscard]] bool Encode(wgpu::ComputePassEncoder pass,
+                              const tensor_buffer::BufferView& a,
+                              const DeviceWeights& weights,
+                              wgpu::Buffer c,
+                              Strategy strategy = Strategy::Auto,
+                              float alpha = 1.0f,
+                              float beta = 0.0f) const;
+
+  private:
+    struct Kernel
+    {
+        slang_compiler::SlangProgram program;
+        compute_kernel::ComputeKernel kernel;
+        uniform_buffer::UniformBufferReflection uniforms;
+        size_t paramsOffset = 0;
+        size_t groupSizeOffset = 0;
+        tensor_reflection::TensorBufferReflection a;
+        tensor_reflection::TensorBufferReflection weights;
+        tensor_reflection::TensorBufferReflection scales;
+        tensor_reflection::TensorBufferReflection zeros;
+        tensor_reflection::TensorBufferReflection c;
+    };
+
+    bool InitializeKernel(const slang_compiler::Compiler& compiler,
+                          Format format,
+                          const char* entryPoint,
+                          Kernel& kernel) const;
+
+    gemm::TileConfig mConfig;
+    wgpu::Device mDevice {nullptr};
+    bool mSubgroups = false;
+    // Indexed by Format.
+    Kernel mGemm[2];
+    Kernel mGemv[2];
+    bool mInitialized = false;
+};
+
+}    // namespace quantization
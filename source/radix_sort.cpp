@@ -0,0 +1,322 @@
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <string>
+#include <utility>
+
+#include "radix_sort.hpp"
+
+#include <fmt/format.h>
+#include <tracy/Tracy.hpp>
+
+#include "dispatch.hpp"
+#include "logging_macros.h"
+#include "tensor_buffer.hpp"
+
+namespace radix_sort
+{
+namespace
+{
+/// Host mirror of SortParams in radix_sort.slang.
+struct Params
+{
+    uint32_t count;
+    uint32_t blocks;
+    uint32_t shift;
+    uint32_t floatKeys;
+    uint32_t invert;
+};
+
+constexpr uint32_t kDigits = 1u << kDigitBits;
+
+uint32_t KeyMask(uint32_t keyBits)
+{
+    return keyBits >= 32 ? 0xffffffffu : (1u << keyBits) - 1u;
+}
+
+/// Mirrors encodeFloat in radix_sort.slang.
+uint32_t EncodeFloat(uint32_t bits)
+{
+    return bits ^ ((bits & 0x80000000u) != 0 ? 0xffffffffu : 0x80000000u);
+}
+}    // namespace
+
+void ReferenceSort(std::vector<uint32_t>& keys,
+                   std::vector<uint32_t>& values,
+                   KeyType type,
+                   Order order,
+                   uint32_t keyBits)
+{
+    const uint32_t mask = type == KeyType::Float ? 0xffffffffu
+                                                 : KeyMask(keyBits);
+    std::vector<uint32_t> sortable(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        uint32_t key = type == KeyType::Float ? EncodeFloat(keys[i]) : keys[i];
+        key &= mask;
+        sortable[i] = order == Order::Descending ? key ^ mask : key;
+    }
+    std::vector<size_t> permutation(keys.size());
+    std::iota(permutation.begin(), permutation.end(), size_t {0});
+    std::stable_sort(permutation.begin(),
+                     permutation.end(),
+                     [&](size_t a, size_t b)
+                     { return sortable[a] < sortable[b]; });
+
+    std::vector<uint32_t> sortedKeys(keys.size());
+    std::vector<uint32_t> sortedValues(values.size());
+    for (size_t i = 0; i < permutation.size(); ++i) {
+        sortedKeys[i] = keys[permutation[i]];
+        sortedValues[i] = values[permutation[i]];
+    }
+    keys = std::move(sortedKeys);
+    values = std::move(sortedValues);
+}
+
+Sorter::Sorter(std::optional<subgroups::Path> path)
+    : mRequestedPath(path)
+    , mScanner(scan::Element::Uint, path)
+{
+}
+
+bool Sorter::Initialize(wgpu::Device device,
+                        const slang_compiler::Compiler& compiler)
+{
+    ZoneScoped;
+    if (mInitialized) {
+        return true;
+    }
+    mDevice = device;
+    const std::optional<subgroups::Path> path = subgroups::Select(
+        subgroups::Query(device), mRequestedPath, kGroupSize);
+    if (!path || !mScanner.Initialize(device, compiler)) {
+        return false;
+    }
+    mPath = *path;
+    mUnusedCounts = CreateScratch("radix_sort_unused_counts", 1);
+
+    if (!InitializeKernel(compiler, "sortEncode", mEncode)
+        || !InitializeKernel(compiler, "sortDecode", mDecode)
+        || !InitializeKernel(compiler, "sortHistogram", mHistogram)
+        || !InitializeKernel(compiler, "sortScatter", mScatter))
+    {
+        return false;
+    }
+    mInitialized = true;
+    return true;
+}
+
+bool Sorter::InitializeKernel(const slang_compiler::Compiler& compiler,
+                              const char* entryPoint,
+                              Kernel& kernel) const
+{
+    const std::string source = fmt::format(
+        "#define SCAN_GROUP_SIZE {}\n"
+        "#define SCAN_SUBGROUPS {}\n"
+        "#include \"radix_sort.slang\"\n",
+        kGroupSize,
+        mPath == subgroups::Path::Subgroups ? 1 : 0);
+    kernel.program = compiler.CompileFromSource(
+        source,
+        fmt::format("radix_sort_{}", subgroups::PathName(mPath)),
+        entryPoint);
+    if (!kernel.program.program) {
+        return false;
+    }
+
+    auto* program = kernel.program.program.get();
+    auto uniformsInfo = uniform_buffer::ReflectUniformBuffer(program);
+    auto paramsOffset = uniform_buffer::ReflectUniformOffset(program, "params");
+    auto keysIn = tensor_reflection::ReflectTensorBuffer(program, "keysIn");
+    auto valuesIn = tensor_reflection::ReflectTensorBuffer(program, "valuesIn");
+    auto keysOut = tensor_reflection::ReflectTensorBuffer(program, "keysOut");
+    auto valuesOut =
+        tensor_reflection::ReflectTensorBuffer(program, "valuesOut");
+    auto counts = tensor_reflection::ReflectTensorBuffer(program, "counts");
+    if (!uniformsInfo || !paramsOffset || !keysIn || !valuesIn || !keysOut
+        || !valuesOut || !counts)
+    {
+        LOG_ERROR("radix_sort.slang is missing parameters of {}", entryPoint);
+        return false;
+    }
+    kernel.uniforms = *uniformsInfo;
+    kernel.paramsOffset = *paramsOffset;
+    kernel.keysIn = *keysIn;
+    kernel.valuesIn = *valuesIn;
+    kernel.keysOut = *keysOut;
+    kernel.valuesOut = *valuesOut;
+    kernel.counts = *counts;
+
+    uniform_buffer::UniformBuffer uniforms(kernel.uniforms);
+    tensor_buffer::TensorBuffer keysInBuffer(kernel.keysIn);
+    tensor_buffer::TensorBuffer valuesInBuffer(kernel.valuesIn);
+    tensor_buffer::TensorBuffer keysOutBuffer(kernel.keysOut);
+    tensor_buffer::TensorBuffer valuesOutBuffer(kernel.valuesOut);
+    tensor_buffer::TensorBuffer countsBuffer(kernel.counts);
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms)
+        .Add(keysInBuffer)
+        .Add(valuesInBuffer)
+        .Add(keysOutBuffer)
+        .Add(valuesOutBuffer)
+        .Add(countsBuffer);
+    kernel.kernel = compute_kernel::ComputeKernel(entryPoint);
+    return kernel.kernel.Initialize(mDevice,
+                                    kernel.program.compileToWGSL(),
+                                    entryPoint,
+                                    bindings.GetLayoutEntries());
+}
+
+bool Sorter::Encode(wgpu::ComputePassEncoder pass,
+                    wgpu::Buffer keys,
+                    wgpu::Buffer values,
+                    wgpu::Buffer sortedKeys,
+                    wgpu::Buffer sortedValues,
+                    uint32_t count,
+                    KeyType type,
+                    Order order,
+                    uint32_t keyBits) const
+{
+    ZoneScoped;
+    if (!mInitialized) {
+        LOG_ERROR("Sorter::Encode called before Initialize");
+        return false;
+    }
+    if (count == 0 || keyBits == 0 || keyBits > 32) {
+        LOG_ERROR("Invalid sort of {} keys of {} bits", count, keyBits);
+        return false;
+    }
+    if (type == KeyType::Float) {
+        keyBits = 32;
+    }
+
+    // The passes ping-pong between two scratch pairs, so the caller's
+    // buffers are only touched by the first and the last dispatch. The
+    // recorded bind groups keep the scratch buffers alive until the pass
+    // has executed.
+    const uint32_t blocks = (count + kBlockLength - 1) / kBlockLength;
+    const size_t countElements = static_cast<size_t>(kDigits) * blocks;
+    std::array<gpu_memory::TrackedBuffer, 2> scratchKeys = {
+        CreateScratch("radix_sort_keys", count),
+        CreateScratch("radix_sort_keys", count)};
+    std::array<gpu_memory::TrackedBuffer, 2> scratchValues = {
+        CreateScratch("radix_sort_values", count),
+        CreateScratch("radix_sort_values", count)};
+    gpu_memory::TrackedBuffer digitCounts =
+        CreateScratch("radix_sort_counts", countElements);
+    gpu_memory::TrackedBuffer digitOffsets =
+        CreateScratch("radix_sort_offsets", countElements);
+
+    Step step;
+    step.count = count;
+    step.blocks = blocks;
+    step.floatKeys = type == KeyType::Float ? 1 : 0;
+    step.invert = order == Order::Descending ? KeyMask(keyBits) : 0;
+    const uint64_t elementGroups = dispatch::WorkgroupsFor(count, kGroupSize);
+
+    step.keysIn = keys;
+    step.valuesIn = values;
+    step.keysOut = scratchKeys[0].Get();
+    step.valuesOut = scratchValues[0].Get();
+    step.counts = mUnusedCounts.Get();
+    if (!EncodeKernel(pass, mEncode, step, elementGroups)) {
+        return false;
+    }
+
+    size_t current = 0;
+    for (uint32_t shift = 0; shift < keyBits; shift += kDigitBits) {
+        step.keysIn = scratchKeys[current].Get();
+        step.valuesIn = scratchValues[current].Get();
+        step.keysOut = scratchKeys[1 - current].Get();
+        step.valuesOut = scratchValues[1 - current].Get();
+        step.shift = shift;
+        step.counts = digitCounts.Get();
+        if (!EncodeKernel(pass, mHistogram, step, blocks)
+            || !mScanner.Encode(pass,
+                                digitCounts.Get(),
+                                digitOffsets.Get(),
+                                1,
+                                static_cast<int32_t>(countElements),
+                                scan::Kind::Exclusive))
+        {
+            return false;
+        }
+        step.counts = digitOffsets.Get();
+        if (!EncodeKernel(pass, mScatter, step, blocks)) {
+            return false;
+        }
+        current = 1 - current;
+    }
+
+    step.keysIn = scratchKeys[current].Get();
+    step.valuesIn = scratchValues[current].Get();
+    step.keysOut = sortedKeys;
+    step.valuesOut = sortedValues;
+    step.counts = mUnusedCounts.Get();
+    return EncodeKernel(pass, mDecode, step, elementGroups);
+}
+
+bool Sorter::EncodeKernel(wgpu::ComputePassEncoder pass,
+                          const Kernel& kernel,
+                          const Step& step,
+                          uint64_t workgroups) const
+{
+    wgpu::Queue queue = mDevice.GetQueue();
+    uniform_buffer::UniformBuffer uniforms(kernel.uniforms);
+    uniforms.Initialize(mDevice);
+    tensor_buffer::TensorBuffer keysIn(kernel.keysIn);
+    tensor_buffer::TensorBuffer valuesIn(kernel.valuesIn);
+    tensor_buffer::TensorBuffer keysOut(kernel.keysOut);
+    tensor_buffer::TensorBuffer valuesOut(kernel.valuesOut);
+    tensor_buffer::TensorBuffer counts(kernel.counts);
+    keysIn.Initialize(uniforms, step.keysIn, step.keysIn.GetSize());
+    valuesIn.Initialize(uniforms, step.valuesIn, step.valuesIn.GetSize());
+    keysOut.Initialize(uniforms, step.keysOut, step.keysOut.GetSize());
+    valuesOut.Initialize(uniforms, step.valuesOut, step.valuesOut.GetSize());
+    counts.Initialize(uniforms, step.counts, step.counts.GetSize());
+    const std::array<int32_t, 1> dims = {static_cast<int32_t>(step.count)};
+    const std::array<int32_t, 1> countDims = {
+        static_cast<int32_t>(kDigits * step.blocks)};
+    keysIn.WriteShape(queue, dims);
+    valuesIn.WriteShape(queue, dims);
+    keysOut.WriteShape(queue, dims);
+    valuesOut.WriteShape(queue, dims);
+    counts.WriteShape(queue, countDims);
+    const Params params {
+        .count = step.count,
+        .blocks = step.blocks,
+        .shift = step.shift,
+        .floatKeys = step.floatKeys,
+        .invert = step.invert,
+    };
+    uniforms.Write(queue, kernel.paramsOffset, params);
+
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms)
+        .Add(keysIn)
+        .Add(valuesIn)
+        .Add(keysOut)
+        .Add(valuesOut)
+        .Add(counts);
+    pass.SetPipeline(kernel.kernel.GetPipeline());
+    pass.SetBindGroup(0, kernel.kernel.CreateBindGroup(bindings.GetEntries()));
+    return dispatch::DispatchLinear(pass, workgroups, kGroupSize);
+}
+
+gpu_memory::TrackedBuffer Sorter::CreateScratch(const char* label,
+                                                size_t elements) const
+{
+    wgpu::BufferDescriptor desc = {
+        .label = label,
+        .usage = wgpu::BufferUsage::Storage,
+        .size = tensor_buffer::PaddedBytes(elements * sizeof(uint32_t)),
+        .mappedAtCreation = false,
+    };
+    return gpu_memory::CreateBuffer(mDevice, desc);
+}
+
+subgroups::Path Sorter::GetPath() const
+{
+    return mPath;
+}
+
+}    // namespace radix_sort
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <webgpu/webgpu_cpp.h>
+
+#include "compute_kernel.hpp"
+#include "gpu_memory.hpp"
+#include "scan.hpp"
+#include "slang_compiler.hpp"
+#include "subgroups.hpp"
+#include "tensor_reflection.hpp"
+#include "uniform_buffer.hpp"
+
+namespace radix_sort
+{
+/// Workgroup size of the sort kernels; shared with scan::kGroupSize.
+inline constexpr uint32_t kGroupSize = scan::kGroupSize;
+/// Key bits sorted per pass; mirrors kSortDigitBits in radix_sort.slang.
+inline constexpr uint32_t kDigitBits = 4;
+/// Elements per workgroup of a pass; mirrors kSortBlockLength.
+inline constexpr uint32_t kBlockLength = 4 * kGroupSize;
+
+enum class KeyType
+{
+    Uint,
+    /// Keys are the bits of floats; NaNs sort past the infinities.
+    Float,
+};
+
+enum class Order
+{
+    Ascending,
+    Descending,
+};
+
+/// CPU reference: the stable sort of `keys` carrying `values` along.
+/// Only the low `keyBits` bits of uint keys are compared.
+void ReferenceSort(std::vector<uint32_t>& keys,
+                   std::vector<uint32_t>& values,
+                   KeyType type,
+                   Order order,
+                   uint32_t keyBits = 32);
+
+/**
+ * @brief Stable radix sort of 32-bit keys with 32-bit values on the GPU.
+ *
+ * Each pass of kDigitBits bits counts the digits of every block, scans the
+ * counts with a scan::Scanner and scatters every element to its offset plus
+ * its rank within the block. The passes need no cross-workgroup
+ * synchronization, so they are plain dispatches within one compute pass.
+ *
+ * Values are opaque 32-bit words, e.g. int32 indices or float bits.
+ */
+class Sorter
+{
+  public:
+    /// `path` overrides subgroups::Select() for the in-block ranking.
+    explicit Sorter(std::optional<subgroups::Path> path = std::nullopt);
+
+    /// Fails if the subgroup path is requested but not usable.
+    bool Initialize(wgpu::Device device,
+                    const slang_compiler::Compiler& compiler);
+
+    /**
+     * @brief Records the sort of the first `count` elements of `keys` and
+     * `values` into `sortedKeys` and `sortedValues`.
+     *
+     * The inputs are only read, and the outputs may alias them. Uint keys
+     * are sorted by their low `keyBits` bits, which saves a pass per
+     * kDigitBits bits left out; float keys always use all 32.
+     * @return false if `count` is 0 or `keyBits` is out of range
+     */
+    [[nodiscard]] bool Encode(wgpu::ComputePassEncoder pass,
+                              wgpu::Buffer keys,
+                              wgpu::Buffer values,
+                              wgpu::Buffer sortedKeys,
+                              wgpu::Buffer sortedValues,
+                              uint32_t count,
+                              KeyType type,
+                              Order order,
+                              uint32_t keyBits = 32) const;
+
+    [[nodiscard]] subgroups::Path GetPath() const;
+
+  private:
+    struct Kernel
+    {
+        slang_compiler::SlangProgram program;
+        compute_kernel::ComputeKernel kernel;
+        uniform_buffer::UniformBufferReflection uniforms;
+        size_t paramsOffset = 0;
+        tensor_reflection::TensorBufferReflection keysIn;
+        tensor_reflection::TensorBufferReflection valuesIn;
+        tensor_reflection::TensorBufferReflection keysOut;
+        tensor_reflection::TensorBufferReflection valuesOut;
+        tensor_reflection::TensorBufferReflection counts;
+    };
+
+    /// Buffers and parameters of one dispatch.
+    struct Step
+    {
+        wgpu::Buffer keysIn;
+        wgpu::Buffer valuesIn;
+        wgpu::Buffer keysOut;
+        wgpu::Buffer valuesOut;
+        wgpu::Buffer counts;
+        uint32_t count = 0;
+        uint32_t blocks = 0;
+        uint32_t shift = 0;
+        uint32_t floatKeys = 0;
+        uint32_t invert = 0;
+    };
+
+    bool InitializeKernel(const slang_compiler::Compiler& compiler,
+                          const char* entryPoint,
+                          Kernel& kernel) const;
+
+    [[nodiscard]] bool EncodeKernel(wgpu::ComputePassEncoder pass,
+                                    const Kernel& kernel,
+                                    const Step& step,
+                                    uint64_t workgroups) const;
+
+    gpu_memory::TrackedBuffer CreateScratch(const char* label,
+                                            size_t elements) const;
+
+    std::optional<subgroups::Path> mRequestedPath;
+    subgroups::Path mPath = subgroups::Path::Shared;
+    wgpu::Device mDevice {nullptr};
+    scan::Scanner mScanner;
+    Kernel mEncode;
+    Kernel mDecode;
+    Kernel mHistogram;
+    Kernel mScatter;
+    // Bound as the counts of sortEncode and sortDecode, which do not use
+    // them.
+    gpu_memory::TrackedBuffer mUnusedCounts;
+    bool mInitialized = false;
+};
+
+}    // namespace radix_sort
@@ -0,0 +1,392 @@
+#include <algorithm>
+#include <array>
+#include <string>
+
+#include "reduction.hpp"
+
+#include <fmt/format.h>
+#include <tracy/Tracy.hpp>
+
+#include "dispatch.hpp"
+#include "logging_macros.h"
+#include "tensor_buffer.hpp"
+
+namespace reduction
+{
+namespace
+{
+/// Operator codes of reduction.slang; mean is a scaled sum.
+constexpr int32_t kOpSum = 0;
+constexpr int32_t kOpMax = 1;
+constexpr int32_t kOpMin = 2;
+constexpr int32_t kOpArgmax = 3;
+
+/// Host mirror of ReduceParams in reduce.slang.
+struct Params
+{
+    int32_t outer;
+    int32_t length;
+    int32_t inner;
+    int32_t parts;
+    int32_t chunk;
+    int32_t op;
+    int32_t readIndices;
+    float scale;
+};
+
+int32_t OpCode(Op op)
+{
+    switch (op) {
+        case Op::Max:
+            return kOpMax;
+        case Op::Min:
+            return kOpMin;
+        case Op::Argmax:
+            return kOpArgmax;
+        default:
+            return kOpSum;
+    }
+}
+
+int32_t ChunkFor(const AxisView& view)
+{
+    return view.inner == 1 ? kRowChunk : kColumnChunk;
+}
+
+size_t ElementCount(const AxisView& view)
+{
+    return static_cast<size_t>(view.outer) * static_cast<size_t>(view.length)
+        * static_cast<size_t>(view.inner);
+}
+
+/// Pairs of [first, last] axes that form contiguous runs.
+std::vector<std::array<size_t, 2>> AxisRuns(std::span<const size_t> axes)
+{
+    std::vector<std::array<size_t, 2>> runs;
+    for (size_t axis : axes) {
+        if (!runs.empty() && runs.back()[1] + 1 == axis) {
+            runs.back()[1] = axis;
+        } else {
+            runs.push_back({axis, axis});
+        }
+    }
+    return runs;
+}
+}    // namespace
+
+AxisView ViewAxes(std::span<const int32_t> dims, size_t first, size_t last)
+{
+    AxisView view;
+    for (size_t d = 0; d < dims.size(); ++d) {
+        if (d < first) {
+            view.outer *= dims[d];
+        } else if (d <= last) {
+            view.length *= dims[d];
+        } else {
+            view.inner *= dims[d];
+        }
+    }
+    return view;
+}
+
+std::vector<int32_t> ReducedDims(std::span<const int32_t> dims,
+                                 std::span<const size_t> axes)
+{
+    std::vector<int32_t> reduced(dims.begin(), dims.end());
+    for (size_t axis : axes) {
+        if (axis < reduced.size()) {
+            reduced[axis] = 1;
+        }
+    }
+    return reduced;
+}
+
+uint32_t PassCount(const AxisView& view)
+{
+    uint32_t passes = 1;
+    int32_t length = view.length;
+    const int32_t chunk = ChunkFor(view);
+    while (length > chunk) {
+        length = (length + chunk - 1) / chunk;
+        ++passes;
+    }
+    return passes;
+}
+
+Reducer::Reducer(std::optional<subgroups::Path> path)
+    : mRequestedPath(path)
+{
+}
+
+bool Reducer::Initialize(wgpu::Device device,
+                         const slang_compiler::Compiler& compiler)
+{
+    ZoneScoped;
+    if (mInitialized) {
+        return true;
+    }
+    mDevice = device;
+    const std::optional<subgroups::Path> path = subgroups::Select(
+        subgroups::Query(device), mRequestedPath, kGroupSize);
+    if (!path) {
+        return false;
+    }
+    mSubgroups = *path == subgroups::Path::Subgroups;
+
+    for (auto& unused : mUnusedIndices) {
+        wgpu::BufferDescriptor desc = {
+            .label = "reduction_unused_indices",
+            .usage = wgpu::BufferUsage::Storage,
+            .size = sizeof(int32_t),
+            .mappedAtCreation = false,
+        };
+        unused = gpu_memory::CreateBuffer(device, desc);
+    }
+
+    if (!InitializeKernel(compiler, "reduceRows", false, mRows)
+        || !InitializeKernel(compiler, "reduceRows", true, mVectorRows)
+        || !InitializeKernel(compiler, "reduceColumns", false, mColumns))
+    {
+        return false;
+    }
+    mInitialized = true;
+    return true;
+}
+
+bool Reducer::InitializeKernel(const slang_compiler::Compiler& compiler,
+                               const char* entryPoint,
+                               bool vec4,
+                               Kernel& kernel) const
+{
+    const std::string source = fmt::format(
+        "#define REDUCE_GROUP_SIZE {}\n"
+        "#define REDUCE_SUBGROUPS {}\n"
+        "#define REDUCE_VEC4 {}\n"
+        "#include \"reduce.slang\"\n",
+        kGroupSize,
+        mSubgroups ? 1 : 0,
+        vec4 ? 1 : 0);
+    const std::string moduleName = fmt::format("reduce_{}{}",
+                                               vec4 ? "vec4_" : "",
+                                               mSubgroups ? "subgroups"
+                                                          : "shared");
+    kernel.program =
+        compiler.CompileFromSource(source, moduleName, entryPoint);
+    if (!kernel.program.program) {
+        return false;
+    }
+
+    auto* program = kernel.program.program.get();
+    auto uniformsInfo = uniform_buffer::ReflectUniformBuffer(program);
+    auto paramsOffset = uniform_buffer::ReflectUniformOffset(program, "params");
+    auto input = tensor_reflection::ReflectTensorBuffer(program, "input");
+    auto output = tensor_reflection::ReflectTensorBuffer(program, "output");
+    auto inputIndices =
+        tensor_reflection::ReflectTensorBuffer(program, "inputIndices");
+    auto outputIndices =
+        tensor_reflection::ReflectTensorBuffer(program, "outputIndices");
+    if (!uniformsInfo || !paramsOffset || !input || !output || !inputIndices
+        || !outputIndices)
+    {
+        LOG_ERROR("reduce.slang is missing parameters of {}", entryPoint);
+        return false;
+    }
+    kernel.uniforms = *uniformsInfo;
+    kernel.paramsOffset = *paramsOffset;
+    kernel.input = *input;
+    kernel.output = *output;
+    kernel.inputIndices = *inputIndices;
+    kernel.outputIndices = *outputIndices;
+
+    // The layout only depends on the reflection; bind the placeholder index
+    // buffers to build it.
+    uniform_buffer::UniformBuffer uniforms(kernel.uniforms);
+    tensor_buffer::TensorBuffer in(kernel.input);
+    tensor_buffer::TensorBuffer out(kernel.output);
+    tensor_buffer::TensorBuffer inIndices(kernel.inputIndices);
+    tensor_buffer::TensorBuffer outIndices(kernel.outputIndices);
+    in.Initialize(uniforms, mUnusedIndices[0].Get(), sizeof(float));
+    out.Initialize(uniforms, mUnusedIndices[1].Get(), sizeof(float));
+    inIndices.Initialize(uniforms, mUnusedIndices[0].Get(), sizeof(int32_t));
+    outIndices.Initialize(uniforms, mUnusedIndices[1].Get(), sizeof(int32_t));
+
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms).Add(in).Add(out).Add(inIndices).Add(outIndices);
+    return kernel.kernel.Initialize(mDevice,
+                                    kernel.program.compileToWGSL(),
+                                    entryPoint,
+                                    bindings.GetLayoutEntries());
+}
+
+std::optional<Result> Reducer::Reduce(wgpu::ComputePassEncoder pass,
+                                      wgpu::Buffer input,
+                                      std::span<const int32_t> dims,
+                                      std::span<const size_t> axes,
+                                      Op op) const
+{
+    ZoneScoped;
+    if (!mInitialized) {
+        LOG_ERROR("Reducer::Reduce called before Initialize");
+        return std::nullopt;
+    }
+    if (dims.empty() || axes.empty()
+        || std::ranges::any_of(dims, [](int32_t d) { return d <= 0; }))
+    {
+        LOG_ERROR("Invalid reduction of {} axes over {} dimensions",
+                  axes.size(),
+                  dims.size());
+        return std::nullopt;
+    }
+    for (size_t i = 0; i < axes.size(); ++i) {
+        if (axes[i] >= dims.size() || (i > 0 && axes[i] <= axes[i - 1])) {
+            LOG_ERROR("Reduction axes must be increasing and below {}",
+                      dims.size());
+            return std::nullopt;
+        }
+    }
+
+    const std::vector<std::array<size_t, 2>> runs = AxisRuns(axes);
+    if (op == Op::Argmax && runs.size() != 1) {
+        LOG_ERROR("Argmax needs contiguous axes");
+        return std::nullopt;
+    }
+
+    // Runs are reduced innermost first so that earlier axis numbers stay
+    // valid; each reduced run keeps its dimensions as ones.
+    std::vector<int32_t> current(dims.begin(), dims.end());
+    std::optional<Result> result;
+    for (auto run = runs.rbegin(); run != runs.rend(); ++run) {
+        AxisView view = ViewAxes(current, (*run)[0], (*run)[1]);
+        const float scale =
+            op == Op::Mean ? 1.0f / static_cast<float>(view.length) : 1.0f;
+        bool readIndices = false;
+        do {
+            const bool last = PassCount(view) == 1;
+            wgpu::Buffer values = result ? result->values.Get() : input;
+            wgpu::Buffer indices =
+                readIndices ? result->indices.Get() : mUnusedIndices[0].Get();
+            std::optional<Result> partial = EncodePass(pass,
+                                                       values,
+                                                       indices,
+                                                       view,
+                                                       op,
+                                                       readIndices,
+                                                       last ? scale : 1.0f);
+            if (!partial) {
+                return std::nullopt;
+            }
+            // Dropping the previous partial is safe: the recorded bind group
+            // keeps its buffer alive until the pass has executed.
+            result = std::move(partial);
+            view.length = result->dims[1];
+            readIndices = op == Op::Argmax;
+        } while (view.length > 1);
+
+        for (size_t d = (*run)[0]; d <= (*run)[1]; ++d) {
+            current[d] = 1;
+        }
+    }
+    result->dims = ReducedDims(dims, axes);
+    return result;
+}
+
+std::optional<Result> Reducer::EncodePass(wgpu::ComputePassEncoder pass,
+                                          wgpu::Buffer values,
+                                          wgpu::Buffer indices,
+                                          const AxisView& view,
+                                          Op op,
+                                          bool readIndices,
+                                          float scale) const
+{
+    const bool rows = view.inner == 1;
+    const int32_t chunk = ChunkFor(view);
+    const AxisView outView = {
+        .outer = view.outer,
+        .length = (view.length + chunk - 1) / chunk,
+        .inner = view.inner,
+    };
+    const size_t inBytes = ElementCount(view) * sizeof(float);
+    const size_t outBytes = ElementCount(outView) * sizeof(float);
+    const bool argmax = op == Op::Argmax;
+
+    // The vector kernel binds the input as whole 16-byte words, which the
+    // padded partials and most caller buffers have room for.
+    const size_t paddedInBytes = tensor_buffer::PaddedBytes(inBytes);
+    const bool vec4 = rows && values.GetSize() >= paddedInBytes;
+    const Kernel& kernel = rows ? (vec4 ? mVectorRows : mRows) : mColumns;
+
+    Result result;
+    result.dims = {outView.outer, outView.length, outView.inner};
+    wgpu::BufferDescriptor valuesDesc = {
+        .label = "reduction_values",
+        .usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopySrc
+            | wgpu::BufferUsage::CopyDst,
+        .size = tensor_buffer::PaddedBytes(outBytes),
+        .mappedAtCreation = false,
+    };
+    result.values = gpu_memory::CreateBuffer(mDevice, valuesDesc);
+    if (argmax) {
+        wgpu::BufferDescriptor indicesDesc = valuesDesc;
+        indicesDesc.label = "reduction_indices";
+        result.indices = gpu_memory::CreateBuffer(mDevice, indicesDesc);
+    }
+
+    wgpu::Queue queue = mDevice.GetQueue();
+    uniform_buffer::UniformBuffer uniforms(kernel.uniforms);
+    uniforms.Initialize(mDevice);
+    tensor_buffer::TensorBuffer in(kernel.input);
+    tensor_buffer::TensorBuffer out(kernel.output);
+    tensor_buffer::TensorBuffer inIndices(kernel.inputIndices);
+    tensor_buffer::TensorBuffer outIndices(kernel.outputIndices);
+    in.Initialize(uniforms, values, vec4 ? paddedInBytes : inBytes);
+    out.Initialize(uniforms, result.values.Get(), outBytes);
+    inIndices.Initialize(
+        uniforms, indices, readIndices ? inBytes : sizeof(int32_t));
+    outIndices.Initialize(
+        uniforms,
+        argmax ? result.indices.Get() : mUnusedIndices[1].Get(),
+        argmax ? outBytes : sizeof(int32_t));
+
+    const std::array<int32_t, 3> inDims = {
+        view.outer, view.length, view.inner};
+    const std::array<int32_t, 3> outDims = {
+        outView.outer, outView.length, outView.inner};
+    const std::array<int32_t, 3> unusedDims = {1, 1, 1};
+    in.WriteShape(queue, inDims);
+    out.WriteShape(queue, outDims);
+    inIndices.WriteShape(queue, readIndices ? inDims : unusedDims);
+    outIndices.WriteShape(queue, argmax ? outDims : unusedDims);
+
+    Params params {
+        .outer = view.outer,
+        .length = view.length,
+        .inner = view.inner,
+        .parts = outView.length,
+        .chunk = chunk,
+        .op = OpCode(op),
+        .readIndices = readIndices ? 1 : 0,
+        .scale = scale,
+    };
+    uniforms.Write(queue, kernel.paramsOffset, params);
+
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms).Add(in).Add(out).Add(inIndices).Add(outIndices);
+    pass.SetPipeline(kernel.kernel.GetPipeline());
+    pass.SetBindGroup(0, kernel.kernel.CreateBindGroup(bindings.GetEntries()));
+
+    const uint64_t workgroups = rows
+        ? static_cast<uint64_t>(outView.outer)
+            * static_cast<uint64_t>(outView.length)
+        : dispatch::WorkgroupsFor(ElementCount(outView), kGroupSize);
+    if (!dispatch::DispatchLinear(pass, workgroups, rows ? 1 : kGroupSize)) {
+        return std::nullopt;
+    }
+    return result;
+}
+
+bool Reducer::UsesSubgroups() const
+{
+    return mSubgroups;
+}
+
+}    // namespace reduction
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <webgpu/webgpu_cpp.h>
+
+#include "compute_kernel.hpp"
+#include "gpu_memory.hpp"
+#include "slang_compiler.hpp"
+#include "subgroups.hpp"
+#include "tensor_reflection.hpp"
+#include "uniform_buffer.hpp"
+
+namespace reduction
+{
+/// Workgroup size and per-pass chunk lengths; the workgroup size mirrors
+/// REDUCE_GROUP_SIZE in reduction.slang.
+inline constexpr uint32_t kGroupSize = 256;
+inline constexpr int32_t kRowChunk = 16 * kGroupSize;
+inline constexpr int32_t kColumnChunk = kGroupSize;
+
+enum class Op
+{
+    Sum,
+    Max,
+    Min,
+    /// Position of the first maximum along the reduced axes, as int32.
+    Argmax,
+    Mean,
+};
+
+/**
+ * @brief A tensor seen as [outer, length, inner], with `length` covering the
+ * reduced axes.
+ */
+struct AxisView
+{
+    int32_t outer = 1;
+    int32_t length = 1;
+    int32_t inner = 1;
+};
+
+/// View of `dims` reducing the contiguous axes [first, last].
+[[nodiscard]] AxisView ViewAxes(std::span<const int32_t> dims,
+                                size_t first,
+                                size_t last);
+
+/// `dims` with every reduced axis kept as a dimension of size 1.
+[[nodiscard]] std::vector<int32_t> ReducedDims(std::span<const int32_t> dims,
+                                               std::span<const size_t> axes);
+
+/// Number of passes needed to reduce `length` elements of a view.
+[[nodiscard]] uint32_t PassCount(const AxisView& view);
+
+struct Result
+{
+    gpu_memory::TrackedBuffer values;    // float
+    gpu_memory::TrackedBuffer indices;    // int32, argmax only
+    std::vector<int32_t> dims;
+};
+
+/**
+ * @brief Sum, max, min, argmax and mean over arbitrary axes of a row-major
+ * float tensor.
+ *
+ * Contiguous runs of reduced axes are folded into one axis and reduced in
+ * passes of at most kRowChunk (innermost axis) or kColumnChunk elements,
+ * each pass writing one partial per chunk, until a single value remains.
+ * When subgroups::Select() allows it, the workgroup reduction uses subgroup
+ * operations before falling back to groupshared memory. Row passes over
+ * inputs that cover whole tensor_buffer::kStorageAlignment words, such as
+ * the padded partials, load four elements per 128-bit access.
+ */
+class Reducer
+{
+  public:
+    /// `path` overrides subgroups::Select(), e.g. to benchmark the fallback.
+    explicit Reducer(std::optional<subgroups::Path> path = std::nullopt);
+
+    /// Compiles both reduction entry points; fails if the subgroup path is
+    /// requested but not usable.
+    bool Initialize(wgpu::Device device,
+                    const slang_compiler::Compiler& compiler);
+
+    /**
+     * @brief Records the passes reducing `axes` of `input` into `pass`.
+     * @param input Storage buffer holding the row-major tensor.
+     * @param dims Dimensions of the tensor, outermost first.
+     * @param axes Axes to reduce, in increasing order. Argmax only supports
+     * contiguous axes, whose flattened position it returns.
+     * @return the output buffers, or nullopt if the request is invalid
+     */
+    [[nodiscard]] std::optional<Result> Reduce(wgpu::ComputePassEncoder pass,
+                                               wgpu::Buffer input,
+                                               std::span<const int32_t> dims,
+                                               std::span<const size_t> axes,
+                                               Op op) const;
+
+    [[nodiscard]] bool UsesSubgroups() const;
+
+  private:
+    struct Kernel
+    {
+        slang_compiler::SlangProgram program;
+        compute_kernel::ComputeKernel kernel;
+        uniform_buffer::UniformBufferReflection uniforms;
+        size_t paramsOffset = 0;
+        tensor_reflection::TensorBufferReflection input;
+        tensor_reflection::TensorBufferReflection output;
+        tensor_reflection::TensorBufferReflection inputIndices;
+        tensor_reflection::TensorBufferReflection outputIndices;
+    };
+
+    bool InitializeKernel(const slang_compiler::Compiler& compiler,
+                          const char* entryPoint,
+                          bool vec4,
+                          Kernel& kernel) const;
+
+    /**
+     * @brief Records one pass over `view`, writing an [outer, parts, inner]
+     * partial. `indices` is only read when `readIndices` is set and an
+     * index output is only allocated for argmax.
+     */
+    [[nodiscard]] std::optional<Result> EncodePass(
+        wgpu::ComputePassEncoder pass,
+        wgpu::Buffer values,
+        wgpu::Buffer indices,
+        const AxisView& view,
+        Op op,
+        bool readIndices,
+        float scale) const;
+
+    wgpu::Device mDevice {nullptr};
+    Kernel mRows;
+    Kernel mVectorRows;
+    Kernel mColumns;
+    // Bound in place of index tensors that a pass does not use; two of them
+    // since writable storage bindings of a dispatch must not alias.
+    gpu_memory::TrackedBuffer mUnusedIndices[2];
+    std::optional<subgroups::Path> mRequestedPath;
+    bool mSubgroups = false;
+    bool mInitialized = false;
+};
+
+}    // namespace reduction
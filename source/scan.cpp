@@ -0,0 +1,275 @@
+#include <array>
+#include <string>
+
+#include "scan.hpp"
+
+#include <fmt/format.h>
+#include <tracy/Tracy.hpp>
+
+#include "dispatch.hpp"
+#include "logging_macros.h"
+#include "tensor_buffer.hpp"
+
+namespace scan
+{
+namespace
+{
+/// Host mirror of ScanParams in prefix_sum.slang.
+struct Params
+{
+    int32_t rows;
+    int32_t length;
+    int32_t exclusive;
+    int32_t blocks;
+};
+
+template<typename T>
+void Reference(std::span<const T> input,
+               std::span<T> output,
+               int32_t rows,
+               int32_t length,
+               Kind kind)
+{
+    const auto width = static_cast<size_t>(length);
+    for (size_t r = 0; r < static_cast<size_t>(rows); ++r) {
+        T sum {};
+        for (size_t i = r * width; i < (r + 1) * width; ++i) {
+            const T value = input[i];
+            output[i] = kind == Kind::Exclusive ? sum : sum + value;
+            sum += value;
+        }
+    }
+}
+
+const char* ElementName(Element element)
+{
+    return element == Element::Uint ? "uint" : "float";
+}
+}    // namespace
+
+void ReferenceScan(std::span<const float> input,
+                   std::span<float> output,
+                   int32_t rows,
+                   int32_t length,
+                   Kind kind)
+{
+    Reference(input, output, rows, length, kind);
+}
+
+void ReferenceScan(std::span<const uint32_t> input,
+                   std::span<uint32_t> output,
+                   int32_t rows,
+                   int32_t length,
+                   Kind kind)
+{
+    Reference(input, output, rows, length, kind);
+}
+
+Scanner::Scanner(Element element, std::optional<subgroups::Path> path)
+    : mElement(element)
+    , mRequestedPath(path)
+{
+}
+
+bool Scanner::Initialize(wgpu::Device device,
+                         const slang_compiler::Compiler& compiler)
+{
+    ZoneScoped;
+    if (mInitialized) {
+        return true;
+    }
+    mDevice = device;
+    const std::optional<subgroups::Path> path = subgroups::Select(
+        subgroups::Query(device), mRequestedPath, kGroupSize);
+    if (!path) {
+        return false;
+    }
+    mPath = *path;
+
+    wgpu::BufferDescriptor desc = {
+        .label = "scan_unused_partials",
+        .usage = wgpu::BufferUsage::Storage,
+        .size = sizeof(uint32_t),
+        .mappedAtCreation = false,
+    };
+    mUnusedPartials = gpu_memory::CreateBuffer(device, desc);
+
+    if (!InitializeKernel(compiler, "scanRows", mRows)
+        || !InitializeKernel(compiler, "scanBlockTotals", mBlockTotals)
+        || !InitializeKernel(compiler, "scanBlocks", mBlocks))
+    {
+        return false;
+    }
+    mInitialized = true;
+    return true;
+}
+
+bool Scanner::InitializeKernel(const slang_compiler::Compiler& compiler,
+                               const char* entryPoint,
+                               Kernel& kernel) const
+{
+    const std::string source = fmt::format(
+        "#define SCAN_GROUP_SIZE {}\n"
+        "#define SCAN_SUBGROUPS {}\n"
+        "#define SCAN_TYPE {}\n"
+        "#include \"prefix_sum.slang\"\n",
+        kGroupSize,
+        mPath == subgroups::Path::Subgroups ? 1 : 0,
+        ElementName(mElement));
+    kernel.program = compiler.CompileFromSource(
+        source,
+        fmt::format("prefix_sum_{}_{}",
+                    ElementName(mElement),
+                    subgroups::PathName(mPath)),
+        entryPoint);
+    if (!kernel.program.program) {
+        return false;
+    }
+
+    auto* program = kernel.program.program.get();
+    auto uniformsInfo = uniform_buffer::ReflectUniformBuffer(program);
+    auto paramsOffset = uniform_buffer::ReflectUniformOffset(program, "params");
+    auto input = tensor_reflection::ReflectTensorBuffer(program, "input");
+    auto output = tensor_reflection::ReflectTensorBuffer(program, "output");
+    auto partials = tensor_reflection::ReflectTensorBuffer(program, "partials");
+    if (!uniformsInfo || !paramsOffset || !input || !output || !partials) {
+        LOG_ERROR("prefix_sum.slang is missing parameters of {}", entryPoint);
+        return false;
+    }
+    kernel.uniforms = *uniformsInfo;
+    kernel.paramsOffset = *paramsOffset;
+    kernel.input = *input;
+    kernel.output = *output;
+    kernel.partials = *partials;
+
+    uniform_buffer::UniformBuffer uniforms(kernel.uniforms);
+    tensor_buffer::TensorBuffer inBuffer(kernel.input);
+    tensor_buffer::TensorBuffer outBuffer(kernel.output);
+    tensor_buffer::TensorBuffer partialsBuffer(kernel.partials);
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms).Add(inBuffer).Add(outBuffer).Add(partialsBuffer);
+    kernel.kernel = compute_kernel::ComputeKernel(entryPoint);
+    return kernel.kernel.Initialize(mDevice,
+                                    kernel.program.compileToWGSL(),
+                                    entryPoint,
+                                    bindings.GetLayoutEntries());
+}
+
+bool Scanner::Encode(wgpu::ComputePassEncoder pass,
+                     wgpu::Buffer input,
+                     wgpu::Buffer output,
+                     int32_t rows,
+                     int32_t length,
+                     Kind kind) const
+{
+    ZoneScoped;
+    if (!mInitialized) {
+        LOG_ERROR("Scanner::Encode called before Initialize");
+        return false;
+    }
+    if (rows <= 0 || length <= 0) {
+        LOG_ERROR("Invalid scan of [{}, {}]", rows, length);
+        return false;
+    }
+    if (length <= kBlockLength) {
+        return EncodeKernel(pass,
+                            mRows,
+                            input,
+                            output,
+                            mUnusedPartials.Get(),
+                            rows,
+                            length,
+                            1,
+                            kind,
+                            static_cast<uint64_t>(rows));
+    }
+
+    // Block sums, their exclusive scan as block offsets, then the blocks.
+    // The recorded bind groups keep the scratch buffers alive until the
+    // pass has executed.
+    const int32_t blocks = (length + kBlockLength - 1) / kBlockLength;
+    const uint64_t workgroups =
+        static_cast<uint64_t>(rows) * static_cast<uint64_t>(blocks);
+    wgpu::BufferDescriptor desc = {
+        .label = "scan_partials",
+        .usage = wgpu::BufferUsage::Storage,
+        .size = tensor_buffer::PaddedBytes(workgroups * sizeof(uint32_t)),
+        .mappedAtCreation = false,
+    };
+    gpu_memory::TrackedBuffer totals = gpu_memory::CreateBuffer(mDevice, desc);
+    gpu_memory::TrackedBuffer offsets = gpu_memory::CreateBuffer(mDevice, desc);
+    return EncodeKernel(pass,
+                        mBlockTotals,
+                        input,
+                        mUnusedPartials.Get(),
+                        totals.Get(),
+                        rows,
+                        length,
+                        blocks,
+                        kind,
+                        workgroups)
+        && Encode(pass, totals.Get(), offsets.Get(), rows, blocks,
+                  Kind::Exclusive)
+        && EncodeKernel(pass,
+                        mBlocks,
+                        input,
+                        output,
+                        offsets.Get(),
+                        rows,
+                        length,
+                        blocks,
+                        kind,
+                        workgroups);
+}
+
+bool Scanner::EncodeKernel(wgpu::ComputePassEncoder pass,
+                           const Kernel& kernel,
+                           wgpu::Buffer input,
+                           wgpu::Buffer output,
+                           wgpu::Buffer partials,
+                           int32_t rows,
+                           int32_t length,
+                           int32_t blocks,
+                           Kind kind,
+                           uint64_t workgroups) const
+{
+    wgpu::Queue queue = mDevice.GetQueue();
+    uniform_buffer::UniformBuffer uniforms(kernel.uniforms);
+    uniforms.Initialize(mDevice);
+    tensor_buffer::TensorBuffer inBuffer(kernel.input);
+    tensor_buffer::TensorBuffer outBuffer(kernel.output);
+    tensor_buffer::TensorBuffer partialsBuffer(kernel.partials);
+    inBuffer.Initialize(uniforms, input, input.GetSize());
+    outBuffer.Initialize(uniforms, output, output.GetSize());
+    partialsBuffer.Initialize(uniforms, partials, partials.GetSize());
+    const std::array<int32_t, 2> dims = {rows, length};
+    const std::array<int32_t, 2> partialDims = {rows, blocks};
+    inBuffer.WriteShape(queue, dims);
+    outBuffer.WriteShape(queue, dims);
+    partialsBuffer.WriteShape(queue, partialDims);
+    const Params params {
+        .rows = rows,
+        .length = length,
+        .exclusive = kind == Kind::Exclusive ? 1 : 0,
+        .blocks = blocks,
+    };
+    uniforms.Write(queue, kernel.paramsOffset, params);
+
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms).Add(inBuffer).Add(outBuffer).Add(partialsBuffer);
+    pass.SetPipeline(kernel.kernel.GetPipeline());
+    pass.SetBindGroup(0, kernel.kernel.CreateBindGroup(bindings.GetEntries()));
+    return dispatch::DispatchLinear(pass, workgroups);
+}
+
+Element Scanner::GetElement() const
+{
+    return mElement;
+}
+
+subgroups::Path Scanner::GetPath() const
+{
+    return mPath;
+}
+
+}    // namespace scan
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+
+#include <webgpu/webgpu_cpp.h>
+
+#include "compute_kernel.hpp"
+#include "gpu_memory.hpp"
+#include "slang_compiler.hpp"
+#include "subgroups.hpp"
+#include "tensor_reflection.hpp"
+#include "uniform_buffer.hpp"
+
+namespace scan
+{
+/// Workgroup size of the scan kernels; mirrors SCAN_GROUP_SIZE in
+/// scan.slang.
+inline constexpr uint32_t kGroupSize = 256;
+/// Elements per reduce-then-scan block; mirrors kScanBlockLength in
+/// prefix_sum.slang. Rows up to this length take a single pass.
+inline constexpr int32_t kBlockLength = 4 * kGroupSize;
+
+enum class Kind
+{
+    /// Element i is the sum of elements 0..i.
+    Inclusive,
+    /// Element i is the sum of elements 0..i-1, so the first is 0.
+    Exclusive,
+};
+
+/// Element type of the scanned tensors.
+enum class Element
+{
+    Float,
+    /// uint32, e.g. counts and flags; sums wrap around.
+    Uint,
+};
+
+/// CPU references of the row prefix sums of a row-major [rows, length]
+/// tensor.
+void ReferenceScan(std::span<const float> input,
+                   std::span<float> output,
+                   int32_t rows,
+                   int32_t length,
+                   Kind kind);
+void ReferenceScan(std::span<const uint32_t> input,
+                   std::span<uint32_t> output,
+                   int32_t rows,
+                   int32_t length,
+                   Kind kind);
+
+/**
+ * @brief Prefix sums along the rows of row-major float or uint32 tensors.
+ *
+ * Rows of at most kBlockLength elements are scanned by one workgroup each.
+ * Longer rows use reduce-then-scan: one pass sums every block of
+ * kBlockLength elements, the block sums are scanned recursively, and a
+ * last pass rescans each block from its offset. Every pass spreads over
+ * all blocks, so single long rows keep the device busy.
+ *
+ * On the subgroup path a workgroup scans with subgroup prefix sums and only
+ * the subgroup totals go through groupshared memory; the fallback runs a
+ * groupshared scan over the whole workgroup.
+ */
+class Scanner
+{
+  public:
+    /// `path` overrides subgroups::Select(), e.g. to benchmark the fallback.
+    explicit Scanner(Element element = Element::Float,
+                     std::optional<subgroups::Path> path = std::nullopt);
+
+    /// Fails if the subgroup path is requested but not usable.
+    bool Initialize(wgpu::Device device,
+                    const slang_compiler::Compiler& compiler);
+
+    /**
+     * @brief Records the scan of the [rows, length] tensor in `input` into
+     * `output`, which must not alias it.
+     * @return false if the shape is empty or nothing was dispatched
+     */
+    [[nodiscard]] bool Encode(wgpu::ComputePassEncoder pass,
+                              wgpu::Buffer input,
+                              wgpu::Buffer output,
+                              int32_t rows,
+                              int32_t length,
+                              Kind kind = Kind::Inclusive) const;
+
+    [[nodiscard]] Element GetElement() const;
+    [[nodiscard]] subgroups::Path GetPath() const;
+
+  private:
+    struct Kernel
+    {
+        slang_compiler::SlangProgram program;
+        compute_kernel::ComputeKernel kernel;
+        uniform_buffer::UniformBufferReflection uniforms;
+        size_t paramsOffset = 0;
+        tensor_reflection::TensorBufferReflection input;
+        tensor_reflection::TensorBufferReflection output;
+        tensor_reflection::TensorBufferReflection partials;
+    };
+
+    bool InitializeKernel(const slang_compiler::Compiler& compiler,
+                          const char* entryPoint,
+                          Kernel& kernel) const;
+
+    /// Records one dispatch of `kernel` over `workgroups` workgroups.
+    [[nodiscard]] bool EncodeKernel(wgpu::ComputePassEncoder pass,
+                                    const Kernel& kernel,
+                                    wgpu::Buffer input,
+                                    wgpu::Buffer output,
+                                    wgpu::Buffer partials,
+                                    int32_t rows,
+                                    int32_t length,
+                                    int32_t blocks,
+                                    Kind kind,
+                                    uint64_t workgroups) const;
+
+    Element mElement;
+    std::optional<subgroups::Path> mRequestedPath;
+    subgroups::Path mPath = subgroups::Path::Shared;
+    wgpu::Device mDevice {nullptr};
+    Kernel mRows;
+    Kernel mBlockTotals;
+    Kernel mBlocks;
+    // Bound as the partials of scanRows, which does not use them.
+    gpu_memory::TrackedBuffer mUnusedPartials;
+    bool mInitialized = false;
+};
+
+}    // namespace scan
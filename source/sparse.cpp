@@ -0,0 +1,443 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "sparse.hpp"
+
+#include <tracy/Tracy.hpp>
+
+#include "dispatch.hpp"
+#include "logging_macros.h"
+
+namespace sparse
+{
+namespace
+{
+/// Host mirror of SparseParams in sparse.slang.
+struct Params
+{
+    int32_t m;
+    int32_t threads;
+};
+
+bool SizesMatch(std::span<const float> values, int32_t rows, int32_t cols)
+{
+    if (rows <= 0 || cols <= 0
+        || values.size()
+            != static_cast<size_t>(rows) * static_cast<size_t>(cols))
+    {
+        LOG_ERROR("{} values are not a [{}, {}] matrix",
+                  values.size(),
+                  rows,
+                  cols);
+        return false;
+    }
+    return true;
+}
+
+gpu_memory::TrackedBuffer CreateStorage(wgpu::Device device,
+                                        const char* label,
+                                        const void* data,
+                                        size_t bytes)
+{
+    wgpu::BufferDescriptor desc = {
+        .label = label,
+        .usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst,
+        .size = tensor_buffer::PaddedBytes(bytes),
+        .mappedAtCreation = false,
+    };
+    gpu_memory::TrackedBuffer buffer = gpu_memory::CreateBuffer(device, desc);
+    if (bytes > 0) {
+        device.GetQueue().WriteBuffer(buffer.Get(), 0, data, bytes);
+    }
+    return buffer;
+}
+}    // namespace
+
+int32_t CsrMatrix::Nnz() const
+{
+    return static_cast<int32_t>(values.size());
+}
+
+float CsrMatrix::Density() const
+{
+    const double cells = static_cast<double>(rows) * cols;
+    return cells > 0.0 ? static_cast<float>(Nnz() / cells) : 0.0f;
+}
+
+int32_t CsrMatrix::MaxRowNnz() const
+{
+    int32_t longest = 0;
+    for (size_t r = 0; r + 1 < rowPtr.size(); ++r) {
+        longest = std::max(longest, rowPtr[r + 1] - rowPtr[r]);
+    }
+    return longest;
+}
+
+std::optional<CsrMatrix> ToCsr(std::span<const float> values,
+                               int32_t rows,
+                               int32_t cols)
+{
+    ZoneScoped;
+    if (!SizesMatch(values, rows, cols)) {
+        return std::nullopt;
+    }
+    CsrMatrix result;
+    result.rows = rows;
+    result.cols = cols;
+    result.rowPtr.reserve(static_cast<size_t>(rows) + 1);
+    result.rowPtr.push_back(0);
+    const auto width = static_cast<size_t>(cols);
+    for (size_t r = 0; r < static_cast<size_t>(rows); ++r) {
+        for (size_t k = 0; k < width; ++k) {
+            const float value = values[r * width + k];
+            if (std::abs(value) > 0.0f) {
+                result.colIndices.push_back(static_cast<int32_t>(k));
+                result.values.push_back(value);
+            }
+        }
+        result.rowPtr.push_back(result.Nnz());
+    }
+    return result;
+}
+
+std::vector<float> ToDense(const CsrMatrix& matrix)
+{
+    const auto width = static_cast<size_t>(matrix.cols);
+    std::vector<float> values(static_cast<size_t>(matrix.rows) * width, 0.0f);
+    for (size_t r = 0; r < static_cast<size_t>(matrix.rows); ++r) {
+        for (auto e = static_cast<size_t>(matrix.rowPtr[r]);
+             e < static_cast<size_t>(matrix.rowPtr[r + 1]);
+             ++e)
+        {
+            values[r * width + static_cast<size_t>(matrix.colIndices[e])] =
+                matrix.values[e];
+        }
+    }
+    return values;
+}
+
+float Density(std::span<const float> values)
+{
+    if (values.empty()) {
+        return 0.0f;
+    }
+    const auto nonZero = std::ranges::count_if(
+        values, [](float value) { return std::abs(value) > 0.0f; });
+    return static_cast<float>(static_cast<double>(nonZero)
+                              / static_cast<double>(values.size()));
+}
+
+void ReferenceSpmm(const CsrMatrix& weights,
+                   std::span<const float> a,
+                   int32_t m,
+                   std::span<float> c)
+{
+    const auto k = static_cast<size_t>(weights.cols);
+    const auto n = static_cast<size_t>(weights.rows);
+    for (size_t i = 0; i < static_cast<size_t>(m); ++i) {
+        for (size_t r = 0; r < n; ++r) {
+            float sum = 0.0f;
+            for (auto e = static_cast<size_t>(weights.rowPtr[r]);
+                 e < static_cast<size_t>(weights.rowPtr[r + 1]);
+                 ++e)
+            {
+                sum += weights.values[e]
+                    * a[i * k + static_cast<size_t>(weights.colIndices[e])];
+            }
+            c[i * n + r] = sum;
+        }
+    }
+}
+
+Format ChooseFormat(float density, float threshold)
+{
+    return density <= threshold ? Format::Csr : Format::Dense;
+}
+
+uint64_t DeviceWeights::Bytes() const
+{
+    uint64_t bytes = values.GetSize();
+    if (format == Format::Csr) {
+        bytes += rowPtr.GetSize() + colIndices.GetSize();
+    }
+    return bytes;
+}
+
+DeviceWeights Upload(wgpu::Device device, const CsrMatrix& matrix)
+{
+    DeviceWeights result;
+    result.format = Format::Csr;
+    result.rows = matrix.rows;
+    result.cols = matrix.cols;
+    result.nnz = matrix.Nnz();
+    result.maxRowNnz = matrix.MaxRowNnz();
+    result.rowPtr = CreateStorage(device,
+                                  "csr_row_ptr",
+                                  matrix.rowPtr.data(),
+                                  matrix.rowPtr.size() * sizeof(int32_t));
+    result.colIndices =
+        CreateStorage(device,
+                      "csr_col_indices",
+                      matrix.colIndices.data(),
+                      matrix.colIndices.size() * sizeof(int32_t));
+    result.values = CreateStorage(device,
+                                  "csr_values",
+                                  matrix.values.data(),
+                                  matrix.values.size() * sizeof(float));
+    return result;
+}
+
+std::optional<DeviceWeights> Load(wgpu::Device device,
+                                  std::span<const float> values,
+                                  int32_t rows,
+                                  int32_t cols,
+                                  float threshold)
+{
+    ZoneScoped;
+    if (!SizesMatch(values, rows, cols)) {
+        return std::nullopt;
+    }
+    if (ChooseFormat(Density(values), threshold) == Format::Csr) {
+        return Upload(device, *ToCsr(values, rows, cols));
+    }
+    DeviceWeights result;
+    result.format = Format::Dense;
+    result.rows = rows;
+    result.cols = cols;
+    result.nnz = rows * cols;
+    result.maxRowNnz = cols;
+    result.values = CreateStorage(
+        device, "dense_weights", values.data(), values.size_bytes());
+    return result;
+}
+
+Matmul::Matmul(gemm::TileConfig config)
+    : mDense(config)
+{
+}
+
+bool Matmul::Initialize(wgpu::Device device,
+                        const slang_compiler::Compiler& compiler)
+{
+    ZoneScoped;
+    if (mInitialized) {
+        return true;
+    }
+    mDevice = device;
+    if (!mDense.Initialize(device, compiler)) {
+        return false;
+    }
+    // Separate buffers, so that no two writable bindings alias.
+    wgpu::BufferDescriptor desc = {
+        .label = "sparse_unused_carries",
+        .usage = wgpu::BufferUsage::Storage,
+        .size = sizeof(float),
+        .mappedAtCreation = false,
+    };
+    mUnusedCarryRows = gpu_memory::CreateBuffer(device, desc);
+    mUnusedCarryValues = gpu_memory::CreateBuffer(device, desc);
+
+    if (!InitializeKernel(compiler, "spmmRows", mRows)
+        || !InitializeKernel(compiler, "spmmMergePath", mMergePath)
+        || !InitializeKernel(compiler, "spmmFixup", mFixup))
+    {
+        return false;
+    }
+    mInitialized = true;
+    return true;
+}
+
+bool Matmul::InitializeKernel(const slang_compiler::Compiler& compiler,
+                              const char* entryPoint,
+                              Kernel& kernel) const
+{
+    kernel.program = compiler.CreateProgram("sparse", entryPoint);
+    if (!kernel.program.program) {
+        return false;
+    }
+
+    auto* program = kernel.program.program.get();
+    auto uniformsInfo = uniform_buffer::ReflectUniformBuffer(program);
+    auto paramsOffset = uniform_buffer::ReflectUniformOffset(program, "params");
+    auto weights =
+        tensor_reflection::ReflectCsrTensorBuffer(program, "weights");
+    auto a = tensor_reflection::ReflectTensorBuffer(program, "a");
+    auto c = tensor_reflection::ReflectTensorBuffer(program, "c");
+    auto carryRows =
+        tensor_reflection::ReflectTensorBuffer(program, "carryRows");
+    auto carryValues =
+        tensor_reflection::ReflectTensorBuffer(program, "carryValues");
+    if (!uniformsInfo || !paramsOffset || !weights || !a || !c || !carryRows
+        || !carryValues)
+    {
+        LOG_ERROR("sparse.slang is missing parameters of {}", entryPoint);
+        return false;
+    }
+    kernel.uniforms = *uniformsInfo;
+    kernel.paramsOffset = *paramsOffset;
+    kernel.weights = *weights;
+    kernel.a = *a;
+    kernel.c = *c;
+    kernel.carryRows = *carryRows;
+    kernel.carryValues = *carryValues;
+
+    uniform_buffer::UniformBuffer uniforms(kernel.uniforms);
+    tensor_buffer::CsrTensorBuffer weightsBuffer(kernel.weights);
+    tensor_buffer::TensorBuffer aBuffer(kernel.a);
+    tensor_buffer::TensorBuffer cBuffer(kernel.c);
+    tensor_buffer::TensorBuffer carryRowsBuffer(kernel.carryRows);
+    tensor_buffer::TensorBuffer carryValuesBuffer(kernel.carryValues);
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms)
+        .Add(weightsBuffer)
+        .Add(aBuffer)
+        .Add(cBuffer)
+        .Add(carryRowsBuffer)
+        .Add(carryValuesBuffer);
+    kernel.kernel = compute_kernel::ComputeKernel(entryPoint);
+    return kernel.kernel.Initialize(mDevice,
+                                    kernel.program.compileToWGSL(),
+                                    entryPoint,
+                                    bindings.GetLayoutEntries());
+}
+
+bool Matmul::Encode(wgpu::ComputePassEncoder pass,
+                    const tensor_buffer::BufferView& a,
+                    const DeviceWeights& weights,
+                    wgpu::Buffer c,
+                    Strategy strategy) const
+{
+    ZoneScoped;
+    if (!mInitialized) {
+        LOG_ERROR("sparse::Matmul::Encode called before Initialize");
+        return false;
+    }
+    if (a.view.dims.size() != 2 || a.view.dims[0] <= 0
+        || a.view.dims[1] != weights.cols)
+    {
+        LOG_ERROR("Sparse matmul needs an [M, {}] operand", weights.cols);
+        return false;
+    }
+    const int32_t m = a.view.dims[0];
+
+    if (weights.format == Format::Dense) {
+        // W^T as a strided [K, N] view of the row-major [N, K] weights.
+        const std::array<int32_t, 2> dims = {weights.rows, weights.cols};
+        const tensor_buffer::BufferView b {
+            .buffer = weights.values.Get(),
+            .view = *tensor_buffer::TensorView::Contiguous(dims).Transpose(
+                0, 1),
+        };
+        return mDense.Encode(pass, a, b, c);
+    }
+
+    if (strategy == Strategy::Auto) {
+        const int32_t mean =
+            std::max(1, weights.nnz / std::max(1, weights.rows));
+        strategy = weights.maxRowNnz > kSkewRatio * mean ? Strategy::MergePath
+                                                         : Strategy::RowSplit;
+    }
+    if (strategy == Strategy::RowSplit) {
+        const uint64_t outputs =
+            static_cast<uint64_t>(m) * static_cast<uint64_t>(weights.rows);
+        return EncodeKernel(pass,
+                            mRows,
+                            a,
+                            weights,
+                            c,
+                            mUnusedCarryRows.Get(),
+                            mUnusedCarryValues.Get(),
+                            0,
+                            dispatch::WorkgroupsFor(outputs * kLanes,
+                                                    kGroupSize));
+    }
+
+    // The recorded bind groups keep the carries alive until the pass has
+    // executed.
+    const int32_t threads =
+        (weights.rows + weights.nnz + kMergePathItems - 1) / kMergePathItems;
+    const uint64_t carries =
+        static_cast<uint64_t>(m) * static_cast<uint64_t>(threads);
+    wgpu::BufferDescriptor desc = {
+        .label = "sparse_carries",
+        .usage = wgpu::BufferUsage::Storage,
+        .size = tensor_buffer::PaddedBytes(carries * sizeof(float)),
+        .mappedAtCreation = false,
+    };
+    gpu_memory::TrackedBuffer carryRows =
+        gpu_memory::CreateBuffer(mDevice, desc);
+    gpu_memory::TrackedBuffer carryValues =
+        gpu_memory::CreateBuffer(mDevice, desc);
+    const uint64_t workgroups = dispatch::WorkgroupsFor(carries, kGroupSize);
+    return EncodeKernel(pass,
+                        mMergePath,
+                        a,
+                        weights,
+                        c,
+                        carryRows.Get(),
+                        carryValues.Get(),
+                        threads,
+                        workgroups)
+        && EncodeKernel(pass,
+                        mFixup,
+                        a,
+                        weights,
+                        c,
+                        carryRows.Get(),
+                        carryValues.Get(),
+                        threads,
+                        workgroups);
+}
+
+bool Matmul::EncodeKernel(wgpu::ComputePassEncoder pass,
+                          const Kernel& kernel,
+                          const tensor_buffer::BufferView& a,
+                          const DeviceWeights& weights,
+                          wgpu::Buffer c,
+                          wgpu::Buffer carryRows,
+                          wgpu::Buffer carryValues,
+                          int32_t threads,
+                          uint64_t workgroups) const
+{
+    const int32_t m = a.view.dims[0];
+    const std::array<int32_t, 2> cDims = {m, weights.rows};
+    const std::array<int32_t, 2> carryDims = {m, threads};
+
+    wgpu::Queue queue = mDevice.GetQueue();
+    uniform_buffer::UniformBuffer uniforms(kernel.uniforms);
+    uniforms.Initialize(mDevice);
+    tensor_buffer::CsrTensorBuffer weightsBuffer(kernel.weights);
+    tensor_buffer::TensorBuffer aBuffer(kernel.a);
+    tensor_buffer::TensorBuffer cBuffer(kernel.c);
+    tensor_buffer::TensorBuffer carryRowsBuffer(kernel.carryRows);
+    tensor_buffer::TensorBuffer carryValuesBuffer(kernel.carryValues);
+    weightsBuffer.Initialize(uniforms,
+                             weights.rowPtr.Get(),
+                             weights.colIndices.Get(),
+                             weights.values.Get());
+    aBuffer.Initialize(uniforms, a.buffer, a.buffer.GetSize());
+    cBuffer.Initialize(uniforms, c, c.GetSize());
+    carryRowsBuffer.Initialize(uniforms, carryRows, carryRows.GetSize());
+    carryValuesBuffer.Initialize(uniforms, carryValues, carryValues.GetSize());
+    weightsBuffer.WriteShape(queue, weights.rows, weights.cols, weights.nnz);
+    aBuffer.WriteShape(queue, a.view);
+    cBuffer.WriteShape(queue, cDims);
+    carryRowsBuffer.WriteShape(queue, carryDims);
+    carryValuesBuffer.WriteShape(queue, carryDims);
+    const Params params {.m = m, .threads = threads};
+    uniforms.Write(queue, kernel.paramsOffset, params);
+
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms)
+        .Add(weightsBuffer)
+        .Add(aBuffer)
+        .Add(cBuffer)
+        .Add(carryRowsBuffer)
+        .Add(carryValuesBuffer);
+    pass.SetPipeline(kernel.kernel.GetPipeline());
+    pass.SetBindGroup(0, kernel.kernel.CreateBindGroup(bindings.GetEntries()));
+    return dispatch::DispatchLinear(pass, workgroups, kGroupSize);
+}
+
+}    // namespace sparse
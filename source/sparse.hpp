@@ -0,0 +1,198 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <webgpu/webgpu_cpp.h>
+
+#include "batched_gemm.hpp"
+#include "compute_kernel.hpp"
+#include "gpu_memory.hpp"
+#include "slang_compiler.hpp"
+#include "tensor_buffer.hpp"
+#include "tensor_reflection.hpp"
+#include "uniform_buffer.hpp"
+
+namespace sparse
+{
+/// Workgroup size of the sparse.slang kernels.
+inline constexpr uint32_t kGroupSize = 256;
+/// Threads per output of the row-split kernel; mirrors kSparseLanes.
+inline constexpr uint32_t kLanes = 8;
+/// Merge-path items per thread; mirrors kMergePathItems.
+inline constexpr int32_t kMergePathItems = 16;
+/// Largest fraction of non-zero weights that Load() stores as CSR. Above
+/// it, the index traffic and irregular reads cost more than the skipped
+/// multiplications save, and the dense tiled GEMM wins.
+inline constexpr float kDensityThreshold = 0.1f;
+/// Strategy::Auto takes the merge path when the longest row holds more than
+/// this many times the mean number of elements per row.
+inline constexpr int32_t kSkewRatio = 8;
+
+/**
+ * @brief A [rows, cols] matrix in compressed sparse row form.
+ *
+ * The stored elements of row r are e = rowPtr[r] .. rowPtr[r + 1] - 1, at
+ * column colIndices[e] with value values[e]; columns ascend within a row.
+ */
+struct CsrMatrix
+{
+    int32_t rows = 0;
+    int32_t cols = 0;
+    std::vector<int32_t> rowPtr;    // rows + 1 entries
+    std::vector<int32_t> colIndices;
+    std::vector<float> values;
+
+    [[nodiscard]] int32_t Nnz() const;
+    /// Stored elements over rows * cols.
+    [[nodiscard]] float Density() const;
+    /// Stored elements of the longest row.
+    [[nodiscard]] int32_t MaxRowNnz() const;
+};
+
+/**
+ * @brief Compresses row-major [rows, cols] values, dropping exact zeros.
+ * @return nullopt if the sizes do not match
+ */
+[[nodiscard]] std::optional<CsrMatrix> ToCsr(std::span<const float> values,
+                                             int32_t rows,
+                                             int32_t cols);
+
+/// CPU expansion back to row-major floats.
+[[nodiscard]] std::vector<float> ToDense(const CsrMatrix& matrix);
+
+/// Fraction of non-zero values.
+[[nodiscard]] float Density(std::span<const float> values);
+
+/// CPU reference of C = A x W^T for A: [M, K] and W: [N, K].
+void ReferenceSpmm(const CsrMatrix& weights,
+                   std::span<const float> a,
+                   int32_t m,
+                   std::span<float> c);
+
+/// How DeviceWeights stores the matrix.
+enum class Format
+{
+    Csr,
+    /// Row-major floats in `values`; `rowPtr` and `colIndices` are empty.
+    Dense,
+};
+
+/// Csr if `density` is at most `threshold`.
+[[nodiscard]] Format ChooseFormat(float density,
+                                  float threshold = kDensityThreshold);
+
+enum class Strategy
+{
+    /// MergePath for skewed rows (see kSkewRatio), RowSplit otherwise.
+    Auto,
+    RowSplit,
+    MergePath,
+};
+
+/// Weights resident on a device, sparse or dense.
+struct DeviceWeights
+{
+    Format format = Format::Csr;
+    int32_t rows = 0;
+    int32_t cols = 0;
+    int32_t nnz = 0;
+    int32_t maxRowNnz = 0;
+    gpu_memory::TrackedBuffer rowPtr;
+    gpu_memory::TrackedBuffer colIndices;
+    gpu_memory::TrackedBuffer values;
+
+    /// Bytes of the stored buffers.
+    [[nodiscard]] uint64_t Bytes() const;
+};
+
+/// Uploads a CSR matrix.
+[[nodiscard]] DeviceWeights Upload(wgpu::Device device,
+                                   const CsrMatrix& matrix);
+
+/**
+ * @brief Uploads row-major [rows, cols] weights as CSR if their density is
+ * at most `threshold`, as dense floats otherwise.
+ * @return nullopt if the sizes do not match
+ */
+[[nodiscard]] std::optional<DeviceWeights> Load(
+    wgpu::Device device,
+    std::span<const float> values,
+    int32_t rows,
+    int32_t cols,
+    float threshold = kDensityThreshold);
+
+/**
+ * @brief C = A x W^T for f32 A: [M, K] and weights W: [N, K] in either
+ * format, as in a linear layer.
+ *
+ * CSR weights use spmmRows, which spreads each output over kLanes threads,
+ * or the merge-path kernels, which balance the work when a few rows hold
+ * most of the elements. M = 1 is the SpMV case. Dense weights go through
+ * batched_gemm::BatchedGemm.
+ */
+class Matmul
+{
+  public:
+    explicit Matmul(gemm::TileConfig config = {});
+
+    bool Initialize(wgpu::Device device,
+                    const slang_compiler::Compiler& compiler);
+
+    /**
+     * @brief Records the product into `pass`.
+     * @param a [M, K] view of an f32 buffer.
+     * @param c Buffer holding the contiguous f32 [M, N] output; it must not
+     * alias `a`.
+     * @return false if the operands do not multiply or nothing was
+     * dispatched
+     */
+    [[nodiscard]] bool Encode(wgpu::ComputePassEncoder pass,
+                              const tensor_buffer::BufferView& a,
+                              const DeviceWeights& weights,
+                              wgpu::Buffer c,
+                              Strategy strategy = Strategy::Auto) const;
+
+  private:
+    struct Kernel
+    {
+        slang_compiler::SlangProgram program;
+        compute_kernel::ComputeKernel kernel;
+        uniform_buffer::UniformBufferReflection uniforms;
+        size_t paramsOffset = 0;
+        tensor_reflection::CsrTensorBufferReflection weights;
+        tensor_reflection::TensorBufferReflection a;
+        tensor_reflection::TensorBufferReflection c;
+        tensor_reflection::TensorBufferReflection carryRows;
+        tensor_reflection::TensorBufferReflection carryValues;
+    };
+
+    bool InitializeKernel(const slang_compiler::Compiler& compiler,
+                          const char* entryPoint,
+                          Kernel& kernel) const;
+
+    /// Records one dispatch of `kernel` over `workgroups` workgroups.
+    [[nodiscard]] bool EncodeKernel(wgpu::ComputePassEncoder pass,
+                                    const Kernel& kernel,
+                                    const tensor_buffer::BufferView& a,
+                                    const DeviceWeights& weights,
+                                    wgpu::Buffer c,
+                                    wgpu::Buffer carryRows,
+                                    wgpu::Buffer carryValues,
+                                    int32_t threads,
+                                    uint64_t workgroups) const;
+
+    wgpu::Device mDevice {nullptr};
+    batched_gemm::BatchedGemm mDense;
+    Kernel mRows;
+    Kernel mMergePath;
+    Kernel mFixup;
+    // Bound as the carries of spmmRows, which does not use them.
+    gpu_memory::TrackedBuffer mUnusedCarryRows;
+    gpu_memory::TrackedBuffer mUnusedCarryValues;
+    bool mInitialized = false;
+};
+
+}    // namespace sparse
@@ -0,0 +1,52 @@
+#include "subgroups.hpp"
+
+#include "logging_macros.h"
+
+namespace subgroups
+{
+Properties Query(wgpu::Device device)
+{
+    Properties properties;
+    properties.supported = device.HasFeature(wgpu::FeatureName::Subgroups);
+    if (properties.supported) {
+        wgpu::AdapterInfo info {};
+        device.GetAdapterInfo(&info);
+        properties.minSize = info.subgroupMinSize;
+        properties.maxSize = info.subgroupMaxSize;
+    }
+    return properties;
+}
+
+std::optional<Path> Select(const Properties& properties,
+                           std::optional<Path> requested,
+                           uint32_t workgroupSize,
+                           uint32_t minSize)
+{
+    if (requested == Path::Shared) {
+        return Path::Shared;
+    }
+    const bool usable = properties.supported && properties.minSize > 0
+        && properties.minSize >= minSize
+        && properties.maxSize >= properties.minSize
+        && workgroupSize % properties.maxSize == 0;
+    if (usable) {
+        return Path::Subgroups;
+    }
+    if (requested == Path::Subgroups) {
+        LOG_ERROR("Subgroups of {} to {} lanes do not fit a kernel needing {}"
+                  " lanes in workgroups of {}",
+                  properties.minSize,
+                  properties.maxSize,
+                  minSize,
+                  workgroupSize);
+        return std::nullopt;
+    }
+    return Path::Shared;
+}
+
+const char* PathName(Path path)
+{
+    return path == Path::Subgroups ? "subgroups" : "shared";
+}
+
+}    // namespace subgroups
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+#include <webgpu/webgpu_cpp.h>
+
+namespace subgroups
+{
+/// Smallest subgroup that makes a subgroup step worth a kernel variant.
+inline constexpr uint32_t kMinUsefulSize = 4;
+
+/// How a kernel combines values across the invocations of a workgroup.
+enum class Path
+{
+    /// Subgroup operations, with groupshared memory only between subgroups.
+    Subgroups,
+    /// Groupshared memory and barriers only; runs on every device.
+    Shared,
+};
+
+/// What the device negotiated; sizes are 0 when they are unknown.
+struct Properties
+{
+    bool supported = false;
+    uint32_t minSize = 0;
+    uint32_t maxSize = 0;
+};
+
+/// Reads the Subgroups feature and the adapter's subgroup size range.
+[[nodiscard]] Properties Query(wgpu::Device device);
+
+/**
+ * @brief Picks the path of a kernel at pipeline creation.
+ *
+ * Subgroups need the feature, a minimum size of at least `minSize`, and a
+ * maximum size that divides `workgroupSize`, so that every subgroup is
+ * full. A requested path overrides the choice, e.g. to benchmark the
+ * fallback.
+ * @return nullopt if the subgroup path is requested but not usable
+ */
+[[nodiscard]] std::optional<Path> Select(
+    const Properties& properties,
+    std::optional<Path> requested,
+    uint32_t workgroupSize,
+    uint32_t minSize = kMinUsefulSize);
+
+[[nodiscard]] const char* PathName(Path path);
+
+}    // namespace subgroups
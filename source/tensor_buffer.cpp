@@ -1,7 +1,211 @@
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
 #include "tensor_buffer.hpp"
 
+#include "logging_macros.h"
+#include "std140.hpp"
+
 namespace tensor_buffer
 {
+TensorView TensorView::Contiguous(std::span<const int32_t> dims)
+{
+    TensorView view;
+    view.dims.assign(dims.begin(), dims.end());
+    view.strides.resize(dims.size());
+    int32_t stride = 1;
+    for (size_t d = dims.size(); d-- > 0;) {
+        view.strides[d] = stride;
+        stride *= dims[d];
+    }
+    return view;
+}
+
+int32_t TensorView::Count() const
+{
+    int32_t count = 1;
+    for (int32_t dim : dims) {
+        count *= dim;
+    }
+    return count;
+}
+
+bool TensorView::IsContiguous() const
+{
+    int32_t expected = 1;
+    for (size_t d = dims.size(); d-- > 0;) {
+        // The stride of a size-1 axis is never used.
+        if (dims[d] != 1 && strides[d] != expected) {
+            return false;
+        }
+        expected *= dims[d];
+    }
+    return true;
+}
+
+std::optional<TensorView> TensorView::View(
+    std::span<const int32_t> newDims) const
+{
+    TensorView view = Contiguous(newDims);
+    if (!IsContiguous() || view.Count() != Count()) {
+        LOG_ERROR("Cannot view {} elements as {} elements{}",
+                  Count(),
+                  view.Count(),
+                  IsContiguous() ? "" : " of a non-contiguous tensor");
+        return std::nullopt;
+    }
+    view.offset = offset;
+    return view;
+}
+
+std::optional<TensorView> TensorView::Transpose(size_t a, size_t b) const
+{
+    if (a >= dims.size() || b >= dims.size()) {
+        LOG_ERROR("Cannot transpose axes {} and {} of a {}-D tensor",
+                  a,
+                  b,
+                  dims.size());
+        return std::nullopt;
+    }
+    TensorView view = *this;
+    std::swap(view.dims[a], view.dims[b]);
+    std::swap(view.strides[a], view.strides[b]);
+    return view;
+}
+
+std::optional<TensorView> TensorView::Permute(
+    std::span<const size_t> order) const
+{
+    std::vector<bool> seen(dims.size(), false);
+    if (order.size() != dims.size()) {
+        LOG_ERROR("Permutation of {} axes for a {}-D tensor",
+                  order.size(),
+                  dims.size());
+        return std::nullopt;
+    }
+    TensorView view = *this;
+    for (size_t d = 0; d < order.size(); ++d) {
+        if (order[d] >= dims.size() || seen[order[d]]) {
+            LOG_ERROR("Invalid permutation axis {}", order[d]);
+            return std::nullopt;
+        }
+        seen[order[d]] = true;
+        view.dims[d] = dims[order[d]];
+        view.strides[d] = strides[order[d]];
+    }
+    return view;
+}
+
+std::optional<TensorView> TensorView::Slice(size_t axis,
+                                            int32_t begin,
+                                            int32_t end,
+                                            int32_t step) const
+{
+    if (axis >= dims.size() || step <= 0 || begin < 0 || end > dims[axis]
+        || begin >= end)
+    {
+        LOG_ERROR("Invalid slice [{}, {}) step {} of axis {}",
+                  begin,
+                  end,
+                  step,
+                  axis);
+        return std::nullopt;
+    }
+    TensorView view = *this;
+    view.offset += begin * strides[axis];
+    view.dims[axis] = (end - begin + step - 1) / step;
+    view.strides[axis] *= step;
+    return view;
+}
+
+std::optional<TensorView> TensorView::Expand(
+    std::span<const int32_t> newDims) const
+{
+    if (newDims.size() < dims.size()) {
+        LOG_ERROR("Cannot expand a {}-D tensor to {} dimensions",
+                  dims.size(),
+                  newDims.size());
+        return std::nullopt;
+    }
+    const size_t leading = newDims.size() - dims.size();
+    TensorView view;
+    view.dims.assign(newDims.begin(), newDims.end());
+    view.strides.assign(newDims.size(), 0);
+    view.offset = offset;
+    for (size_t d = 0; d < dims.size(); ++d) {
+        const int32_t target = newDims[leading + d];
+        if (dims[d] == target) {
+            view.strides[leading + d] = strides[d];
+        } else if (dims[d] != 1) {
+            LOG_ERROR("Cannot expand axis {} of size {} to {}",
+                      d,
+                      dims[d],
+                      target);
+            return std::nullopt;
+        }
+    }
+    return view;
+}
+
+std::vector<std::byte> EncodeShape(std::span<const int32_t> dims)
+{
+    return EncodeShape(TensorView::Contiguous(dims));
+}
+
+std::vector<std::byte> EncodeShape(const TensorView& view)
+{
+    std140::Encoder encoder;
+    {
+        auto shape = encoder.beginStruct();
+        {
+            auto tuple = encoder.beginStruct();
+            for (int32_t dim : view.dims) {
+                encoder.write(dim);
+            }
+        }
+        encoder.write(view.Count());
+        {
+            auto tuple = encoder.beginStruct();
+            for (int32_t stride : view.strides) {
+                encoder.write(stride);
+            }
+        }
+        encoder.write(view.offset);
+        encoder.write(int32_t {view.IsContiguous() ? 1 : 0});
+    }
+    return encoder.data();
+}
+
+std::vector<std::byte> EncodeChunkedShape(std::span<const int32_t> dims,
+                                          uint32_t chunkElements)
+{
+    // Shape is a struct of its own, so its encoding already ends on a
+    // 16-byte boundary and the chunk size follows it directly.
+    std::vector<std::byte> shape = EncodeShape(dims);
+    std140::Encoder encoder;
+    {
+        auto chunked = encoder.beginStruct();
+        encoder.write(chunkElements);
+    }
+    shape.insert(shape.end(), encoder.data().begin(), encoder.data().end());
+    return shape;
+}
+
+std::vector<std::byte> EncodeCsrShape(int32_t rows,
+                                      int32_t cols,
+                                      int32_t nnz)
+{
+    std140::Encoder encoder;
+    {
+        auto shape = encoder.beginStruct();
+        encoder.write(rows);
+        encoder.write(cols);
+        encoder.write(nnz);
+    }
+    return encoder.data();
+}
+
 TensorBuffer::TensorBuffer(
     const tensor_reflection::TensorBufferReflection& refl,
     wgpu::ShaderStage visibility)
@@ -33,6 +237,13 @@ TensorBuffer::TensorBuffer(
     mEntries[1].binding = mReflection.dataBinding;
 }
 
+size_t PaddedBytes(size_t byteSize)
+{
+    const size_t padded = (byteSize + kStorageAlignment - 1)
+        & ~(kStorageAlignment - 1);
+    return std::max(padded, kStorageAlignment);
+}
+
 void TensorBuffer::Initialize(wgpu::Device device,
                               size_t byteSize,
                               wgpu::BufferUsage extraUsage)
@@ -47,23 +258,77 @@ void TensorBuffer::Initialize(wgpu::Device device,
         .size = mReflection.shapeOffset + mReflection.shapeSize,
         .mappedAtCreation = false,
     };
-    mShapeBuffer = device.CreateBuffer(&shapeDesc);
-    mEntries[0].buffer = mShapeBuffer;
+    mShapeBuffer = gpu_memory::CreateBuffer(device, shapeDesc);
+    mEntries[0].buffer = mShapeBuffer.Get();
     mEntries[0].offset = 0;
     mEntries[0].size = shapeDesc.size;
 
+    InitializeData(device, byteSize, extraUsage);
+    mInitialized = true;
+}
+
+void TensorBuffer::Initialize(wgpu::Device device,
+                              size_t byteSize,
+                              const uniform_buffer::UniformBuffer& uniforms,
+                              wgpu::BufferUsage extraUsage)
+{
+    if (mInitialized) {
+        return;
+    }
+
+    mEntries[0] = *uniforms.GetBindGroupEntries();
+    mLayoutEntries[0] = *uniforms.GetBindGroupLayoutEntries();
+
+    InitializeData(device, byteSize, extraUsage);
+    mInitialized = true;
+}
+
+void TensorBuffer::Initialize(const uniform_buffer::UniformBuffer& uniforms,
+                              wgpu::Buffer data,
+                              size_t byteSize)
+{
+    if (mInitialized) {
+        return;
+    }
+
+    mEntries[0] = *uniforms.GetBindGroupEntries();
+    mLayoutEntries[0] = *uniforms.GetBindGroupLayoutEntries();
+
+    mEntries[1].buffer = data;
+    mEntries[1].offset = 0;
+    mEntries[1].size = byteSize;
+    mInitialized = true;
+}
+
+void TensorBuffer::InitializeData(wgpu::Device device,
+                                  size_t byteSize,
+                                  wgpu::BufferUsage extraUsage)
+{
     wgpu::BufferDescriptor dataDesc = {
         .label = "tensor_data",
         .usage = wgpu::BufferUsage::Storage | extraUsage,
-        .size = byteSize,
+        .size = PaddedBytes(byteSize),
         .mappedAtCreation = false,
     };
-    mDataBuffer = device.CreateBuffer(&dataDesc);
-    mEntries[1].buffer = mDataBuffer;
+    mDataBuffer = gpu_memory::CreateBuffer(device, dataDesc);
+    mEntries[1].buffer = mDataBuffer.Get();
     mEntries[1].offset = 0;
-    mEntries[1].size = byteSize;
+    mEntries[1].size = dataDesc.size;
+}
 
-    mInitialized = true;
+void TensorBuffer::WriteShape(wgpu::Queue queue,
+                              std::span<const int32_t> dims) const
+{
+    std::vector<std::byte> shape = EncodeShape(dims);
+    queue.WriteBuffer(
+        GetShapeBuffer(), GetShapeOffset(), shape.data(), shape.size());
+}
+
+void TensorBuffer::WriteShape(wgpu::Queue queue, const TensorView& view) const
+{
+    std::vector<std::byte> shape = EncodeShape(view);
+    queue.WriteBuffer(
+        GetShapeBuffer(), GetShapeOffset(), shape.data(), shape.size());
 }
 
 const wgpu::BindGroupLayoutEntry* TensorBuffer::GetBindGroupLayoutEntries()
@@ -84,12 +349,12 @@ size_t TensorBuffer::GetEntryCount() const
 
 wgpu::Buffer TensorBuffer::GetDataBuffer() const
 {
-    return mDataBuffer;
+    return mEntries[1].buffer;
 }
 
 wgpu::Buffer TensorBuffer::GetShapeBuffer() const
 {
-    return mShapeBuffer;
+    return mEntries[0].buffer;
 }
 
 size_t TensorBuffer::GetShapeOffset() const
@@ -102,4 +367,343 @@ size_t TensorBuffer::GetShapeSize() const
     return mReflection.shapeSize;
 }
 
+namespace
+{
+// Storage bindings and queue writes must cover a multiple of four bytes.
+size_t AlignTo4(size_t size)
+{
+    return (size + 3) & ~size_t {3};
+}
+}    // namespace
+
+ChunkedTensorBuffer::ChunkedTensorBuffer(
+    const tensor_reflection::ChunkedTensorBufferReflection& refl,
+    wgpu::ShaderStage visibility)
+    : mReflection(refl)
+    , mVisibility(visibility)
+{
+    mLayoutEntries[0] = {
+        .binding = mReflection.shapeBinding,
+        .visibility = mVisibility,
+        .buffer =
+            {
+                .type = wgpu::BufferBindingType::Uniform,
+                .hasDynamicOffset = false,
+                .minBindingSize = mReflection.shapeSize,
+            },
+    };
+    mEntries[0].binding = mReflection.shapeBinding;
+
+    for (size_t c = 0; c < tensor_reflection::kMaxTensorChunks; ++c) {
+        mLayoutEntries[1 + c] = {
+            .binding = mReflection.chunkBindings[c],
+            .visibility = mVisibility,
+            .buffer =
+                {
+                    .type = wgpu::BufferBindingType::Storage,
+                    .hasDynamicOffset = false,
+                    .minBindingSize = 0,
+                },
+        };
+        mEntries[1 + c].binding = mReflection.chunkBindings[c];
+    }
+}
+
+bool ChunkedTensorBuffer::Initialize(wgpu::Device device,
+                                     size_t byteSize,
+                                     size_t elementSize,
+                                     size_t maxChunkBytes,
+                                     wgpu::BufferUsage extraUsage)
+{
+    if (mInitialized) {
+        return true;
+    }
+    if (elementSize == 0) {
+        LOG_ERROR("Chunked tensor element size must be non-zero");
+        return false;
+    }
+
+    wgpu::Limits limits {};
+    device.GetLimits(&limits);
+    size_t deviceMax = static_cast<size_t>(std::min(
+        limits.maxStorageBufferBindingSize, limits.maxBufferSize));
+    size_t chunkBytes =
+        maxChunkBytes == 0 ? deviceMax : std::min(maxChunkBytes, deviceMax);
+
+    size_t chunkElements = chunkBytes / elementSize;
+    size_t elementCount = (byteSize + elementSize - 1) / elementSize;
+    if (chunkElements == 0 || chunkElements > UINT32_MAX) {
+        LOG_ERROR("Invalid chunk size of {} bytes for {}-byte elements",
+                  chunkBytes,
+                  elementSize);
+        return false;
+    }
+    if (elementCount > tensor_reflection::kMaxChunkedElements) {
+        LOG_ERROR("Chunked tensor of {} elements exceeds the 32-bit index "
+                  "limit of {}",
+                  elementCount,
+                  tensor_reflection::kMaxChunkedElements);
+        return false;
+    }
+    size_t chunkCount =
+        std::max<size_t>(1, (elementCount + chunkElements - 1) / chunkElements);
+    if (chunkCount > tensor_reflection::kMaxTensorChunks) {
+        LOG_ERROR("Tensor of {} bytes needs {} chunks of {} bytes, at most {} "
+                  "are supported",
+                  byteSize,
+                  chunkCount,
+                  chunkElements * elementSize,
+                  tensor_reflection::kMaxTensorChunks);
+        return false;
+    }
+
+    wgpu::BufferDescriptor shapeDesc = {
+        .label = "tensor_shape",
+        .usage = wgpu::BufferUsage::Uniform | wgpu::BufferUsage::CopyDst,
+        .size = mReflection.shapeOffset + mReflection.shapeSize,
+        .mappedAtCreation = false,
+    };
+    mShapeBuffer = gpu_memory::CreateBuffer(device, shapeDesc);
+    mEntries[0].buffer = mShapeBuffer.Get();
+    mEntries[0].offset = 0;
+    mEntries[0].size = shapeDesc.size;
+
+    for (size_t c = 0; c < tensor_reflection::kMaxTensorChunks; ++c) {
+        size_t first = std::min(c * chunkElements, elementCount);
+        size_t count =
+            c < chunkCount ? std::min(chunkElements, elementCount - first) : 0;
+
+        // Unused chunks still need a binding; give each its own small buffer
+        // so that no two writable storage bindings alias.
+        wgpu::BufferDescriptor chunkDesc = {
+            .label = c < chunkCount ? "tensor_chunk" : "tensor_chunk_unused",
+            .usage = wgpu::BufferUsage::Storage | extraUsage,
+            .size = std::max<size_t>(4, AlignTo4(count * elementSize)),
+            .mappedAtCreation = false,
+        };
+        mChunks[c] = gpu_memory::CreateBuffer(device, chunkDesc);
+        mChunkBytes[c] = count * elementSize;
+        mEntries[1 + c].buffer = mChunks[c].Get();
+        mEntries[1 + c].offset = 0;
+        mEntries[1 + c].size = chunkDesc.size;
+    }
+
+    mChunkCount = chunkCount;
+    mChunkElements = static_cast<uint32_t>(chunkElements);
+    mElementSize = elementSize;
+    mInitialized = true;
+    return true;
+}
+
+bool ChunkedTensorBuffer::Initialize(
+    const uniform_buffer::UniformBuffer& uniforms,
+    std::span<const wgpu::Buffer> chunks,
+    uint32_t chunkElements,
+    size_t elementSize)
+{
+    if (mInitialized) {
+        return true;
+    }
+    if (chunks.size() != tensor_reflection::kMaxTensorChunks
+        || chunkElements == 0 || elementSize == 0)
+    {
+        LOG_ERROR("A chunked tensor binds {} chunks of non-zero size, got {}",
+                  tensor_reflection::kMaxTensorChunks,
+                  chunks.size());
+        return false;
+    }
+
+    mEntries[0] = *uniforms.GetBindGroupEntries();
+    mLayoutEntries[0] = *uniforms.GetBindGroupLayoutEntries();
+
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        mChunkBytes[c] = chunks[c].GetSize();
+        mEntries[1 + c].buffer = chunks[c];
+        mEntries[1 + c].offset = 0;
+        mEntries[1 + c].size = chunks[c].GetSize();
+    }
+
+    mChunkCount = chunks.size();
+    mChunkElements = chunkElements;
+    mElementSize = elementSize;
+    mInitialized = true;
+    return true;
+}
+
+void ChunkedTensorBuffer::Write(wgpu::Queue queue,
+                                const void* data,
+                                size_t byteSize) const
+{
+    const auto* bytes = static_cast<const std::byte*>(data);
+    size_t chunkBytes = mChunkElements * mElementSize;
+    for (size_t c = 0; c < mChunkCount; ++c) {
+        size_t first = c * chunkBytes;
+        if (first >= byteSize) {
+            break;
+        }
+        size_t size = std::min(chunkBytes, byteSize - first);
+        queue.WriteBuffer(GetChunkBuffer(c), 0, bytes + first, size);
+    }
+}
+
+void ChunkedTensorBuffer::WriteShape(wgpu::Queue queue,
+                                     std::span<const int32_t> dims) const
+{
+    std::vector<std::byte> shape = EncodeChunkedShape(dims, mChunkElements);
+    queue.WriteBuffer(
+        GetShapeBuffer(), GetShapeOffset(), shape.data(), shape.size());
+}
+
+const wgpu::BindGroupLayoutEntry*
+ChunkedTensorBuffer::GetBindGroupLayoutEntries() const
+{
+    return mLayoutEntries;
+}
+
+const wgpu::BindGroupEntry* ChunkedTensorBuffer::GetBindGroupEntries() const
+{
+    return mEntries;
+}
+
+size_t ChunkedTensorBuffer::GetEntryCount() const
+{
+    return kEntryCount;
+}
+
+uint32_t ChunkedTensorBuffer::GetChunkElements() const
+{
+    return mChunkElements;
+}
+
+size_t ChunkedTensorBuffer::GetChunkCount() const
+{
+    return mChunkCount;
+}
+
+wgpu::Buffer ChunkedTensorBuffer::GetChunkBuffer(size_t chunk) const
+{
+    return mEntries[1 + chunk].buffer;
+}
+
+size_t ChunkedTensorBuffer::GetChunkByteSize(size_t chunk) const
+{
+    return mChunkBytes[chunk];
+}
+
+wgpu::Buffer ChunkedTensorBuffer::GetShapeBuffer() const
+{
+    return mEntries[0].buffer;
+}
+
+size_t ChunkedTensorBuffer::GetShapeOffset() const
+{
+    return mReflection.shapeOffset;
+}
+
+size_t ChunkedTensorBuffer::GetShapeSize() const
+{
+    return mReflection.shapeSize;
+}
+
+CsrTensorBuffer::CsrTensorBuffer(
+    const tensor_reflection::CsrTensorBufferReflection& refl,
+    wgpu::ShaderStage visibility)
+    : mReflection(refl)
+    , mVisibility(visibility)
+{
+    mLayoutEntries[0] = {
+        .binding = mReflection.shapeBinding,
+        .visibility = mVisibility,
+        .buffer =
+            {
+                .type = wgpu::BufferBindingType::Uniform,
+                .hasDynamicOffset = false,
+                .minBindingSize = mReflection.shapeSize,
+            },
+    };
+    mEntries[0].binding = mReflection.shapeBinding;
+
+    const std::array<uint32_t, kEntryCount - 1> bindings = {
+        mReflection.rowPtrBinding,
+        mReflection.colIndicesBinding,
+        mReflection.valuesBinding,
+    };
+    for (size_t i = 0; i < bindings.size(); ++i) {
+        mLayoutEntries[1 + i] = {
+            .binding = bindings[i],
+            .visibility = mVisibility,
+            .buffer =
+                {
+                    .type = wgpu::BufferBindingType::Storage,
+                    .hasDynamicOffset = false,
+                    .minBindingSize = 0,
+                },
+        };
+        mEntries[1 + i].binding = bindings[i];
+    }
+}
+
+void CsrTensorBuffer::Initialize(const uniform_buffer::UniformBuffer& uniforms,
+                                 wgpu::Buffer rowPtr,
+                                 wgpu::Buffer colIndices,
+                                 wgpu::Buffer values)
+{
+    if (mInitialized) {
+        return;
+    }
+
+    mEntries[0] = *uniforms.GetBindGroupEntries();
+    mLayoutEntries[0] = *uniforms.GetBindGroupLayoutEntries();
+
+    const std::array<wgpu::Buffer, kEntryCount - 1> buffers = {
+        rowPtr, colIndices, values};
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        mEntries[1 + i].buffer = buffers[i];
+        mEntries[1 + i].offset = 0;
+        mEntries[1 + i].size = buffers[i].GetSize();
+    }
+    mInitialized = true;
+}
+
+void CsrTensorBuffer::WriteShape(wgpu::Queue queue,
+                                 int32_t rows,
+                                 int32_t cols,
+                                 int32_t nnz) const
+{
+    std::vector<std::byte> shape = EncodeCsrShape(rows, cols, nnz);
+    queue.WriteBuffer(
+        GetShapeBuffer(), GetShapeOffset(), shape.data(), shape.size());
+}
+
+const wgpu::BindGroupLayoutEntry* CsrTensorBuffer::GetBindGroupLayoutEntries()
+    const
+{
+    return mLayoutEntries;
+}
+
+const wgpu::BindGroupEntry* CsrTensorBuffer::GetBindGroupEntries() const
+{
+    return mEntries;
+}
+
+size_t CsrTensorBuffer::GetEntryCount() const
+{
+    return kEntryCount;
+}
+
+wgpu::Buffer CsrTensorBuffer::GetShapeBuffer() const
+{
+    return mEntries[0].buffer;
+}
+
+size_t CsrTensorBuffer::GetShapeOffset() const
+{
+    return mReflection.shapeOffset;
+}
+
+size_t CsrTensorBuffer::GetShapeSize() const
+{
+    return mReflection.shapeSize;
+}
+
 }    // namespace tensor_buffer
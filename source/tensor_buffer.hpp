@@ -1,22 +1,147 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
 #include <webgpu/webgpu_cpp.h>
 
+#include "gpu_memory.hpp"
 #include "tensor_reflection.hpp"
+#include "uniform_buffer.hpp"
 
 namespace tensor_buffer
 {
+/**
+ * @brief Where the elements of a tensor live in its buffer.
+ *
+ * Element (i0, i1, ...) is buffer element offset + i0 * strides[0] + i1 *
+ * strides[1] + ..., so transposes, slices and broadcasts are new views of the
+ * same buffer rather than copies. Strides are in elements and non-negative.
+ */
+struct TensorView
+{
+    std::vector<int32_t> dims;    // outermost first
+    std::vector<int32_t> strides;
+    int32_t offset = 0;
+
+    /// Row-major view of `dims` starting at element 0.
+    [[nodiscard]] static TensorView Contiguous(std::span<const int32_t> dims);
+
+    /// Number of elements in the view.
+    [[nodiscard]] int32_t Count() const;
+
+    /// Whether the strides are the row-major strides of dims, so that
+    /// kernels can take the contiguous fast path. Any offset is allowed.
+    [[nodiscard]] bool IsContiguous() const;
+
+    /// The same elements with new dimensions; only for contiguous views.
+    [[nodiscard]] std::optional<TensorView> View(
+        std::span<const int32_t> newDims) const;
+
+    /// Swaps two axes.
+    [[nodiscard]] std::optional<TensorView> Transpose(size_t a,
+                                                      size_t b) const;
+
+    /// Reorders the axes; axis i of the result is axis order[i] of this view.
+    [[nodiscard]] std::optional<TensorView> Permute(
+        std::span<const size_t> order) const;
+
+    /// Elements begin, begin + step, ... below end along one axis.
+    [[nodiscard]] std::optional<TensorView> Slice(size_t axis,
+                                                  int32_t begin,
+                                                  int32_t end,
+                                                  int32_t step = 1) const;
+
+    /**
+     * @brief Broadcasts size-1 axes to `newDims` with stride 0. Leading axes
+     * may be added, like NumPy broadcasting.
+     */
+    [[nodiscard]] std::optional<TensorView> Expand(
+        std::span<const int32_t> newDims) const;
+};
+
+/// A float tensor in a caller-owned storage buffer, possibly strided.
+struct BufferView
+{
+    wgpu::Buffer buffer {nullptr};
+    TensorView view;
+};
+
+/**
+ * Encodes a row-major Shape<each I> uniform with std140 layout.
+ * @param dims size of each dimension, outermost first
+ */
+[[nodiscard]] std::vector<std::byte> EncodeShape(
+    std::span<const int32_t> dims);
+
+/**
+ * Encodes a Shape<each I> uniform for a strided view: dimensions, element
+ * count, strides, offset and whether the view is contiguous.
+ */
+[[nodiscard]] std::vector<std::byte> EncodeShape(const TensorView& view);
+
+/**
+ * Encodes the ChunkedShape<each I> uniform of a contiguous chunked tensor:
+ * its Shape followed by the number of elements per chunk.
+ */
+[[nodiscard]] std::vector<std::byte> EncodeChunkedShape(
+    std::span<const int32_t> dims, uint32_t chunkElements);
+
+/// Encodes the CsrShape uniform of a CsrTensorBuffer (tensor.slang).
+[[nodiscard]] std::vector<std::byte> EncodeCsrShape(int32_t rows,
+                                                    int32_t cols,
+                                                    int32_t nnz);
+
+/// Granularity of tensor data allocations, so that RWTensorBufferVec4 can
+/// bind every buffer as whole 16-byte vectors.
+inline constexpr size_t kStorageAlignment = 16;
+
+/// `byteSize` rounded up to a non-zero multiple of kStorageAlignment.
+[[nodiscard]] size_t PaddedBytes(size_t byteSize);
+
 class TensorBuffer
 {
   public:
     TensorBuffer(const tensor_reflection::TensorBufferReflection& refl,
                  wgpu::ShaderStage visibility = wgpu::ShaderStage::Compute);
 
+    /// Allocates a data buffer of PaddedBytes(byteSize) and a buffer for
+    /// the shape.
+    void Initialize(wgpu::Device device,
+                    size_t byteSize,
+                    wgpu::BufferUsage extraUsage = wgpu::BufferUsage::CopyDst
+                        | wgpu::BufferUsage::CopySrc);
+
+    /**
+     * @brief Allocates the data buffer and places the shape in the kernel's
+     * shared uniform buffer instead of a buffer of its own.
+     */
     void Initialize(wgpu::Device device,
                     size_t byteSize,
+                    const uniform_buffer::UniformBuffer& uniforms,
                     wgpu::BufferUsage extraUsage = wgpu::BufferUsage::CopyDst
                         | wgpu::BufferUsage::CopySrc);
 
+    /**
+     * @brief Binds an existing storage buffer as the tensor's data instead of
+     * allocating one, with the shape in the kernel's shared uniform buffer.
+     * The caller keeps ownership of `data`.
+     */
+    void Initialize(const uniform_buffer::UniformBuffer& uniforms,
+                    wgpu::Buffer data,
+                    size_t byteSize);
+
+    /// Writes the shape uniform for a contiguous tensor of the given
+    /// dimensions.
+    void WriteShape(wgpu::Queue queue, std::span<const int32_t> dims) const;
+
+    /// Writes the shape uniform for a strided view of the data buffer.
+    void WriteShape(wgpu::Queue queue, const TensorView& view) const;
+
     [[nodiscard]] const wgpu::BindGroupLayoutEntry* GetBindGroupLayoutEntries()
         const;
     [[nodiscard]] const wgpu::BindGroupEntry* GetBindGroupEntries() const;
@@ -31,11 +156,159 @@ class TensorBuffer
     tensor_reflection::TensorBufferReflection mReflection;
     wgpu::ShaderStage mVisibility;
 
-    wgpu::Buffer mDataBuffer {nullptr};
-    wgpu::Buffer mShapeBuffer {nullptr};
+    void InitializeData(wgpu::Device device,
+                        size_t byteSize,
+                        wgpu::BufferUsage extraUsage);
+
+    gpu_memory::TrackedBuffer mDataBuffer;
+    gpu_memory::TrackedBuffer mShapeBuffer;    // empty when shared
 
     wgpu::BindGroupLayoutEntry mLayoutEntries[2] {};
     wgpu::BindGroupEntry mEntries[2] {};
     bool mInitialized = false;
 };
+
+/**
+ * @brief Host side of a ChunkedRWTensorBuffer.
+ *
+ * Spreads a tensor that exceeds the device's storage binding limit over up to
+ * tensor_reflection::kMaxTensorChunks storage buffers. Kernels index it as one
+ * logical tensor; the number of elements per chunk is part of the shape
+ * uniform and must be written after the dimensions and element count.
+ *
+ * The shader picks a chunk with a switch over four fixed bindings and
+ * indexes elements with 32-bit uints, so a tensor holds at most
+ * tensor_reflection::kMaxChunkedElements elements, whatever the device
+ * limits. Dispatches are not split per chunk; one launch covers every 32-bit
+ * index.
+ */
+class ChunkedTensorBuffer
+{
+  public:
+    explicit ChunkedTensorBuffer(
+        const tensor_reflection::ChunkedTensorBufferReflection& refl,
+        wgpu::ShaderStage visibility = wgpu::ShaderStage::Compute);
+
+    /**
+     * @brief Allocates the shape buffer and one storage buffer per chunk.
+     * @param device Device to allocate on.
+     * @param byteSize Logical size of the tensor in bytes.
+     * @param elementSize Size in bytes of one tensor element.
+     * @param maxChunkBytes Upper bound on the size of a chunk, 0 to use the
+     * device's maxStorageBufferBindingSize and maxBufferSize.
+     * @param extraUsage Usage flags added to the storage usage of the chunks.
+     * @return false if the tensor does not fit in kMaxTensorChunks chunks or
+     * has more than kMaxChunkedElements elements.
+     */
+    bool Initialize(wgpu::Device device,
+                    size_t byteSize,
+                    size_t elementSize,
+                    size_t maxChunkBytes = 0,
+                    wgpu::BufferUsage extraUsage = wgpu::BufferUsage::CopyDst
+                        | wgpu::BufferUsage::CopySrc);
+
+    /**
+     * @brief Binds chunks allocated elsewhere, with the shape in the
+     * kernel's shared uniform buffer, so that several kernels can index one
+     * chunked tensor. The caller keeps ownership of the chunks.
+     * @param chunks kMaxTensorChunks distinct storage buffers, the unused
+     * ones included.
+     * @param chunkElements Elements per chunk.
+     * @param elementSize Size in bytes of one tensor element.
+     * @return false if the chunks or sizes are invalid.
+     */
+    bool Initialize(const uniform_buffer::UniformBuffer& uniforms,
+                    std::span<const wgpu::Buffer> chunks,
+                    uint32_t chunkElements,
+                    size_t elementSize);
+
+    /// Uploads `byteSize` bytes (a multiple of four) of row-major tensor data
+    /// across the chunks.
+    void Write(wgpu::Queue queue, const void* data, size_t byteSize) const;
+
+    /// Writes the shape uniform, including the chunk size, for a contiguous
+    /// tensor of the given dimensions.
+    void WriteShape(wgpu::Queue queue, std::span<const int32_t> dims) const;
+
+    [[nodiscard]] const wgpu::BindGroupLayoutEntry* GetBindGroupLayoutEntries()
+        const;
+    [[nodiscard]] const wgpu::BindGroupEntry* GetBindGroupEntries() const;
+    [[nodiscard]] size_t GetEntryCount() const;
+
+    [[nodiscard]] uint32_t GetChunkElements() const;
+    [[nodiscard]] size_t GetChunkCount() const;
+    [[nodiscard]] wgpu::Buffer GetChunkBuffer(size_t chunk) const;
+    [[nodiscard]] size_t GetChunkByteSize(size_t chunk) const;
+
+    [[nodiscard]] wgpu::Buffer GetShapeBuffer() const;
+    [[nodiscard]] size_t GetShapeOffset() const;
+    [[nodiscard]] size_t GetShapeSize() const;
+
+  private:
+    static constexpr size_t kEntryCount =
+        1 + tensor_reflection::kMaxTensorChunks;
+
+    tensor_reflection::ChunkedTensorBufferReflection mReflection;
+    wgpu::ShaderStage mVisibility;
+
+    // Empty when the chunks are owned elsewhere.
+    std::array<gpu_memory::TrackedBuffer, tensor_reflection::kMaxTensorChunks>
+        mChunks {};
+    std::array<size_t, tensor_reflection::kMaxTensorChunks> mChunkBytes {};
+    size_t mChunkCount = 0;
+    uint32_t mChunkElements = 0;
+    size_t mElementSize = 0;
+    gpu_memory::TrackedBuffer mShapeBuffer;    // empty when shared
+
+    wgpu::BindGroupLayoutEntry mLayoutEntries[kEntryCount] {};
+    wgpu::BindGroupEntry mEntries[kEntryCount] {};
+    bool mInitialized = false;
+};
+
+/**
+ * @brief Host side of a CsrTensorBuffer.
+ *
+ * Binds the row offsets, column indices and values of a sparse matrix held
+ * in caller-owned storage buffers, with the shape in the kernel's shared
+ * uniform buffer.
+ */
+class CsrTensorBuffer
+{
+  public:
+    explicit CsrTensorBuffer(
+        const tensor_reflection::CsrTensorBufferReflection& refl,
+        wgpu::ShaderStage visibility = wgpu::ShaderStage::Compute);
+
+    /// Binds whole buffers; the caller keeps ownership of them.
+    void Initialize(const uniform_buffer::UniformBuffer& uniforms,
+                    wgpu::Buffer rowPtr,
+                    wgpu::Buffer colIndices,
+                    wgpu::Buffer values);
+
+    /// Writes the shape uniform of a [rows, cols] matrix with `nnz` stored
+    /// elements.
+    void WriteShape(wgpu::Queue queue,
+                    int32_t rows,
+                    int32_t cols,
+                    int32_t nnz) const;
+
+    [[nodiscard]] const wgpu::BindGroupLayoutEntry* GetBindGroupLayoutEntries()
+        const;
+    [[nodiscard]] const wgpu::BindGroupEntry* GetBindGroupEntries() const;
+    [[nodiscard]] size_t GetEntryCount() const;
+
+    [[nodiscard]] wgpu::Buffer GetShapeBuffer() const;
+    [[nodiscard]] size_t GetShapeOffset() const;
+    [[nodiscard]] size_t GetShapeSize() const;
+
+  private:
+    static constexpr size_t kEntryCount = 4;
+
+    tensor_reflection::CsrTensorBufferReflection mReflection;
+    wgpu::ShaderStage mVisibility;
+
+    wgpu::BindGroupLayoutEntry mLayoutEntries[kEntryCount] {};
+    wgpu::BindGroupEntry mEntries[kEntryCount] {};
+    bool mInitialized = false;
+};
 }    // namespace tensor_buffer
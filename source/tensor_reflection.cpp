@@ -26,10 +26,18 @@ slang::VariableLayoutReflection* FindField(
     return nullptr;
 }
 
-}    // namespace
-
-std::optional<TensorBufferReflection> ReflectTensorBuffer(
-    slang::IComponentType* program, const std::string& paramName)
+// A tensor parameter located in the global scope, together with the binding
+// of the constant buffer that holds its shape.
+struct TensorParam
+{
+    slang::VariableLayoutReflection* scope = nullptr;
+    slang::VariableLayoutReflection* tensorVar = nullptr;
+    uint32_t shapeBinding = 0;
+    uint32_t shapeSpace = 0;
+};
+
+std::optional<TensorParam> FindTensorParam(slang::IComponentType* program,
+                                           const std::string& paramName)
 {
     if (!program) {
         return std::nullopt;
@@ -48,10 +56,9 @@ std::optional<TensorBufferReflection> ReflectTensorBuffer(
     }
 
     // Global scope may be wrapped in a parameter block and constant buffer.
-    slang::VariableLayoutReflection* scope = global;
-    auto* typeLayout = scope->getTypeLayout();
-
-    TensorBufferReflection result {};
+    TensorParam param {};
+    param.scope = global;
+    auto* typeLayout = param.scope->getTypeLayout();
 
     if (typeLayout
         && (typeLayout->getKind() == slang::TypeReflection::Kind::ParameterBlock
@@ -63,30 +70,82 @@ std::optional<TensorBufferReflection> ReflectTensorBuffer(
         slang::VariableLayoutReflection* container =
             typeLayout->getContainerVarLayout();
         if (container) {
-            result.shapeBinding = static_cast<uint32_t>(container->getOffset(
+            param.shapeBinding = static_cast<uint32_t>(container->getOffset(
                 slang::ParameterCategory::DescriptorTableSlot));
-            result.shapeSpace =
+            param.shapeSpace =
                 static_cast<uint32_t>(container->getBindingSpace(
                     slang::ParameterCategory::DescriptorTableSlot));
         }
-        scope = typeLayout->getElementVarLayout();
-        typeLayout = scope ? scope->getTypeLayout() : nullptr;
+        param.scope = typeLayout->getElementVarLayout();
+        typeLayout = param.scope ? param.scope->getTypeLayout() : nullptr;
     }
 
-    if (!scope || !typeLayout
+    if (!param.scope || !typeLayout
         || typeLayout->getKind() != slang::TypeReflection::Kind::Struct)
     {
         return std::nullopt;
     }
 
-    slang::VariableLayoutReflection* tensorVar =
-        FindField(typeLayout, paramName);
-    if (!tensorVar) {
+    param.tensorVar = FindField(typeLayout, paramName);
+    if (!param.tensorVar) {
+        return std::nullopt;
+    }
+    return param;
+}
+
+// Cumulative binding index of a resource field of the tensor
+uint32_t FieldBinding(const TensorParam& param,
+                      slang::VariableLayoutReflection* field)
+{
+    return static_cast<uint32_t>(
+        param.scope->getOffset(slang::ParameterCategory::DescriptorTableSlot)
+        + param.tensorVar->getOffset(
+            slang::ParameterCategory::DescriptorTableSlot)
+        + field->getOffset(slang::ParameterCategory::DescriptorTableSlot));
+}
+
+// Cumulative binding space of a resource field of the tensor
+uint32_t FieldSpace(const TensorParam& param,
+                    slang::VariableLayoutReflection* field)
+{
+    return static_cast<uint32_t>(
+        param.scope->getBindingSpace(
+            slang::ParameterCategory::DescriptorTableSlot)
+        + param.tensorVar->getBindingSpace(
+            slang::ParameterCategory::DescriptorTableSlot)
+        + field->getBindingSpace(
+            slang::ParameterCategory::DescriptorTableSlot));
+}
+
+// Byte offset of a uniform field of the tensor within the constant buffer
+size_t FieldUniformOffset(const TensorParam& param,
+                          slang::VariableLayoutReflection* field)
+{
+    return param.scope->getOffset(slang::ParameterCategory::Uniform)
+        + param.tensorVar->getOffset(slang::ParameterCategory::Uniform)
+        + field->getOffset(slang::ParameterCategory::Uniform);
+}
+
+size_t FieldUniformSize(slang::VariableLayoutReflection* field)
+{
+    if (auto* type = field->getTypeLayout()) {
+        return type->getSize(slang::ParameterCategory::Uniform);
+    }
+    return 0;
+}
+
+}    // namespace
+
+std::optional<TensorBufferReflection> ReflectTensorBuffer(
+    slang::IComponentType* program, const std::string& paramName)
+{
+    std::optional<TensorParam> param = FindTensorParam(program, paramName);
+    if (!param) {
         return std::nullopt;
     }
 
     // Access fields of the tensor buffer
-    slang::TypeLayoutReflection* tensorType = tensorVar->getTypeLayout();
+    slang::TypeLayoutReflection* tensorType = param->tensorVar->getTypeLayout();
     slang::VariableLayoutReflection* dataField = FindField(tensorType, "data");
     slang::VariableLayoutReflection* shapeField =
         FindField(tensorType, "shape");
@@ -94,27 +153,89 @@ std::optional<TensorBufferReflection> ReflectTensorBuffer(
         return std::nullopt;
     }
 
+    TensorBufferReflection result {};
+    result.shapeBinding = param->shapeBinding;
+    result.shapeSpace = param->shapeSpace;
+
     // Compute cumulative binding for the data field
-    result.dataBinding = static_cast<uint32_t>(
-        scope->getOffset(slang::ParameterCategory::DescriptorTableSlot)
-        + tensorVar->getOffset(slang::ParameterCategory::DescriptorTableSlot)
-        + dataField->getOffset(slang::ParameterCategory::DescriptorTableSlot));
-    result.dataSpace = static_cast<uint32_t>(
-        scope->getBindingSpace(slang::ParameterCategory::DescriptorTableSlot)
-        + tensorVar->getBindingSpace(
-            slang::ParameterCategory::DescriptorTableSlot)
-        + dataField->getBindingSpace(
-            slang::ParameterCategory::DescriptorTableSlot));
+    result.dataBinding = FieldBinding(*param, dataField);
+    result.dataSpace = FieldSpace(*param, dataField);
 
     // Compute offset and size for the shape struct within the constant buffer
-    result.shapeOffset = scope->getOffset(slang::ParameterCategory::Uniform)
-        + tensorVar->getOffset(slang::ParameterCategory::Uniform)
-        + shapeField->getOffset(slang::ParameterCategory::Uniform);
-    if (auto* shapeType = shapeField->getTypeLayout()) {
-        result.shapeSize =
-            shapeType->getSize(slang::ParameterCategory::Uniform);
+    result.shapeOffset = FieldUniformOffset(*param, shapeField);
+    result.shapeSize = FieldUniformSize(shapeField);
+
+    return result;
+}
+
+std::optional<ChunkedTensorBufferReflection> ReflectChunkedTensorBuffer(
+    slang::IComponentType* program, const std::string& paramName)
+{
+    std::optional<TensorParam> param = FindTensorParam(program, paramName);
+    if (!param) {
+        return std::nullopt;
+    }
+
+    slang::TypeLayoutReflection* tensorType = param->tensorVar->getTypeLayout();
+    slang::VariableLayoutReflection* shapeField =
+        FindField(tensorType, "shape");
+    if (!shapeField) {
+        return std::nullopt;
+    }
+
+    ChunkedTensorBufferReflection result {};
+    result.shapeBinding = param->shapeBinding;
+    result.shapeSpace = param->shapeSpace;
+
+    for (uint32_t c = 0; c < kMaxTensorChunks; ++c) {
+        slang::VariableLayoutReflection* chunkField =
+            FindField(tensorType, "chunk" + std::to_string(c));
+        if (!chunkField) {
+            return std::nullopt;
+        }
+        result.chunkBindings[c] = FieldBinding(*param, chunkField);
+        result.chunkSpace = FieldSpace(*param, chunkField);
     }
 
+    result.shapeOffset = FieldUniformOffset(*param, shapeField);
+    result.shapeSize = FieldUniformSize(shapeField);
+
+    return result;
+}
+
+std::optional<CsrTensorBufferReflection> ReflectCsrTensorBuffer(
+    slang::IComponentType* program, const std::string& paramName)
+{
+    std::optional<TensorParam> param = FindTensorParam(program, paramName);
+    if (!param) {
+        return std::nullopt;
+    }
+
+    slang::TypeLayoutReflection* tensorType = param->tensorVar->getTypeLayout();
+    slang::VariableLayoutReflection* rowPtrField =
+        FindField(tensorType, "rowPtr");
+    slang::VariableLayoutReflection* colIndicesField =
+        FindField(tensorType, "colIndices");
+    slang::VariableLayoutReflection* valuesField =
+        FindField(tensorType, "values");
+    slang::VariableLayoutReflection* shapeField =
+        FindField(tensorType, "shape");
+    if (!rowPtrField || !colIndicesField || !valuesField || !shapeField) {
+        return std::nullopt;
+    }
+
+    CsrTensorBufferReflection result {};
+    result.shapeBinding = param->shapeBinding;
+    result.shapeSpace = param->shapeSpace;
+
+    result.rowPtrBinding = FieldBinding(*param, rowPtrField);
+    result.colIndicesBinding = FieldBinding(*param, colIndicesField);
+    result.valuesBinding = FieldBinding(*param, valuesField);
+    result.dataSpace = FieldSpace(*param, valuesField);
+
+    result.shapeOffset = FieldUniformOffset(*param, shapeField);
+    result.shapeSize = FieldUniformSize(shapeField);
+
     return result;
 }
 
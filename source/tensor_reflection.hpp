@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <optional>
 #include <string>
 
@@ -18,6 +20,37 @@ struct TensorBufferReflection
     size_t shapeSize = 0;    // size in bytes of shape struct
 };
 
+/// Number of storage buffers backing a ChunkedRWTensorBuffer (tensor.slang).
+inline constexpr uint32_t kMaxTensorChunks = 4;
+
+/// Largest element count of a ChunkedRWTensorBuffer: its element indices and
+/// chunk size are 32-bit uints, however many chunks hold the data.
+inline constexpr uint64_t kMaxChunkedElements = UINT32_MAX;
+
+struct ChunkedTensorBufferReflection
+{
+    std::array<uint32_t, kMaxTensorChunks> chunkBindings {};    // chunk0..N
+    uint32_t chunkSpace = 0;    // descriptor set / register space for chunks
+    uint32_t shapeBinding =
+        0;    // binding index for constant buffer storing shape
+    uint32_t shapeSpace = 0;    // descriptor set / register space for shape
+    size_t shapeOffset = 0;    // byte offset of shape struct in constant buffer
+    size_t shapeSize = 0;    // size in bytes of shape struct (incl. chunking)
+};
+
+struct CsrTensorBufferReflection
+{
+    uint32_t rowPtrBinding = 0;    // binding index for the row offsets
+    uint32_t colIndicesBinding = 0;    // binding index for the columns
+    uint32_t valuesBinding = 0;    // binding index for the stored values
+    uint32_t dataSpace = 0;    // descriptor set / register space for data
+    uint32_t shapeBinding =
+        0;    // binding index for constant buffer storing shape
+    uint32_t shapeSpace = 0;    // descriptor set / register space for shape
+    size_t shapeOffset = 0;    // byte offset of shape struct in constant buffer
+    size_t shapeSize = 0;    // size in bytes of shape struct
+};
+
 /**
  * Reflect binding information for a tensor buffer parameter.
  * @param program linked Slang program
@@ -28,4 +61,24 @@ struct TensorBufferReflection
 std::optional<TensorBufferReflection> ReflectTensorBuffer(
     slang::IComponentType* program, const std::string& paramName);
 
+/**
+ * Reflect binding information for a chunked tensor buffer parameter.
+ * @param program linked Slang program
+ * @param paramName name of the ChunkedRWTensorBuffer parameter to reflect
+ * @return reflection information if found
+ */
+[[nodiscard]]
+std::optional<ChunkedTensorBufferReflection> ReflectChunkedTensorBuffer(
+    slang::IComponentType* program, const std::string& paramName);
+
+/**
+ * Reflect binding information for a CSR sparse tensor parameter.
+ * @param program linked Slang program
+ * @param paramName name of the CsrTensorBuffer parameter to reflect
+ * @return reflection information if found
+ */
+[[nodiscard]]
+std::optional<CsrTensorBufferReflection> ReflectCsrTensorBuffer(
+    slang::IComponentType* program, const std::string& paramName);
+
 }    // namespace tensor_reflection
@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <numeric>
+#include <vector>
+
+#include "top_k.hpp"
+
+#include <tracy/Tracy.hpp>
+
+#include "dispatch.hpp"
+#include "gpu_memory.hpp"
+#include "logging_macros.h"
+#include "tensor_buffer.hpp"
+
+namespace top_k
+{
+namespace
+{
+/// Host mirror of TopKParams in top_k.slang.
+struct Params
+{
+    int32_t rows;
+    int32_t n;
+    int32_t k;
+};
+}    // namespace
+
+void ReferenceTopK(std::span<const float> logits,
+                   int32_t rows,
+                   int32_t n,
+                   int32_t k,
+                   std::span<float> values,
+                   std::span<int32_t> indices)
+{
+    const auto width = static_cast<size_t>(n);
+    const auto count = static_cast<size_t>(k);
+    std::vector<int32_t> order(width);
+    for (size_t r = 0; r < static_cast<size_t>(rows); ++r) {
+        const std::span<const float> row = logits.subspan(r * width, width);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(),
+                         order.end(),
+                         [&](int32_t a, int32_t b)
+                         {
+                             return row[static_cast<size_t>(a)]
+                                 > row[static_cast<size_t>(b)];
+                         });
+        for (size_t j = 0; j < count; ++j) {
+            values[r * count + j] = row[static_cast<size_t>(order[j])];
+            indices[r * count + j] = order[j];
+        }
+    }
+}
+
+TopK::TopK(std::optional<subgroups::Path> path)
+    : mSorter(path)
+{
+}
+
+bool TopK::Initialize(wgpu::Device device,
+                      const slang_compiler::Compiler& compiler)
+{
+    ZoneScoped;
+    if (mInitialized) {
+        return true;
+    }
+    mDevice = device;
+    if (!mSorter.Initialize(device, compiler)
+        || !InitializeKernel(compiler, "topKInit", mInit)
+        || !InitializeKernel(compiler, "topKRowKeys", mRowKeys)
+        || !InitializeKernel(compiler, "topKGather", mGather))
+    {
+        return false;
+    }
+    mInitialized = true;
+    return true;
+}
+
+bool TopK::InitializeKernel(const slang_compiler::Compiler& compiler,
+                            const char* entryPoint,
+                            Kernel& kernel) const
+{
+    kernel.program = compiler.CreateProgram("top_k", entryPoint);
+    if (!kernel.program.program) {
+        return false;
+    }
+
+    auto* program = kernel.program.program.get();
+    auto uniformsInfo = uniform_buffer::ReflectUniformBuffer(program);
+    auto paramsOffset = uniform_buffer::ReflectUniformOffset(program, "params");
+    auto logits = tensor_reflection::ReflectTensorBuffer(program, "logits");
+    auto order = tensor_reflection::ReflectTensorBuffer(program, "order");
+    auto rowKeys = tensor_reflection::ReflectTensorBuffer(program, "rowKeys");
+    auto values = tensor_reflection::ReflectTensorBuffer(program, "values");
+    auto indices = tensor_reflection::ReflectTensorBuffer(program, "indices");
+    if (!uniformsInfo || !paramsOffset || !logits || !order || !rowKeys
+        || !values || !indices)
+    {
+        LOG_ERROR("top_k.slang is missing parameters of {}", entryPoint);
+        return false;
+    }
+    kernel.uniforms = *uniformsInfo;
+    kernel.paramsOffset = *paramsOffset;
+    kernel.logits = *logits;
+    kernel.order = *order;
+    kernel.rowKeys = *rowKeys;
+    kernel.values = *values;
+    kernel.indices = *indices;
+
+    uniform_buffer::UniformBuffer uniforms(kernel.uniforms);
+    tensor_buffer::TensorBuffer logitsBuffer(kernel.logits);
+    tensor_buffer::TensorBuffer orderBuffer(kernel.order);
+    tensor_buffer::TensorBuffer rowKeysBuffer(kernel.rowKeys);
+    tensor_buffer::TensorBuffer valuesBuffer(kernel.values);
+    tensor_buffer::TensorBuffer indicesBuffer(kernel.indices);
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms)
+        .Add(logitsBuffer)
+        .Add(orderBuffer)
+        .Add(rowKeysBuffer)
+        .Add(valuesBuffer)
+        .Add(indicesBuffer);
+    kernel.kernel = compute_kernel::ComputeKernel(entryPoint);
+    return kernel.kernel.Initialize(mDevice,
+                                    kernel.program.compileToWGSL(),
+                                    entryPoint,
+                                    bindings.GetLayoutEntries());
+}
+
+bool TopK::Encode(wgpu::ComputePassEncoder pass,
+                  wgpu::Buffer logits,
+                  wgpu::Buffer values,
+                  wgpu::Buffer indices,
+                  int32_t rows,
+                  int32_t n,
+                  int32_t k) const
+{
+    ZoneScoped;
+    if (!mInitialized) {
+        LOG_ERROR("TopK::Encode called before Initialize");
+        return false;
+    }
+    if (rows <= 0 || n <= 0 || k <= 0 || k > n) {
+        LOG_ERROR("Invalid top-{} of [{}, {}]", k, rows, n);
+        return false;
+    }
+
+    // The recorded bind groups keep the scratch buffers alive until the
+    // pass has executed.
+    const auto count = static_cast<uint32_t>(rows) * static_cast<uint32_t>(n);
+    wgpu::BufferDescriptor desc = {
+        .label = "top_k_scratch",
+        .usage = wgpu::BufferUsage::Storage,
+        .size = tensor_buffer::PaddedBytes(count * sizeof(uint32_t)),
+        .mappedAtCreation = false,
+    };
+    gpu_memory::TrackedBuffer order = gpu_memory::CreateBuffer(mDevice, desc);
+    gpu_memory::TrackedBuffer sortedKeys =
+        gpu_memory::CreateBuffer(mDevice, desc);
+    gpu_memory::TrackedBuffer rowKeys = gpu_memory::CreateBuffer(mDevice, desc);
+
+    Step step;
+    step.logits = logits;
+    step.order = order.Get();
+    step.rowKeys = rowKeys.Get();
+    step.values = values;
+    step.indices = indices;
+    step.rows = rows;
+    step.n = n;
+    step.k = k;
+    if (!EncodeKernel(pass, mInit, step, count)
+        || !mSorter.Encode(pass,
+                           logits,
+                           order.Get(),
+                           sortedKeys.Get(),
+                           order.Get(),
+                           count,
+                           radix_sort::KeyType::Float,
+                           radix_sort::Order::Descending))
+    {
+        return false;
+    }
+    // A single row is already in order.
+    if (rows > 1
+        && (!EncodeKernel(pass, mRowKeys, step, count)
+            || !mSorter.Encode(
+                pass,
+                rowKeys.Get(),
+                order.Get(),
+                rowKeys.Get(),
+                order.Get(),
+                count,
+                radix_sort::KeyType::Uint,
+                radix_sort::Order::Ascending,
+                static_cast<uint32_t>(
+                    std::bit_width(static_cast<uint32_t>(rows - 1))))))
+    {
+        return false;
+    }
+    return EncodeKernel(pass,
+                        mGather,
+                        step,
+                        static_cast<uint64_t>(rows)
+                            * static_cast<uint64_t>(k));
+}
+
+bool TopK::EncodeKernel(wgpu::ComputePassEncoder pass,
+                        const Kernel& kernel,
+                        const Step& step,
+                        uint64_t threads) const
+{
+    wgpu::Queue queue = mDevice.GetQueue();
+    uniform_buffer::UniformBuffer uniforms(kernel.uniforms);
+    uniforms.Initialize(mDevice);
+    tensor_buffer::TensorBuffer logits(kernel.logits);
+    tensor_buffer::TensorBuffer order(kernel.order);
+    tensor_buffer::TensorBuffer rowKeys(kernel.rowKeys);
+    tensor_buffer::TensorBuffer values(kernel.values);
+    tensor_buffer::TensorBuffer indices(kernel.indices);
+    logits.Initialize(uniforms, step.logits, step.logits.GetSize());
+    order.Initialize(uniforms, step.order, step.order.GetSize());
+    rowKeys.Initialize(uniforms, step.rowKeys, step.rowKeys.GetSize());
+    values.Initialize(uniforms, step.values, step.values.GetSize());
+    indices.Initialize(uniforms, step.indices, step.indices.GetSize());
+    const std::array<int32_t, 1> flat = {step.rows * step.n};
+    const std::array<int32_t, 2> selected = {step.rows, step.k};
+    logits.WriteShape(queue, flat);
+    order.WriteShape(queue, flat);
+    rowKeys.WriteShape(queue, flat);
+    values.WriteShape(queue, selected);
+    indices.WriteShape(queue, selected);
+    const Params params {.rows = step.rows, .n = step.n, .k = step.k};
+    uniforms.Write(queue, kernel.paramsOffset, params);
+
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms)
+        .Add(logits)
+        .Add(order)
+        .Add(rowKeys)
+        .Add(values)
+        .Add(indices);
+    pass.SetPipeline(kernel.kernel.GetPipeline());
+    pass.SetBindGroup(0, kernel.kernel.CreateBindGroup(bindings.GetEntries()));
+    return dispatch::DispatchLinear(
+        pass, dispatch::WorkgroupsFor(threads, kGroupSize), kGroupSize);
+}
+
+}    // namespace top_k
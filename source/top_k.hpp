@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+
+#include <webgpu/webgpu_cpp.h>
+
+#include "compute_kernel.hpp"
+#include "radix_sort.hpp"
+#include "slang_compiler.hpp"
+#include "subgroups.hpp"
+#include "tensor_reflection.hpp"
+#include "uniform_buffer.hpp"
+
+namespace top_k
+{
+/// Workgroup size of the top_k.slang kernels.
+inline constexpr uint32_t kGroupSize = 256;
+
+/// CPU reference of TopK::Encode: the k largest values of every row in
+/// descending order, ties by ascending index.
+void ReferenceTopK(std::span<const float> logits,
+                   int32_t rows,
+                   int32_t n,
+                   int32_t k,
+                   std::span<float> values,
+                   std::span<int32_t> indices);
+
+/**
+ * @brief The k largest elements of every row of a [rows, n] float tensor,
+ * e.g. for top-k sampling.
+ *
+ * Built from two stable radix_sort::Sorter passes over the whole tensor:
+ * by value, then by row. The cost does not depend on k, and the order
+ * within a row is fully defined: descending values, ties by ascending
+ * index.
+ */
+class TopK
+{
+  public:
+    explicit TopK(std::optional<subgroups::Path> path = std::nullopt);
+
+    bool Initialize(wgpu::Device device,
+                    const slang_compiler::Compiler& compiler);
+
+    /**
+     * @brief Records the selection from the [rows, n] `logits` into the
+     * [rows, k] float `values` and int32 `indices` (column indices within
+     * the row).
+     * @return false if the shape is empty or k is not in [1, n]
+     */
+    [[nodiscard]] bool Encode(wgpu::ComputePassEncoder pass,
+                              wgpu::Buffer logits,
+                              wgpu::Buffer values,
+                              wgpu::Buffer indices,
+                              int32_t rows,
+                              int32_t n,
+                              int32_t k) const;
+
+  private:
+    struct Kernel
+    {
+        slang_compiler::SlangProgram program;
+        compute_kernel::ComputeKernel kernel;
+        uniform_buffer::UniformBufferReflection uniforms;
+        size_t paramsOffset = 0;
+        tensor_reflection::TensorBufferReflection logits;
+        tensor_reflection::TensorBufferReflection order;
+        tensor_reflection::TensorBufferReflection rowKeys;
+        tensor_reflection::TensorBufferReflection values;
+        tensor_reflection::TensorBufferReflection indices;
+    };
+
+    /// Buffers and shape of one dispatch.
+    struct Step
+    {
+        wgpu::Buffer logits;
+        wgpu::Buffer order;
+        wgpu::Buffer rowKeys;
+        wgpu::Buffer values;
+        wgpu::Buffer indices;
+        int32_t rows = 0;
+        int32_t n = 0;
+        int32_t k = 0;
+    };
+
+    bool InitializeKernel(const slang_compiler::Compiler& compiler,
+                          const char* entryPoint,
+                          Kernel& kernel) const;
+
+    [[nodiscard]] bool EncodeKernel(wgpu::ComputePassEncoder pass,
+                                    const Kernel& kernel,
+                                    const Step& step,
+                                    uint64_t threads) const;
+
+    wgpu::Device mDevice {nullptr};
+    radix_sort::Sorter mSorter;
+    Kernel mInit;
+    Kernel mRowKeys;
+    Kernel mGather;
+    bool mInitialized = false;
+};
+
+}    // namespace top_k
@@ -0,0 +1,164 @@
+#include "uniform_buffer.hpp"
+
+#include <slang-com-ptr.h>
+
+namespace uniform_buffer
+{
+namespace
+{
+// Returns the global scope variable layout when it is wrapped in the constant
+// buffer Slang introduces for global uniforms.
+slang::VariableLayoutReflection* FindGlobalConstantBuffer(
+    slang::IComponentType* program)
+{
+    if (!program) {
+        return nullptr;
+    }
+    slang::ProgramLayout* layout = program->getLayout();
+    if (!layout) {
+        return nullptr;
+    }
+    slang::VariableLayoutReflection* global =
+        layout->getGlobalParamsVarLayout();
+    if (!global || !global->getTypeLayout()) {
+        return nullptr;
+    }
+    auto kind = global->getTypeLayout()->getKind();
+    if (kind != slang::TypeReflection::Kind::ParameterBlock
+        && kind != slang::TypeReflection::Kind::ConstantBuffer)
+    {
+        return nullptr;
+    }
+    return global;
+}
+}    // namespace
+
+std::optional<UniformBufferReflection> ReflectUniformBuffer(
+    slang::IComponentType* program)
+{
+    slang::VariableLayoutReflection* global = FindGlobalConstantBuffer(program);
+    if (!global) {
+        return std::nullopt;
+    }
+    slang::TypeLayoutReflection* typeLayout = global->getTypeLayout();
+    slang::VariableLayoutReflection* container =
+        typeLayout->getContainerVarLayout();
+    slang::VariableLayoutReflection* element =
+        typeLayout->getElementVarLayout();
+    if (!container || !element || !element->getTypeLayout()) {
+        return std::nullopt;
+    }
+
+    UniformBufferReflection result {};
+    result.binding = static_cast<uint32_t>(
+        container->getOffset(slang::ParameterCategory::DescriptorTableSlot));
+    result.space = static_cast<uint32_t>(container->getBindingSpace(
+        slang::ParameterCategory::DescriptorTableSlot));
+    result.size =
+        element->getTypeLayout()->getSize(slang::ParameterCategory::Uniform);
+    return result;
+}
+
+std::optional<size_t> ReflectUniformOffset(slang::IComponentType* program,
+                                           const std::string& name)
+{
+    slang::VariableLayoutReflection* global = FindGlobalConstantBuffer(program);
+    if (!global) {
+        return std::nullopt;
+    }
+    slang::VariableLayoutReflection* scope =
+        global->getTypeLayout()->getElementVarLayout();
+    slang::TypeLayoutReflection* typeLayout =
+        scope ? scope->getTypeLayout() : nullptr;
+    if (!typeLayout
+        || typeLayout->getKind() != slang::TypeReflection::Kind::Struct)
+    {
+        return std::nullopt;
+    }
+
+    const int fieldCount = typeLayout->getFieldCount();
+    for (int i = 0; i < fieldCount; ++i) {
+        slang::VariableLayoutReflection* field = typeLayout->getFieldByIndex(i);
+        if (name == field->getName()) {
+            return scope->getOffset(slang::ParameterCategory::Uniform)
+                + field->getOffset(slang::ParameterCategory::Uniform);
+        }
+    }
+    return std::nullopt;
+}
+
+UniformBuffer::UniformBuffer(const UniformBufferReflection& refl,
+                             wgpu::ShaderStage visibility)
+    : mReflection(refl)
+    , mVisibility(visibility)
+{
+    mLayoutEntry = {
+        .binding = mReflection.binding,
+        .visibility = mVisibility,
+        .buffer =
+            {
+                .type = wgpu::BufferBindingType::Uniform,
+                .hasDynamicOffset = false,
+                .minBindingSize = mReflection.size,
+            },
+    };
+
+    mEntry.binding = mReflection.binding;
+}
+
+void UniformBuffer::Initialize(wgpu::Device device)
+{
+    if (mInitialized) {
+        return;
+    }
+
+    // Uniform structs are padded to 16 bytes in WGSL.
+    wgpu::BufferDescriptor desc = {
+        .label = "uniforms",
+        .usage = wgpu::BufferUsage::Uniform | wgpu::BufferUsage::CopyDst,
+        .size = (mReflection.size + 15) & ~size_t {15},
+        .mappedAtCreation = false,
+    };
+    mBuffer = gpu_memory::CreateBuffer(device, desc);
+    mEntry.buffer = mBuffer.Get();
+    mEntry.offset = 0;
+    mEntry.size = desc.size;
+
+    mInitialized = true;
+}
+
+void UniformBuffer::Write(wgpu::Queue queue,
+                          size_t offset,
+                          const void* data,
+                          size_t byteSize) const
+{
+    queue.WriteBuffer(mBuffer.Get(), offset, data, byteSize);
+}
+
+const wgpu::BindGroupLayoutEntry* UniformBuffer::GetBindGroupLayoutEntries()
+    const
+{
+    return &mLayoutEntry;
+}
+
+const wgpu::BindGroupEntry* UniformBuffer::GetBindGroupEntries() const
+{
+    return &mEntry;
+}
+
+size_t UniformBuffer::GetEntryCount() const
+{
+    return 1;
+}
+
+wgpu::Buffer UniformBuffer::GetBuffer() const
+{
+    return mBuffer.Get();
+}
+
+size_t UniformBuffer::GetSize() const
+{
+    return mReflection.size;
+}
+
+}    // namespace uniform_buffer
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <optional>
+#include <string>
+
+#include <slang.h>
+#include <webgpu/webgpu_cpp.h>
+
+#include "gpu_memory.hpp"
+
+namespace uniform_buffer
+{
+struct UniformBufferReflection
+{
+    uint32_t binding = 0;    // binding index of the global constant buffer
+    uint32_t space = 0;    // descriptor set / register space
+    size_t size = 0;    // size in bytes of all global uniforms
+};
+
+/**
+ * Reflect the constant buffer Slang introduces for global uniform parameters,
+ * which holds the shapes of every tensor and any scalar kernel arguments.
+ * @param program linked Slang program
+ * @return reflection information, or nullopt if the program has no uniforms
+ */
+[[nodiscard]] std::optional<UniformBufferReflection> ReflectUniformBuffer(
+    slang::IComponentType* program);
+
+/**
+ * Reflect the byte offset of a global uniform parameter.
+ * @param program linked Slang program
+ * @param name name of the global uniform parameter
+ * @return offset inside the global constant buffer if found
+ */
+[[nodiscard]] std::optional<size_t> ReflectUniformOffset(
+    slang::IComponentType* program, const std::string& name);
+
+/**
+ * @brief The global constant buffer of a kernel, shared by all its tensors.
+ *
+ * Slang places the shape of every tensor buffer in the same constant buffer,
+ * so kernels with several tensors initialize them against one UniformBuffer
+ * instead of letting each allocate its own.
+ */
+class UniformBuffer
+{
+  public:
+    explicit UniformBuffer(
+        const UniformBufferReflection& refl,
+        wgpu::ShaderStage visibility = wgpu::ShaderStage::Compute);
+
+    void Initialize(wgpu::Device device);
+
+    void Write(wgpu::Queue queue,
+               size_t offset,
+               const void* data,
+               size_t byteSize) const;
+
+    template<typename T>
+    void Write(wgpu::Queue queue, size_t offset, const T& value) const
+    {
+        Write(queue, offset, &value, sizeof(T));
+    }
+
+    [[nodiscard]] const wgpu::BindGroupLayoutEntry* GetBindGroupLayoutEntries()
+        const;
+    [[nodiscard]] const wgpu::BindGroupEntry* GetBindGroupEntries() const;
+    [[nodiscard]] size_t GetEntryCount() const;
+
+    [[nodiscard]] wgpu::Buffer GetBuffer() const;
+    [[nodiscard]] size_t GetSize() const;
+
+  private:
+    UniformBufferReflection mReflection;
+    wgpu::ShaderStage mVisibility;
+
+    gpu_memory::TrackedBuffer mBuffer;
+
+    wgpu::BindGroupLayoutEntry mLayoutEntry {};
+    wgpu::BindGroupEntry mEntry {};
+    bool mInitialized = false;
+};
+}    // namespace uniform_buffer
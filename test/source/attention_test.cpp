@@ -0,0 +1,169 @@
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "attention.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include "test_fixture.hpp"
+
+namespace
+{
+using tensor_buffer::TensorView;
+
+constexpr int32_t kHeadDim = 16;
+
+struct Fixture : TestFixture
+{
+    attention::Attention kernel {kHeadDim};
+
+    std::vector<float> Run(const tensor_buffer::BufferView& q,
+                           const tensor_buffer::BufferView& k,
+                           const tensor_buffer::BufferView& v,
+                           size_t count,
+                           bool causal)
+    {
+        wgpu::Buffer output = Create<float>(count);
+        wgpu::CommandEncoder encoder = device.CreateCommandEncoder();
+        wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+        const bool encoded = kernel.Encode(
+            pass, q, k, v, output, attention::DefaultScale(kHeadDim), causal);
+        pass.End();
+        if (!encoded) {
+            return {};
+        }
+        Submit(encoder);
+        return Read<float>(output, count);
+    }
+};
+
+std::vector<float> Values(size_t count, float phase)
+{
+    std::vector<float> values(count);
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = std::sin(static_cast<float>(i) * 0.37f + phase);
+    }
+    return values;
+}
+
+void CheckClose(const std::vector<float>& result,
+                const std::vector<float>& expected)
+{
+    REQUIRE(result.size() == expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        INFO("element " << i);
+        CHECK_THAT(result[i], Catch::Matchers::WithinAbs(expected[i], 1e-4));
+    }
+}
+}    // namespace
+
+TEST_CASE("Attention shapes come from the views", "[attention]")
+{
+    const auto q = TensorView::Contiguous(std::vector<int32_t>({2, 4, 9, 8}));
+    const auto kv = TensorView::Contiguous(std::vector<int32_t>({2, 4, 5, 8}));
+    const auto shape = attention::InferShape(q, kv, kv);
+    REQUIRE(shape);
+    CHECK(shape->queryLen == 9);
+    CHECK(shape->keyLen == 5);
+    CHECK(shape->headDim == 8);
+    CHECK(attention::Workgroups(*shape).x == 1);
+    CHECK(attention::Workgroups(*shape).y == 4);
+    CHECK(attention::Workgroups(*shape).z == 2);
+
+    const auto other =
+        TensorView::Contiguous(std::vector<int32_t>({2, 4, 5, 4}));
+    CHECK_FALSE(attention::InferShape(q, other, other));
+    CHECK_FALSE(attention::InferShape(q, kv, other));
+}
+
+TEST_CASE("Fused attention matches the CPU reference", "[attention]")
+{
+    Fixture f;
+    REQUIRE(f.kernel.Initialize(f.device, f.compiler));
+
+    // Sequence lengths straddle the query block and key tile sizes; the
+    // short query block is aligned with the end of the keys.
+    for (auto [queryLen, keyLen] : {std::array<int32_t, 2> {70, 70},
+                                    std::array<int32_t, 2> {5, 37}})
+    {
+        const attention::Shape shape = {.batch = 2,
+                                        .heads = 3,
+                                        .queryLen = queryLen,
+                                        .keyLen = keyLen,
+                                        .headDim = kHeadDim};
+        const std::vector<int32_t> qDims = {2, 3, queryLen, kHeadDim};
+        const std::vector<int32_t> kvDims = {2, 3, keyLen, kHeadDim};
+        const auto q = Values(2 * 3 * static_cast<size_t>(queryLen) * 16, 0);
+        const auto k = Values(2 * 3 * static_cast<size_t>(keyLen) * 16, 1);
+        const auto v = Values(2 * 3 * static_cast<size_t>(keyLen) * 16, 2);
+        for (bool causal : {false, true}) {
+            INFO("query " << queryLen << " key " << keyLen << " causal "
+                          << causal);
+            std::vector<float> expected(q.size());
+            attention::ReferenceAttention(shape,
+                                          q,
+                                          k,
+                                          v,
+                                          expected,
+                                          attention::DefaultScale(kHeadDim),
+                                          causal);
+            CheckClose(f.Run({f.Upload(q), TensorView::Contiguous(qDims)},
+                             {f.Upload(k), TensorView::Contiguous(kvDims)},
+                             {f.Upload(v), TensorView::Contiguous(kvDims)},
+                             q.size(),
+                             causal),
+                       expected);
+        }
+    }
+}
+
+TEST_CASE("Attention reads head-interleaved projections in place",
+          "[attention]")
+{
+    Fixture f;
+    REQUIRE(f.kernel.Initialize(f.device, f.compiler));
+
+    // Q, K and V stored as [batch, seq, heads, headDim].
+    const attention::Shape shape = {
+        .batch = 1, .heads = 2, .queryLen = 20, .keyLen = 20, .headDim = 16};
+    const std::vector<int32_t> stored = {1, 20, 2, kHeadDim};
+    const std::array<size_t, 4> order = {0, 2, 1, 3};
+    const auto view = TensorView::Contiguous(stored).Permute(order);
+    REQUIRE(view);
+    const auto q = Values(20 * 2 * 16, 0);
+    const auto k = Values(20 * 2 * 16, 1);
+    const auto v = Values(20 * 2 * 16, 2);
+
+    // The reference wants [batch, heads, seq, headDim].
+    auto toHeadMajor = [](const std::vector<float>& values)
+    {
+        std::vector<float> result(values.size());
+        for (size_t s = 0; s < 20; ++s) {
+            for (size_t h = 0; h < 2; ++h) {
+                for (size_t d = 0; d < 16; ++d) {
+                    result[(h * 20 + s) * 16 + d] =
+                        values[(s * 2 + h) * 16 + d];
+                }
+            }
+        }
+        return result;
+    };
+    std::vector<float> expected(q.size());
+    attention::ReferenceAttention(shape,
+                                  toHeadMajor(q),
+                                  toHeadMajor(k),
+                                  toHeadMajor(v),
+                                  expected,
+                                  attention::DefaultScale(kHeadDim),
+                                  true);
+    CheckClose(f.Run({f.Upload(q), *view},
+                     {f.Upload(k), *view},
+                     {f.Upload(v), *view},
+                     q.size(),
+                     true),
+               expected);
+}
@@ -0,0 +1,125 @@
+#include <array>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "autotune.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers.hpp>
+#include <catch2/matchers/catch_matchers_vector.hpp>
+
+#include "gemm.hpp"
+#include "lib.hpp"
+#include "slang_compiler.hpp"
+
+TEST_CASE("Shapes are bucketed by powers of two", "[autotune]")
+{
+    const std::array<int64_t, 3> dims = {67, 33, 64};
+    CHECK(autotune::ShapeBucket(dims) == "128x64x64");
+    const std::array<int64_t, 2> small = {1, 0};
+    CHECK(autotune::ShapeBucket(small) == "1x1");
+}
+
+TEST_CASE("Configs round-trip through text", "[autotune]")
+{
+    autotune::Config config = {{"threads_x", 8}, {"tile_k", 32}};
+    std::string text = autotune::FormatConfig(config);
+    CHECK(text == "threads_x=8 tile_k=32");
+    auto parsed = autotune::ParseConfig(text);
+    REQUIRE(parsed.has_value());
+    CHECK(*parsed == config);
+    CHECK_FALSE(autotune::ParseConfig("threads_x=").has_value());
+    CHECK_FALSE(autotune::ParseConfig("=4").has_value());
+}
+
+TEST_CASE("Tuning results persist per kernel, bucket and adapter",
+          "[autotune]")
+{
+    const autotune::Key key = {
+        .kernel = "gemmNN",
+        .bucket = "256x256x256",
+        .adapter = "vendor/arch/device/driver 1.2",
+    };
+    autotune::TuningCache cache;
+    cache.Store(key, {{"threads_x", 8}, {"threads_y", 32}}, 12.5);
+    cache.Store({.kernel = "gemmNT", .bucket = key.bucket, .adapter = "x"},
+                {{"tile_k", 8}},
+                3.0);
+
+    auto path = std::filesystem::temp_directory_path() / "congpu_tuning.tsv";
+    REQUIRE(cache.Save(path.string()));
+
+    autotune::TuningCache loaded;
+    REQUIRE(loaded.Load(path.string()));
+    std::filesystem::remove(path);
+    CHECK(loaded.GetSize() == 2);
+    auto found = loaded.Find(key);
+    REQUIRE(found.has_value());
+    CHECK(found->at("threads_y") == 32);
+    CHECK_FALSE(loaded
+                    .Find({.kernel = "gemmTN",
+                           .bucket = key.bucket,
+                           .adapter = key.adapter})
+                    .has_value());
+
+    // A missing file leaves the cache empty.
+    autotune::TuningCache empty;
+    CHECK(empty.Load(path.string()));
+    CHECK(empty.GetSize() == 0);
+}
+
+TEST_CASE("GEMM tile configs map to tuning configs", "[autotune]")
+{
+    gemm::TileConfig tile {.threadsX = 8, .threadsY = 32, .tileK = 8};
+    auto roundTrip = gemm::FromConfig(gemm::ToConfig(tile));
+    REQUIRE(roundTrip.has_value());
+    CHECK(*roundTrip == tile);
+    CHECK_FALSE(gemm::FromConfig({{"threads_x", 8}}).has_value());
+
+    wgpu::Limits limits {};
+    limits.maxComputeInvocationsPerWorkgroup = 256;
+    limits.maxComputeWorkgroupSizeX = 256;
+    limits.maxComputeWorkgroupSizeY = 256;
+    limits.maxComputeWorkgroupStorageSize = 16384;
+    std::vector<gemm::TileConfig> candidates = gemm::Candidates(limits);
+    REQUIRE_FALSE(candidates.empty());
+    for (const gemm::TileConfig& candidate : candidates) {
+        CHECK(candidate.threadsX * candidate.threadsY <= 256);
+        CHECK(candidate.SharedBytes() <= 16384);
+    }
+}
+
+TEST_CASE("Autotune a GEMM and reuse the result", "[autotune]")
+{
+    Library lib;
+    wgpu::Instance instance = lib.CreateInstance();
+    wgpu::Adapter adapter = lib.RequestAdapter(instance);
+    wgpu::Device device = lib.RequestDevice(adapter);
+    const std::string adapterKey =
+        autotune::AdapterKey(lib.GetAdapterInfo(adapter));
+
+    slang_compiler::Compiler compiler({SHADERS_DIR});
+    autotune::Autotuner tuner(0, 2);
+    tuner.Initialize(instance, device);
+    autotune::TuningCache cache;
+
+    const gemm::Shape shape = {.m = 40, .n = 72, .k = 24};
+    auto best = gemm::Autotune(tuner,
+                               cache,
+                               device,
+                               compiler,
+                               gemm::Variant::NN,
+                               shape,
+                               adapterKey);
+    REQUIRE(best.has_value());
+    CHECK(cache.GetSize() == 1);
+    CHECK_FALSE(tuner.GetTimings().empty());
+
+    // Shapes in the same bucket find the tuned config.
+    const gemm::Shape similar = {.m = 64, .n = 128, .k = 32};
+    CHECK(gemm::LookupTileConfig(cache, gemm::Variant::NN, similar, adapterKey)
+          == *best);
+    CHECK(gemm::LookupTileConfig(cache, gemm::Variant::NT, similar, adapterKey)
+          == gemm::TileConfig {});
+}
@@ -0,0 +1,137 @@
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "batched_gemm.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers.hpp>
+#include <catch2/matchers/catch_matchers_vector.hpp>
+
+#include "test_fixture.hpp"
+
+namespace
+{
+using tensor_buffer::TensorView;
+
+struct Fixture : TestFixture
+{
+    batched_gemm::BatchedGemm kernel;
+
+    std::vector<float> Run(const tensor_buffer::BufferView& a,
+                           const tensor_buffer::BufferView& b,
+                           size_t count)
+    {
+        wgpu::Buffer c = Create<float>(count);
+        wgpu::CommandEncoder encoder = device.CreateCommandEncoder();
+        wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+        const bool encoded = kernel.Encode(pass, a, b, c);
+        pass.End();
+        if (!encoded) {
+            return {};
+        }
+        Submit(encoder);
+        return Read<float>(c, count);
+    }
+};
+
+/// Small integers keep every partial sum exact.
+std::vector<float> Sequence(size_t count, int seed)
+{
+    std::vector<float> values(count);
+    for (size_t i = 0; i < count; ++i) {
+        size_t step = (i * 5 + static_cast<size_t>(seed)) % 7;
+        values[i] = static_cast<float>(step) - 3.0f;
+    }
+    return values;
+}
+}    // namespace
+
+TEST_CASE("Batched shapes broadcast the batch axis", "[batched_gemm]")
+{
+    const auto a = TensorView::Contiguous(std::vector<int32_t>({4, 5, 6}));
+    const auto b = TensorView::Contiguous(std::vector<int32_t>({6, 7}));
+    const auto shape = batched_gemm::InferShape(a, b);
+    REQUIRE(shape);
+    CHECK(shape->batch == 4);
+    CHECK(shape->m == 5);
+    CHECK(shape->n == 7);
+    CHECK(shape->k == 6);
+
+    const auto wrongK = TensorView::Contiguous(std::vector<int32_t>({5, 7}));
+    const auto wrongBatch =
+        TensorView::Contiguous(std::vector<int32_t>({3, 6, 7}));
+    CHECK_FALSE(batched_gemm::InferShape(a, wrongK));
+    CHECK_FALSE(batched_gemm::InferShape(a, wrongBatch));
+
+    wgpu::Limits limits {};
+    limits.maxComputeWorkgroupsPerDimension = 3;
+    const dispatch::Grid grid =
+        batched_gemm::Workgroups(*shape, gemm::TileConfig {}, limits);
+    CHECK(grid.z == 3);
+}
+
+TEST_CASE("Batched GEMM matches the CPU reference", "[batched_gemm]")
+{
+    Fixture f;
+    REQUIRE(f.kernel.Initialize(f.device, f.compiler));
+
+    // Deliberately not multiples of the tile sizes.
+    const batched_gemm::Shape shape = {.batch = 3, .m = 37, .n = 70, .k = 19};
+    const auto m = static_cast<size_t>(shape.m);
+    const auto n = static_cast<size_t>(shape.n);
+    const auto k = static_cast<size_t>(shape.k);
+    const auto batch = static_cast<size_t>(shape.batch);
+    const std::vector<int32_t> aDims = {shape.batch, shape.m, shape.k};
+    const std::vector<int32_t> bDims = {shape.batch, shape.k, shape.n};
+    const std::vector<int32_t> aMatrix = {shape.m, shape.k};
+    const std::vector<int32_t> bSingle = {1, shape.k, shape.n};
+    const auto a = Sequence(batch * m * k, 1);
+    const auto b = Sequence(batch * k * n, 2);
+    std::vector<float> expected(batch * m * n);
+
+    SECTION("full batches")
+    {
+        batched_gemm::ReferenceBatchedGemm(shape, a, 3, b, 3, expected);
+        CHECK_THAT(f.Run({f.Upload(a), TensorView::Contiguous(aDims)},
+                         {f.Upload(b), TensorView::Contiguous(bDims)},
+                         expected.size()),
+                   Catch::Matchers::Equals(expected));
+    }
+    SECTION("broadcast 2-D A")
+    {
+        batched_gemm::ReferenceBatchedGemm(shape, a, 1, b, 3, expected);
+        CHECK_THAT(f.Run({f.Upload(a), TensorView::Contiguous(aMatrix)},
+                         {f.Upload(b), TensorView::Contiguous(bDims)},
+                         expected.size()),
+                   Catch::Matchers::Equals(expected));
+    }
+    SECTION("broadcast B with a batch of one")
+    {
+        batched_gemm::ReferenceBatchedGemm(shape, a, 3, b, 1, expected);
+        CHECK_THAT(f.Run({f.Upload(a), TensorView::Contiguous(aDims)},
+                         {f.Upload(b), TensorView::Contiguous(bSingle)},
+                         expected.size()),
+                   Catch::Matchers::Equals(expected));
+    }
+    SECTION("B stored transposed as [batch, N, K]")
+    {
+        batched_gemm::ReferenceBatchedGemm(shape, a, 3, b, 3, expected);
+        std::vector<float> stored(b.size());
+        for (size_t i = 0; i < batch; ++i) {
+            for (size_t row = 0; row < k; ++row) {
+                for (size_t col = 0; col < n; ++col) {
+                    stored[(i * n + col) * k + row] =
+                        b[(i * k + row) * n + col];
+                }
+            }
+        }
+        const std::vector<int32_t> storedDims = {shape.batch, shape.n, shape.k};
+        auto view = TensorView::Contiguous(storedDims).Transpose(1, 2);
+        REQUIRE(view);
+        CHECK_THAT(f.Run({f.Upload(a), TensorView::Contiguous(aDims)},
+                         {f.Upload(stored), *view},
+                         expected.size()),
+                   Catch::Matchers::Equals(expected));
+    }
+}
@@ -0,0 +1,135 @@
+#include <array>
+#include <string>
+#include <vector>
+
+#include "compute_kernel.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers.hpp>
+#include <catch2/matchers/catch_matchers_vector.hpp>
+
+#include "lib.hpp"
+#include "slang_compiler.hpp"
+#include "tensor_buffer.hpp"
+#include "tensor_reflection.hpp"
+#include "uniform_buffer.hpp"
+
+namespace
+{
+const char* kAddShader = R"(
+import tensor;
+RWTensorBuffer<float, int, int> a;
+RWTensorBuffer<float, int, int> b;
+RWTensorBuffer<float, int, int> c;
+uniform float scale;
+[numthreads(1,1,1)]
+void computeMain(uint3 tid: SV_DispatchThreadID)
+{
+    int i = int(tid.x);
+    int j = int(tid.y);
+    var out = c;
+    out[i, j] = (a[i, j] + b[i, j]) * scale;
+}
+)";
+}    // namespace
+
+TEST_CASE("Reflect the global uniform buffer", "[compute_kernel]")
+{
+    slang_compiler::Compiler compiler({SHADERS_DIR});
+    auto prog = compiler.CompileFromSource(kAddShader, "add", "computeMain");
+
+    auto uniformsOpt =
+        uniform_buffer::ReflectUniformBuffer(prog.program.get());
+    REQUIRE(uniformsOpt.has_value());
+    CHECK(uniformsOpt->binding == 0);
+    // Three 32-byte shapes followed by the scale.
+    CHECK(uniformsOpt->size >= 3 * 32 + sizeof(float));
+
+    auto scaleOffset =
+        uniform_buffer::ReflectUniformOffset(prog.program.get(), "scale");
+    REQUIRE(scaleOffset.has_value());
+    CHECK(*scaleOffset == 3 * 32);
+    CHECK_FALSE(uniform_buffer::ReflectUniformOffset(prog.program.get(),
+                                                     "missing")
+                    .has_value());
+}
+
+TEST_CASE("Run a kernel with several tensors", "[compute_kernel]")
+{
+    Library lib;
+    wgpu::Instance instance = lib.CreateInstance();
+    wgpu::Adapter adapter = lib.RequestAdapter(instance);
+    wgpu::Device device = lib.RequestDevice(adapter);
+    wgpu::Queue queue = device.GetQueue();
+
+    constexpr int M = 3;
+    constexpr int N = 4;
+    const std::array<int32_t, 2> dims = {M, N};
+
+    slang_compiler::Compiler compiler({SHADERS_DIR});
+    auto prog = compiler.CompileFromSource(kAddShader, "add", "computeMain");
+    auto* program = prog.program.get();
+
+    auto uniformsInfo = uniform_buffer::ReflectUniformBuffer(program);
+    auto aInfo = tensor_reflection::ReflectTensorBuffer(program, "a");
+    auto bInfo = tensor_reflection::ReflectTensorBuffer(program, "b");
+    auto cInfo = tensor_reflection::ReflectTensorBuffer(program, "c");
+    auto scaleOffset = uniform_buffer::ReflectUniformOffset(program, "scale");
+    REQUIRE(uniformsInfo.has_value());
+    REQUIRE(aInfo.has_value());
+    REQUIRE(bInfo.has_value());
+    REQUIRE(cInfo.has_value());
+    REQUIRE(scaleOffset.has_value());
+
+    uniform_buffer::UniformBuffer uniforms(*uniformsInfo);
+    uniforms.Initialize(device);
+
+    tensor_buffer::TensorBuffer a(*aInfo);
+    tensor_buffer::TensorBuffer b(*bInfo);
+    tensor_buffer::TensorBuffer c(*cInfo);
+    for (tensor_buffer::TensorBuffer* t : {&a, &b, &c}) {
+        t->Initialize(device, M * N * sizeof(float), uniforms);
+        t->WriteShape(queue, dims);
+        CHECK(t->GetShapeBuffer().Get() == uniforms.GetBuffer().Get());
+    }
+    uniforms.Write(queue, *scaleOffset, 0.5f);
+
+    std::vector<float> dataA(M * N);
+    std::vector<float> dataB(M * N);
+    std::vector<float> expected(M * N);
+    for (size_t i = 0; i < dataA.size(); ++i) {
+        dataA[i] = static_cast<float>(i);
+        dataB[i] = static_cast<float>(2 * i);
+        expected[i] = (dataA[i] + dataB[i]) * 0.5f;
+    }
+    queue.WriteBuffer(
+        a.GetDataBuffer(), 0, dataA.data(), dataA.size() * sizeof(float));
+    queue.WriteBuffer(
+        b.GetDataBuffer(), 0, dataB.data(), dataB.size() * sizeof(float));
+
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms).Add(a).Add(b).Add(c);
+    // The shared uniform buffer is bound once, plus one binding per tensor.
+    REQUIRE(bindings.GetEntries().size() == 4);
+
+    compute_kernel::ComputeKernel kernel("add");
+    REQUIRE(kernel.Initialize(device,
+                              prog.compileToWGSL(),
+                              "computeMain",
+                              bindings.GetLayoutEntries()));
+    wgpu::BindGroup bindGroup = kernel.CreateBindGroup(bindings.GetEntries());
+    REQUIRE(bindGroup != nullptr);
+
+    wgpu::CommandEncoder commandEncoder = device.CreateCommandEncoder();
+    wgpu::ComputePassEncoder pass = commandEncoder.BeginComputePass();
+    pass.SetPipeline(kernel.GetPipeline());
+    pass.SetBindGroup(0, bindGroup);
+    pass.DispatchWorkgroups(M, N, 1);
+    pass.End();
+    wgpu::CommandBuffer commandBuffer = commandEncoder.Finish();
+    queue.Submit(1, &commandBuffer);
+
+    std::vector<float> result = compute_kernel::ReadBuffer<float>(
+        instance, device, c.GetDataBuffer(), M * N);
+    REQUIRE_THAT(result, Catch::Matchers::Equals(expected));
+}
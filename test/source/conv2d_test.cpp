@@ -0,0 +1,169 @@
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "conv2d.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers.hpp>
+#include <catch2/matchers/catch_matchers_vector.hpp>
+
+#include "lib.hpp"
+#include "slang_compiler.hpp"
+
+namespace
+{
+/// Small integers keep every partial sum exact.
+std::vector<float> Sequence(size_t count, int seed)
+{
+    std::vector<float> values(count);
+    for (size_t i = 0; i < count; ++i) {
+        size_t step = (i * 3 + static_cast<size_t>(seed)) % 5;
+        values[i] = static_cast<float>(step) - 2.0f;
+    }
+    return values;
+}
+
+size_t Count(const std::array<int32_t, 4>& dims)
+{
+    return static_cast<size_t>(dims[0]) * static_cast<size_t>(dims[1])
+        * static_cast<size_t>(dims[2]) * static_cast<size_t>(dims[3]);
+}
+
+void Submit(wgpu::Device device, wgpu::CommandEncoder encoder)
+{
+    wgpu::CommandBuffer commandBuffer = encoder.Finish();
+    device.GetQueue().Submit(1, &commandBuffer);
+}
+}    // namespace
+
+TEST_CASE("Conv2D output sizes and layout heuristic", "[conv2d]")
+{
+    const conv2d::Shape shape = {
+        .height = 9,
+        .width = 8,
+        .kernelH = 3,
+        .kernelW = 3,
+        .strideH = 2,
+        .padW = 1,
+        .dilationH = 2,
+    };
+    CHECK(shape.OutHeight() == 3);
+    CHECK(shape.OutWidth() == 8);
+    CHECK(shape.IsValid());
+
+    conv2d::Shape grouped = shape;
+    grouped.inChannels = 3;
+    grouped.groups = 2;
+    CHECK_FALSE(grouped.IsValid());
+
+    conv2d::Shape dense = {.inChannels = 64, .kernelH = 3, .kernelW = 3};
+    CHECK(conv2d::PreferredLayout(dense) == conv2d::Layout::NHWC);
+    conv2d::Shape depthwise = dense;
+    depthwise.outChannels = 64;
+    depthwise.groups = 64;
+    CHECK(conv2d::PreferredLayout(depthwise) == conv2d::Layout::NCHW);
+    depthwise.dilationW = 2;
+    CHECK(conv2d::PreferredLayout(depthwise) == conv2d::Layout::NHWC);
+}
+
+TEST_CASE("Implicit GEMM Conv2D matches the CPU in both layouts",
+          "[conv2d]")
+{
+    Library lib;
+    wgpu::Instance instance = lib.CreateInstance();
+    wgpu::Adapter adapter = lib.RequestAdapter(instance);
+    wgpu::Device device = lib.RequestDevice(adapter);
+    wgpu::Queue queue = device.GetQueue();
+    slang_compiler::Compiler compiler({SHADERS_DIR});
+
+    const conv2d::Shape shape = {
+        .batch = 2,
+        .inChannels = 4,
+        .height = 11,
+        .width = 9,
+        .outChannels = 6,
+        .kernelH = 3,
+        .kernelW = 2,
+        .strideH = 2,
+        .strideW = 1,
+        .padH = 1,
+        .padW = 2,
+        .dilationH = 1,
+        .dilationW = 2,
+        .groups = 2,
+    };
+    const auto weight = Sequence(Count(conv2d::WeightDims(shape)), 1);
+    const auto bias = Sequence(static_cast<size_t>(shape.outChannels), 2);
+
+    for (conv2d::Layout layout : {conv2d::Layout::NHWC, conv2d::Layout::NCHW})
+    {
+        INFO("entry point " << conv2d::EntryPoint(layout));
+        const auto input =
+            Sequence(Count(conv2d::InputDims(shape, layout)), 3);
+        conv2d::Conv2d kernel(layout);
+        REQUIRE(kernel.Initialize(device, compiler));
+        REQUIRE(kernel.Resize(queue, shape));
+        kernel.WriteInput(queue, input);
+        kernel.WriteWeight(queue, weight);
+        kernel.WriteBias(queue, bias);
+
+        wgpu::CommandEncoder encoder = device.CreateCommandEncoder();
+        wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+        kernel.Encode(pass);
+        pass.End();
+        Submit(device, encoder);
+
+        std::vector<float> expected(Count(conv2d::OutputDims(shape, layout)));
+        conv2d::ReferenceConv2d(
+            shape, layout, input, weight, bias, expected);
+        REQUIRE_THAT(kernel.ReadOutput(instance),
+                     Catch::Matchers::Equals(expected));
+    }
+}
+
+TEST_CASE("Layout transforms round-trip", "[conv2d]")
+{
+    Library lib;
+    wgpu::Instance instance = lib.CreateInstance();
+    wgpu::Adapter adapter = lib.RequestAdapter(instance);
+    wgpu::Device device = lib.RequestDevice(adapter);
+    slang_compiler::Compiler compiler({SHADERS_DIR});
+
+    conv2d::LayoutTransform transform;
+    REQUIRE(transform.Initialize(device, compiler));
+
+    const std::array<int32_t, 4> nchw = {2, 3, 4, 5};
+    const size_t count = Count(nchw);
+    std::vector<float> source(count);
+    for (size_t i = 0; i < count; ++i) {
+        source[i] = static_cast<float>(i);
+    }
+    wgpu::BufferDescriptor desc = {
+        .label = "conv2d_test_layout",
+        .usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst
+            | wgpu::BufferUsage::CopySrc,
+        .size = count * sizeof(float),
+        .mappedAtCreation = false,
+    };
+    wgpu::Buffer a = device.CreateBuffer(&desc);
+    wgpu::Buffer b = device.CreateBuffer(&desc);
+    wgpu::Buffer c = device.CreateBuffer(&desc);
+    device.GetQueue().WriteBuffer(a, 0, source.data(), desc.size);
+
+    wgpu::CommandEncoder encoder = device.CreateCommandEncoder();
+    wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+    REQUIRE(transform.Encode(pass, conv2d::Layout::NCHW, a, b, nchw));
+    REQUIRE(transform.Encode(pass, conv2d::Layout::NHWC, b, c, nchw));
+    pass.End();
+    Submit(device, encoder);
+
+    // Element (n=0, h=0, w=1, c=0) of the NHWC copy is NCHW element 1.
+    std::vector<float> nhwc =
+        compute_kernel::ReadBuffer<float>(instance, device, b, count);
+    REQUIRE(nhwc.size() == count);
+    CHECK_THAT(std::vector<float>(nhwc.begin(), nhwc.begin() + 4),
+               Catch::Matchers::Equals(std::vector<float> {0, 20, 40, 1}));
+    CHECK_THAT(compute_kernel::ReadBuffer<float>(instance, device, c, count),
+               Catch::Matchers::Equals(source));
+}
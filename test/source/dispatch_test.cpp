@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <array>
+#include <string>
+#include <vector>
+
+#include "dispatch.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers.hpp>
+#include <catch2/matchers/catch_matchers_vector.hpp>
+
+#include "compute_kernel.hpp"
+#include "lib.hpp"
+#include "slang_compiler.hpp"
+#include "tensor_buffer.hpp"
+#include "tensor_reflection.hpp"
+
+TEST_CASE("Fold linear workgroup counts", "[dispatch]")
+{
+    constexpr uint64_t W = dispatch::kFoldWidth;
+
+    auto small = dispatch::FoldWorkgroups(12);
+    REQUIRE(small.has_value());
+    CHECK(small->x == 12);
+    CHECK(small->y == 1);
+    CHECK(small->z == 1);
+
+    auto folded2d = dispatch::FoldWorkgroups(W + 1);
+    REQUIRE(folded2d.has_value());
+    CHECK(folded2d->x == W);
+    CHECK(folded2d->y == 2);
+    CHECK(folded2d->z == 1);
+
+    auto folded3d = dispatch::FoldWorkgroups(W * W + 1);
+    REQUIRE(folded3d.has_value());
+    CHECK(folded3d->x == W);
+    CHECK(folded3d->y == W);
+    CHECK(folded3d->z == 2);
+
+    // Linear indices are 32-bit, so z never grows past 2.
+    auto largest = dispatch::FoldWorkgroups(dispatch::kMaxLinearThreads);
+    REQUIRE(largest.has_value());
+    CHECK(largest->z == 2);
+    CHECK_FALSE(dispatch::FoldWorkgroups(dispatch::kMaxLinearThreads + 1)
+                    .has_value());
+
+    CHECK(dispatch::WorkgroupsFor(65, 64) == 2);
+    CHECK(dispatch::WorkgroupsFor(64, 64) == 1);
+}
+
+TEST_CASE("Validate grids against device limits", "[dispatch]")
+{
+    wgpu::Limits limits {};
+    limits.maxComputeWorkgroupsPerDimension = 65535;
+    CHECK(dispatch::FitsLimits({.x = 65535, .y = 2, .z = 1}, limits));
+    CHECK_FALSE(dispatch::FitsLimits({.x = 65536, .y = 1, .z = 1}, limits));
+}
+
+TEST_CASE("Folded dispatch covers every element", "[dispatch]")
+{
+    Library lib;
+    wgpu::Instance instance = lib.CreateInstance();
+    wgpu::Adapter adapter = lib.RequestAdapter(instance);
+    wgpu::Device device = lib.RequestDevice(adapter);
+    wgpu::Queue queue = device.GetQueue();
+
+    // One element more than a single row of workgroups can address.
+    constexpr int Count = static_cast<int>(dispatch::kFoldWidth) + 3;
+
+    const char* shader = R"(
+import tensor;
+RWTensorBuffer<float, int> input;
+[numthreads(1,1,1)]
+void computeMain(uint3 gid: SV_GroupID, uint3 ltid: SV_GroupThreadID)
+{
+    var r = input;
+    uint i = linearThreadIndex(gid, ltid, 1);
+    if (i < uint(r.getCount())) {
+        r[i] = r[i] + 1.0f;
+    }
+}
+)";
+
+    slang_compiler::Compiler compiler({SHADERS_DIR});
+    auto prog = compiler.CompileFromSource(shader, "folded", "computeMain");
+    std::string wgslSource = prog.compileToWGSL();
+
+    auto infoOpt =
+        tensor_reflection::ReflectTensorBuffer(prog.program.get(), "input");
+    REQUIRE(infoOpt.has_value());
+
+    std::vector<float> data(Count, 1.0f);
+    tensor_buffer::TensorBuffer tb(*infoOpt);
+    tb.Initialize(device, data.size() * sizeof(float));
+    queue.WriteBuffer(
+        tb.GetDataBuffer(), 0, data.data(), data.size() * sizeof(float));
+
+    const std::array<int32_t, 1> dims = {Count};
+    tb.WriteShape(queue, dims);
+
+    wgpu::BindGroupLayoutDescriptor bindGroupLayoutDesc = {
+        .label = "Folded Layout",
+        .entryCount = tb.GetEntryCount(),
+        .entries = tb.GetBindGroupLayoutEntries(),
+    };
+    wgpu::BindGroupLayout bindGroupLayout =
+        device.CreateBindGroupLayout(&bindGroupLayoutDesc);
+    wgpu::BindGroupDescriptor bindGroupDesc = {
+        .label = "Folded BindGroup",
+        .layout = bindGroupLayout,
+        .entryCount = tb.GetEntryCount(),
+        .entries = tb.GetBindGroupEntries(),
+    };
+    wgpu::BindGroup bindGroup = device.CreateBindGroup(&bindGroupDesc);
+
+    wgpu::PipelineLayoutDescriptor pipelineLayoutDesc = {
+        .label = "Pipeline Layout",
+        .bindGroupLayoutCount = 1,
+        .bindGroupLayouts = &bindGroupLayout,
+    };
+    wgpu::PipelineLayout pipelineLayout =
+        device.CreatePipelineLayout(&pipelineLayoutDesc);
+
+    wgpu::ShaderSourceWGSL wgsl = {};
+    wgsl.code = wgslSource.c_str();
+    wgpu::ShaderModuleDescriptor shaderModuleDesc = {
+        .nextInChain = reinterpret_cast<wgpu::ChainedStruct*>(&wgsl),
+        .label = "Shader Module",
+    };
+    wgpu::ShaderModule shaderModule =
+        device.CreateShaderModule(&shaderModuleDesc);
+
+    wgpu::ComputePipelineDescriptor computePipelineDesc = {
+        .label = "Compute Pipeline",
+        .layout = pipelineLayout,
+        .compute =
+            {
+                .module = shaderModule,
+                .entryPoint = "computeMain",
+            },
+    };
+    wgpu::ComputePipeline computePipeline =
+        device.CreateComputePipeline(&computePipelineDesc);
+
+    wgpu::BufferDescriptor mapBufferDesc = {
+        .label = "Map Buffer",
+        .usage = wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::MapRead,
+        .size = data.size() * sizeof(float),
+        .mappedAtCreation = false,
+    };
+    wgpu::Buffer mapBuffer = device.CreateBuffer(&mapBufferDesc);
+
+    wgpu::CommandEncoder commandEncoder = device.CreateCommandEncoder();
+    wgpu::ComputePassEncoder pass = commandEncoder.BeginComputePass();
+    pass.SetPipeline(computePipeline);
+    pass.SetBindGroup(0, bindGroup);
+    REQUIRE(dispatch::DispatchLinear(pass, dispatch::WorkgroupsFor(Count, 1)));
+    pass.End();
+    commandEncoder.CopyBufferToBuffer(
+        tb.GetDataBuffer(), 0, mapBuffer, 0, data.size() * sizeof(float));
+    wgpu::CommandBuffer commandBuffer = commandEncoder.Finish();
+    queue.Submit(1, &commandBuffer);
+
+    std::vector<float> result(data.size());
+    auto mapCallback =
+        [&mapBuffer, &result](wgpu::MapAsyncStatus status, wgpu::StringView)
+    {
+        if (status == wgpu::MapAsyncStatus::Success) {
+            const auto* mapped = static_cast<const float*>(
+                mapBuffer.GetConstMappedRange(0, result.size() * sizeof(float)));
+            std::copy(mapped, mapped + result.size(), result.begin());
+            mapBuffer.Unmap();
+        }
+    };
+    instance.WaitAny(mapBuffer.MapAsync(wgpu::MapMode::Read,
+                                        0,
+                                        result.size() * sizeof(float),
+                                        wgpu::CallbackMode::WaitAnyOnly,
+                                        mapCallback),
+                     UINT64_MAX);
+
+    std::vector<float> expected(data.size(), 2.0f);
+    REQUIRE_THAT(result, Catch::Matchers::Equals(expected));
+}
+
+TEST_CASE("Folded indices saturate instead of wrapping", "[dispatch]")
+{
+    Library lib;
+    wgpu::Instance instance = lib.CreateInstance();
+    wgpu::Adapter adapter = lib.RequestAdapter(instance);
+    wgpu::Device device = lib.RequestDevice(adapter);
+
+    // A z fold can reach workgroups whose linear index needs more than 32
+    // bits; launching one takes billions of workgroups, so evaluate the index
+    // helpers on such group ids directly.
+    const char* shader = R"(
+import tensor;
+RWTensorBuffer<uint, int> indices;
+[numthreads(1,1,1)]
+void computeMain()
+{
+    var out = indices;
+    out[0] = linearGroupIndex(uint3(7, 3, 0));
+    out[1] = linearGroupIndex(uint3(65534, 1, 1));
+    out[2] = linearGroupIndex(uint3(1, 2, 1));
+    out[3] = linearGroupIndex(uint3(0, 0, 2));
+    out[4] = linearThreadIndex(uint3(5, 1, 0), uint3(3, 0, 0), 64);
+    out[5] = linearThreadIndex(uint3(0, 1025, 0), uint3(0, 0, 0), 64);
+    uint3 grid = foldWorkgroups(65535u * 65535u + 1u);
+    out[6] = grid.x;
+    out[7] = grid.y;
+    out[8] = grid.z;
+}
+)";
+
+    slang_compiler::Compiler compiler({SHADERS_DIR});
+    auto prog = compiler.CompileFromSource(shader, "saturate", "computeMain");
+    auto infoOpt =
+        tensor_reflection::ReflectTensorBuffer(prog.program.get(), "indices");
+    REQUIRE(infoOpt.has_value());
+
+    constexpr uint32_t W = dispatch::kFoldWidth;
+    constexpr uint32_t kOverflow = UINT32_MAX;
+    const std::vector<uint32_t> expected = {
+        3 * W + 7,
+        W * W + W + 65534,
+        kOverflow,
+        kOverflow,
+        (W + 5) * 64 + 3,
+        kOverflow,
+        W,
+        W,
+        2,
+    };
+
+    tensor_buffer::TensorBuffer tb(*infoOpt);
+    tb.Initialize(device, expected.size() * sizeof(uint32_t));
+    const std::array<int32_t, 1> dims = {
+        static_cast<int32_t>(expected.size())};
+    tb.WriteShape(device.GetQueue(), dims);
+
+    compute_kernel::Bindings bindings;
+    bindings.Add(tb);
+    compute_kernel::ComputeKernel kernel("computeMain");
+    REQUIRE(kernel.Initialize(device,
+                              prog.compileToWGSL(),
+                              "computeMain",
+                              bindings.GetLayoutEntries()));
+
+    wgpu::CommandEncoder encoder = device.CreateCommandEncoder();
+    wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+    pass.SetPipeline(kernel.GetPipeline());
+    pass.SetBindGroup(0, kernel.CreateBindGroup(bindings.GetEntries()));
+    pass.DispatchWorkgroups(1, 1, 1);
+    pass.End();
+    wgpu::CommandBuffer commandBuffer = encoder.Finish();
+    device.GetQueue().Submit(1, &commandBuffer);
+
+    CHECK_THAT(compute_kernel::ReadBuffer<uint32_t>(
+                   instance, device, tb.GetDataBuffer(), expected.size()),
+               Catch::Matchers::Equals(expected));
+}
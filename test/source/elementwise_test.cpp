@@ -0,0 +1,151 @@
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "elementwise.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers.hpp>
+#include <catch2/matchers/catch_matchers_vector.hpp>
+
+#include "test_fixture.hpp"
+
+namespace
+{
+using tensor_buffer::TensorView;
+
+struct Fixture : TestFixture
+{
+    elementwise::Engine engine;
+
+    /// Runs op(a, b) and reads back `count` output elements.
+    std::vector<float> Run(elementwise::BinaryOp op,
+                           const tensor_buffer::BufferView& a,
+                           const tensor_buffer::BufferView& b,
+                           size_t count)
+    {
+        wgpu::Buffer output = Create<float>(count);
+        wgpu::CommandEncoder encoder = device.CreateCommandEncoder();
+        wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+        const bool encoded = engine.Encode(pass, op, a, b, output);
+        pass.End();
+        if (!encoded) {
+            return {};
+        }
+        Submit(encoder);
+        return Read<float>(output, count);
+    }
+};
+
+/// Small integers keep every result exact.
+std::vector<float> Sequence(size_t count, int32_t seed)
+{
+    std::vector<float> values(count);
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = static_cast<float>((i * 7 + static_cast<size_t>(seed)) % 11)
+            - 5.0f;
+    }
+    return values;
+}
+}    // namespace
+
+TEST_CASE("Broadcast shapes follow NumPy rules", "[elementwise]")
+{
+    using elementwise::BroadcastShape;
+    const std::array<int32_t, 3> a = {2, 3, 4};
+    const std::array<int32_t, 1> bias = {4};
+    const std::array<int32_t, 3> channel = {1, 3, 1};
+    const std::array<int32_t, 1> wrong = {3};
+    const std::array<int32_t, 2> column = {3, 1};
+    const std::array<int32_t, 2> row = {1, 4};
+
+    CHECK(BroadcastShape(a, bias) == std::vector<int32_t>({2, 3, 4}));
+    CHECK(BroadcastShape(a, channel) == std::vector<int32_t>({2, 3, 4}));
+    CHECK(BroadcastShape(column, row) == std::vector<int32_t>({3, 4}));
+    CHECK(BroadcastShape(a, {}) == std::vector<int32_t>({2, 3, 4}));
+    CHECK_FALSE(BroadcastShape(a, wrong));
+}
+
+TEST_CASE("Broadcast binary operations match the CPU", "[elementwise]")
+{
+    Fixture f;
+    REQUIRE(f.engine.Initialize(f.device, f.compiler));
+
+    struct Case
+    {
+        std::vector<int32_t> aDims;
+        std::vector<int32_t> bDims;
+        elementwise::BinaryOp op;
+    };
+    // Bias add, per-channel scale, outer product shapes, a rank-1 tail that
+    // is not a multiple of the vector width, and a 4-D broadcast. The first
+    // and last cases have buffers of whole 16-byte words, which take the
+    // 128-bit path; the [8, 6] case has whole words too, but rows that
+    // share them.
+    const std::vector<Case> cases = {
+        {{2, 3, 8}, {8}, elementwise::BinaryOp::Add},
+        {{2, 3, 5}, {3, 1}, elementwise::BinaryOp::Multiply},
+        {{7, 1}, {1, 6}, elementwise::BinaryOp::Subtract},
+        {{13}, {1}, elementwise::BinaryOp::Maximum},
+        {{2, 1, 4, 5}, {3, 1, 5}, elementwise::BinaryOp::Minimum},
+        {{8, 6}, {8, 6}, elementwise::BinaryOp::Add},
+        {{4, 16}, {4, 1}, elementwise::BinaryOp::Divide},
+    };
+    for (const Case& c : cases) {
+        INFO("rank " << c.aDims.size() << " op " << static_cast<int>(c.op));
+        const auto aView = TensorView::Contiguous(c.aDims);
+        const auto bView = TensorView::Contiguous(c.bDims);
+        const auto a = Sequence(static_cast<size_t>(aView.Count()), 1);
+        const auto b = Sequence(static_cast<size_t>(bView.Count()), 4);
+        const auto expected =
+            elementwise::ReferenceBinary(c.op, c.aDims, a, c.bDims, b);
+        REQUIRE_FALSE(expected.empty());
+
+        const auto result = f.Run(c.op,
+                                  {f.Upload(a), aView},
+                                  {f.Upload(b), bView},
+                                  expected.size());
+        CHECK_THAT(result, Catch::Matchers::Equals(expected));
+    }
+}
+
+TEST_CASE("Strided operands are read through their views", "[elementwise]")
+{
+    Fixture f;
+    REQUIRE(f.engine.Initialize(f.device, f.compiler));
+
+    // a is a [4, 3] transpose of a row-major [3, 4] buffer.
+    const std::array<int32_t, 2> stored = {3, 4};
+    const auto a = Sequence(12, 2);
+    auto aView = TensorView::Contiguous(stored).Transpose(0, 1);
+    REQUIRE(aView);
+    const std::array<int32_t, 1> bDims = {3};
+    const std::vector<float> b = {1.0f, 2.0f, 3.0f};
+
+    const auto result = f.Run(elementwise::BinaryOp::Multiply,
+                              {f.Upload(a), *aView},
+                              {f.Upload(b), TensorView::Contiguous(bDims)},
+                              12);
+    std::vector<float> expected(12);
+    for (size_t r = 0; r < 4; ++r) {
+        for (size_t c = 0; c < 3; ++c) {
+            expected[r * 3 + c] = a[c * 4 + r] * b[c];
+        }
+    }
+    CHECK_THAT(result, Catch::Matchers::Equals(expected));
+}
+
+TEST_CASE("Incompatible shapes are rejected", "[elementwise]")
+{
+    Fixture f;
+    REQUIRE(f.engine.Initialize(f.device, f.compiler));
+    const std::array<int32_t, 2> aDims = {2, 3};
+    const std::array<int32_t, 2> bDims = {2, 4};
+    const auto result = f.Run(elementwise::BinaryOp::Add,
+                              {f.Upload(Sequence(6, 0)),
+                               TensorView::Contiguous(aDims)},
+                              {f.Upload(Sequence(8, 0)),
+                               TensorView::Contiguous(bDims)},
+                              8);
+    CHECK(result.empty());
+}
@@ -0,0 +1,156 @@
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "embedding.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <catch2/matchers/catch_matchers_vector.hpp>
+
+#include "test_fixture.hpp"
+
+namespace
+{
+using embedding::Scatter;
+
+// A 50 x 5 table in chunks of 64 floats: four chunks, with rows that
+// straddle the chunk boundaries.
+constexpr int32_t kRows = 50;
+constexpr int32_t kDim = 5;
+constexpr size_t kChunkBytes = 64 * sizeof(float);
+
+using Fixture = TestFixture;
+
+std::vector<float> Values(size_t count, float phase)
+{
+    std::vector<float> values(count);
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = std::sin(static_cast<float>(i) * 0.61f + phase);
+    }
+    return values;
+}
+
+/// Token ids with many repeats of a few rows and two out-of-range ids.
+std::vector<int32_t> Tokens(size_t count)
+{
+    std::vector<int32_t> tokens(count);
+    for (size_t i = 0; i < count; ++i) {
+        tokens[i] = i % 3 == 0 ? 7 : static_cast<int32_t>((i * 17) % kRows);
+    }
+    tokens[1] = -1;
+    tokens[2] = kRows;
+    return tokens;
+}
+}    // namespace
+
+TEST_CASE("Embedding tables span several chunks", "[embedding]")
+{
+    Fixture f;
+    CHECK_FALSE(embedding::CreateTable(f.device, 0, kDim));
+    CHECK_FALSE(embedding::CreateTable(f.device, 1000, kDim, kChunkBytes));
+    // 2^32 elements: more than 32-bit indices address.
+    CHECK_FALSE(embedding::CreateTable(f.device, 1 << 16, 1 << 16));
+
+    auto table = embedding::CreateTable(f.device, kRows, kDim, kChunkBytes);
+    REQUIRE(table);
+    CHECK(table->chunkCount == 4);
+    CHECK(table->chunkElements == 64);
+    const std::vector<float> values =
+        Values(static_cast<size_t>(kRows * kDim), 0.0f);
+    embedding::WriteTable(f.device.GetQueue(), *table, values);
+    CHECK_THAT(embedding::ReadTable(f.instance, f.device, *table),
+               Catch::Matchers::Equals(values));
+}
+
+TEST_CASE("Embedding gather matches the CPU", "[embedding]")
+{
+    Fixture f;
+    embedding::Embedding lookup;
+    REQUIRE(lookup.Initialize(f.device, f.compiler));
+    auto table = embedding::CreateTable(f.device, kRows, kDim, kChunkBytes);
+    REQUIRE(table);
+    const std::vector<float> weights =
+        Values(static_cast<size_t>(kRows * kDim), 0.0f);
+    embedding::WriteTable(f.device.GetQueue(), *table, weights);
+
+    const std::vector<int32_t> tokens = Tokens(300);
+    const size_t count = tokens.size() * kDim;
+    std::vector<float> expected(count);
+    embedding::ReferenceGather(weights, kRows, kDim, tokens, expected);
+    wgpu::Buffer indices = f.Upload(tokens);
+    wgpu::Buffer values = f.Upload(std::vector<float>(count));
+
+    wgpu::CommandEncoder encoder = f.device.CreateCommandEncoder();
+    wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+    const bool encoded = lookup.EncodeGather(
+        pass, *table, indices, static_cast<int32_t>(tokens.size()), values);
+    pass.End();
+    REQUIRE(encoded);
+    f.Submit(encoder);
+    CHECK_THAT(f.Read<float>(values, count),
+               Catch::Matchers::Equals(expected));
+}
+
+TEST_CASE("Embedding scatter-add matches the CPU", "[embedding]")
+{
+    Fixture f;
+    embedding::Embedding lookup;
+    REQUIRE(lookup.Initialize(f.device, f.compiler));
+    // Up to several sort blocks.
+    for (int32_t tokenCount : {3, 300, 2500}) {
+        const std::vector<int32_t> tokens =
+            Tokens(static_cast<size_t>(tokenCount));
+        const std::vector<float> gradients =
+            Values(tokens.size() * kDim, 1.3f);
+        std::vector<float> expected =
+            Values(static_cast<size_t>(kRows * kDim), 0.0f);
+        const std::vector<float> initial = expected;
+        embedding::ReferenceScatterAdd(
+            expected, kRows, kDim, tokens, gradients);
+        wgpu::Buffer indices = f.Upload(tokens);
+        wgpu::Buffer values = f.Upload(gradients);
+
+        for (Scatter scatter : {Scatter::SortedSegments, Scatter::Atomic}) {
+            INFO("tokens " << tokens.size() << " scatter "
+                           << static_cast<int>(scatter));
+            auto table =
+                embedding::CreateTable(f.device, kRows, kDim, kChunkBytes);
+            REQUIRE(table);
+            embedding::WriteTable(f.device.GetQueue(), *table, initial);
+
+            wgpu::CommandEncoder encoder = f.device.CreateCommandEncoder();
+            wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+            const bool encoded =
+                lookup.EncodeScatterAdd(pass,
+                                        *table,
+                                        indices,
+                                        static_cast<int32_t>(tokens.size()),
+                                        values,
+                                        scatter);
+            pass.End();
+            REQUIRE(encoded);
+            f.Submit(encoder);
+            CHECK_THAT(embedding::ReadTable(f.instance, f.device, *table),
+                       Catch::Matchers::Approx(expected).epsilon(1e-4f).margin(
+                           1e-3f));
+        }
+    }
+}
+
+TEST_CASE("Embedding kernels reject empty lookups", "[embedding]")
+{
+    Fixture f;
+    embedding::Embedding lookup;
+    REQUIRE(lookup.Initialize(f.device, f.compiler));
+    auto table = embedding::CreateTable(f.device, kRows, kDim);
+    REQUIRE(table);
+    wgpu::Buffer buffer = f.Upload(std::vector<int32_t>(4));
+
+    wgpu::CommandEncoder encoder = f.device.CreateCommandEncoder();
+    wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+    CHECK_FALSE(lookup.EncodeGather(pass, *table, buffer, 0, buffer));
+    CHECK_FALSE(lookup.EncodeScatterAdd(pass, *table, buffer, -1, buffer));
+    pass.End();
+}
@@ -0,0 +1,172 @@
+#include <array>
+#include <vector>
+
+#include "gemm.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers.hpp>
+#include <catch2/matchers/catch_matchers_vector.hpp>
+
+#include "lib.hpp"
+#include "slang_compiler.hpp"
+
+namespace
+{
+/// Small integers keep every partial sum exact, so results compare equal
+/// regardless of the summation order.
+std::vector<float> Sequence(size_t count, int seed)
+{
+    std::vector<float> values(count);
+    for (size_t i = 0; i < count; ++i) {
+        size_t step = (i * 5 + static_cast<size_t>(seed)) % 7;
+        values[i] = static_cast<float>(step) - 3.0f;
+    }
+    return values;
+}
+
+void RunGemm(gemm::Gemm& kernel, wgpu::Device device)
+{
+    wgpu::CommandEncoder encoder = device.CreateCommandEncoder();
+    wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+    kernel.Encode(pass);
+    pass.End();
+    wgpu::CommandBuffer commandBuffer = encoder.Finish();
+    device.GetQueue().Submit(1, &commandBuffer);
+}
+}    // namespace
+
+TEST_CASE("Workgroups cover partial tiles", "[gemm]")
+{
+    dispatch::Grid grid = gemm::Workgroups({.m = 65, .n = 64, .k = 3});
+    CHECK(grid.x == 1);
+    CHECK(grid.y == 2);
+    CHECK(grid.z == 1);
+}
+
+TEST_CASE("Tiled GEMM matches the CPU reference", "[gemm]")
+{
+    Library lib;
+    wgpu::Instance instance = lib.CreateInstance();
+    wgpu::Adapter adapter = lib.RequestAdapter(instance);
+    wgpu::Device device = lib.RequestDevice(adapter);
+    wgpu::Queue queue = device.GetQueue();
+    slang_compiler::Compiler compiler({SHADERS_DIR});
+
+    // Deliberately not multiples of the tile sizes.
+    const gemm::Shape shape = {.m = 67, .n = 33, .k = 45};
+    const auto a = Sequence(static_cast<size_t>(shape.m * shape.k), 1);
+    const auto b = Sequence(static_cast<size_t>(shape.k * shape.n), 2);
+    const auto c = Sequence(static_cast<size_t>(shape.m * shape.n), 3);
+
+    for (gemm::Variant variant : {gemm::Variant::NN,
+                                  gemm::Variant::NT,
+                                  gemm::Variant::TN,
+                                  gemm::Variant::TT})
+    {
+        INFO("entry point " << gemm::EntryPoint(variant));
+        gemm::Gemm kernel(variant);
+        REQUIRE(kernel.Initialize(device, compiler));
+        REQUIRE(kernel.Resize(queue, shape));
+        kernel.WriteA(queue, a);
+        kernel.WriteB(queue, b);
+        kernel.WriteC(queue, c);
+
+        RunGemm(kernel, device);
+        std::vector<float> expected = c;
+        gemm::ReferenceGemm(variant, shape, a, b, expected);
+        REQUIRE_THAT(kernel.ReadC(instance),
+                     Catch::Matchers::Equals(expected));
+
+        // C now holds op(A) * op(B); apply the epilogue on top of it.
+        kernel.SetScalars(queue, 2.0f, 0.5f);
+        RunGemm(kernel, device);
+        gemm::ReferenceGemm(variant, shape, a, b, expected, 2.0f, 0.5f);
+        REQUIRE_THAT(kernel.ReadC(instance),
+                     Catch::Matchers::Equals(expected));
+    }
+}
+
+TEST_CASE("GEMM rejects empty shapes", "[gemm]")
+{
+    Library lib;
+    wgpu::Instance instance = lib.CreateInstance();
+    wgpu::Adapter adapter = lib.RequestAdapter(instance);
+    wgpu::Device device = lib.RequestDevice(adapter);
+
+    slang_compiler::Compiler compiler({SHADERS_DIR});
+    gemm::Gemm kernel;
+    REQUIRE(kernel.Initialize(device, compiler));
+    CHECK_FALSE(kernel.Resize(device.GetQueue(), {.m = 0, .n = 4, .k = 4}));
+}
+
+TEST_CASE("Tiled GEMM with a non-default tile config", "[gemm]")
+{
+    Library lib;
+    wgpu::Instance instance = lib.CreateInstance();
+    wgpu::Adapter adapter = lib.RequestAdapter(instance);
+    wgpu::Device device = lib.RequestDevice(adapter);
+    wgpu::Queue queue = device.GetQueue();
+    slang_compiler::Compiler compiler({SHADERS_DIR});
+
+    const gemm::TileConfig config = {.threadsX = 8, .threadsY = 32, .tileK = 8};
+    const gemm::Shape shape = {.m = 130, .n = 20, .k = 17};
+    dispatch::Grid grid = gemm::Workgroups(shape, config);
+    CHECK(grid.x == 1);
+    CHECK(grid.y == 2);
+
+    gemm::Gemm kernel(gemm::Variant::NN, config);
+    REQUIRE(kernel.Initialize(device, compiler));
+    REQUIRE(kernel.Resize(queue, shape));
+    const auto a = Sequence(static_cast<size_t>(shape.m * shape.k), 4);
+    const auto b = Sequence(static_cast<size_t>(shape.k * shape.n), 5);
+    kernel.WriteA(queue, a);
+    kernel.WriteB(queue, b);
+    RunGemm(kernel, device);
+
+    std::vector<float> expected(static_cast<size_t>(shape.m * shape.n));
+    gemm::ReferenceGemm(gemm::Variant::NN, shape, a, b, expected);
+    REQUIRE_THAT(kernel.ReadC(instance), Catch::Matchers::Equals(expected));
+}
+
+TEST_CASE("Both inner-product paths match the CPU reference", "[gemm]")
+{
+    Library lib;
+    wgpu::Instance instance = lib.CreateInstance();
+    wgpu::Adapter adapter = lib.RequestAdapter(instance);
+    wgpu::Device device = lib.RequestDevice(adapter);
+    wgpu::Queue queue = device.GetQueue();
+    slang_compiler::Compiler compiler({SHADERS_DIR});
+
+    const gemm::Shape shape = {.m = 67, .n = 33, .k = 45};
+    const auto a = Sequence(static_cast<size_t>(shape.m * shape.k), 6);
+    const auto b = Sequence(static_cast<size_t>(shape.k * shape.n), 7);
+    std::vector<float> expected(static_cast<size_t>(shape.m * shape.n));
+    gemm::ReferenceGemm(gemm::Variant::NN, shape, a, b, expected);
+
+    // K slices shorter than, equal to and longer than a thread row.
+    const std::array<gemm::TileConfig, 3> configs = {{
+        {.threadsX = 16, .threadsY = 16, .tileK = 8},
+        {.threadsX = 8, .threadsY = 32, .tileK = 8},
+        {.threadsX = 8, .threadsY = 8, .tileK = 32},
+    }};
+    for (const gemm::TileConfig& config : configs) {
+        std::vector<subgroups::Path> paths = {subgroups::Path::Shared};
+        if (gemm::SelectPath(device, config) == subgroups::Path::Subgroups) {
+            paths.push_back(subgroups::Path::Subgroups);
+        }
+        for (subgroups::Path path : paths) {
+            INFO("path " << subgroups::PathName(path) << " config "
+                         << config.threadsX << "x" << config.threadsY << "x"
+                         << config.tileK);
+            gemm::Gemm kernel(gemm::Variant::NN, config, path);
+            REQUIRE(kernel.Initialize(device, compiler));
+            CHECK(kernel.GetPath() == path);
+            REQUIRE(kernel.Resize(queue, shape));
+            kernel.WriteA(queue, a);
+            kernel.WriteB(queue, b);
+            RunGemm(kernel, device);
+            CHECK_THAT(kernel.ReadC(instance),
+                       Catch::Matchers::Equals(expected));
+        }
+    }
+}
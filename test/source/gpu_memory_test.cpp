@@ -0,0 +1,69 @@
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "gpu_memory.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "lib.hpp"
+
+namespace
+{
+gpu_memory::LabelUsage FindLabel(const gpu_memory::MemoryReport& report,
+                                 const std::string& label)
+{
+    auto it = std::find_if(report.labels.begin(),
+                           report.labels.end(),
+                           [&label](const gpu_memory::LabelUsage& usage)
+                           { return usage.label == label; });
+    return it != report.labels.end() ? *it : gpu_memory::LabelUsage {};
+}
+}    // namespace
+
+TEST_CASE("Track live bytes and high-water marks", "[gpu_memory]")
+{
+    Library lib;
+    wgpu::Instance instance = lib.CreateInstance();
+    wgpu::Adapter adapter = lib.RequestAdapter(instance);
+    wgpu::Device device = lib.RequestDevice(adapter);
+
+    wgpu::BufferDescriptor desc = {
+        .label = "gpu_memory_test",
+        .usage = wgpu::BufferUsage::Storage,
+        .size = 1024,
+        .mappedAtCreation = false,
+    };
+
+    uint64_t liveBefore = gpu_memory::GetReport().liveBytes;
+    {
+        gpu_memory::TrackedBuffer a = gpu_memory::CreateBuffer(device, desc);
+        gpu_memory::TrackedBuffer b = gpu_memory::CreateBuffer(device, desc);
+        REQUIRE(a.Get() != nullptr);
+        CHECK(a.GetSize() == 1024);
+
+        auto report = gpu_memory::GetReport();
+        auto usage = FindLabel(report, "gpu_memory_test");
+        CHECK(usage.liveBytes == 2048);
+        CHECK(usage.liveBuffers == 2);
+        CHECK(report.liveBytes == liveBefore + 2048);
+        CHECK(gpu_memory::ReportLeaks(device) >= 2);
+
+        // Moving ownership must not double count or untrack.
+        gpu_memory::TrackedBuffer c = std::move(a);
+        CHECK(FindLabel(gpu_memory::GetReport(), "gpu_memory_test").liveBytes
+              == 2048);
+        c.Reset();
+        CHECK(FindLabel(gpu_memory::GetReport(), "gpu_memory_test").liveBytes
+              == 1024);
+    }
+
+    auto report = gpu_memory::GetReport();
+    auto usage = FindLabel(report, "gpu_memory_test");
+    CHECK(usage.liveBytes == 0);
+    CHECK(usage.liveBuffers == 0);
+    CHECK(usage.highWaterBytes == 2048);
+    CHECK(usage.totalAllocations == 2);
+    CHECK(report.liveBytes == liveBefore);
+    CHECK(gpu_memory::ReportLeaks(device) == 0);
+}
@@ -0,0 +1,126 @@
+#include <string>
+
+#include "gpu_profiler.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "lib.hpp"
+#include "slang_compiler.hpp"
+
+TEST_CASE("Aggregate kernel samples", "[gpu_profiler]")
+{
+    gpu_profiler::GpuProfiler profiler;
+    for (uint64_t i = 1; i <= 100; ++i) {
+        profiler.RecordSample("fast", i * 1000);
+    }
+    profiler.RecordSample("slow", 500'000);
+
+    auto stats = profiler.GetStats();
+    REQUIRE(stats.size() == 2);
+    CHECK(stats[0].name == "slow");
+    CHECK(stats[1].name == "fast");
+    CHECK(stats[1].count == 100);
+    CHECK(stats[1].minUs > 0.99);
+    CHECK(stats[1].minUs < 1.01);
+    CHECK(stats[1].meanUs > 50.49);
+    CHECK(stats[1].meanUs < 50.51);
+    CHECK(stats[1].p99Us > 98.99);
+    CHECK(stats[1].p99Us < 99.01);
+
+    std::string json = profiler.DumpJSON();
+    CHECK(json.find("\"name\": \"fast\"") != std::string::npos);
+    CHECK(json.find("\"p99_us\"") != std::string::npos);
+}
+
+TEST_CASE("Profile compute passes with timestamp queries", "[gpu_profiler]")
+{
+    Library lib;
+    wgpu::Instance instance = lib.CreateInstance();
+    wgpu::Adapter adapter = lib.RequestAdapter(instance);
+    wgpu::Device device = lib.RequestDevice(adapter);
+    wgpu::Queue queue = device.GetQueue();
+
+    gpu_profiler::GpuProfiler profiler(4, 2);
+    if (!profiler.Initialize(device)) {
+        SKIP("TimestampQuery is not supported by this adapter");
+    }
+
+    const char* shader = R"(
+RWStructuredBuffer<float> result;
+[numthreads(64,1,1)]
+void computeMain(uint3 tid : SV_DispatchThreadID)
+{
+    result[tid.x] = float(tid.x);
+}
+)";
+
+    slang_compiler::Compiler compiler;
+    auto prog = compiler.CompileFromSource(shader, "profiled", "computeMain");
+    std::string wgslSource = prog.compileToWGSL();
+
+    wgpu::ShaderSourceWGSL wgsl = {};
+    wgsl.code = wgslSource.c_str();
+    wgpu::ShaderModuleDescriptor shaderModuleDesc = {
+        .nextInChain = reinterpret_cast<wgpu::ChainedStruct*>(&wgsl),
+        .label = "Shader Module",
+    };
+    wgpu::ComputePipelineDescriptor computePipelineDesc = {
+        .label = "Compute Pipeline",
+        .layout = nullptr,
+        .compute =
+            {
+                .module = device.CreateShaderModule(&shaderModuleDesc),
+                .entryPoint = "computeMain",
+            },
+    };
+    wgpu::ComputePipeline computePipeline =
+        device.CreateComputePipeline(&computePipelineDesc);
+
+    wgpu::BufferDescriptor bufferDesc = {
+        .label = "Result Buffer",
+        .usage = wgpu::BufferUsage::Storage,
+        .size = 64 * sizeof(float),
+        .mappedAtCreation = false,
+    };
+    wgpu::Buffer buffer = device.CreateBuffer(&bufferDesc);
+    wgpu::BindGroupEntry entry = {
+        .binding = 0,
+        .buffer = buffer,
+        .offset = 0,
+        .size = bufferDesc.size,
+    };
+    wgpu::BindGroupDescriptor bindGroupDesc = {
+        .label = "Bind Group",
+        .layout = computePipeline.GetBindGroupLayout(0),
+        .entryCount = 1,
+        .entries = &entry,
+    };
+    wgpu::BindGroup bindGroup = device.CreateBindGroup(&bindGroupDesc);
+
+    constexpr int Frames = 3;
+    for (int frame = 0; frame < Frames; ++frame) {
+        wgpu::CommandEncoder commandEncoder = device.CreateCommandEncoder();
+        wgpu::ComputePassDescriptor computePassDesc = {
+            .label = "fill",
+            .timestampWrites = profiler.BeginPass("fill"),
+        };
+        REQUIRE(computePassDesc.timestampWrites != nullptr);
+        wgpu::ComputePassEncoder pass =
+            commandEncoder.BeginComputePass(&computePassDesc);
+        pass.SetPipeline(computePipeline);
+        pass.SetBindGroup(0, bindGroup);
+        pass.DispatchWorkgroups(1, 1, 1);
+        pass.End();
+        profiler.Resolve(commandEncoder);
+
+        wgpu::CommandBuffer commandBuffer = commandEncoder.Finish();
+        queue.Submit(1, &commandBuffer);
+        profiler.Flush(instance);
+    }
+
+    auto stats = profiler.GetStats();
+    REQUIRE(stats.size() == 1);
+    CHECK(stats[0].name == "fill");
+    CHECK(stats[0].count == Frames);
+    CHECK(stats[0].minUs <= stats[0].p99Us);
+}
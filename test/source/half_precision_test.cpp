@@ -0,0 +1,167 @@
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "half_precision.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <catch2/matchers/catch_matchers_vector.hpp>
+
+#include "test_fixture.hpp"
+
+namespace
+{
+using half_precision::Storage;
+using tensor_buffer::TensorView;
+
+struct Fixture : TestFixture
+{
+    /// Packed always runs; native only with ShaderF16.
+    std::vector<Storage> Storages() const
+    {
+        if (half_precision::StorageFor(device) == Storage::Native) {
+            return {Storage::Packed, Storage::Native};
+        }
+        return {Storage::Packed};
+    }
+};
+
+/// Small integers and halves are exact in f16 and keep every product and
+/// partial sum exact in f32.
+std::vector<float> Sequence(size_t count, int seed)
+{
+    std::vector<float> values(count);
+    for (size_t i = 0; i < count; ++i) {
+        size_t step = (i * 5 + static_cast<size_t>(seed)) % 7;
+        values[i] = 0.5f * static_cast<float>(step) - 1.5f;
+    }
+    return values;
+}
+}    // namespace
+
+TEST_CASE("Host f16 conversion rounds to nearest even", "[half_precision]")
+{
+    using half_precision::ToFloat;
+    using half_precision::ToHalf;
+
+    CHECK(ToHalf(0.0f) == 0x0000);
+    CHECK(ToHalf(-0.0f) == 0x8000);
+    CHECK(ToHalf(1.0f) == 0x3c00);
+    CHECK(ToHalf(-2.0f) == 0xc000);
+    CHECK(ToHalf(65504.0f) == 0x7bff);
+    CHECK(ToHalf(1e6f) == 0x7c00);
+    CHECK(ToHalf(std::numeric_limits<float>::infinity()) == 0x7c00);
+    CHECK(ToHalf(std::ldexp(1.0f, -24)) == 0x0001);
+    CHECK(ToHalf(std::ldexp(1.0f, -26)) == 0x0000);
+    // 1 + 2^-11 lies halfway between 1 and 1 + 2^-10 and rounds to even.
+    CHECK(ToHalf(1.0f + std::ldexp(1.0f, -11)) == 0x3c00);
+    CHECK(ToHalf(1.0f + 3.0f * std::ldexp(1.0f, -11)) == 0x3c02);
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    CHECK(std::isnan(ToFloat(ToHalf(nan))));
+
+    // Subnormals, the smallest normal, the largest finite value and signs.
+    const std::array<uint16_t, 6> exact = {
+        0x0001, 0x03ff, 0x0400, 0x3555, 0x7bff, 0xbc00};
+    for (uint16_t bits : exact) {
+        CHECK(ToHalf(ToFloat(bits)) == bits);
+    }
+    CHECK_THAT(ToFloat(0x3555), Catch::Matchers::WithinAbs(0.33325195, 1e-8));
+}
+
+TEST_CASE("Conversion kernels round-trip through f16 storage",
+          "[half_precision]")
+{
+    Fixture f;
+    // An odd count leaves half of the last word unused.
+    const std::vector<float> values = {
+        0.0f, 1.0f, -2.5f, 1024.0f, 0.333333f, -65504.0f, 0.1f};
+    const std::vector<float> expected =
+        half_precision::ToFloat(half_precision::ToHalf(values));
+
+    for (Storage storage : f.Storages()) {
+        INFO("storage " << static_cast<int>(storage));
+        half_precision::Converter converter(storage);
+        REQUIRE(converter.Initialize(f.device, f.compiler));
+
+        wgpu::Buffer floats = f.Upload(values);
+        auto halves = half_precision::CreateBuffer(f.device, values.size());
+        wgpu::Buffer widened = f.Create<float>(values.size());
+
+        wgpu::CommandEncoder encoder = f.device.CreateCommandEncoder();
+        wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+        REQUIRE(converter.Encode(pass,
+                                 floats,
+                                 halves.Get(),
+                                 values.size(),
+                                 half_precision::Direction::ToHalf));
+        pass.End();
+        // A second pass orders the reads after the writes.
+        pass = encoder.BeginComputePass();
+        REQUIRE(converter.Encode(pass,
+                                 halves.Get(),
+                                 widened,
+                                 values.size(),
+                                 half_precision::Direction::ToFloat));
+        pass.End();
+        f.Submit(encoder);
+
+        // WGSL may round inexact values either way, so allow one f16 ulp.
+        CHECK_THAT(half_precision::Readback(
+                       f.instance, f.device, halves.Get(), values.size()),
+                   Catch::Matchers::Approx(expected).epsilon(1e-3f));
+        CHECK_THAT(f.Read<float>(widened, values.size()),
+                   Catch::Matchers::Approx(expected).epsilon(1e-3f));
+    }
+}
+
+TEST_CASE("Mixed-precision GEMM accumulates in f32", "[half_precision]")
+{
+    Fixture f;
+    constexpr int32_t M = 37;
+    constexpr int32_t N = 45;
+    constexpr int32_t K = 70;
+    const std::vector<float> a = Sequence(M * K, 1);
+    const std::vector<float> b = Sequence(K * N, 4);
+    std::vector<float> expected(M * N, 0.0f);
+    gemm::ReferenceGemm(
+        gemm::Variant::NN, {.m = M, .n = N, .k = K}, a, b, expected);
+
+    // B^T stored as [N, K] and read through a transposed view.
+    std::vector<float> bt(b.size());
+    for (size_t k = 0; k < K; ++k) {
+        for (size_t n = 0; n < N; ++n) {
+            bt[n * K + k] = b[k * N + n];
+        }
+    }
+
+    for (Storage storage : f.Storages()) {
+        INFO("storage " << static_cast<int>(storage));
+        half_precision::Gemm kernel({}, storage);
+        REQUIRE(kernel.Initialize(f.device, f.compiler));
+        auto aHalf = half_precision::CreateBuffer(f.device, a.size());
+        auto btHalf = half_precision::CreateBuffer(f.device, bt.size());
+        half_precision::Upload(f.device.GetQueue(), aHalf.Get(), a);
+        half_precision::Upload(f.device.GetQueue(), btHalf.Get(), bt);
+        wgpu::Buffer c = f.Create<float>(expected.size());
+
+        const std::array<int32_t, 2> aDims = {M, K};
+        const std::array<int32_t, 2> btDims = {N, K};
+        auto bView = TensorView::Contiguous(btDims).Transpose(0, 1);
+        REQUIRE(bView);
+        wgpu::CommandEncoder encoder = f.device.CreateCommandEncoder();
+        wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+        REQUIRE(kernel.Encode(pass,
+                              {aHalf.Get(), TensorView::Contiguous(aDims)},
+                              {btHalf.Get(), *bView},
+                              c));
+        pass.End();
+        f.Submit(encoder);
+
+        CHECK_THAT(f.Read<float>(c, expected.size()),
+                   Catch::Matchers::Equals(expected));
+    }
+}
@@ -0,0 +1,190 @@
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "indirect.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers.hpp>
+#include <catch2/matchers/catch_matchers_vector.hpp>
+
+#include "dispatch.hpp"
+#include "tensor_buffer.hpp"
+#include "test_fixture.hpp"
+
+namespace
+{
+using Fixture = TestFixture;
+
+// filterPositive stands in for a kernel with a data-dependent output size;
+// doubleKept is sized by the count it leaves on the device.
+const char* kChainShader = R"(
+import tensor;
+RWTensorBuffer<float, int> input;
+RWTensorBuffer<float, int> kept;
+RWTensorBuffer<uint, int> counts;
+
+[numthreads(1,1,1)]
+void filterPositive()
+{
+    var out = kept;
+    var outCounts = counts;
+    uint n = 0;
+    for (int i = 0; i < input.getCount(); ++i) {
+        if (input[i] > 0.0f) {
+            out[int(n)] = input[i];
+            ++n;
+        }
+    }
+    outCounts[0] = n;
+}
+
+[numthreads(64,1,1)]
+void doubleKept(uint3 gid: SV_GroupID, uint3 ltid: SV_GroupThreadID)
+{
+    uint i = linearThreadIndex(gid, ltid, 64);
+    if (i >= counts[0])
+        return;
+    var out = kept;
+    out[int(i)] = 2.0f * kept[int(i)];
+}
+)";
+}    // namespace
+
+TEST_CASE("Indirect dispatch validates its arguments", "[indirect]")
+{
+    Fixture f;
+    gpu_memory::TrackedBuffer args = indirect::CreateArgsBuffer(f.device, 2);
+    wgpu::Buffer plain = f.Upload(std::vector<uint32_t>(3));
+
+    wgpu::CommandEncoder encoder = f.device.CreateCommandEncoder();
+    wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+    CHECK_FALSE(dispatch::DispatchIndirect(pass, plain));
+    CHECK_FALSE(dispatch::DispatchIndirect(pass, args.Get(), 2));
+    CHECK_FALSE(dispatch::DispatchIndirect(pass, args.Get(), args.GetSize()));
+    pass.End();
+}
+
+TEST_CASE("Indirect arguments fold device counts", "[indirect]")
+{
+    Fixture f;
+    indirect::ArgsWriter writer;
+    REQUIRE(writer.Initialize(f.device, f.compiler));
+    // Nothing, one partial workgroup, more workgroups than one row, and more
+    // threads than 32-bit indices address.
+    const std::vector<uint32_t> counts = {0, 5, 70000 * 64, UINT32_MAX};
+    wgpu::Buffer countsBuffer = f.Upload(counts);
+    gpu_memory::TrackedBuffer args = indirect::CreateArgsBuffer(f.device, 4);
+
+    wgpu::CommandEncoder encoder = f.device.CreateCommandEncoder();
+    wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+    const bool encoded = writer.Encode(pass, countsBuffer, args.Get(), 4, 64);
+    CHECK_FALSE(writer.Encode(pass, countsBuffer, args.Get(), 4, 0));
+    CHECK_FALSE(writer.Encode(pass, countsBuffer, args.Get(), 100, 64));
+    pass.End();
+    REQUIRE(encoded);
+    f.Submit(encoder);
+
+    const std::vector<uint32_t> expected = {
+        0, 1, 1, 1, 1, 1, 65535, 2, 1, 0, 0, 0};
+    CHECK(f.Read<uint32_t>(args.Get(), expected.size()) == expected);
+}
+
+TEST_CASE("Kernels chain through indirect dispatch", "[indirect]")
+{
+    Fixture f;
+    indirect::ArgsWriter writer;
+    REQUIRE(writer.Initialize(f.device, f.compiler));
+    gpu_memory::TrackedBuffer args = indirect::CreateArgsBuffer(f.device);
+
+    constexpr size_t kCount = 200;
+    std::vector<float> mixed(kCount);
+    for (size_t i = 0; i < kCount; ++i) {
+        mixed[i] = std::sin(static_cast<float>(i) * 0.7f);
+    }
+    // The second input launches no workgroups at all.
+    const std::vector<float> negative(kCount, -1.0f);
+    const std::array<const std::vector<float>*, 2> inputs = {&mixed,
+                                                             &negative};
+
+    for (const std::vector<float>* values : inputs) {
+        std::vector<float> expected;
+        for (float value : *values) {
+            if (value > 0.0f) {
+                expected.push_back(2.0f * value);
+            }
+        }
+        expected.resize(kCount, 0.0f);
+
+        wgpu::Buffer input = f.Upload(*values);
+        wgpu::Buffer kept = f.Upload(std::vector<float>(kCount));
+        wgpu::Buffer counts = f.Upload(std::vector<uint32_t>(1));
+
+        wgpu::CommandEncoder encoder = f.device.CreateCommandEncoder();
+        wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+        // Sizes the second kernel from the first one's count on the device,
+        // all in one pass without a readback.
+        for (const char* entryPoint : {"filterPositive", "doubleKept"}) {
+            auto prog = f.compiler.CompileFromSource(
+                kChainShader, "indirect_chain", entryPoint);
+            auto* program = prog.program.get();
+            auto uniformsInfo = uniform_buffer::ReflectUniformBuffer(program);
+            auto inputInfo =
+                tensor_reflection::ReflectTensorBuffer(program, "input");
+            auto keptInfo =
+                tensor_reflection::ReflectTensorBuffer(program, "kept");
+            auto countsInfo =
+                tensor_reflection::ReflectTensorBuffer(program, "counts");
+            REQUIRE(uniformsInfo);
+            REQUIRE(inputInfo);
+            REQUIRE(keptInfo);
+            REQUIRE(countsInfo);
+
+            uniform_buffer::UniformBuffer uniforms(*uniformsInfo);
+            uniforms.Initialize(f.device);
+            tensor_buffer::TensorBuffer inputBuffer(*inputInfo);
+            tensor_buffer::TensorBuffer keptBuffer(*keptInfo);
+            tensor_buffer::TensorBuffer countsBuffer(*countsInfo);
+            inputBuffer.Initialize(uniforms, input, input.GetSize());
+            keptBuffer.Initialize(uniforms, kept, kept.GetSize());
+            countsBuffer.Initialize(uniforms, counts, counts.GetSize());
+            const std::array<int32_t, 1> dims = {
+                static_cast<int32_t>(kCount)};
+            const std::array<int32_t, 1> one = {1};
+            wgpu::Queue queue = f.device.GetQueue();
+            inputBuffer.WriteShape(queue, dims);
+            keptBuffer.WriteShape(queue, dims);
+            countsBuffer.WriteShape(queue, one);
+
+            compute_kernel::Bindings bindings;
+            bindings.Add(uniforms).Add(inputBuffer).Add(keptBuffer).Add(
+                countsBuffer);
+            compute_kernel::ComputeKernel kernel(entryPoint);
+            REQUIRE(kernel.Initialize(f.device,
+                                      prog.compileToWGSL(),
+                                      entryPoint,
+                                      bindings.GetLayoutEntries()));
+            wgpu::BindGroup bindGroup =
+                kernel.CreateBindGroup(bindings.GetEntries());
+
+            const bool consumer =
+                std::string_view(entryPoint) == "doubleKept";
+            if (consumer) {
+                REQUIRE(writer.Encode(pass, counts, args.Get(), 1, 64));
+            }
+            pass.SetPipeline(kernel.GetPipeline());
+            pass.SetBindGroup(0, bindGroup);
+            if (consumer) {
+                REQUIRE(dispatch::DispatchIndirect(pass, args.Get()));
+            } else {
+                pass.DispatchWorkgroups(1, 1, 1);
+            }
+        }
+        pass.End();
+        f.Submit(encoder);
+        CHECK_THAT(f.Read<float>(kept, kCount),
+                   Catch::Matchers::Equals(expected));
+    }
+}
@@ -0,0 +1,103 @@
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "normalization.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers.hpp>
+#include <catch2/matchers/catch_matchers_vector.hpp>
+
+#include "lib.hpp"
+#include "slang_compiler.hpp"
+
+namespace
+{
+std::vector<float> Values(size_t count, float offset)
+{
+    std::vector<float> values(count);
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = offset + std::sin(static_cast<float>(i) * 0.37f) * 4.0f;
+    }
+    return values;
+}
+
+void Run(const normalization::RowNormalization& kernel, wgpu::Device device)
+{
+    wgpu::CommandEncoder encoder = device.CreateCommandEncoder();
+    wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+    kernel.Encode(pass);
+    pass.End();
+    wgpu::CommandBuffer commandBuffer = encoder.Finish();
+    device.GetQueue().Submit(1, &commandBuffer);
+}
+}    // namespace
+
+TEST_CASE("Fused softmax matches the CPU and survives large inputs",
+          "[normalization]")
+{
+    Library lib;
+    wgpu::Instance instance = lib.CreateInstance();
+    wgpu::Adapter adapter = lib.RequestAdapter(instance);
+    wgpu::Device device = lib.RequestDevice(adapter);
+    wgpu::Queue queue = device.GetQueue();
+    slang_compiler::Compiler compiler({SHADERS_DIR});
+
+    normalization::RowNormalization softmax(normalization::Kind::Softmax);
+    REQUIRE(softmax.Initialize(device, compiler));
+
+    // More columns than threads, and an offset that overflows a naive exp.
+    const int32_t rows = 7;
+    const int32_t cols = 1000;
+    for (float offset : {0.0f, 1000.0f}) {
+        INFO("offset " << offset);
+        const auto input = Values(static_cast<size_t>(rows * cols), offset);
+        REQUIRE(softmax.Resize(queue, rows, cols));
+        softmax.WriteInput(queue, input);
+        Run(softmax, device);
+
+        std::vector<float> expected(input.size());
+        normalization::ReferenceSoftmax(input, expected, rows, cols);
+        REQUIRE_THAT(softmax.ReadOutput(instance),
+                     Catch::Matchers::Approx(expected).margin(1e-6f));
+    }
+}
+
+TEST_CASE("Fused layer norm matches the CPU", "[normalization]")
+{
+    Library lib;
+    wgpu::Instance instance = lib.CreateInstance();
+    wgpu::Adapter adapter = lib.RequestAdapter(instance);
+    wgpu::Device device = lib.RequestDevice(adapter);
+    wgpu::Queue queue = device.GetQueue();
+    slang_compiler::Compiler compiler({SHADERS_DIR});
+
+    normalization::RowNormalization layerNorm(normalization::Kind::LayerNorm);
+    REQUIRE(layerNorm.Initialize(device, compiler));
+
+    const int32_t rows = 5;
+    const int32_t cols = 300;
+    // A large common offset is where a sum-of-squares variance falls apart.
+    const auto input = Values(static_cast<size_t>(rows * cols), 1000.0f);
+    std::vector<float> gamma(static_cast<size_t>(cols));
+    std::vector<float> beta(static_cast<size_t>(cols));
+    for (size_t c = 0; c < gamma.size(); ++c) {
+        gamma[c] = 0.5f + static_cast<float>(c % 3);
+        beta[c] = static_cast<float>(c % 5) - 2.0f;
+    }
+
+    REQUIRE(layerNorm.Resize(queue, rows, cols));
+    layerNorm.SetEpsilon(queue, 1e-3f);
+    layerNorm.WriteInput(queue, input);
+    layerNorm.WriteGamma(queue, gamma);
+    layerNorm.WriteBeta(queue, beta);
+    Run(layerNorm, device);
+
+    std::vector<float> expected(input.size());
+    normalization::ReferenceLayerNorm(
+        input, gamma, beta, expected, rows, cols, 1e-3f);
+    REQUIRE_THAT(layerNorm.ReadOutput(instance),
+                 Catch::Matchers::Approx(expected).margin(1e-3f));
+
+    CHECK_FALSE(layerNorm.Resize(queue, 0, cols));
+}
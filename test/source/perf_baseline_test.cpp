@@ -0,0 +1,116 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "baseline.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include "bench.hpp"
+
+using Catch::Matchers::WithinAbs;
+
+namespace
+{
+bench::Result MakeResult(const std::string& name, double medianMs, double mad)
+{
+    bench::Result result {};
+    result.name = name;
+    result.medianMs = medianMs;
+    result.madMs = mad;
+    return result;
+}
+}    // namespace
+
+TEST_CASE("Median and MAD of benchmark samples", "[perf_baseline]")
+{
+    CHECK_THAT(bench::Median({3.0, 1.0, 2.0}), WithinAbs(2.0, 1e-12));
+    CHECK_THAT(bench::Median({4.0, 1.0, 3.0, 2.0}), WithinAbs(2.5, 1e-12));
+    // A single outlier moves neither statistic much.
+    std::vector<double> samples = {1.0, 1.1, 0.9, 1.0, 50.0};
+    CHECK_THAT(bench::Median(samples), WithinAbs(1.0, 1e-12));
+    CHECK_THAT(bench::MedianAbsoluteDeviation(samples), WithinAbs(0.1, 1e-12));
+}
+
+TEST_CASE("Compare results against a baseline", "[perf_baseline]")
+{
+    bench::BaselineRun baseline = {
+        {"dispatch", {.medianMs = 1.0, .madMs = 0.01}},
+        {"compile", {.medianMs = 10.0, .madMs = 2.0}},
+        {"removed", {.medianMs = 1.0, .madMs = 0.0}},
+    };
+    std::vector<bench::Result> results = {
+        MakeResult("dispatch", 1.5, 0.01),    // +50%, beyond 25%
+        MakeResult("compile", 13.0, 2.0),    // +30%, within the MAD noise
+        MakeResult("added", 1.0, 0.0),
+    };
+
+    bench::Thresholds thresholds;
+    auto comparisons = bench::Compare(baseline, results, thresholds);
+    REQUIRE(comparisons.size() == 4);
+    CHECK(comparisons[0].verdict == bench::Verdict::Regressed);
+    CHECK(comparisons[1].verdict == bench::Verdict::Ok);
+    CHECK(comparisons[2].verdict == bench::Verdict::New);
+    CHECK(comparisons[3].name == "removed");
+    CHECK(comparisons[3].verdict == bench::Verdict::Missing);
+    CHECK(bench::HasRegression(comparisons));
+
+    std::string report = bench::FormatReport(comparisons);
+    CHECK(report.find("REGRESSED") != std::string::npos);
+    CHECK(report.find("+50.0%") != std::string::npos);
+
+    results[0].medianMs = 0.5;
+    comparisons = bench::Compare(baseline, results, thresholds);
+    CHECK(comparisons[0].verdict == bench::Verdict::Improved);
+    CHECK_FALSE(bench::HasRegression(comparisons));
+}
+
+TEST_CASE("Result strings are escaped for JSON", "[perf_baseline]")
+{
+    CHECK(bench::EscapeJSON("gemm/int4/64x2048") == "gemm/int4/64x2048");
+    CHECK(bench::EscapeJSON("a\"b\\c") == "a\\\"b\\\\c");
+    CHECK(bench::EscapeJSON("line\nbreak\x01") == "line\\nbreak\\u0001");
+}
+
+TEST_CASE("Baselines round-trip through JSON", "[perf_baseline]")
+{
+    const std::string key = bench::BaselineKey("SwiftShader (Vulkan)", "Debug");
+    bench::Baseline baseline;
+    bench::UpdateBaseline(baseline,
+                          key,
+                          {MakeResult("slang/compile", 12.5, 0.25),
+                           MakeResult("dispatch/\"quoted\"", 0.125, 0.0)});
+
+    auto path = std::filesystem::temp_directory_path() / "congpu_baseline.json";
+    REQUIRE(bench::SaveBaseline(path.string(), baseline));
+    auto loaded = bench::LoadBaseline(path.string());
+    std::filesystem::remove(path);
+
+    REQUIRE(loaded.has_value());
+    REQUIRE(loaded->runs.count(key) == 1);
+    const bench::BaselineRun& run = loaded->runs.at(key);
+    REQUIRE(run.size() == 2);
+    CHECK_THAT(run.at("slang/compile").medianMs, WithinAbs(12.5, 1e-6));
+    CHECK_THAT(run.at("slang/compile").madMs, WithinAbs(0.25, 1e-6));
+    CHECK_THAT(run.at("dispatch/\"quoted\"").medianMs, WithinAbs(0.125, 1e-6));
+
+    // A missing file is an empty baseline, a malformed one an error.
+    auto missing = bench::LoadBaseline(path.string());
+    REQUIRE(missing.has_value());
+    CHECK(missing->runs.empty());
+
+    {
+        std::ofstream out(path);
+        out << "{\"runs\": {\"key\": {\"x\": {\"mad_ms\": 1}}}}";
+    }
+    CHECK_FALSE(bench::LoadBaseline(path.string()).has_value());
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("The checked-in baseline parses", "[perf_baseline]")
+{
+    auto baseline = bench::LoadBaseline(PERF_BASELINE_PATH);
+    CHECK(baseline.has_value());
+}
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "permute.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers.hpp>
+#include <catch2/matchers/catch_matchers_vector.hpp>
+
+#include "test_fixture.hpp"
+
+namespace
+{
+struct Fixture : TestFixture
+{
+    permute::Permuter permuter;
+
+    std::vector<float> Run(const std::vector<float>& values,
+                           std::span<const int32_t> dims,
+                           std::span<const size_t> order,
+                           permute::Strategy strategy)
+    {
+        wgpu::Buffer src = Upload(values);
+        wgpu::Buffer dst = Create<float>(values.size());
+        wgpu::CommandEncoder encoder = device.CreateCommandEncoder();
+        wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+        const bool encoded =
+            permuter.Encode(pass, src, dst, dims, order, strategy);
+        pass.End();
+        if (!encoded) {
+            return {};
+        }
+        Submit(encoder);
+        return Read<float>(dst, values.size());
+    }
+};
+
+std::vector<float> Sequence(size_t count)
+{
+    std::vector<float> values(count);
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = static_cast<float>(i);
+    }
+    return values;
+}
+}    // namespace
+
+TEST_CASE("Permuted dimensions and kernel selection", "[permute]")
+{
+    const std::array<int32_t, 3> dims = {2, 3, 4};
+    const std::array<size_t, 3> order = {2, 0, 1};
+    const std::array<size_t, 3> keepInner = {1, 0, 2};
+    const std::array<size_t, 3> repeated = {0, 0, 1};
+
+    CHECK(permute::PermutedDims(dims, order)
+          == std::vector<int32_t>({4, 2, 3}));
+    CHECK_FALSE(permute::PermutedDims(dims, repeated));
+    CHECK(permute::Select(dims, order) == permute::Strategy::Tiled);
+    CHECK(permute::Select(dims, keepInner) == permute::Strategy::Vector);
+
+    const std::array<int32_t, 3> odd = {2, 3, 5};
+    CHECK(permute::Select(odd, keepInner) == permute::Strategy::Naive);
+
+    const std::array<int32_t, 2> column = {5, 1};
+    const std::array<size_t, 2> swap = {1, 0};
+    CHECK(permute::Select(column, swap) == permute::Strategy::Naive);
+}
+
+TEST_CASE("Every 4-D permutation matches the CPU", "[permute]")
+{
+    Fixture f;
+    REQUIRE(f.permuter.Initialize(f.device, f.compiler));
+
+    // Sizes straddle the 32-element tile edge.
+    const std::array<int32_t, 4> dims = {2, 3, 33, 34};
+    const std::vector<float> values = Sequence(2 * 3 * 33 * 34);
+    std::array<size_t, 4> order = {0, 1, 2, 3};
+    do {
+        INFO("order " << order[0] << order[1] << order[2] << order[3]);
+        const auto expected = permute::ReferencePermute(dims, values, order);
+        CHECK_THAT(f.Run(values, dims, order, permute::Strategy::Auto),
+                   Catch::Matchers::Equals(expected));
+        CHECK_THAT(f.Run(values, dims, order, permute::Strategy::Naive),
+                   Catch::Matchers::Equals(expected));
+    } while (std::next_permutation(order.begin(), order.end()));
+}
+
+TEST_CASE("Lower ranks are padded to four dimensions", "[permute]")
+{
+    Fixture f;
+    REQUIRE(f.permuter.Initialize(f.device, f.compiler));
+
+    const std::array<int32_t, 2> matrix = {70, 45};
+    const std::array<size_t, 2> transpose = {1, 0};
+    const std::vector<float> values = Sequence(70 * 45);
+    CHECK_THAT(f.Run(values, matrix, transpose, permute::Strategy::Tiled),
+               Catch::Matchers::Equals(
+                   permute::ReferencePermute(matrix, values, transpose)));
+
+    const std::array<int32_t, 3> cube = {5, 40, 3};
+    const std::array<size_t, 3> order = {2, 0, 1};
+    const std::vector<float> cubeValues = Sequence(5 * 40 * 3);
+    CHECK_THAT(f.Run(cubeValues, cube, order, permute::Strategy::Tiled),
+               Catch::Matchers::Equals(
+                   permute::ReferencePermute(cube, cubeValues, order)));
+}
+
+TEST_CASE("Vector permutations move aligned innermost runs", "[permute]")
+{
+    Fixture f;
+    REQUIRE(f.permuter.Initialize(f.device, f.compiler));
+
+    const std::array<int32_t, 4> dims = {3, 5, 2, 12};
+    const std::array<size_t, 4> order = {2, 0, 1, 3};
+    const std::vector<float> values = Sequence(3 * 5 * 2 * 12);
+    CHECK_THAT(f.Run(values, dims, order, permute::Strategy::Vector),
+               Catch::Matchers::Equals(
+                   permute::ReferencePermute(dims, values, order)));
+
+    const std::array<int32_t, 1> row = {8};
+    const std::array<size_t, 1> copy = {0};
+    CHECK_THAT(f.Run(Sequence(8), row, copy, permute::Strategy::Vector),
+               Catch::Matchers::Equals(Sequence(8)));
+}
+
+TEST_CASE("Tiled permutations need a moving innermost axis", "[permute]")
+{
+    Fixture f;
+    REQUIRE(f.permuter.Initialize(f.device, f.compiler));
+    const std::array<int32_t, 2> dims = {4, 8};
+    const std::array<size_t, 2> identity = {0, 1};
+    CHECK(f.Run(Sequence(32), dims, identity, permute::Strategy::Tiled)
+              .empty());
+
+    const std::array<int32_t, 2> odd = {4, 7};
+    const std::array<size_t, 2> transpose = {1, 0};
+    CHECK(f.Run(Sequence(28), odd, identity, permute::Strategy::Vector)
+              .empty());
+    CHECK(f.Run(Sequence(28), odd, transpose, permute::Strategy::Vector)
+              .empty());
+}
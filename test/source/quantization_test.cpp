@@ -0,0 +1,223 @@
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "quantization.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <catch2/matchers/catch_matchers_vector.hpp>
+
+#include "test_fixture.hpp"
+
+namespace
+{
+using quantization::Format;
+using quantization::Strategy;
+using tensor_buffer::TensorView;
+
+struct Fixture : TestFixture
+{
+    /// Runs A x W^T on the device.
+    std::vector<float> Multiply(const quantization::Matmul& matmul,
+                                const std::vector<float>& a,
+                                int32_t m,
+                                const quantization::DeviceWeights& weights,
+                                Strategy strategy)
+    {
+        wgpu::Buffer aBuffer = Upload(a);
+        wgpu::Buffer c = Upload(std::vector<float>(
+            static_cast<size_t>(m) * static_cast<size_t>(weights.rows)));
+        const std::array<int32_t, 2> aDims = {m, weights.cols};
+
+        wgpu::CommandEncoder encoder = device.CreateCommandEncoder();
+        wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+        const bool encoded =
+            matmul.Encode(pass,
+                          {aBuffer, TensorView::Contiguous(aDims)},
+                          weights,
+                          c,
+                          strategy);
+        pass.End();
+        REQUIRE(encoded);
+        Submit(encoder);
+        return Read<float>(
+            c, static_cast<size_t>(m) * static_cast<size_t>(weights.rows));
+    }
+};
+
+std::vector<float> Weights(size_t count, float phase)
+{
+    std::vector<float> values(count);
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = std::sin(static_cast<float>(i) * 0.73f + phase);
+    }
+    return values;
+}
+
+/// Frobenius norm of `actual - expected` relative to that of `expected`.
+float RelativeError(const std::vector<float>& actual,
+                    const std::vector<float>& expected)
+{
+    double error = 0.0;
+    double norm = 0.0;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        const auto reference = static_cast<double>(expected[i]);
+        const double diff = static_cast<double>(actual[i]) - reference;
+        error += diff * diff;
+        norm += reference * reference;
+    }
+    return static_cast<float>(std::sqrt(error / norm));
+}
+}    // namespace
+
+TEST_CASE("Quantization packs values from the low bits", "[quantization]")
+{
+    // With a range of [0, 2^bits - 1] the scale is 1 and the zero point 0.
+    std::vector<float> int4(16);
+    for (size_t i = 0; i < int4.size(); ++i) {
+        int4[i] = static_cast<float>(i);
+    }
+    auto packed4 = quantization::Quantize(int4, 1, 16, Format::Int4);
+    REQUIRE(packed4);
+    const std::vector<uint32_t> words4 = {0x76543210, 0xfedcba98};
+    CHECK(packed4->words == words4);
+    CHECK_THAT(packed4->scales, Catch::Matchers::Equals<float>({1.0f}));
+    CHECK_THAT(packed4->zeros, Catch::Matchers::Equals<float>({0.0f}));
+
+    // Five values pad the second word with zero slots.
+    const std::vector<float> int8 = {0.0f, 1.0f, 2.0f, 255.0f, 3.0f};
+    auto packed8 = quantization::Quantize(int8, 1, 5, Format::Int8);
+    REQUIRE(packed8);
+    CHECK(packed8->WordsPerRow() == 2);
+    const std::vector<uint32_t> words8 = {0xff020100, 0x00000003};
+    CHECK(packed8->words == words8);
+
+    // Groups must hold whole words unless they cover the row, and the sizes
+    // must match.
+    const std::vector<float> values = Weights(2 * 37, 0.0f);
+    CHECK_FALSE(quantization::Quantize(values, 2, 37, Format::Int4, 12));
+    CHECK(quantization::Quantize(values, 2, 37, Format::Int4, 40));
+    CHECK_FALSE(quantization::Quantize(values, 2, 36, Format::Int8));
+}
+
+TEST_CASE("Quantization error is at most half a step", "[quantization]")
+{
+    constexpr int32_t rows = 3;
+    constexpr int32_t cols = 37;
+    std::vector<float> values = Weights(rows * cols, 0.5f);
+    // Zero stays exact, and an all-positive group still includes it.
+    values[5] = 0.0f;
+    for (size_t k = 32; k < cols; ++k) {
+        values[cols + k] = 2.0f + static_cast<float>(k);
+    }
+
+    for (Format format : {Format::Int8, Format::Int4}) {
+        for (int32_t groupSize : {0, 8, 16}) {
+            INFO("format " << static_cast<int>(format) << " group "
+                           << groupSize);
+            auto weights =
+                quantization::Quantize(values, rows, cols, format, groupSize);
+            REQUIRE(weights);
+            CHECK(weights->Groups()
+                  == (groupSize == 0 ? 1 : (cols + groupSize - 1) / groupSize));
+            const std::vector<float> restored =
+                quantization::Dequantize(*weights);
+            CHECK_THAT(restored[5], Catch::Matchers::WithinAbs(0.0, 0.0));
+            for (size_t i = 0; i < values.size(); ++i) {
+                const size_t row = i / cols;
+                const size_t group = (i % cols)
+                    / static_cast<size_t>(weights->groupSize);
+                const float scale =
+                    weights->scales[row * static_cast<size_t>(weights->Groups())
+                                    + group];
+                CHECK(std::abs(restored[i] - values[i])
+                      <= 0.5f * scale * 1.0001f);
+            }
+        }
+    }
+}
+
+TEST_CASE("Quantized GEMM and GEMV dequantize in registers",
+          "[quantization]")
+{
+    Fixture f;
+    quantization::Matmul matmul;
+    REQUIRE(matmul.Initialize(f.device, f.compiler));
+    constexpr int32_t N = 45;
+    constexpr int32_t K = 70;
+    const std::vector<float> w = Weights(N * K, 1.0f);
+
+    struct Case
+    {
+        Format format;
+        int32_t groupSize;
+        int32_t m;
+        Strategy strategy;
+    };
+    const std::vector<Case> cases = {
+        {Format::Int8, 0, 37, Strategy::Gemm},
+        {Format::Int8, 0, 3, Strategy::Gemv},
+        {Format::Int8, 32, 37, Strategy::Gemv},
+        {Format::Int4, 16, 37, Strategy::Gemm},
+        {Format::Int4, 16, 1, Strategy::Auto},
+        {Format::Int4, 0, 2, Strategy::Gemm},
+    };
+    for (const Case& c : cases) {
+        INFO("format " << static_cast<int>(c.format) << " group "
+                       << c.groupSize << " m " << c.m << " strategy "
+                       << static_cast<int>(c.strategy));
+        auto host = quantization::Quantize(w, N, K, c.format, c.groupSize);
+        REQUIRE(host);
+        const std::vector<float> a =
+            Weights(static_cast<size_t>(c.m) * K, 2.0f);
+        std::vector<float> expected(static_cast<size_t>(c.m) * N);
+        gemm::ReferenceGemm(gemm::Variant::NT,
+                            {.m = c.m, .n = N, .k = K},
+                            a,
+                            quantization::Dequantize(*host),
+                            expected);
+
+        const quantization::DeviceWeights weights =
+            quantization::Upload(f.device, *host);
+        CHECK_THAT(f.Multiply(matmul, a, c.m, weights, c.strategy),
+                   Catch::Matchers::Approx(expected).epsilon(1e-4f).margin(
+                       1e-4f));
+    }
+}
+
+TEST_CASE("Quantized products stay close to f32", "[quantization]")
+{
+    Fixture f;
+    quantization::Matmul matmul;
+    REQUIRE(matmul.Initialize(f.device, f.compiler));
+    constexpr int32_t M = 8;
+    constexpr int32_t N = 64;
+    constexpr int32_t K = 256;
+    const std::vector<float> w = Weights(N * K, 0.25f);
+    const std::vector<float> a = Weights(M * K, 3.0f);
+    std::vector<float> expected(M * N);
+    gemm::ReferenceGemm(
+        gemm::Variant::NT, {.m = M, .n = N, .k = K}, a, w, expected);
+
+    auto int8 = quantization::Load(f.device, w, N, K, Format::Int8);
+    auto int4 = quantization::Load(f.device, w, N, K, Format::Int4, 32);
+    REQUIRE(int8);
+    REQUIRE(int4);
+    // Packed words take a quarter and an eighth of the f32 bytes.
+    CHECK(int8->words.GetSize() == N * K);
+    CHECK(int4->words.GetSize() == N * K / 2);
+
+    // A step is 1/255 and 1/15 of the range; the errors mostly cancel.
+    CHECK(RelativeError(f.Multiply(matmul, a, M, *int8, Strategy::Gemm),
+                        expected)
+          < 0.01f);
+    CHECK(RelativeError(f.Multiply(matmul, a, M, *int4, Strategy::Gemm),
+                        expected)
+          < 0.1f);
+    CHECK(RelativeError(f.Multiply(matmul, a, M, *int4, Strategy::Gemv),
+                        expected)
+          < 0.1f);
+}
@@ -0,0 +1,169 @@
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+#include "radix_sort.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "test_fixture.hpp"
+
+namespace
+{
+using radix_sort::KeyType;
+using radix_sort::Order;
+
+struct Fixture : TestFixture
+{
+    /// Sorts in place on the GPU and reads keys and values back.
+    void Sort(const radix_sort::Sorter& sorter,
+              std::vector<uint32_t>& keys,
+              std::vector<uint32_t>& values,
+              KeyType type,
+              Order order,
+              uint32_t keyBits = 32)
+    {
+        wgpu::Buffer keyBuffer = Upload(keys);
+        wgpu::Buffer valueBuffer = Upload(values);
+        const auto count = static_cast<uint32_t>(keys.size());
+        wgpu::CommandEncoder encoder = device.CreateCommandEncoder();
+        wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+        REQUIRE(sorter.Encode(pass,
+                              keyBuffer,
+                              valueBuffer,
+                              keyBuffer,
+                              valueBuffer,
+                              count,
+                              type,
+                              order,
+                              keyBits));
+        pass.End();
+        Submit(encoder);
+        keys = Read<uint32_t>(keyBuffer, keys.size());
+        values = Read<uint32_t>(valueBuffer, values.size());
+    }
+};
+
+/// Keys with many duplicates, so that stability shows in the values.
+std::vector<uint32_t> Keys(size_t count, uint32_t distinct)
+{
+    std::vector<uint32_t> keys(count);
+    for (size_t i = 0; i < count; ++i) {
+        keys[i] = (static_cast<uint32_t>(i) * 2654435761u) % distinct
+            * 0x01010101u;
+    }
+    return keys;
+}
+
+std::vector<uint32_t> Indices(size_t count)
+{
+    std::vector<uint32_t> values(count);
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = static_cast<uint32_t>(i);
+    }
+    return values;
+}
+}    // namespace
+
+TEST_CASE("Reference sorts are stable", "[radix_sort]")
+{
+    std::vector<uint32_t> keys = {3, 1, 3, 0, 1};
+    std::vector<uint32_t> values = {0, 1, 2, 3, 4};
+    radix_sort::ReferenceSort(keys, values, KeyType::Uint, Order::Descending);
+    const std::vector<uint32_t> expectedKeys = {3, 3, 1, 1, 0};
+    const std::vector<uint32_t> expectedValues = {0, 2, 1, 4, 3};
+    CHECK(keys == expectedKeys);
+    CHECK(values == expectedValues);
+}
+
+TEST_CASE("Uint sorts match a stable CPU sort", "[radix_sort]")
+{
+    Fixture f;
+    radix_sort::Sorter sorter;
+    REQUIRE(sorter.Initialize(f.device, f.compiler));
+    // Within one block, a partial last block, and many blocks.
+    for (size_t count : {size_t {1}, size_t {1000}, size_t {70000}}) {
+        for (Order order : {Order::Ascending, Order::Descending}) {
+            INFO("count " << count << " order " << static_cast<int>(order));
+            std::vector<uint32_t> keys = Keys(count, 251);
+            std::vector<uint32_t> values = Indices(count);
+            std::vector<uint32_t> expectedKeys = keys;
+            std::vector<uint32_t> expectedValues = values;
+            radix_sort::ReferenceSort(
+                expectedKeys, expectedValues, KeyType::Uint, order);
+
+            f.Sort(sorter, keys, values, KeyType::Uint, order);
+            CHECK(keys == expectedKeys);
+            CHECK(values == expectedValues);
+        }
+    }
+}
+
+TEST_CASE("Float sorts order signs and magnitudes", "[radix_sort]")
+{
+    Fixture f;
+    radix_sort::Sorter sorter;
+    REQUIRE(sorter.Initialize(f.device, f.compiler));
+    constexpr size_t kCount = 5000;
+    std::vector<uint32_t> keys(kCount);
+    for (size_t i = 0; i < kCount; ++i) {
+        const float value =
+            static_cast<float>((i * 37) % 101) * 0.25f - 12.5f;
+        keys[i] = std::bit_cast<uint32_t>(value);
+    }
+    keys[7] = std::bit_cast<uint32_t>(-0.0f);
+
+    for (Order order : {Order::Ascending, Order::Descending}) {
+        INFO("order " << static_cast<int>(order));
+        std::vector<uint32_t> sortedKeys = keys;
+        std::vector<uint32_t> values = Indices(kCount);
+        std::vector<uint32_t> expectedKeys = keys;
+        std::vector<uint32_t> expectedValues = values;
+        radix_sort::ReferenceSort(
+            expectedKeys, expectedValues, KeyType::Float, order);
+
+        f.Sort(sorter, sortedKeys, values, KeyType::Float, order);
+        CHECK(sortedKeys == expectedKeys);
+        CHECK(values == expectedValues);
+    }
+}
+
+TEST_CASE("Narrow key sorts compare only the low bits", "[radix_sort]")
+{
+    Fixture f;
+    radix_sort::Sorter sorter;
+    REQUIRE(sorter.Initialize(f.device, f.compiler));
+    std::vector<uint32_t> keys = Keys(3000, 1 << 12);
+    std::vector<uint32_t> values = Indices(keys.size());
+    std::vector<uint32_t> expectedKeys = keys;
+    std::vector<uint32_t> expectedValues = values;
+    radix_sort::ReferenceSort(
+        expectedKeys, expectedValues, KeyType::Uint, Order::Ascending, 6);
+
+    f.Sort(sorter, keys, values, KeyType::Uint, Order::Ascending, 6);
+    CHECK(keys == expectedKeys);
+    CHECK(values == expectedValues);
+}
+
+TEST_CASE("Sorts reject empty inputs and bad key widths", "[radix_sort]")
+{
+    Fixture f;
+    radix_sort::Sorter sorter;
+    REQUIRE(sorter.Initialize(f.device, f.compiler));
+    wgpu::Buffer keys = f.Upload<uint32_t>({1, 2});
+    wgpu::Buffer values = f.Upload<uint32_t>({1, 2});
+    wgpu::CommandEncoder encoder = f.device.CreateCommandEncoder();
+    wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+    CHECK_FALSE(sorter.Encode(
+        pass, keys, values, keys, values, 0, KeyType::Uint, Order::Ascending));
+    CHECK_FALSE(sorter.Encode(pass,
+                              keys,
+                              values,
+                              keys,
+                              values,
+                              2,
+                              KeyType::Uint,
+                              Order::Ascending,
+                              33));
+    pass.End();
+}
@@ -0,0 +1,238 @@
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "reduction.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <catch2/matchers/catch_matchers_vector.hpp>
+
+#include "test_fixture.hpp"
+
+namespace
+{
+struct Fixture : TestFixture
+{
+    reduction::Reducer reducer;
+
+    explicit Fixture(std::optional<subgroups::Path> path = std::nullopt)
+        : reducer(path)
+    {
+    }
+
+    std::optional<reduction::Result> Reduce(const std::vector<float>& values,
+                                            std::span<const int32_t> dims,
+                                            std::span<const size_t> axes,
+                                            reduction::Op op)
+    {
+        wgpu::Buffer input = Upload(values);
+        wgpu::CommandEncoder encoder = device.CreateCommandEncoder();
+        wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+        auto result = reducer.Reduce(pass, input, dims, axes, op);
+        pass.End();
+        Submit(encoder);
+        return result;
+    }
+};
+
+/// Small integers keep every partial sum exact.
+std::vector<float> Sequence(size_t count)
+{
+    std::vector<float> values(count);
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = static_cast<float>((i * 7) % 11) - 5.0f;
+    }
+    return values;
+}
+
+/// CPU sum of a [outer, length, inner] view over its middle axis.
+std::vector<float> ReferenceSum(const std::vector<float>& values,
+                                const reduction::AxisView& view)
+{
+    const auto outer = static_cast<size_t>(view.outer);
+    const auto length = static_cast<size_t>(view.length);
+    const auto inner = static_cast<size_t>(view.inner);
+    std::vector<float> sums(outer * inner, 0.0f);
+    for (size_t o = 0; o < outer; ++o) {
+        for (size_t l = 0; l < length; ++l) {
+            for (size_t i = 0; i < inner; ++i) {
+                sums[o * inner + i] += values[(o * length + l) * inner + i];
+            }
+        }
+    }
+    return sums;
+}
+}    // namespace
+
+TEST_CASE("Axis views fold contiguous axes", "[reduction]")
+{
+    const std::array<int32_t, 4> dims = {2, 3, 5, 7};
+    reduction::AxisView view = reduction::ViewAxes(dims, 1, 2);
+    CHECK(view.outer == 2);
+    CHECK(view.length == 15);
+    CHECK(view.inner == 7);
+
+    const std::array<size_t, 2> axes = {0, 3};
+    CHECK(reduction::ReducedDims(dims, axes)
+          == std::vector<int32_t>({1, 3, 5, 1}));
+
+    CHECK(reduction::PassCount({.length = reduction::kRowChunk}) == 1);
+    CHECK(reduction::PassCount({.length = reduction::kRowChunk + 1}) == 2);
+    CHECK(reduction::PassCount(
+              {.length = reduction::kColumnChunk + 1, .inner = 2})
+          == 2);
+}
+
+TEST_CASE("Sums over every axis match the CPU", "[reduction]")
+{
+    Fixture f;
+    REQUIRE(f.reducer.Initialize(f.device, f.compiler));
+
+    const std::array<int32_t, 3> dims = {3, 5, 7};
+    const std::vector<float> values = Sequence(3 * 5 * 7);
+    for (size_t axis = 0; axis < dims.size(); ++axis) {
+        INFO("axis " << axis);
+        const std::array<size_t, 1> axes = {axis};
+        auto result = f.Reduce(values, dims, axes, reduction::Op::Sum);
+        REQUIRE(result);
+        reduction::AxisView view = reduction::ViewAxes(dims, axis, axis);
+        std::vector<float> expected = ReferenceSum(values, view);
+        CHECK(result->dims == reduction::ReducedDims(dims, axes));
+        CHECK_THAT(f.Read<float>(result->values, expected.size()),
+                   Catch::Matchers::Equals(expected));
+    }
+
+    // Non-contiguous axes reduce the inner run first, then the outer one.
+    const std::array<size_t, 2> outerInner = {0, 2};
+    auto result = f.Reduce(values, dims, outerInner, reduction::Op::Sum);
+    REQUIRE(result);
+    std::vector<float> expected(5, 0.0f);
+    for (size_t i = 0; i < values.size(); ++i) {
+        expected[(i / 7) % 5] += values[i];
+    }
+    CHECK_THAT(f.Read<float>(result->values, 5),
+               Catch::Matchers::Equals(expected));
+}
+
+TEST_CASE("Max, min, mean and argmax over the last axis", "[reduction]")
+{
+    Fixture f;
+    REQUIRE(f.reducer.Initialize(f.device, f.compiler));
+
+    const std::array<int32_t, 2> dims = {2, 6};
+    const std::vector<float> values = {
+        1.0f, 9.0f, -2.0f, 9.0f, 0.5f, 3.0f,
+        -1.0f, -4.0f, -3.0f, -0.5f, -8.0f, -2.0f,
+    };
+    const std::array<size_t, 1> axes = {1};
+
+    auto max = f.Reduce(values, dims, axes, reduction::Op::Max);
+    auto min = f.Reduce(values, dims, axes, reduction::Op::Min);
+    auto mean = f.Reduce(values, dims, axes, reduction::Op::Mean);
+    auto argmax = f.Reduce(values, dims, axes, reduction::Op::Argmax);
+    REQUIRE(max);
+    REQUIRE(min);
+    REQUIRE(mean);
+    REQUIRE(argmax);
+
+    CHECK_THAT(f.Read<float>(max->values, 2),
+               Catch::Matchers::Equals(std::vector<float> {9.0f, -0.5f}));
+    CHECK_THAT(f.Read<float>(min->values, 2),
+               Catch::Matchers::Equals(std::vector<float> {-2.0f, -8.0f}));
+    std::vector<float> means = f.Read<float>(mean->values, 2);
+    REQUIRE(means.size() == 2);
+    CHECK_THAT(means[0], Catch::Matchers::WithinRel(20.5f / 6.0f, 1e-6f));
+    CHECK_THAT(means[1], Catch::Matchers::WithinRel(-18.5f / 6.0f, 1e-6f));
+    // Ties resolve to the first maximum.
+    CHECK(f.Read<int32_t>(argmax->indices, 2)
+          == std::vector<int32_t>({1, 3}));
+
+    // Contiguous axes are flattened; split ones are rejected for argmax.
+    const std::array<size_t, 2> both = {0, 1};
+    auto flat = f.Reduce(values, dims, both, reduction::Op::Argmax);
+    REQUIRE(flat);
+    CHECK(f.Read<int32_t>(flat->indices, 1) == std::vector<int32_t>({1}));
+    const std::array<int32_t, 3> cube = {2, 3, 2};
+    const std::array<size_t, 2> split = {0, 2};
+    CHECK_FALSE(f.Reduce(values, cube, split, reduction::Op::Argmax));
+    const std::array<size_t, 1> outOfRange = {2};
+    CHECK_FALSE(f.Reduce(values, dims, outOfRange, reduction::Op::Sum));
+}
+
+TEST_CASE("Rows of infinities reduce to infinity", "[reduction]")
+{
+    constexpr float kInf = std::numeric_limits<float>::infinity();
+    const std::array<int32_t, 2> dims = {2, 5};
+    const std::vector<float> values = {
+        -kInf, -kInf, -kInf, -kInf, -kInf,
+        kInf, kInf, kInf, kInf, kInf,
+    };
+    const std::array<size_t, 1> axes = {1};
+
+    for (subgroups::Path path :
+         {subgroups::Path::Shared, subgroups::Path::Subgroups})
+    {
+        INFO("path " << subgroups::PathName(path));
+        Fixture f(path);
+        if (!f.reducer.Initialize(f.device, f.compiler)) {
+            CHECK(path == subgroups::Path::Subgroups);
+            continue;
+        }
+
+        auto max = f.Reduce(values, dims, axes, reduction::Op::Max);
+        auto min = f.Reduce(values, dims, axes, reduction::Op::Min);
+        auto argmax = f.Reduce(values, dims, axes, reduction::Op::Argmax);
+        REQUIRE(max);
+        REQUIRE(min);
+        REQUIRE(argmax);
+        CHECK_THAT(f.Read<float>(max->values, 2),
+                   Catch::Matchers::Equals(std::vector<float> {-kInf, kInf}));
+        CHECK_THAT(f.Read<float>(min->values, 2),
+                   Catch::Matchers::Equals(std::vector<float> {-kInf, kInf}));
+        CHECK_THAT(f.Read<float>(argmax->values, 2),
+                   Catch::Matchers::Equals(std::vector<float> {-kInf, kInf}));
+        CHECK(f.Read<int32_t>(argmax->indices, 2)
+              == std::vector<int32_t>({0, 0}));
+    }
+}
+
+TEST_CASE("Large reductions take several passes", "[reduction]")
+{
+    const int32_t length = 100000;
+    std::vector<float> values = Sequence(static_cast<size_t>(length));
+    values[77777] = 100.0f;
+    const std::array<int32_t, 1> dims = {length};
+    const std::array<size_t, 1> axes = {0};
+    REQUIRE(reduction::PassCount(reduction::ViewAxes(dims, 0, 0)) == 2);
+    float expected = 0.0f;
+    for (float value : values) {
+        expected += value;
+    }
+
+    // Both workgroup reduction paths, when the device has subgroups.
+    for (subgroups::Path path :
+         {subgroups::Path::Shared, subgroups::Path::Subgroups})
+    {
+        INFO("path " << subgroups::PathName(path));
+        Fixture f(path);
+        if (!f.reducer.Initialize(f.device, f.compiler)) {
+            CHECK(path == subgroups::Path::Subgroups);
+            continue;
+        }
+        CHECK(f.reducer.UsesSubgroups()
+              == (path == subgroups::Path::Subgroups));
+
+        auto sum = f.Reduce(values, dims, axes, reduction::Op::Sum);
+        auto argmax = f.Reduce(values, dims, axes, reduction::Op::Argmax);
+        REQUIRE(sum);
+        REQUIRE(argmax);
+        CHECK_THAT(f.Read<float>(sum->values, 1),
+                   Catch::Matchers::Equals(std::vector<float> {expected}));
+        CHECK(f.Read<int32_t>(argmax->indices, 1)
+              == std::vector<int32_t>({77777}));
+    }
+}
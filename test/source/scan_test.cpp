@@ -0,0 +1,140 @@
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "scan.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers.hpp>
+#include <catch2/matchers/catch_matchers_vector.hpp>
+
+#include "test_fixture.hpp"
+
+namespace
+{
+struct Fixture : TestFixture
+{
+    /// The fallback always runs; the subgroup path when it is usable.
+    std::vector<subgroups::Path> Paths() const
+    {
+        if (subgroups::Select(
+                subgroups::Query(device), std::nullopt, scan::kGroupSize)
+            == subgroups::Path::Subgroups)
+        {
+            return {subgroups::Path::Shared, subgroups::Path::Subgroups};
+        }
+        return {subgroups::Path::Shared};
+    }
+};
+
+/// Small integers keep every prefix sum exact.
+std::vector<float> Sequence(size_t count)
+{
+    std::vector<float> values(count);
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = static_cast<float>((i * 7) % 11) - 5.0f;
+    }
+    return values;
+}
+}    // namespace
+
+TEST_CASE("Reference scans are inclusive or exclusive", "[scan]")
+{
+    const std::vector<float> values = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+    std::vector<float> output(values.size());
+    scan::ReferenceScan(values, output, 2, 3, scan::Kind::Inclusive);
+    CHECK_THAT(output,
+               Catch::Matchers::Equals<float>(
+                   {1.0f, 3.0f, 6.0f, 4.0f, 9.0f, 15.0f}));
+    scan::ReferenceScan(values, output, 2, 3, scan::Kind::Exclusive);
+    CHECK_THAT(output,
+               Catch::Matchers::Equals<float>(
+                   {0.0f, 1.0f, 3.0f, 0.0f, 4.0f, 9.0f}));
+}
+
+TEST_CASE("Row scans match the CPU on both paths", "[scan]")
+{
+    Fixture f;
+    // Short rows, a row ending in a partial chunk, a full block, several
+    // blocks ending in a partial one, and enough blocks that their totals
+    // are scanned in blocks themselves.
+    const std::vector<std::array<int32_t, 2>> shapes = {
+        {5, 3},
+        {3, 1000},
+        {2, scan::kBlockLength},
+        {3, 5 * scan::kBlockLength + 17},
+        {1, scan::kBlockLength * scan::kBlockLength + 3}};
+
+    for (subgroups::Path path : f.Paths()) {
+        scan::Scanner scanner(scan::Element::Float, path);
+        REQUIRE(scanner.Initialize(f.device, f.compiler));
+        CHECK(scanner.GetPath() == path);
+        for (const auto& [rows, length] : shapes) {
+            for (scan::Kind kind :
+                 {scan::Kind::Inclusive, scan::Kind::Exclusive})
+            {
+                INFO("path " << subgroups::PathName(path) << " shape " << rows
+                             << "x" << length << " kind "
+                             << static_cast<int>(kind));
+                const auto count = static_cast<size_t>(rows * length);
+                const std::vector<float> values = Sequence(count);
+                std::vector<float> expected(count);
+                scan::ReferenceScan(values, expected, rows, length, kind);
+
+                wgpu::Buffer input = f.Upload(values);
+                wgpu::Buffer output = f.Create<float>(count);
+                wgpu::CommandEncoder encoder =
+                    f.device.CreateCommandEncoder();
+                wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+                REQUIRE(scanner.Encode(
+                    pass, input, output, rows, length, kind));
+                pass.End();
+                f.Submit(encoder);
+
+                CHECK_THAT(f.Read<float>(output, count),
+                           Catch::Matchers::Equals(expected));
+            }
+        }
+    }
+}
+
+TEST_CASE("Uint scans of long rows match the CPU", "[scan]")
+{
+    Fixture f;
+    constexpr int32_t kRows = 2;
+    constexpr int32_t kLength = 3 * scan::kBlockLength + 5;
+    constexpr size_t kCount = static_cast<size_t>(kRows) * kLength;
+    std::vector<uint32_t> values(kCount);
+    for (size_t i = 0; i < kCount; ++i) {
+        values[i] = static_cast<uint32_t>((i * 13) % 7);
+    }
+    std::vector<uint32_t> expected(kCount);
+    scan::ReferenceScan(
+        values, expected, kRows, kLength, scan::Kind::Exclusive);
+
+    scan::Scanner scanner(scan::Element::Uint);
+    REQUIRE(scanner.Initialize(f.device, f.compiler));
+    CHECK(scanner.GetElement() == scan::Element::Uint);
+    wgpu::Buffer input = f.Upload(values);
+    wgpu::Buffer output = f.Create<uint32_t>(kCount);
+    wgpu::CommandEncoder encoder = f.device.CreateCommandEncoder();
+    wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+    REQUIRE(scanner.Encode(
+        pass, input, output, kRows, kLength, scan::Kind::Exclusive));
+    pass.End();
+    f.Submit(encoder);
+
+    CHECK(f.Read<uint32_t>(output, kCount) == expected);
+}
+
+TEST_CASE("Scans reject empty shapes", "[scan]")
+{
+    Fixture f;
+    scan::Scanner scanner;
+    REQUIRE(scanner.Initialize(f.device, f.compiler));
+    wgpu::Buffer buffer = f.Create<float>(4);
+    wgpu::CommandEncoder encoder = f.device.CreateCommandEncoder();
+    wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+    CHECK_FALSE(scanner.Encode(pass, buffer, f.Create<float>(4), 0, 4));
+    pass.End();
+}
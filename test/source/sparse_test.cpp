@@ -0,0 +1,172 @@
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "sparse.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <catch2/matchers/catch_matchers_vector.hpp>
+
+#include "test_fixture.hpp"
+
+namespace
+{
+using sparse::Format;
+using sparse::Strategy;
+using tensor_buffer::TensorView;
+
+struct Fixture : TestFixture
+{
+    /// Runs A x W^T on the device.
+    std::vector<float> Multiply(const sparse::Matmul& matmul,
+                                const std::vector<float>& a,
+                                int32_t m,
+                                const sparse::DeviceWeights& weights,
+                                Strategy strategy)
+    {
+        const size_t count =
+            static_cast<size_t>(m) * static_cast<size_t>(weights.rows);
+        wgpu::Buffer aBuffer = Upload(a);
+        wgpu::Buffer c = Upload(std::vector<float>(count));
+        const std::array<int32_t, 2> aDims = {m, weights.cols};
+
+        wgpu::CommandEncoder encoder = device.CreateCommandEncoder();
+        wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+        const bool encoded =
+            matmul.Encode(pass,
+                          {aBuffer, TensorView::Contiguous(aDims)},
+                          weights,
+                          c,
+                          strategy);
+        pass.End();
+        REQUIRE(encoded);
+        Submit(encoder);
+        return Read<float>(c, count);
+    }
+};
+
+std::vector<float> Values(size_t count, float phase)
+{
+    std::vector<float> values(count);
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = std::sin(static_cast<float>(i) * 0.37f + phase);
+    }
+    return values;
+}
+
+/// [rows, cols] weights keeping about one value in `keep`, except for row
+/// 3, which is dense, so that the rows are skewed.
+std::vector<float> Pruned(int32_t rows, int32_t cols, size_t keep)
+{
+    const auto width = static_cast<size_t>(cols);
+    std::vector<float> values = Values(static_cast<size_t>(rows) * width, 0.3f);
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i / width != 3 && (i * 7919) % keep != 0) {
+            values[i] = 0.0f;
+        }
+    }
+    return values;
+}
+}    // namespace
+
+TEST_CASE("CSR conversion keeps the non-zero values", "[sparse]")
+{
+    const std::vector<float> dense = {
+        0.0f, 2.0f, 0.0f, 0.0f, 0.0f, 0.0f, 3.0f, 0.0f, 4.0f};
+    auto csr = sparse::ToCsr(dense, 3, 3);
+    REQUIRE(csr);
+    const std::vector<int32_t> rowPtr = {0, 1, 1, 3};
+    const std::vector<int32_t> colIndices = {1, 0, 2};
+    CHECK(csr->rowPtr == rowPtr);
+    CHECK(csr->colIndices == colIndices);
+    CHECK_THAT(csr->values, Catch::Matchers::Equals<float>({2.0f, 3.0f, 4.0f}));
+    CHECK(csr->Nnz() == 3);
+    CHECK(csr->MaxRowNnz() == 2);
+    CHECK_THAT(csr->Density(), Catch::Matchers::WithinAbs(1.0 / 3.0, 1e-6));
+    CHECK_THAT(sparse::ToDense(*csr), Catch::Matchers::Equals(dense));
+    CHECK_FALSE(sparse::ToCsr(dense, 2, 3));
+
+    CHECK(sparse::ChooseFormat(0.05f) == Format::Csr);
+    CHECK(sparse::ChooseFormat(0.5f) == Format::Dense);
+    CHECK(sparse::ChooseFormat(0.5f, 0.6f) == Format::Csr);
+}
+
+TEST_CASE("Sparse products match the CPU with both strategies", "[sparse]")
+{
+    Fixture f;
+    sparse::Matmul matmul;
+    REQUIRE(matmul.Initialize(f.device, f.compiler));
+    constexpr int32_t kRows = 45;
+    constexpr int32_t kCols = 300;
+    auto csr = sparse::ToCsr(Pruned(kRows, kCols, 13), kRows, kCols);
+    REQUIRE(csr);
+    REQUIRE(csr->MaxRowNnz() == kCols);
+    const sparse::DeviceWeights weights = sparse::Upload(f.device, *csr);
+
+    // M = 1 is the SpMV case.
+    for (int32_t m : {1, 5}) {
+        const std::vector<float> a =
+            Values(static_cast<size_t>(m) * kCols, 1.1f);
+        std::vector<float> expected(static_cast<size_t>(m) * kRows);
+        sparse::ReferenceSpmm(*csr, a, m, expected);
+        for (Strategy strategy :
+             {Strategy::Auto, Strategy::RowSplit, Strategy::MergePath})
+        {
+            INFO("m " << m << " strategy " << static_cast<int>(strategy));
+            CHECK_THAT(f.Multiply(matmul, a, m, weights, strategy),
+                       Catch::Matchers::Approx(expected).epsilon(1e-4f).margin(
+                           1e-4f));
+        }
+    }
+}
+
+TEST_CASE("Dense weights above the threshold use the GEMM", "[sparse]")
+{
+    Fixture f;
+    sparse::Matmul matmul;
+    REQUIRE(matmul.Initialize(f.device, f.compiler));
+    constexpr int32_t kRows = 20;
+    constexpr int32_t kCols = 33;
+    constexpr int32_t kM = 3;
+    const std::vector<float> values =
+        Values(static_cast<size_t>(kRows) * kCols, 0.0f);
+
+    auto dense = sparse::Load(f.device, values, kRows, kCols);
+    REQUIRE(dense);
+    CHECK(dense->format == Format::Dense);
+    auto pruned =
+        sparse::Load(f.device, Pruned(kRows, kCols, 50), kRows, kCols);
+    REQUIRE(pruned);
+    CHECK(pruned->format == Format::Csr);
+    CHECK(pruned->Bytes() < dense->Bytes());
+
+    const std::vector<float> a = Values(static_cast<size_t>(kM) * kCols, 2.0f);
+    std::vector<float> expected(static_cast<size_t>(kM) * kRows);
+    auto csr = sparse::ToCsr(values, kRows, kCols);
+    REQUIRE(csr);
+    sparse::ReferenceSpmm(*csr, a, kM, expected);
+    CHECK_THAT(f.Multiply(matmul, a, kM, *dense, Strategy::Auto),
+               Catch::Matchers::Approx(expected).epsilon(1e-4f).margin(1e-4f));
+}
+
+TEST_CASE("Sparse products reject mismatched operands", "[sparse]")
+{
+    Fixture f;
+    sparse::Matmul matmul;
+    REQUIRE(matmul.Initialize(f.device, f.compiler));
+    auto csr = sparse::ToCsr(Pruned(4, 8, 3), 4, 8);
+    REQUIRE(csr);
+    const sparse::DeviceWeights weights = sparse::Upload(f.device, *csr);
+    wgpu::Buffer a = f.Upload(std::vector<float>(16));
+    wgpu::Buffer c = f.Upload(std::vector<float>(16));
+    const std::array<int32_t, 2> dims = {2, 7};
+
+    wgpu::CommandEncoder encoder = f.device.CreateCommandEncoder();
+    wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+    CHECK_FALSE(
+        matmul.Encode(pass, {a, TensorView::Contiguous(dims)}, weights, c));
+    pass.End();
+}
@@ -0,0 +1,48 @@
+#include "subgroups.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "lib.hpp"
+
+TEST_CASE("Subgroup paths need full subgroups of a minimum size",
+          "[subgroups]")
+{
+    using subgroups::Path;
+    using subgroups::Select;
+    const subgroups::Properties wave32 = {
+        .supported = true, .minSize = 32, .maxSize = 32};
+    const subgroups::Properties varying = {
+        .supported = true, .minSize = 8, .maxSize = 64};
+
+    CHECK(Select(wave32, std::nullopt, 256) == Path::Subgroups);
+    CHECK(Select(varying, std::nullopt, 256) == Path::Subgroups);
+    // Too few lanes for the kernel, or subgroups that could be partial.
+    CHECK(Select(varying, std::nullopt, 256, 16) == Path::Shared);
+    CHECK(Select(wave32, std::nullopt, 16) == Path::Shared);
+    CHECK(Select(varying, std::nullopt, 96) == Path::Shared);
+    // Without the feature, or with unknown sizes, only the fallback runs.
+    CHECK(Select({}, std::nullopt, 256) == Path::Shared);
+    CHECK(Select({.supported = true}, std::nullopt, 256) == Path::Shared);
+
+    // Requests override the choice, but cannot force unusable subgroups.
+    CHECK(Select(wave32, Path::Shared, 256) == Path::Shared);
+    CHECK(Select(wave32, Path::Subgroups, 256) == Path::Subgroups);
+    CHECK_FALSE(Select({}, Path::Subgroups, 256));
+}
+
+TEST_CASE("Subgroup properties follow the negotiated features",
+          "[subgroups]")
+{
+    Library lib;
+    wgpu::Instance instance = lib.CreateInstance();
+    wgpu::Adapter adapter = lib.RequestAdapter(instance);
+    wgpu::Device device = lib.RequestDevice(adapter);
+
+    const subgroups::Properties properties = subgroups::Query(device);
+    CHECK(properties.supported
+          == device.HasFeature(wgpu::FeatureName::Subgroups));
+    if (properties.supported) {
+        CHECK(properties.minSize > 0);
+        CHECK(properties.minSize <= properties.maxSize);
+    }
+}
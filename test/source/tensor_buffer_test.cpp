@@ -1,13 +1,19 @@
+#include <algorithm>
+#include <array>
+#include <string>
 #include <vector>
 
 #include "tensor_buffer.hpp"
 
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers.hpp>
+#include <catch2/matchers/catch_matchers_vector.hpp>
 
 #include "lib.hpp"
+#include "compute_kernel.hpp"
 #include "slang_compiler.hpp"
-#include "std140.hpp"
 #include "tensor_reflection.hpp"
+#include "uniform_buffer.hpp"
 
 TEST_CASE("Create TensorBuffer bindings", "[tensor_buffer]")
 {
@@ -49,17 +55,8 @@ void computeMain(uint3 tid: SV_DispatchThreadID, uint3 ltid : SV_GroupThreadID)
     tensor_buffer::TensorBuffer tb(info);
     tb.Initialize(device, M * N * sizeof(float));
 
-    std140::Encoder encoder;
-    {
-        auto shape = encoder.beginStruct();
-        {
-            auto tuple = encoder.beginStruct();
-            encoder.write(M);
-            encoder.write(N);
-        }
-        encoder.write(M * N);
-    }
-    const auto& shape = encoder.data();
+    const std::array<int32_t, 2> dims = {M, N};
+    const auto shape = tensor_buffer::EncodeShape(dims);
     REQUIRE(shape.size() == tb.GetShapeSize());
     queue.WriteBuffer(
         tb.GetShapeBuffer(), tb.GetShapeOffset(), shape.data(), shape.size());
@@ -90,3 +87,533 @@ void computeMain(uint3 tid: SV_DispatchThreadID, uint3 ltid : SV_GroupThreadID)
     wgpu::BindGroup bindGroup = device.CreateBindGroup(&bindGroupDesc);
     REQUIRE(bindGroup != nullptr);
 }
+
+TEST_CASE("ChunkedTensorBuffer spans several bindings", "[tensor_buffer]")
+{
+    Library lib;
+    wgpu::Instance instance = lib.CreateInstance();
+    wgpu::Adapter adapter = lib.RequestAdapter(instance);
+    wgpu::Device device = lib.RequestDevice(adapter);
+    wgpu::Queue queue = device.GetQueue();
+
+    constexpr int M = 3;
+    constexpr int N = 4;
+    // Artificially low limit: four floats per chunk, three chunks in total.
+    constexpr size_t ChunkBytes = 4 * sizeof(float);
+
+    const char* shader = R"(
+import tensor;
+ChunkedRWTensorBuffer<float, int, int> input;
+[numthreads(1,1,1)]
+void computeMain(uint3 tid: SV_DispatchThreadID)
+{
+    int i = int(tid.x);
+    int j = int(tid.y);
+    var r = input;
+    r[i, j] = r[i, j] * 2.0f;
+}
+)";
+
+    slang_compiler::Compiler compiler({SHADERS_DIR});
+    auto prog =
+        compiler.CompileFromSource(shader, "chunked-tensor", "computeMain");
+    std::string wgslSource = prog.compileToWGSL();
+
+    auto infoOpt = tensor_reflection::ReflectChunkedTensorBuffer(
+        prog.program.get(), "input");
+    REQUIRE(infoOpt.has_value());
+
+    std::vector<float> data(M * N);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<float>(i);
+    }
+
+    tensor_buffer::ChunkedTensorBuffer tb(*infoOpt);
+    REQUIRE(tb.Initialize(
+        device, data.size() * sizeof(float), sizeof(float), ChunkBytes));
+    REQUIRE(tb.GetChunkCount() == 3);
+    REQUIRE(tb.GetChunkElements() == 4);
+    tb.Write(queue, data.data(), data.size() * sizeof(float));
+
+    const std::array<int32_t, 2> dims = {M, N};
+    const auto shape =
+        tensor_buffer::EncodeChunkedShape(dims, tb.GetChunkElements());
+    REQUIRE(shape.size() == tb.GetShapeSize());
+    tb.WriteShape(queue, dims);
+
+    wgpu::BindGroupLayoutDescriptor bindGroupLayoutDesc = {
+        .label = "ChunkedTensorBuffer Layout",
+        .entryCount = tb.GetEntryCount(),
+        .entries = tb.GetBindGroupLayoutEntries(),
+    };
+    wgpu::BindGroupLayout bindGroupLayout =
+        device.CreateBindGroupLayout(&bindGroupLayoutDesc);
+
+    wgpu::BindGroupDescriptor bindGroupDesc = {
+        .label = "ChunkedTensorBuffer BindGroup",
+        .layout = bindGroupLayout,
+        .entryCount = tb.GetEntryCount(),
+        .entries = tb.GetBindGroupEntries(),
+    };
+    wgpu::BindGroup bindGroup = device.CreateBindGroup(&bindGroupDesc);
+    REQUIRE(bindGroup != nullptr);
+
+    wgpu::PipelineLayoutDescriptor pipelineLayoutDesc = {
+        .label = "Pipeline Layout",
+        .bindGroupLayoutCount = 1,
+        .bindGroupLayouts = &bindGroupLayout,
+    };
+    wgpu::PipelineLayout pipelineLayout =
+        device.CreatePipelineLayout(&pipelineLayoutDesc);
+
+    wgpu::ShaderSourceWGSL wgsl = {};
+    wgsl.code = wgslSource.c_str();
+    wgpu::ShaderModuleDescriptor shaderModuleDesc = {
+        .nextInChain = reinterpret_cast<wgpu::ChainedStruct*>(&wgsl),
+        .label = "Shader Module",
+    };
+    wgpu::ShaderModule shaderModule =
+        device.CreateShaderModule(&shaderModuleDesc);
+
+    wgpu::ComputePipelineDescriptor computePipelineDesc = {
+        .label = "Compute Pipeline",
+        .layout = pipelineLayout,
+        .compute =
+            {
+                .module = shaderModule,
+                .entryPoint = "computeMain",
+            },
+    };
+    wgpu::ComputePipeline computePipeline =
+        device.CreateComputePipeline(&computePipelineDesc);
+
+    wgpu::BufferDescriptor mapBufferDesc = {
+        .label = "Map Buffer",
+        .usage = wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::MapRead,
+        .size = data.size() * sizeof(float),
+        .mappedAtCreation = false,
+    };
+    wgpu::Buffer mapBuffer = device.CreateBuffer(&mapBufferDesc);
+
+    wgpu::CommandEncoder commandEncoder = device.CreateCommandEncoder();
+    wgpu::ComputePassEncoder pass = commandEncoder.BeginComputePass();
+    pass.SetPipeline(computePipeline);
+    pass.SetBindGroup(0, bindGroup);
+    pass.DispatchWorkgroups(M, N, 1);
+    pass.End();
+
+    size_t mapOffset = 0;
+    for (size_t c = 0; c < tb.GetChunkCount(); ++c) {
+        commandEncoder.CopyBufferToBuffer(tb.GetChunkBuffer(c),
+                                          0,
+                                          mapBuffer,
+                                          mapOffset,
+                                          tb.GetChunkByteSize(c));
+        mapOffset += tb.GetChunkByteSize(c);
+    }
+    wgpu::CommandBuffer commandBuffer = commandEncoder.Finish();
+    queue.Submit(1, &commandBuffer);
+
+    std::vector<float> result(data.size());
+    auto mapCallback =
+        [&mapBuffer, &result](wgpu::MapAsyncStatus status, wgpu::StringView)
+    {
+        if (status == wgpu::MapAsyncStatus::Success) {
+            const auto* mapped = static_cast<const float*>(
+                mapBuffer.GetConstMappedRange(0, result.size() * sizeof(float)));
+            std::copy(mapped, mapped + result.size(), result.begin());
+            mapBuffer.Unmap();
+        }
+    };
+    instance.WaitAny(mapBuffer.MapAsync(wgpu::MapMode::Read,
+                                        0,
+                                        result.size() * sizeof(float),
+                                        wgpu::CallbackMode::WaitAnyOnly,
+                                        mapCallback),
+                     UINT64_MAX);
+
+    std::vector<float> expected(data.size());
+    for (size_t i = 0; i < data.size(); ++i) {
+        expected[i] = data[i] * 2.0f;
+    }
+    REQUIRE_THAT(result, Catch::Matchers::Equals(expected));
+}
+
+TEST_CASE("ChunkedTensorBuffer rejects too many chunks", "[tensor_buffer]")
+{
+    Library lib;
+    wgpu::Instance instance = lib.CreateInstance();
+    wgpu::Adapter adapter = lib.RequestAdapter(instance);
+    wgpu::Device device = lib.RequestDevice(adapter);
+
+    tensor_reflection::ChunkedTensorBufferReflection info {};
+    tensor_buffer::ChunkedTensorBuffer tb(info);
+    CHECK_FALSE(tb.Initialize(device, 64 * sizeof(float), sizeof(float), 16));
+
+    // One-byte elements, more of them than 32-bit indices address.
+    tensor_buffer::ChunkedTensorBuffer huge(info);
+    CHECK_FALSE(huge.Initialize(
+        device, tensor_reflection::kMaxChunkedElements + 1, 1, 1u << 30));
+}
+
+TEST_CASE("TensorView transposes, slices and expands", "[tensor_buffer]")
+{
+    const std::array<int32_t, 3> dims = {2, 3, 4};
+    const auto view = tensor_buffer::TensorView::Contiguous(dims);
+    CHECK(view.strides == std::vector<int32_t>({12, 4, 1}));
+    CHECK(view.Count() == 24);
+    CHECK(view.IsContiguous());
+
+    auto transposed = view.Transpose(0, 2);
+    REQUIRE(transposed);
+    CHECK(transposed->dims == std::vector<int32_t>({4, 3, 2}));
+    CHECK(transposed->strides == std::vector<int32_t>({1, 4, 12}));
+    CHECK_FALSE(transposed->IsContiguous());
+    const std::array<int32_t, 1> flat = {24};
+    CHECK_FALSE(transposed->View(flat));
+
+    const std::array<size_t, 3> order = {1, 2, 0};
+    auto permuted = view.Permute(order);
+    REQUIRE(permuted);
+    CHECK(permuted->dims == std::vector<int32_t>({3, 4, 2}));
+
+    // An outer slice stays contiguous at an offset.
+    auto outer = view.Slice(0, 1, 2);
+    REQUIRE(outer);
+    CHECK(outer->offset == 12);
+    CHECK(outer->IsContiguous());
+    auto reshaped = outer->View(std::array<int32_t, 2> {6, 2});
+    REQUIRE(reshaped);
+    CHECK(reshaped->offset == 12);
+
+    auto strided = view.Slice(2, 1, 4, 2);
+    REQUIRE(strided);
+    CHECK(strided->dims == std::vector<int32_t>({2, 3, 2}));
+    CHECK(strided->strides == std::vector<int32_t>({12, 4, 2}));
+    CHECK(strided->offset == 1);
+    CHECK_FALSE(view.Slice(2, 3, 3));
+
+    const std::array<int32_t, 2> row = {1, 4};
+    auto expanded = tensor_buffer::TensorView::Contiguous(row).Expand(
+        std::array<int32_t, 3> {5, 3, 4});
+    REQUIRE(expanded);
+    CHECK(expanded->strides == std::vector<int32_t>({0, 0, 1}));
+    CHECK_FALSE(view.Expand(std::array<int32_t, 3> {2, 5, 4}));
+
+    // Dimensions, count, strides, offset and the contiguous flag.
+    CHECK(tensor_buffer::EncodeShape(*strided).size() == 64);
+}
+
+TEST_CASE("Kernels index strided views of one buffer", "[tensor_buffer]")
+{
+    Library lib;
+    wgpu::Instance instance = lib.CreateInstance();
+    wgpu::Adapter adapter = lib.RequestAdapter(instance);
+    wgpu::Device device = lib.RequestDevice(adapter);
+    wgpu::Queue queue = device.GetQueue();
+
+    const char* shader = R"(
+import tensor;
+RWTensorBuffer<float, int, int> src;
+RWTensorBuffer<float, int, int> dst;
+[numthreads(64,1,1)]
+void copyLinear(uint3 tid: SV_DispatchThreadID)
+{
+    var out = dst;
+    if (tid.x < uint(out.getCount()))
+        out[tid.x] = src[tid.x];
+}
+[numthreads(8,8,1)]
+void copyIndexed(uint3 tid: SV_DispatchThreadID)
+{
+    var out = dst;
+    int i = int(tid.x);
+    int j = int(tid.y);
+    if (i < 3 && j < 4)
+        out[i, j] = src[i, j];
+}
+)";
+
+    constexpr int M = 3;
+    constexpr int N = 4;
+    std::vector<float> data(M * N);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<float>(i);
+    }
+    wgpu::BufferDescriptor desc = {
+        .label = "tensor_buffer_test_view",
+        .usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst,
+        .size = data.size() * sizeof(float),
+        .mappedAtCreation = false,
+    };
+    wgpu::Buffer source = device.CreateBuffer(&desc);
+    queue.WriteBuffer(source, 0, data.data(), desc.size);
+
+    slang_compiler::Compiler compiler({SHADERS_DIR});
+    auto run = [&](const char* entryPoint,
+                   const tensor_buffer::TensorView& view,
+                   uint32_t groupsX)
+    {
+        auto prog = compiler.CompileFromSource(shader, "views", entryPoint);
+        auto* program = prog.program.get();
+        auto uniformsInfo = uniform_buffer::ReflectUniformBuffer(program);
+        auto srcInfo = tensor_reflection::ReflectTensorBuffer(program, "src");
+        auto dstInfo = tensor_reflection::ReflectTensorBuffer(program, "dst");
+        REQUIRE(uniformsInfo);
+        REQUIRE(srcInfo);
+        REQUIRE(dstInfo);
+
+        uniform_buffer::UniformBuffer uniforms(*uniformsInfo);
+        uniforms.Initialize(device);
+        tensor_buffer::TensorBuffer src(*srcInfo);
+        tensor_buffer::TensorBuffer dst(*dstInfo);
+        src.Initialize(uniforms, source, desc.size);
+        dst.Initialize(device, desc.size, uniforms);
+        src.WriteShape(queue, view);
+        dst.WriteShape(queue, view.dims);
+
+        compute_kernel::Bindings bindings;
+        bindings.Add(uniforms).Add(src).Add(dst);
+        compute_kernel::ComputeKernel kernel(entryPoint);
+        REQUIRE(kernel.Initialize(device,
+                                  prog.compileToWGSL(),
+                                  entryPoint,
+                                  bindings.GetLayoutEntries()));
+        wgpu::CommandEncoder encoder = device.CreateCommandEncoder();
+        wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+        pass.SetPipeline(kernel.GetPipeline());
+        pass.SetBindGroup(0, kernel.CreateBindGroup(bindings.GetEntries()));
+        pass.DispatchWorkgroups(groupsX, 1, 1);
+        pass.End();
+        wgpu::CommandBuffer commandBuffer = encoder.Finish();
+        queue.Submit(1, &commandBuffer);
+        return compute_kernel::ReadBuffer<float>(
+            instance,
+            device,
+            dst.GetDataBuffer(),
+            static_cast<size_t>(view.Count()));
+    };
+
+    const std::array<int32_t, 2> dims = {M, N};
+    const auto contiguous = tensor_buffer::TensorView::Contiguous(dims);
+
+    // Linear indices of a transposed view walk the source column by column.
+    auto transposed = contiguous.Transpose(0, 1);
+    REQUIRE(transposed);
+    std::vector<float> expected;
+    for (int j = 0; j < N; ++j) {
+        for (int i = 0; i < M; ++i) {
+            expected.push_back(data[static_cast<size_t>(i * N + j)]);
+        }
+    }
+    CHECK_THAT(run("copyLinear", *transposed, 1),
+               Catch::Matchers::Equals(expected));
+
+    // The middle row broadcast to every row, without a copy.
+    auto row = contiguous.Slice(0, 1, 2);
+    REQUIRE(row);
+    auto broadcast = row->Expand(dims);
+    REQUIRE(broadcast);
+    expected.clear();
+    for (int i = 0; i < M; ++i) {
+        expected.insert(expected.end(), data.begin() + N, data.begin() + 2 * N);
+    }
+    CHECK_THAT(run("copyIndexed", *broadcast, 1),
+               Catch::Matchers::Equals(expected));
+}
+
+TEST_CASE("SharedTensor tiles load and store cooperatively", "[tensor_buffer]")
+{
+    Library lib;
+    wgpu::Instance instance = lib.CreateInstance();
+    wgpu::Adapter adapter = lib.RequestAdapter(instance);
+    wgpu::Device device = lib.RequestDevice(adapter);
+    wgpu::Queue queue = device.GetQueue();
+
+    // Each workgroup doubles one 8x8 tile; fewer threads than elements
+    // exercises the strided distribution.
+    const char* shader = R"(
+import tensor;
+RWTensorBuffer<float, int, int> src;
+RWTensorBuffer<float, int, int> dst;
+uniform int2 dims;
+groupshared float tileStorage[64];
+struct TileStorage : ISharedStorage<float> {
+    static float load(int i) { return tileStorage[i]; }
+    static void store(int i, float value) { tileStorage[i] = value; }
+}
+[numthreads(16,1,1)]
+void doubleTiles(uint3 gid: SV_GroupID, uint3 ltid: SV_GroupThreadID)
+{
+    SharedTensor<float, TileStorage, 8, 8> tile;
+    int2 origin = int2(gid.y, gid.x) * 8;
+    tile.loadFrom(src, origin, dims, 0.0f, ltid.x, 16);
+    for (int e = int(ltid.x); e < tile.getCount(); e += 16)
+        tile[e / 8, e % 8] = 2.0f * tile[e / 8, e % 8];
+    var out = dst;
+    tile.storeTo(out, origin, dims, ltid.x, 16);
+}
+)";
+
+    constexpr int M = 10;
+    constexpr int N = 13;
+    std::vector<float> data(M * N);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<float>(i);
+    }
+    wgpu::BufferDescriptor desc = {
+        .label = "tensor_buffer_test_shared",
+        .usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst,
+        .size = data.size() * sizeof(float),
+        .mappedAtCreation = false,
+    };
+    wgpu::Buffer source = device.CreateBuffer(&desc);
+    queue.WriteBuffer(source, 0, data.data(), desc.size);
+
+    slang_compiler::Compiler compiler({SHADERS_DIR});
+    auto prog = compiler.CompileFromSource(shader, "shared", "doubleTiles");
+    auto* program = prog.program.get();
+    auto uniformsInfo = uniform_buffer::ReflectUniformBuffer(program);
+    auto dimsOffset = uniform_buffer::ReflectUniformOffset(program, "dims");
+    auto srcInfo = tensor_reflection::ReflectTensorBuffer(program, "src");
+    auto dstInfo = tensor_reflection::ReflectTensorBuffer(program, "dst");
+    REQUIRE(uniformsInfo);
+    REQUIRE(dimsOffset);
+    REQUIRE(srcInfo);
+    REQUIRE(dstInfo);
+
+    uniform_buffer::UniformBuffer uniforms(*uniformsInfo);
+    uniforms.Initialize(device);
+    tensor_buffer::TensorBuffer src(*srcInfo);
+    tensor_buffer::TensorBuffer dst(*dstInfo);
+    src.Initialize(uniforms, source, desc.size);
+    dst.Initialize(device, desc.size, uniforms);
+    const std::array<int32_t, 2> dims = {M, N};
+    src.WriteShape(queue, dims);
+    dst.WriteShape(queue, dims);
+    uniforms.Write(queue, *dimsOffset, dims);
+
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms).Add(src).Add(dst);
+    compute_kernel::ComputeKernel kernel("doubleTiles");
+    REQUIRE(kernel.Initialize(device,
+                              prog.compileToWGSL(),
+                              "doubleTiles",
+                              bindings.GetLayoutEntries()));
+    wgpu::CommandEncoder encoder = device.CreateCommandEncoder();
+    wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+    pass.SetPipeline(kernel.GetPipeline());
+    pass.SetBindGroup(0, kernel.CreateBindGroup(bindings.GetEntries()));
+    pass.DispatchWorkgroups((N + 7) / 8, (M + 7) / 8, 1);
+    pass.End();
+    wgpu::CommandBuffer commandBuffer = encoder.Finish();
+    queue.Submit(1, &commandBuffer);
+
+    std::vector<float> expected(data.size());
+    for (size_t i = 0; i < data.size(); ++i) {
+        expected[i] = 2.0f * data[i];
+    }
+    CHECK_THAT(compute_kernel::ReadBuffer<float>(
+                   instance, device, dst.GetDataBuffer(), data.size()),
+               Catch::Matchers::Equals(expected));
+}
+
+TEST_CASE("Data allocations are padded to whole 16-byte words",
+          "[tensor_buffer]")
+{
+    CHECK(tensor_buffer::PaddedBytes(0) == 16);
+    CHECK(tensor_buffer::PaddedBytes(4) == 16);
+    CHECK(tensor_buffer::PaddedBytes(16) == 16);
+    CHECK(tensor_buffer::PaddedBytes(40) == 48);
+}
+
+TEST_CASE("RWTensorBufferVec4 falls back on misaligned views and tails",
+          "[tensor_buffer]")
+{
+    Library lib;
+    wgpu::Instance instance = lib.CreateInstance();
+    wgpu::Adapter adapter = lib.RequestAdapter(instance);
+    wgpu::Device device = lib.RequestDevice(adapter);
+    wgpu::Queue queue = device.GetQueue();
+
+    // Each thread copies a run of four; the source view starts one element
+    // into its buffer and the last run covers only two elements.
+    const char* shader = R"(
+import tensor;
+RWTensorBufferVec4<float, int> src;
+RWTensorBufferVec4<float, int> dst;
+[numthreads(4,1,1)]
+void copyRuns(uint3 tid: SV_DispatchThreadID)
+{
+    uint first = tid.x * 4;
+    if (first >= uint(dst.getCount()))
+        return;
+    var out = dst;
+    out.storeVec4(first, src.loadVec4(first) + 1.0f);
+}
+)";
+
+    constexpr int32_t kCount = 10;
+    std::vector<float> data(16);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<float>(i);
+    }
+    wgpu::BufferDescriptor desc = {
+        .label = "tensor_buffer_test_vec4",
+        .usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst,
+        .size = data.size() * sizeof(float),
+        .mappedAtCreation = false,
+    };
+    wgpu::Buffer source = device.CreateBuffer(&desc);
+    queue.WriteBuffer(source, 0, data.data(), desc.size);
+
+    slang_compiler::Compiler compiler({SHADERS_DIR});
+    auto prog = compiler.CompileFromSource(shader, "vec4", "copyRuns");
+    auto* program = prog.program.get();
+    auto uniformsInfo = uniform_buffer::ReflectUniformBuffer(program);
+    auto srcInfo = tensor_reflection::ReflectTensorBuffer(program, "src");
+    auto dstInfo = tensor_reflection::ReflectTensorBuffer(program, "dst");
+    REQUIRE(uniformsInfo);
+    REQUIRE(srcInfo);
+    REQUIRE(dstInfo);
+
+    uniform_buffer::UniformBuffer uniforms(*uniformsInfo);
+    uniforms.Initialize(device);
+    tensor_buffer::TensorBuffer src(*srcInfo);
+    tensor_buffer::TensorBuffer dst(*dstInfo);
+    src.Initialize(uniforms, source, desc.size);
+    // Ten floats round up to three vectors.
+    dst.Initialize(device, kCount * sizeof(float), uniforms);
+    const std::array<int32_t, 1> all = {16};
+    const std::array<int32_t, 1> dims = {kCount};
+    auto view = tensor_buffer::TensorView::Contiguous(all).Slice(
+        0, 1, kCount + 1);
+    REQUIRE(view);
+    src.WriteShape(queue, *view);
+    dst.WriteShape(queue, dims);
+
+    compute_kernel::Bindings bindings;
+    bindings.Add(uniforms).Add(src).Add(dst);
+    compute_kernel::ComputeKernel kernel("copyRuns");
+    REQUIRE(kernel.Initialize(device,
+                              prog.compileToWGSL(),
+                              "copyRuns",
+                              bindings.GetLayoutEntries()));
+    wgpu::CommandEncoder encoder = device.CreateCommandEncoder();
+    wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+    pass.SetPipeline(kernel.GetPipeline());
+    pass.SetBindGroup(0, kernel.CreateBindGroup(bindings.GetEntries()));
+    pass.DispatchWorkgroups(1, 1, 1);
+    pass.End();
+    wgpu::CommandBuffer commandBuffer = encoder.Finish();
+    queue.Submit(1, &commandBuffer);
+
+    // Elements past the view stay zero.
+    std::vector<float> expected(12, 0.0f);
+    for (size_t i = 0; i < kCount; ++i) {
+        expected[i] = data[i + 1] + 1.0f;
+    }
+    CHECK_THAT(compute_kernel::ReadBuffer<float>(
+                   instance, device, dst.GetDataBuffer(), expected.size()),
+               Catch::Matchers::Equals(expected));
+}
@@ -39,5 +39,78 @@ void computeMain(uint3 tid: SV_DispatchThreadID, uint3 ltid : SV_GroupThreadID)
     CHECK(info.shapeBinding == 0);
     CHECK(info.shapeSpace == 0);
     CHECK(info.shapeOffset == 0);
-    CHECK(info.shapeSize == 32);
+    CHECK(info.shapeSize == 64);
+}
+
+TEST_CASE("Reflect ChunkedRWTensorBuffer bindings", "[reflection]")
+{
+    const char* shader = R"(
+import tensor;
+ChunkedRWTensorBuffer<float, int, int> input;
+[numthreads(1,1,1)]
+void computeMain(uint3 tid: SV_DispatchThreadID)
+{
+    int i = int(tid.x);
+    int j = int(tid.y);
+    var r = input;
+    r[i, j] = r[i, j] + 1.0f;
+}
+)";
+
+    slang_compiler::Compiler compiler({SHADERS_DIR});
+    auto prog =
+        compiler.CompileFromSource(shader, "chunked-tensor", "computeMain");
+    auto infoOpt = tensor_reflection::ReflectChunkedTensorBuffer(
+        prog.program.get(), "input");
+    REQUIRE(infoOpt.has_value());
+    auto info = *infoOpt;
+    CHECK(info.shapeBinding == 0);
+    CHECK(info.shapeOffset == 0);
+    CHECK(info.shapeSize == 80);
+    for (uint32_t c = 0; c < tensor_reflection::kMaxTensorChunks; ++c) {
+        CHECK(info.chunkBindings[c] == c + 1);
+    }
+
+    CHECK_FALSE(
+        tensor_reflection::ReflectTensorBuffer(prog.program.get(), "input")
+            .has_value());
+}
+
+TEST_CASE("Reflect CsrTensorBuffer bindings", "[reflection]")
+{
+    const char* shader = R"(
+import tensor;
+CsrTensorBuffer<float> matrix;
+RWTensorBuffer<float, int> output;
+[numthreads(1,1,1)]
+void computeMain(uint3 tid: SV_DispatchThreadID)
+{
+    int row = int(tid.x);
+    float sum = 0.0f;
+    for (int e = matrix.rowBegin(row); e < matrix.rowEnd(row); ++e)
+        sum += matrix.value(e) * float(matrix.column(e));
+    var out = output;
+    out[row] = sum;
+}
+)";
+
+    slang_compiler::Compiler compiler({SHADERS_DIR});
+    auto prog = compiler.CompileFromSource(shader, "csr-tensor", "computeMain");
+    auto infoOpt = tensor_reflection::ReflectCsrTensorBuffer(
+        prog.program.get(), "matrix");
+    REQUIRE(infoOpt.has_value());
+    auto info = *infoOpt;
+    CHECK(info.shapeBinding == 0);
+    CHECK(info.shapeOffset == 0);
+    CHECK(info.rowPtrBinding == 1);
+    CHECK(info.colIndicesBinding == 2);
+    CHECK(info.valuesBinding == 3);
+    CHECK(info.dataSpace == 0);
+
+    CHECK_FALSE(
+        tensor_reflection::ReflectTensorBuffer(prog.program.get(), "matrix")
+            .has_value());
+    CHECK_FALSE(tensor_reflection::ReflectCsrTensorBuffer(prog.program.get(),
+                                                          "output")
+                    .has_value());
 }
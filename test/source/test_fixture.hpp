@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <webgpu/webgpu_cpp.h>
+
+#include "compute_kernel.hpp"
+#include "gpu_memory.hpp"
+#include "lib.hpp"
+#include "slang_compiler.hpp"
+
+/**
+ * @brief Device, compiler and buffer helpers shared by the kernel tests.
+ *
+ * Test files derive their own Fixture from it and add the kernel under test
+ * together with the helpers that run it.
+ */
+struct TestFixture
+{
+    Library lib;
+    wgpu::Instance instance = lib.CreateInstance();
+    wgpu::Adapter adapter = lib.RequestAdapter(instance);
+    wgpu::Device device = lib.RequestDevice(adapter);
+    slang_compiler::Compiler compiler {{SHADERS_DIR}};
+    /// Buffers handed out by Create and Upload, released before the device.
+    std::vector<gpu_memory::TrackedBuffer> buffers;
+
+    /// Tracked storage buffer of `bytes` that can be written and read back.
+    gpu_memory::TrackedBuffer CreateBuffer(size_t bytes)
+    {
+        wgpu::BufferDescriptor desc = {
+            .label = "congpu_test",
+            .usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst
+                | wgpu::BufferUsage::CopySrc,
+            .size = bytes,
+            .mappedAtCreation = false,
+        };
+        return gpu_memory::CreateBuffer(device, desc);
+    }
+
+    /// Storage buffer of `count` elements of T, owned by the fixture.
+    template<typename T>
+    wgpu::Buffer Create(size_t count)
+    {
+        buffers.push_back(CreateBuffer(count * sizeof(T)));
+        return buffers.back().Get();
+    }
+
+    template<typename T>
+    wgpu::Buffer Upload(const std::vector<T>& values)
+    {
+        wgpu::Buffer buffer = Create<T>(values.size());
+        device.GetQueue().WriteBuffer(
+            buffer, 0, values.data(), values.size() * sizeof(T));
+        return buffer;
+    }
+
+    void Submit(wgpu::CommandEncoder encoder)
+    {
+        wgpu::CommandBuffer commandBuffer = encoder.Finish();
+        device.GetQueue().Submit(1, &commandBuffer);
+    }
+
+    template<typename T>
+    std::vector<T> Read(wgpu::Buffer buffer, size_t count)
+    {
+        return compute_kernel::ReadBuffer<T>(instance, device, buffer, count);
+    }
+
+    template<typename T>
+    std::vector<T> Read(const gpu_memory::TrackedBuffer& buffer, size_t count)
+    {
+        return Read<T>(buffer.Get(), count);
+    }
+};
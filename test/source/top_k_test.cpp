@@ -0,0 +1,84 @@
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "top_k.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers.hpp>
+#include <catch2/matchers/catch_matchers_vector.hpp>
+
+#include "test_fixture.hpp"
+
+namespace
+{
+using Fixture = TestFixture;
+
+/// Repeating values, so that every row has ties.
+std::vector<float> Logits(size_t count)
+{
+    std::vector<float> values(count);
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = static_cast<float>((i * 29) % 53) * 0.5f - 10.0f;
+    }
+    return values;
+}
+}    // namespace
+
+TEST_CASE("Reference top-k breaks ties by index", "[top_k]")
+{
+    const std::vector<float> logits = {1.0f, 3.0f, 2.0f, 3.0f};
+    std::vector<float> values(2);
+    std::vector<int32_t> indices(2);
+    top_k::ReferenceTopK(logits, 1, 4, 2, values, indices);
+    CHECK_THAT(values, Catch::Matchers::Equals<float>({3.0f, 3.0f}));
+    const std::vector<int32_t> expectedIndices = {1, 3};
+    CHECK(indices == expectedIndices);
+}
+
+TEST_CASE("Top-k matches the CPU", "[top_k]")
+{
+    Fixture f;
+    top_k::TopK topK;
+    REQUIRE(topK.Initialize(f.device, f.compiler));
+    // One long row, and several rows spanning sort blocks.
+    const std::vector<std::array<int32_t, 3>> shapes = {
+        {1, 5000, 40}, {7, 777, 5}, {3, 10, 10}};
+
+    for (const auto& [rows, n, k] : shapes) {
+        INFO("rows " << rows << " n " << n << " k " << k);
+        const auto count = static_cast<size_t>(rows * n);
+        const auto selected = static_cast<size_t>(rows * k);
+        const std::vector<float> logits = Logits(count);
+        std::vector<float> expectedValues(selected);
+        std::vector<int32_t> expectedIndices(selected);
+        top_k::ReferenceTopK(
+            logits, rows, n, k, expectedValues, expectedIndices);
+
+        wgpu::Buffer input = f.Upload(logits);
+        wgpu::Buffer values = f.Create<float>(selected);
+        wgpu::Buffer indices = f.Create<int32_t>(selected);
+        wgpu::CommandEncoder encoder = f.device.CreateCommandEncoder();
+        wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+        REQUIRE(topK.Encode(pass, input, values, indices, rows, n, k));
+        pass.End();
+        f.Submit(encoder);
+
+        CHECK_THAT(f.Read<float>(values, selected),
+                   Catch::Matchers::Equals(expectedValues));
+        CHECK(f.Read<int32_t>(indices, selected) == expectedIndices);
+    }
+}
+
+TEST_CASE("Top-k rejects k outside the row", "[top_k]")
+{
+    Fixture f;
+    top_k::TopK topK;
+    REQUIRE(topK.Initialize(f.device, f.compiler));
+    wgpu::Buffer buffer = f.Create<float>(4);
+    wgpu::CommandEncoder encoder = f.device.CreateCommandEncoder();
+    wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+    CHECK_FALSE(topK.Encode(pass, buffer, buffer, buffer, 1, 4, 0));
+    CHECK_FALSE(topK.Encode(pass, buffer, buffer, buffer, 1, 4, 5));
+    pass.End();
+}